@@ -17,6 +17,7 @@
 
 #include "CCDB/CcdbApi.h"
 #include "CCDB/CCDBTimeStampUtils.h"
+#include "CCDB/CCDBSharedDownloadCache.h"
 #include <string>
 #include <map>
 #include <unordered_map>
@@ -51,6 +52,7 @@ class CCDBManagerInstance
   CCDBManagerInstance(std::string const& path) : mCCDBAccessor{}
   {
     mCCDBAccessor.init(path);
+    mSharedCache = CCDBSharedDownloadCache::fromEnvironment();
   }
 
   /// set a URL to query from
@@ -135,23 +137,39 @@ class CCDBManagerInstance
   /// reset the object upper validity limit
   void resetCreatedNotBefore() { mCreatedNotBefore = 0; }
 
+  /// download the objects via a node-wide shared memory cache (nullptr to disable it); by default the
+  /// one configured with the ALICEO2_CCDB_SHARED_CACHE environment variable is used, if any.
+  /// Each manager still deserializes its own copy of the objects from the shared content
+  void setSharedDownloadCache(std::shared_ptr<CCDBSharedDownloadCache> cache) { mSharedCache = std::move(cache); }
+
+  /// the shared download cache in use, if any
+  std::shared_ptr<CCDBSharedDownloadCache> const& getSharedDownloadCache() const { return mSharedCache; }
+
  private:
   // we access the CCDB via the CURL based C++ API
   o2::ccdb::CcdbApi mCCDBAccessor;
-  std::unordered_map<std::string, CachedObject> mCache; //! map for {path, CachedObject} associations
-  std::map<std::string, std::string> mMetaData;         // some dummy object needed to talk to CCDB API
-  std::map<std::string, std::string> mHeaders;          // headers to retrieve tags
-  long mTimestamp{o2::ccdb::getCurrentTimestamp()};     // timestamp to be used for query (by default "now")
-  bool mCanDefault = false;                             // whether default is ok --> useful for testing purposes done standalone/isolation
-  bool mCachingEnabled = true;                          // whether caching is enabled
-  bool mCheckObjValidityEnabled = false;                // wether the validity of cached object is checked before proceeding to a CCDB API query
-  long mCreatedNotAfter = 0;                            // upper limit for object creation timestamp (TimeMachine mode) - If-Not-After HTTP header
-  long mCreatedNotBefore = 0;                           // lower limit for object creation timestamp (TimeMachine mode) - If-Not-Before HTTP header
+  std::unordered_map<std::string, CachedObject> mCache;  //! map for {path, CachedObject} associations
+  std::map<std::string, std::string> mMetaData;          // some dummy object needed to talk to CCDB API
+  std::map<std::string, std::string> mHeaders;           // headers to retrieve tags
+  long mTimestamp{o2::ccdb::getCurrentTimestamp()};      // timestamp to be used for query (by default "now")
+  bool mCanDefault = false;                              // whether default is ok --> useful for testing purposes done standalone/isolation
+  bool mCachingEnabled = true;                           // whether caching is enabled
+  bool mCheckObjValidityEnabled = false;                 // wether the validity of cached object is checked before proceeding to a CCDB API query
+  long mCreatedNotAfter = 0;                             // upper limit for object creation timestamp (TimeMachine mode) - If-Not-After HTTP header
+  long mCreatedNotBefore = 0;                            // lower limit for object creation timestamp (TimeMachine mode) - If-Not-Before HTTP header
+  std::shared_ptr<CCDBSharedDownloadCache> mSharedCache; //! node-wide cache of the downloaded objects, if any
+
+  template <typename T>
+  T* getFromSharedCache(std::string const& path, long timestamp);
 };
 
 template <typename T>
 T* CCDBManagerInstance::getForTimeStamp(std::string const& path, long timestamp)
 {
+  // the shared cache does not implement the TimeMachine mode
+  if (mSharedCache && !mCreatedNotAfter && !mCreatedNotBefore) {
+    return getFromSharedCache<T>(path, timestamp);
+  }
   if (!isCachingEnabled()) {
     return mCCDBAccessor.retrieveFromTFileAny<T>(path, mMetaData, timestamp, nullptr, "",
                                                  mCreatedNotAfter ? std::to_string(mCreatedNotAfter) : "",
@@ -180,6 +198,42 @@ T* CCDBManagerInstance::getForTimeStamp(std::string const& path, long timestamp)
   return ptr;
 }
 
+template <typename T>
+T* CCDBManagerInstance::getFromSharedCache(std::string const& path, long timestamp)
+{
+  if (timestamp < 0) {
+    timestamp = o2::ccdb::getCurrentTimestamp();
+  }
+  if (!isCachingEnabled()) {
+    auto view = mSharedCache->get(mCCDBAccessor, path, timestamp, mMetaData);
+    mMetaData.clear();
+    return view ? mCCDBAccessor.extractFromMemoryBlob<T>(view.data(), view.size()) : nullptr;
+  }
+  auto& cached = mCache[path];
+  if (mCheckObjValidityEnabled && cached.isValid(timestamp)) {
+    return reinterpret_cast<T*>(cached.objPtr.get());
+  }
+  auto view = mSharedCache->get(mCCDBAccessor, path, timestamp, mMetaData);
+  mMetaData.clear();
+  if (!view) {
+    clearCache(path);
+    return nullptr;
+  }
+  // deserialize only if the object differs from the one we already have
+  if (!cached.objPtr || cached.uuid != view.getETag() || cached.startvalidity != view.getValidFrom() || cached.endvalidity != view.getValidUntil()) {
+    T* ptr = mCCDBAccessor.extractFromMemoryBlob<T>(view.data(), view.size());
+    if (!ptr) {
+      clearCache(path);
+      return nullptr;
+    }
+    cached.objPtr.reset(ptr);
+    cached.uuid = view.getETag();
+    cached.startvalidity = view.getValidFrom();
+    cached.endvalidity = view.getValidUntil();
+  }
+  return reinterpret_cast<T*>(cached.objPtr.get());
+}
+
 class BasicCCDBManager : public CCDBManagerInstance
 {
  public:
@@ -0,0 +1,151 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   CCDBSharedDownloadCache.h
+/// \brief  Node local cache of the downloaded CCDB objects in shared memory
+///
+
+#ifndef O2_CCDBSHAREDDOWNLOADCACHE_H
+#define O2_CCDBSHAREDDOWNLOADCACHE_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace o2::ccdb
+{
+
+class CcdbApi;
+struct CCDBSharedCacheSegment;
+
+/// A cache of the downloaded CCDB objects shared by all the processes of a node.
+///
+/// The raw content of each object (i.e. the image of the TFile served by the CCDB) is stored
+/// once in a named shared memory segment and handed to the clients as a read-only View
+/// pointing into the segment. The first process asking for a given (path, timestamp) downloads
+/// the object, the others wait for it and then find it in the segment, such that the CCDB
+/// server is queried once per node. There is no separate server process, the segment is created
+/// by whichever process opens it first (or in advance with the o2-ccdb-shared-download-cache tool)
+/// and persists until it is removed.
+///
+/// Only the download is shared: a client deserializing an object from the View (as the CCDB
+/// managers do) gets a private copy of it, the memory of the deserialized objects is not shared.
+///
+/// Each entry records the processes holding Views of it, with the number of Views of each.
+/// Entries which are not referenced stay in the segment, so that they can be served to other
+/// processes, and are evicted in least recently used order when space is needed for a new one.
+/// The references of the processes which died without releasing their Views are dropped when
+/// entries are evicted or inspected.
+class CCDBSharedDownloadCache
+{
+ public:
+  /// environment variable with the name of the segment to be used by the CCDB managers
+  static constexpr const char* SEGMENT_ENV = "ALICEO2_CCDB_SHARED_CACHE";
+  /// environment variable with the size of the segment in MB, if it has to be created
+  static constexpr const char* SIZE_ENV = "ALICEO2_CCDB_SHARED_CACHE_SIZE";
+  static constexpr size_t DEFAULT_SIZE = size_t(2048) << 20;
+  /// maximum number of objects in the segment
+  static constexpr size_t MAX_ENTRIES = 1024;
+  /// maximum length of the key (URL, path and metadata) of an object
+  static constexpr size_t MAX_KEY_SIZE = 512;
+  /// maximum number of processes holding Views of the same object
+  static constexpr size_t MAX_HOLDERS = 64;
+
+  class View
+  {
+   public:
+    View() = default;
+
+    char const* data() const { return mData; }
+    size_t size() const { return mSize; }
+    long getValidFrom() const { return mValidFrom; }
+    long getValidUntil() const { return mValidUntil; }
+    std::string const& getETag() const { return mETag; }
+    /// true if the content lives in the shared segment rather than in private memory
+    bool isShared() const { return mShared; }
+    explicit operator bool() const { return mData != nullptr; }
+
+   private:
+    friend class CCDBSharedDownloadCache;
+    struct Holder;
+
+    std::shared_ptr<Holder> mHolder; // releases the entry (or owns the private copy)
+    char const* mData = nullptr;
+    size_t mSize = 0;
+    long mValidFrom = 0;
+    long mValidUntil = 0;
+    std::string mETag;
+    bool mShared = false;
+  };
+
+  struct Stats {
+    size_t nEntries = 0;    // objects in the segment
+    size_t nReferenced = 0; // objects with at least one View
+    size_t usedBytes = 0;   // bytes used by the objects
+    size_t freeBytes = 0;   // bytes still available in the segment
+  };
+
+  struct EntryInfo {
+    std::string key;
+    long validFrom = 0;
+    long validUntil = 0;
+    size_t size = 0;
+    int refCount = 0;           // Views of the object in all the processes
+    std::vector<pid_t> holders; // processes holding the Views
+  };
+
+  /// open the segment @a segmentName, creating it with @a segmentSize bytes if needed
+  /// @throw std::runtime_error if the segment cannot be opened
+  CCDBSharedDownloadCache(std::string const& segmentName, size_t segmentSize = DEFAULT_SIZE);
+  ~CCDBSharedDownloadCache();
+
+  CCDBSharedDownloadCache(const CCDBSharedDownloadCache&) = delete;
+  CCDBSharedDownloadCache& operator=(const CCDBSharedDownloadCache&) = delete;
+
+  /// the cache configured via the SEGMENT_ENV environment variable, shared by the whole
+  /// process, or nullptr if the variable is not set or the segment cannot be used
+  static std::shared_ptr<CCDBSharedDownloadCache> fromEnvironment();
+
+  /// remove the segment from the system; the processes which have it mapped can still use it
+  static bool remove(std::string const& segmentName);
+
+  /// View of the raw content of the object at @a path valid for @a timestamp, downloaded with
+  /// @a api if it is not in the segment yet.
+  /// Should the object not fit in the segment, or have too many holders, the View will own a
+  /// private copy of it.
+  /// @return an empty View if the object could not be retrieved
+  View get(CcdbApi const& api, std::string const& path, long timestamp = -1,
+           std::map<std::string, std::string> const& metadata = {});
+
+  /// drop the references of the processes which died while holding Views
+  /// @return number of dropped references
+  size_t releaseDeadHolders();
+
+  /// evict all the entries which are not referenced by a running process
+  /// @return number of evicted entries
+  size_t evict();
+
+  Stats getStats() const;
+  std::vector<EntryInfo> list() const;
+  std::string const& getSegmentName() const { return mSegmentName; }
+
+ private:
+  std::string mSegmentName;
+  std::shared_ptr<CCDBSharedCacheSegment> mSegment;
+};
+
+} // namespace o2::ccdb
+
+#endif // O2_CCDBSHAREDDOWNLOADCACHE_H
@@ -20,6 +20,7 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <vector>
 #include <curl/curl.h>
 #include <TObject.h>
 #include <TMessage.h>
@@ -233,6 +234,32 @@ class CcdbApi //: public DatabaseInterface
    */
   std::map<std::string, std::string> retrieveHeaders(std::string const& path, std::map<std::string, std::string> const& metadata, long timestamp = -1) const;
 
+  /**
+   * Retrieve the raw content (the image of the TFile, as served by the CCDB) of the object at the given path
+   * for the given timestamp, without deserializing it.
+   *
+   * @param dest The vector where the content is stored.
+   * @param path The path where the object is to be found.
+   * @param metadata Key-values representing the metadata to filter out objects.
+   * @param timestamp Timestamp of the object to retrieve. If omitted, current timestamp is used.
+   * @param headers Map to be populated with the headers we received, if it is not null.
+   * @return true if the content was retrieved.
+   */
+  bool loadFileToMemory(std::vector<char>& dest, std::string const& path, std::map<std::string, std::string> const& metadata,
+                        long timestamp = -1, std::map<std::string, std::string>* headers = nullptr) const;
+
+  /**
+   * Extract an object of the given type from a raw content obtained with loadFileToMemory.
+   * @return the object, or nullptr if the content does not contain an object of the given type.
+   */
+  void* extractFromMemoryBlob(char const* content, size_t size, std::type_info const& tinfo) const;
+
+  template <typename T>
+  T* extractFromMemoryBlob(char const* content, size_t size) const
+  {
+    return static_cast<T*>(extractFromMemoryBlob(content, size, typeid(T)));
+  }
+
   /**
    * A helper function to extract an object from an existing in-memory TFile
    * @param file a TFile instance
@@ -367,6 +394,9 @@ class CcdbApi //: public DatabaseInterface
   /// given by tinfo if that is possible. Returns nullptr if something fails...
   void* navigateURLsAndRetrieveContent(CURL*, std::string const& url, std::type_info const& tinfo, std::map<std::string, std::string>* headers) const;
 
+  /// Same as navigateURLsAndRetrieveContent, but stores the binary content in dest without interpreting it.
+  bool navigateURLsAndLoadFileToMemory(std::vector<char>& dest, CURL*, std::string const& url, std::map<std::string, std::string>* headers) const;
+
   // helper that interprets a content chunk as TMemFile and extracts the object therefrom
   void* interpretAsTMemFileAndExtract(char* contentptr, size_t contentsize, std::type_info const& tinfo) const;
 
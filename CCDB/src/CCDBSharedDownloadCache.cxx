@@ -0,0 +1,446 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   CCDBSharedDownloadCache.cxx
+/// \brief  Node local cache of the downloaded CCDB objects in shared memory
+///
+
+#include "CCDB/CCDBSharedDownloadCache.h"
+#include "CCDB/CcdbApi.h"
+#include "CCDB/CCDBTimeStampUtils.h"
+#include <FairLogger.h>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/offset_ptr.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <signal.h>
+#include <unistd.h>
+
+namespace bip = boost::interprocess;
+
+namespace o2::ccdb
+{
+
+namespace
+{
+enum EntryState : int {
+  Free = 0,
+  Loading, // being fetched by the process loader
+  Ready
+};
+
+/// a process holding Views of an entry
+struct ShmHolder {
+  pid_t pid = 0;
+  int count = 0;
+};
+
+struct ShmEntry {
+  int state = Free;
+  pid_t loader = 0;
+  ShmHolder holders[CCDBSharedDownloadCache::MAX_HOLDERS];
+  uint64_t lastUse = 0;
+  long validFrom = 0;
+  long validUntil = 0;
+  size_t size = 0;
+  bip::offset_ptr<char> data;
+  char key[CCDBSharedDownloadCache::MAX_KEY_SIZE] = {0};
+  char etag[128] = {0};
+
+  int refCount() const
+  {
+    int n = 0;
+    for (auto& h : holders) {
+      n += h.count;
+    }
+    return n;
+  }
+};
+
+/// The table of the objects, living in the segment itself
+struct ShmIndex {
+  bip::interprocess_mutex mutex;
+  bip::interprocess_condition loaded;
+  uint64_t clock = 0;
+  ShmEntry entries[CCDBSharedDownloadCache::MAX_ENTRIES];
+};
+
+constexpr const char* INDEX_NAME = "ccdb-download-cache-index";
+
+long parseHeader(std::map<std::string, std::string> const& headers, const char* name, long defaultValue)
+{
+  auto it = headers.find(name);
+  if (it == headers.end()) {
+    return defaultValue;
+  }
+  try {
+    return std::stol(it->second);
+  } catch (...) {
+    return defaultValue;
+  }
+}
+
+bool isAlive(pid_t pid)
+{
+  return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+void copyString(char* dest, size_t destSize, std::string const& src)
+{
+  auto n = std::min(src.size(), destSize - 1);
+  memcpy(dest, src.data(), n);
+  dest[n] = '\0';
+}
+} // namespace
+
+struct CCDBSharedCacheSegment {
+  bip::managed_shared_memory segment;
+  ShmIndex* index = nullptr;
+
+  /// free the memory of an entry, with the lock held
+  void release(ShmEntry& e)
+  {
+    if (e.data) {
+      segment.deallocate(e.data.get());
+    }
+    e = ShmEntry{};
+  }
+
+  /// drop the references of the dead processes, with the lock held
+  size_t releaseDeadHolders()
+  {
+    size_t nReleased = 0;
+    for (auto& e : index->entries) {
+      if (e.state != Ready) {
+        continue;
+      }
+      for (auto& h : e.holders) {
+        if (h.pid && !isAlive(h.pid)) {
+          LOG(WARN) << "CCDBSharedDownloadCache: process " << h.pid << " died holding " << h.count << " references to " << e.key;
+          nReleased += h.count;
+          h = ShmHolder{};
+        }
+      }
+    }
+    return nReleased;
+  }
+
+  /// evict the least recently used entry which is not referenced, with the lock held
+  bool evictOne()
+  {
+    releaseDeadHolders();
+    ShmEntry* lru = nullptr;
+    for (auto& e : index->entries) {
+      if (e.state == Ready && e.refCount() == 0 && (!lru || e.lastUse < lru->lastUse)) {
+        lru = &e;
+      }
+    }
+    if (!lru) {
+      return false;
+    }
+    LOG(DEBUG) << "CCDBSharedDownloadCache: evicting " << lru->key;
+    release(*lru);
+    return true;
+  }
+};
+
+struct CCDBSharedDownloadCache::View::Holder {
+  std::shared_ptr<CCDBSharedCacheSegment> segment;
+  ShmHolder* holder = nullptr; // the slot of this process in the entry
+  pid_t pid = 0;
+  std::vector<char> privateCopy;
+
+  ~Holder()
+  {
+    // a forked child does not own the references of its parent
+    if (holder && pid == getpid()) {
+      bip::scoped_lock<bip::interprocess_mutex> lock(segment->index->mutex);
+      if (holder->pid == pid && --holder->count == 0) {
+        *holder = ShmHolder{};
+      }
+    }
+  }
+};
+
+CCDBSharedDownloadCache::CCDBSharedDownloadCache(std::string const& segmentName, size_t segmentSize) : mSegmentName(segmentName)
+{
+  try {
+    mSegment = std::make_shared<CCDBSharedCacheSegment>();
+    mSegment->segment = bip::managed_shared_memory(bip::open_or_create, segmentName.c_str(), segmentSize);
+    mSegment->index = mSegment->segment.find_or_construct<ShmIndex>(INDEX_NAME)();
+  } catch (bip::interprocess_exception const& e) {
+    throw std::runtime_error("Cannot open CCDB shared memory segment " + segmentName + ": " + e.what());
+  }
+}
+
+CCDBSharedDownloadCache::~CCDBSharedDownloadCache() = default;
+
+std::shared_ptr<CCDBSharedDownloadCache> CCDBSharedDownloadCache::fromEnvironment()
+{
+  static std::mutex initMutex;
+  static std::shared_ptr<CCDBSharedDownloadCache> instance;
+  static bool initialized = false;
+  std::lock_guard<std::mutex> guard(initMutex);
+  if (initialized) {
+    return instance;
+  }
+  initialized = true;
+  auto name = getenv(SEGMENT_ENV);
+  if (!name || !name[0]) {
+    return instance;
+  }
+  size_t size = DEFAULT_SIZE;
+  if (auto sizeStr = getenv(SIZE_ENV)) {
+    size = size_t(std::strtoul(sizeStr, nullptr, 10)) << 20;
+  }
+  try {
+    instance = std::make_shared<CCDBSharedDownloadCache>(name, size);
+    LOG(INFO) << "Sharing CCDB objects via shared memory segment " << name;
+  } catch (std::exception const& e) {
+    LOG(ERROR) << e.what() << ", CCDB objects will not be shared";
+  }
+  return instance;
+}
+
+bool CCDBSharedDownloadCache::remove(std::string const& segmentName)
+{
+  return bip::shared_memory_object::remove(segmentName.c_str());
+}
+
+CCDBSharedDownloadCache::View CCDBSharedDownloadCache::get(CcdbApi const& api, std::string const& path, long timestamp,
+                                                           std::map<std::string, std::string> const& metadata)
+{
+  if (timestamp < 0) {
+    timestamp = getCurrentTimestamp();
+  }
+  std::string key = api.getURL() + "/" + path;
+  for (auto& kv : metadata) {
+    key += "/" + kv.first + "=" + kv.second;
+  }
+
+  auto fetch = [&](std::vector<char>& content, std::map<std::string, std::string>& headers) {
+    return api.loadFileToMemory(content, path, metadata, timestamp, &headers);
+  };
+  auto makePrivateView = [](std::vector<char>&& content, std::map<std::string, std::string> const& headers) {
+    View view;
+    view.mHolder = std::make_shared<View::Holder>();
+    view.mHolder->privateCopy = std::move(content);
+    view.mData = view.mHolder->privateCopy.data();
+    view.mSize = view.mHolder->privateCopy.size();
+    view.mValidFrom = parseHeader(headers, "Valid-From", 0);
+    view.mValidUntil = parseHeader(headers, "Valid-Until", LONG_MAX);
+    auto etag = headers.find("ETag");
+    view.mETag = etag == headers.end() ? "" : etag->second;
+    return view;
+  };
+  // a View of the entry, with the lock held; a private copy if all the holder slots are taken by other processes
+  auto acquire = [this, &path](ShmEntry& e) {
+    pid_t pid = getpid();
+    ShmHolder* holder = nullptr;
+    for (auto& h : e.holders) {
+      if (h.pid == pid) {
+        holder = &h;
+        break;
+      }
+      if (!h.pid && !holder) {
+        holder = &h;
+      }
+    }
+    if (!holder && mSegment->releaseDeadHolders()) {
+      for (auto& h : e.holders) {
+        if (!h.pid) {
+          holder = &h;
+          break;
+        }
+      }
+    }
+    View view;
+    view.mHolder = std::make_shared<View::Holder>();
+    view.mValidFrom = e.validFrom;
+    view.mValidUntil = e.validUntil;
+    view.mETag = e.etag;
+    e.lastUse = ++mSegment->index->clock;
+    if (!holder) {
+      LOG(WARN) << "CCDBSharedDownloadCache: too many processes hold " << path << ", a private copy is returned";
+      view.mHolder->privateCopy.assign(e.data.get(), e.data.get() + e.size);
+      view.mData = view.mHolder->privateCopy.data();
+      view.mSize = view.mHolder->privateCopy.size();
+      return view;
+    }
+    holder->pid = pid;
+    holder->count++;
+    view.mHolder->segment = mSegment;
+    view.mHolder->holder = holder;
+    view.mHolder->pid = pid;
+    view.mData = e.data.get();
+    view.mSize = e.size;
+    view.mShared = true;
+    return view;
+  };
+
+  std::vector<char> content;
+  std::map<std::string, std::string> headers;
+  if (key.size() >= MAX_KEY_SIZE) {
+    LOG(WARN) << "CCDBSharedDownloadCache: key for " << path << " is too long, the object will not be shared";
+    return fetch(content, headers) ? makePrivateView(std::move(content), headers) : View{};
+  }
+
+  auto& index = *mSegment->index;
+  ShmEntry* slot = nullptr;
+  {
+    bip::scoped_lock<bip::interprocess_mutex> lock(index.mutex);
+    while (true) {
+      ShmEntry* loading = nullptr;
+      slot = nullptr;
+      for (auto& e : index.entries) {
+        if (e.state == Free) {
+          slot = slot ? slot : &e;
+        } else if (strcmp(e.key, key.c_str()) == 0) {
+          if (e.state == Ready && e.validFrom <= timestamp && timestamp < e.validUntil) {
+            return acquire(e);
+          }
+          if (e.state == Loading) {
+            loading = &e;
+          }
+        }
+      }
+      if (!loading) {
+        break;
+      }
+      // someone else is fetching the same object, wait for it unless it died in the meanwhile
+      auto deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(1);
+      if (!index.loaded.timed_wait(lock, deadline) && !isAlive(loading->loader)) {
+        LOG(WARN) << "CCDBSharedDownloadCache: process " << loading->loader << " died while fetching " << loading->key;
+        mSegment->release(*loading);
+      }
+    }
+    if (!slot && mSegment->evictOne()) {
+      for (auto& e : index.entries) {
+        if (e.state == Free) {
+          slot = &e;
+          break;
+        }
+      }
+    }
+    if (slot) {
+      slot->state = Loading;
+      slot->loader = getpid();
+      copyString(slot->key, sizeof(slot->key), key);
+    }
+  }
+
+  bool success = fetch(content, headers);
+
+  bip::scoped_lock<bip::interprocess_mutex> lock(index.mutex);
+  if (!slot || !success) {
+    if (slot) {
+      mSegment->release(*slot);
+      index.loaded.notify_all();
+    }
+    if (!success) {
+      return View{};
+    }
+    LOG(WARN) << "CCDBSharedDownloadCache: no free entry for " << path << ", the object will not be shared";
+    return makePrivateView(std::move(content), headers);
+  }
+
+  char* data = nullptr;
+  while (!(data = static_cast<char*>(mSegment->segment.allocate(content.size() ? content.size() : 1, std::nothrow)))) {
+    if (!mSegment->evictOne()) {
+      break;
+    }
+  }
+  if (!data) {
+    mSegment->release(*slot);
+    index.loaded.notify_all();
+    LOG(WARN) << "CCDBSharedDownloadCache: no space left for " << path << " (" << content.size() << " bytes), the object will not be shared";
+    return makePrivateView(std::move(content), headers);
+  }
+  memcpy(data, content.data(), content.size());
+  slot->data = data;
+  slot->size = content.size();
+  // a local snapshot has no validity, it is good for any timestamp
+  slot->validFrom = parseHeader(headers, "Valid-From", 0);
+  slot->validUntil = parseHeader(headers, "Valid-Until", LONG_MAX);
+  auto etag = headers.find("ETag");
+  copyString(slot->etag, sizeof(slot->etag), etag == headers.end() ? "" : etag->second);
+  slot->loader = 0;
+  slot->state = Ready;
+  index.loaded.notify_all();
+  return acquire(*slot);
+}
+
+size_t CCDBSharedDownloadCache::releaseDeadHolders()
+{
+  bip::scoped_lock<bip::interprocess_mutex> lock(mSegment->index->mutex);
+  return mSegment->releaseDeadHolders();
+}
+
+size_t CCDBSharedDownloadCache::evict()
+{
+  size_t nEvicted = 0;
+  bip::scoped_lock<bip::interprocess_mutex> lock(mSegment->index->mutex);
+  mSegment->releaseDeadHolders();
+  for (auto& e : mSegment->index->entries) {
+    if (e.state == Ready && e.refCount() == 0) {
+      mSegment->release(e);
+      nEvicted++;
+    }
+  }
+  return nEvicted;
+}
+
+CCDBSharedDownloadCache::Stats CCDBSharedDownloadCache::getStats() const
+{
+  Stats stats;
+  bip::scoped_lock<bip::interprocess_mutex> lock(mSegment->index->mutex);
+  mSegment->releaseDeadHolders();
+  for (auto& e : mSegment->index->entries) {
+    if (e.state == Ready) {
+      stats.nEntries++;
+      stats.nReferenced += e.refCount() > 0;
+      stats.usedBytes += e.size;
+    }
+  }
+  stats.freeBytes = mSegment->segment.get_free_memory();
+  return stats;
+}
+
+std::vector<CCDBSharedDownloadCache::EntryInfo> CCDBSharedDownloadCache::list() const
+{
+  std::vector<EntryInfo> entries;
+  bip::scoped_lock<bip::interprocess_mutex> lock(mSegment->index->mutex);
+  mSegment->releaseDeadHolders();
+  for (auto& e : mSegment->index->entries) {
+    if (e.state == Ready) {
+      EntryInfo info{e.key, e.validFrom, e.validUntil, e.size, e.refCount(), {}};
+      for (auto& h : e.holders) {
+        if (h.pid) {
+          info.holders.push_back(h.pid);
+        }
+      }
+      entries.push_back(std::move(info));
+    }
+  }
+  return entries;
+}
+
+} // namespace o2::ccdb
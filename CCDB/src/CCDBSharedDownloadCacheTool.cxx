@@ -0,0 +1,120 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "CCDB/CcdbApi.h"
+#include "CCDB/CCDBSharedDownloadCache.h"
+#include "CCDB/CCDBTimeStampUtils.h"
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+bool initOptionsAndParse(bpo::options_description& options, int argc, char* argv[], bpo::variables_map& vm)
+{
+  auto envSegment = getenv(o2::ccdb::CCDBSharedDownloadCache::SEGMENT_ENV);
+  options.add_options()(
+    "segment,s", bpo::value<std::string>()->default_value(envSegment ? envSegment : "o2-ccdb-shared-cache"), "name of the shared memory segment")(
+    "size", bpo::value<size_t>()->default_value(o2::ccdb::CCDBSharedDownloadCache::DEFAULT_SIZE >> 20), "size of the segment in MB, if it has to be created")(
+    "host", bpo::value<std::string>()->default_value("http://ccdb-test.cern.ch:8080"), "CCDB server (or file:// snapshot) for the prefetching")(
+    "prefetch,p", bpo::value<std::string>()->default_value(""), "comma separated list of CCDB paths to load in the segment")(
+    "timestamp,t", bpo::value<long>()->default_value(-1), "timestamp for the prefetching - default -1 = now")(
+    "list,l", "list the objects in the segment")(
+    "evict", "evict all the objects which are not in use by a running process")(
+    "remove", "remove the segment")(
+    "help,h", "Produce help message.");
+
+  try {
+    bpo::store(parse_command_line(argc, argv, options), vm);
+
+    // help
+    if (vm.count("help")) {
+      std::cout << options << std::endl;
+      return false;
+    }
+
+    bpo::notify(vm);
+  } catch (const bpo::error& e) {
+    std::cerr << e.what() << "\n\n";
+    std::cerr << "Error parsing command line arguments; Available options:\n";
+
+    std::cerr << options << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// a tool to create, fill, inspect and remove the shared memory segment used to share
+// the downloads of the CCDB objects among the processes of a node
+int main(int argc, char* argv[])
+{
+  bpo::options_description options("Allowed options");
+  bpo::variables_map vm;
+  if (!initOptionsAndParse(options, argc, argv, vm)) {
+    return -1;
+  }
+
+  auto segment = vm["segment"].as<std::string>();
+  if (vm.count("remove")) {
+    if (!o2::ccdb::CCDBSharedDownloadCache::remove(segment)) {
+      std::cerr << "Could not remove segment " << segment << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  try {
+    o2::ccdb::CCDBSharedDownloadCache cache(segment, vm["size"].as<size_t>() << 20);
+
+    auto prefetch = vm["prefetch"].as<std::string>();
+    if (!prefetch.empty()) {
+      o2::ccdb::CcdbApi api;
+      api.init(vm["host"].as<std::string>());
+      long timestamp = vm["timestamp"].as<long>();
+      if (timestamp == -1) {
+        timestamp = o2::ccdb::getCurrentTimestamp();
+      }
+      std::vector<std::string> paths;
+      boost::split(paths, prefetch, boost::is_any_of(","));
+      for (auto& path : paths) {
+        // the view is released immediately, the object stays in the segment
+        if (!cache.get(api, path, timestamp)) {
+          std::cerr << "Could not load " << path << "\n";
+        }
+      }
+    }
+
+    if (vm.count("evict")) {
+      std::cout << "Evicted " << cache.evict() << " objects\n";
+    }
+
+    if (vm.count("list")) {
+      for (auto& entry : cache.list()) {
+        std::cout << entry.key << " [" << entry.validFrom << ", " << entry.validUntil << ") "
+                  << entry.size << " bytes, " << entry.refCount << " users";
+        for (auto pid : entry.holders) {
+          std::cout << (pid == entry.holders.front() ? " (pid " : ", ") << pid;
+        }
+        std::cout << (entry.holders.empty() ? "\n" : ")\n");
+      }
+    }
+    auto stats = cache.getStats();
+    std::cout << "Segment " << segment << ": " << stats.nEntries << " objects (" << stats.nReferenced << " in use), "
+              << stats.usedBytes << " bytes used, " << stats.freeBytes << " bytes free\n";
+  } catch (std::exception const& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
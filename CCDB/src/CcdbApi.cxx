@@ -35,6 +35,7 @@
 #include <filesystem>
 #include <boost/algorithm/string.hpp>
 #include <iostream>
+#include <fstream>
 #include <mutex>
 #include <boost/interprocess/sync/named_semaphore.hpp>
 
@@ -750,6 +751,131 @@ void* CcdbApi::retrieveFromTFile(std::type_info const& tinfo, std::string const&
   return content;
 }
 
+bool CcdbApi::loadFileToMemory(std::vector<char>& dest, std::string const& path, std::map<std::string, std::string> const& metadata,
+                               long timestamp, std::map<std::string, std::string>* headers) const
+{
+  dest.clear();
+  CURL* curl_handle = curl_easy_init();
+  string fullUrl = getFullUrlForRetrieval(curl_handle, path, metadata, timestamp);
+  if (!mInSnapshotMode) {
+    auto result = navigateURLsAndLoadFileToMemory(dest, curl_handle, fullUrl, headers);
+    curl_easy_cleanup(curl_handle);
+    return result;
+  }
+  curl_easy_cleanup(curl_handle);
+
+  // in snapshot mode the content is the snapshot file itself
+  std::ifstream in(fullUrl, std::ios::binary | std::ios::ate);
+  if (!in.is_open()) {
+    LOG(ERROR) << "Local snapshot " << fullUrl << " not found";
+    return false;
+  }
+  dest.resize(in.tellg());
+  in.seekg(0);
+  if (!in.read(dest.data(), dest.size())) {
+    LOG(ERROR) << "Could not read local snapshot " << fullUrl;
+    dest.clear();
+    return false;
+  }
+  if (headers) {
+    std::lock_guard<std::mutex> guard(gIOMutex);
+    TFile f(fullUrl.c_str(), "READ");
+    auto storedmeta = retrieveMetaInfo(f);
+    if (storedmeta) {
+      *headers = *storedmeta;
+      delete storedmeta;
+    }
+  }
+  return true;
+}
+
+bool CcdbApi::navigateURLsAndLoadFileToMemory(std::vector<char>& dest, CURL* curl_handle, std::string const& url, std::map<string, string>* headers) const
+{
+  if (url.find("alien:/", 0) != std::string::npos) {
+    if (!initTGrid()) {
+      return false;
+    }
+    std::lock_guard<std::mutex> guard(gIOMutex);
+    std::unique_ptr<TFile> file(TFile::Open(url.c_str(), "READ"));
+    if (!file || file->IsZombie()) {
+      return false;
+    }
+    dest.resize(file->GetSize());
+    // ReadBuffer returns true in case of failure
+    if (file->ReadBuffer(dest.data(), 0, dest.size())) {
+      dest.clear();
+      return false;
+    }
+    return true;
+  }
+
+  static thread_local std::multimap<std::string, std::string> headerData;
+  curl_easy_setopt(curl_handle, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "libcurl-agent/1.0");
+  curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 0L);
+  curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, header_map_callback<decltype(headerData)>);
+  headerData.clear();
+  curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, (void*)&headerData);
+
+  MemoryStruct chunk{(char*)malloc(1), 0};
+  curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
+  curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void*)&chunk);
+
+  auto res = curl_easy_perform(curl_handle);
+  long response_code = -1;
+  bool success = false;
+  if (res == CURLE_OK && curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &response_code) == CURLE_OK) {
+    if (headers) {
+      for (auto& p : headerData) {
+        (*headers)[p.first] = p.second;
+      }
+    }
+    if (200 <= response_code && response_code < 300) {
+      dest.assign(chunk.memory, chunk.memory + chunk.size);
+      success = true;
+    } else if (300 <= response_code && response_code < 400) {
+      // same order of the content locations as in navigateURLsAndRetrieveContent
+      std::vector<std::string> locs;
+      auto addLocation = [this, &locs](std::string const& loc) {
+        auto fullLoc = (!loc.empty() && loc[0] == '/') ? getURL() + loc : loc;
+        if (!fullLoc.empty() && std::find(locs.begin(), locs.end(), fullLoc) == locs.end()) {
+          locs.push_back(fullLoc);
+        }
+      };
+      auto range = headerData.equal_range("Location");
+      for (auto it = range.first; it != range.second; ++it) {
+        addLocation(it->second);
+      }
+      range = headerData.equal_range("Content-Location");
+      for (auto it = range.first; it != range.second; ++it) {
+        addLocation(it->second);
+      }
+      for (auto& l : locs) {
+        LOG(DEBUG) << "Trying content location " << l;
+        if (navigateURLsAndLoadFileToMemory(dest, curl_handle, l, nullptr)) {
+          success = true;
+          break;
+        }
+      }
+    } else if (response_code == 404) {
+      LOG(ERROR) << "Requested resource does not exist: " << url;
+    }
+  } else {
+    LOG(ERROR) << "Curl request to " << url << " failed ";
+  }
+  free(chunk.memory);
+  if (!success && headers) {
+    (*headers)["Error"] = "An error occurred during retrieval";
+  }
+  return success;
+}
+
+void* CcdbApi::extractFromMemoryBlob(char const* content, size_t size, std::type_info const& tinfo) const
+{
+  // TMemFile does not modify the buffer when opened for reading
+  return interpretAsTMemFileAndExtract(const_cast<char*>(content), size, tinfo);
+}
+
 size_t CurlWrite_CallbackFunc_StdString2(void* contents, size_t size, size_t nmemb, std::string* s)
 {
   size_t newLength = size * nmemb;
@@ -0,0 +1,132 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   testCCDBSharedDownloadCache.cxx
+/// \brief  Test the shared memory cache of the CCDB downloads, using a local snapshot as server
+///
+
+#define BOOST_TEST_MODULE CCDB
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "CCDB/CcdbApi.h"
+#include "CCDB/CCDBSharedDownloadCache.h"
+#include "CCDB/BasicCCDBManager.h"
+#include "CommonUtils/StringUtils.h"
+#include <boost/test/unit_test.hpp>
+#include <TFile.h>
+#include <TNamed.h>
+#include <TClass.h>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace o2::ccdb;
+
+namespace
+{
+// write a snapshot file with the same layout as the ones produced by CcdbApi::snapshot
+void writeSnapshot(std::string const& dir, std::string const& path, TNamed const& obj, long from, long until)
+{
+  std::filesystem::create_directories(dir + "/" + path);
+  TFile f((dir + "/" + path + "/snapshot.root").c_str(), "RECREATE");
+  f.WriteObjectAny(&obj, TClass::GetClass(typeid(obj)), CcdbApi::CCDBOBJECT_ENTRY);
+  std::map<std::string, std::string> headers{{"Valid-From", std::to_string(from)}, {"Valid-Until", std::to_string(until)}, {"ETag", path}};
+  f.WriteObjectAny(&headers, TClass::GetClass(typeid(headers)), CcdbApi::CCDBMETA_ENTRY);
+  f.Close();
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestCCDBSharedDownloadCache)
+{
+  auto dir = o2::utils::Str::create_unique_path(std::filesystem::temp_directory_path().native());
+  writeSnapshot(dir, "Test/ObjectA", TNamed("A", "first"), 1000, 2000);
+  writeSnapshot(dir, "Test/ObjectB", TNamed("B", "second"), 1000, 2000);
+
+  CcdbApi api;
+  api.init("file://" + dir);
+
+  auto segmentName = "o2-ccdb-test-" + std::to_string(getpid());
+  CCDBSharedDownloadCache::remove(segmentName);
+  {
+    CCDBSharedDownloadCache cache(segmentName, 16 << 20);
+
+    auto viewA = cache.get(api, "Test/ObjectA", 1500);
+    BOOST_REQUIRE(viewA);
+    BOOST_CHECK(viewA.isShared());
+    BOOST_CHECK_EQUAL(viewA.getValidFrom(), 1000);
+    BOOST_CHECK_EQUAL(viewA.getValidUntil(), 2000);
+    BOOST_CHECK_EQUAL(viewA.getETag(), "Test/ObjectA");
+    std::unique_ptr<TNamed> objA(api.extractFromMemoryBlob<TNamed>(viewA.data(), viewA.size()));
+    BOOST_REQUIRE(objA);
+    BOOST_CHECK_EQUAL(std::string(objA->GetTitle()), "first");
+
+    // a second request, in this or in another process, is served from the segment
+    auto viewA2 = cache.get(api, "Test/ObjectA", 1600);
+    BOOST_CHECK(viewA2.data() == viewA.data());
+    auto entries = cache.list();
+    BOOST_REQUIRE_EQUAL(entries.size(), 1);
+    BOOST_CHECK_EQUAL(entries[0].refCount, 2);
+    BOOST_REQUIRE_EQUAL(entries[0].holders.size(), 1);
+    BOOST_CHECK_EQUAL(entries[0].holders[0], getpid());
+    pid_t pid = fork();
+    if (pid == 0) {
+      CCDBSharedDownloadCache other(segmentName, 16 << 20);
+      CcdbApi otherApi;
+      otherApi.init("file://" + dir);
+      // the View is not released: the process dies holding it
+      auto view = other.get(otherApi, "Test/ObjectA", 1500);
+      bool found = view && view.size() == viewA.size() && memcmp(view.data(), viewA.data(), view.size()) == 0 && other.getStats().nEntries == 1 && other.list()[0].holders.size() == 2;
+      _exit(found ? 0 : 1);
+    }
+    int status = -1;
+    waitpid(pid, &status, 0);
+    BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    BOOST_CHECK_EQUAL(cache.getStats().nEntries, 1);
+    // the reference of the dead process is dropped
+    entries = cache.list();
+    BOOST_REQUIRE_EQUAL(entries.size(), 1);
+    BOOST_CHECK_EQUAL(entries[0].refCount, 2);
+    BOOST_CHECK_EQUAL(entries[0].holders.size(), 1);
+
+    BOOST_CHECK(!cache.get(api, "Test/Missing", 1500));
+
+    auto viewB = cache.get(api, "Test/ObjectB", 1500);
+    BOOST_REQUIRE(viewB);
+    BOOST_CHECK_EQUAL(std::string(viewB.data(), 4), "root");
+
+    auto stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.nEntries, 2);
+    BOOST_CHECK_EQUAL(stats.nReferenced, 2);
+
+    // only the entries which are not in use are evicted
+    viewA = {};
+    viewA2 = {};
+    BOOST_CHECK_EQUAL(cache.getStats().nReferenced, 1);
+    BOOST_CHECK_EQUAL(cache.evict(), 1);
+    BOOST_CHECK_EQUAL(cache.getStats().nEntries, 1);
+
+    // the CCDB manager deserializes from the shared content
+    CCDBManagerInstance manager("file://" + dir);
+    manager.setSharedDownloadCache(std::make_shared<CCDBSharedDownloadCache>(segmentName, 16 << 20));
+    auto objB = manager.getForTimeStamp<TNamed>("Test/ObjectB", 1500);
+    BOOST_REQUIRE(objB);
+    BOOST_CHECK_EQUAL(std::string(objB->GetTitle()), "second");
+    BOOST_CHECK(manager.getForTimeStamp<TNamed>("Test/ObjectB", 1700) == objB);
+    BOOST_CHECK_EQUAL(cache.getStats().nEntries, 1);
+  }
+  CCDBSharedDownloadCache::remove(segmentName);
+  std::filesystem::remove_all(dir);
+}
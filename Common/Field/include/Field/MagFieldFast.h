@@ -66,6 +66,19 @@ class MagFieldFast
   bool GetBy(const float xyz[3], float& by) const { return GetBcomp(kY, xyz, by); }
   bool GetBz(const double xyz[3], double& bz) const { return GetBcomp(kZ, xyz, bz); }
   bool GetBz(const float xyz[3], float& bz) const { return GetBcomp(kZ, xyz, bz); }
+
+#ifndef GPUCA_GPUCODE
+  /// Batched field query for npoints points. The points are bucketed by parametrization segment and each bucket
+  /// is evaluated in vectorizable loops over the segment coefficients. Points outside of the parametrized region are
+  /// left untouched (as in the single point query), their status is reported in the optional ok array.
+  /// Returns the number of points for which the field was evaluated.
+  int Field(int npoints, const float* x, const float* y, const float* z, float* bx, float* by, float* bz, bool* ok = nullptr) const;
+  int Field(int npoints, const double* x, const double* y, const double* z, double* bx, double* by, double* bz, bool* ok = nullptr) const;
+  /// batched query for points in AoS layout, bxyz is filled with 3 components per point
+  int Field(int npoints, const double* xyz, double* bxyz, bool* ok = nullptr) const;
+  int Field(int npoints, const math_utils::Point3D<float>* xyz, float* bxyz, bool* ok = nullptr) const;
+  int Field(int npoints, const math_utils::Point3D<double>* xyz, double* bxyz, bool* ok = nullptr) const;
+#endif
   void setFactorSol(float v = 1.f) { mFactorSol = v; }
   float getFactorSol() const { return mFactorSol; }
 
@@ -82,6 +95,11 @@ class MagFieldFast
 
   float CalcPol(const float* cf, float x, float y, float z) const;
 
+#ifndef GPUCA_GPUCODE
+  template <typename Loader, typename Storer>
+  int FieldBatch(int npoints, Loader load, Storer store, bool* ok) const;
+#endif
+
  private:
   float mFactorSol; // scaling factor
   SolParam mSolPar[kNSolRRanges][kNSolZRanges][kNQuadrants];
@@ -107,6 +107,10 @@ class MagneticField : public FairField
   /// Main interface from TVirtualMagField used in simulation
   void Field(const Double_t* __restrict__ point, Double_t* __restrict__ bField) override;
 
+  /// Method to calculate the field at npoints points, xyz and bField hold 3 values per point.
+  /// Uses the batched fast parametrization when allowed and the batched measured map for the rest
+  void Field(int npoints, const Double_t* __restrict__ xyz, Double_t* __restrict__ bField);
+
   /// 3d field query alias for Alias Method to calculate the field at point xyz
   void GetBxyz(const Double_t p[3], Double_t* b) override { MagneticField::Field(p, b); }
 
@@ -210,6 +210,11 @@ class MagneticWrapperChebyshev : public TNamed
   /// it gets it at closest valid point
   virtual void Field(const Double_t* xyz, Double_t* b) const;
 
+  /// Computes field in cartesian coordinates for npoints points (xyz and b hold 3 values per point).
+  /// The points are grouped by the parameterization piece they belong to, so that the coefficients of
+  /// each piece are traversed once per group rather than once per point
+  void Field(Int_t npoints, const Double_t* xyz, Double_t* b) const;
+
   /// Computes Bz for the point in cartesian coordinates. If point is outside of the parameterized region
   /// it gets it at closest valid point
   Double_t getBz(const Double_t* xyz) const;
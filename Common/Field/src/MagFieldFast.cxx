@@ -23,6 +23,11 @@
 using namespace std;
 #endif
 
+#ifndef GPUCA_GPUCODE
+#include <algorithm>
+#include <vector>
+#endif
+
 using namespace o2::field;
 
 ClassImp(o2::field::MagFieldFast);
@@ -262,3 +267,154 @@ bool MagFieldFast::GetSegment(float x, float y, float z, int& zSeg, int& rSeg, i
   quadrant = GetQuadrant(x, y);
   return true;
 }
+
+#ifndef GPUCA_GPUCODE
+//_______________________________________________________________________
+template <typename Loader, typename Storer>
+int MagFieldFast::FieldBatch(int npoints, Loader load, Storer store, bool* ok) const
+{
+  // Batched field evaluation: the points are bucketed by the parametrization segment (counting sort), then
+  // each bucket is gathered in chunks to contiguous buffers and evaluated with the segment coefficients in
+  // tight loops, which the compiler vectorizes.
+  constexpr int NSegments = kNSolRRanges * kNSolZRanges * kNQuadrants;
+  constexpr int NChunk = 64;
+  static thread_local std::vector<int> segID, order;
+  segID.resize(npoints);
+  order.resize(npoints);
+  int counts[NSegments + 1] = {0};
+  int zSeg, rSeg, quadrant;
+  for (int i = 0; i < npoints; i++) {
+    float x, y, z;
+    load(i, x, y, z);
+    if (GetSegment(x, y, z, zSeg, rSeg, quadrant)) {
+      segID[i] = (rSeg * kNSolZRanges + zSeg) * kNQuadrants + quadrant; // same as the mSolPar memory layout
+      counts[segID[i] + 1]++;
+    } else {
+      segID[i] = -1;
+    }
+    if (ok) {
+      ok[i] = segID[i] >= 0;
+    }
+  }
+  for (int is = 0; is < NSegments; is++) {
+    counts[is + 1] += counts[is];
+  }
+  int nDone = counts[NSegments];
+  for (int i = 0; i < npoints; i++) {
+    if (segID[i] >= 0) {
+      order[counts[segID[i]]++] = i;
+    }
+  }
+  // after the fill counts[is] points to the end of the segment is
+  const SolParam* parFlat = &mSolPar[0][0][0];
+  alignas(64) float cx[NChunk], cy[NChunk], cz[NChunk], cb[kNDim][NChunk];
+  int first = 0;
+  for (int is = 0; is < NSegments; is++) {
+    int last = counts[is];
+    const SolParam& par = parFlat[is];
+    for (int start = first; start < last; start += NChunk) {
+      int n = std::min(NChunk, last - start);
+      for (int i = 0; i < n; i++) {
+        load(order[start + i], cx[i], cy[i], cz[i]);
+      }
+      for (int dim = 0; dim < kNDim; dim++) {
+        const float* cf = par.parBxyz[dim];
+        float* bOut = cb[dim];
+        for (int i = 0; i < n; i++) {
+          bOut[i] = CalcPol(cf, cx[i], cy[i], cz[i]) * mFactorSol;
+        }
+      }
+      for (int i = 0; i < n; i++) {
+        store(order[start + i], cb[kX][i], cb[kY][i], cb[kZ][i]);
+      }
+    }
+    first = last;
+  }
+  return nDone;
+}
+
+//_______________________________________________________________________
+int MagFieldFast::Field(int npoints, const float* x, const float* y, const float* z, float* bx, float* by, float* bz, bool* ok) const
+{
+  // batched field query, SoA layout
+  auto load = [=](int i, float& px, float& py, float& pz) {
+    px = x[i];
+    py = y[i];
+    pz = z[i];
+  };
+  auto store = [=](int i, float vx, float vy, float vz) {
+    bx[i] = vx;
+    by[i] = vy;
+    bz[i] = vz;
+  };
+  return FieldBatch(npoints, load, store, ok);
+}
+
+//_______________________________________________________________________
+int MagFieldFast::Field(int npoints, const double* x, const double* y, const double* z, double* bx, double* by, double* bz, bool* ok) const
+{
+  // batched field query, SoA layout
+  auto load = [=](int i, float& px, float& py, float& pz) {
+    px = x[i];
+    py = y[i];
+    pz = z[i];
+  };
+  auto store = [=](int i, float vx, float vy, float vz) {
+    bx[i] = vx;
+    by[i] = vy;
+    bz[i] = vz;
+  };
+  return FieldBatch(npoints, load, store, ok);
+}
+
+//_______________________________________________________________________
+int MagFieldFast::Field(int npoints, const double* xyz, double* bxyz, bool* ok) const
+{
+  // batched field query, AoS layout
+  auto load = [=](int i, float& px, float& py, float& pz) {
+    px = xyz[3 * i + kX];
+    py = xyz[3 * i + kY];
+    pz = xyz[3 * i + kZ];
+  };
+  auto store = [=](int i, float vx, float vy, float vz) {
+    bxyz[3 * i + kX] = vx;
+    bxyz[3 * i + kY] = vy;
+    bxyz[3 * i + kZ] = vz;
+  };
+  return FieldBatch(npoints, load, store, ok);
+}
+
+//_______________________________________________________________________
+int MagFieldFast::Field(int npoints, const math_utils::Point3D<float>* xyz, float* bxyz, bool* ok) const
+{
+  // batched field query, AoS layout
+  auto load = [=](int i, float& px, float& py, float& pz) {
+    px = xyz[i].X();
+    py = xyz[i].Y();
+    pz = xyz[i].Z();
+  };
+  auto store = [=](int i, float vx, float vy, float vz) {
+    bxyz[3 * i + kX] = vx;
+    bxyz[3 * i + kY] = vy;
+    bxyz[3 * i + kZ] = vz;
+  };
+  return FieldBatch(npoints, load, store, ok);
+}
+
+//_______________________________________________________________________
+int MagFieldFast::Field(int npoints, const math_utils::Point3D<double>* xyz, double* bxyz, bool* ok) const
+{
+  // batched field query, AoS layout
+  auto load = [=](int i, float& px, float& py, float& pz) {
+    px = xyz[i].X();
+    py = xyz[i].Y();
+    pz = xyz[i].Z();
+  };
+  auto store = [=](int i, float vx, float vy, float vz) {
+    bxyz[3 * i + kX] = vx;
+    bxyz[3 * i + kY] = vy;
+    bxyz[3 * i + kZ] = vz;
+  };
+  return FieldBatch(npoints, load, store, ok);
+}
+#endif // GPUCA_GPUCODE
@@ -14,6 +14,8 @@
 /// \author ruben.shahoyan@cern.ch
 
 #include "Field/MagneticField.h"
+#include <numeric>      // for iota
+#include <vector>       // for vector
 #include <TFile.h>      // for TFile
 #include <TPRegexp.h>   // for TPRegexp
 #include <TSystem.h>    // for TSystem, gSystem
@@ -280,6 +282,62 @@ void MagneticField::Field(const Double_t* __restrict__ xyz, Double_t* __restrict
   }
 }
 
+void MagneticField::Field(int npoints, const Double_t* __restrict__ xyz, Double_t* __restrict__ b)
+{
+  /*
+   * query field values at npoints points
+   */
+  static thread_local std::vector<int> rest;
+  static thread_local std::vector<Double_t> xyzMap, bMap;
+  static thread_local std::unique_ptr<bool[]> fastOK;
+  static thread_local int fastOKSize = 0;
+
+  rest.clear();
+  if (mFastField) {
+    if (fastOKSize < npoints) {
+      fastOK = std::make_unique<bool[]>(npoints);
+      fastOKSize = npoints;
+    }
+    if (mFastField->Field(npoints, xyz, b, fastOK.get()) == npoints) {
+      return;
+    }
+    for (int i = 0; i < npoints; i++) {
+      if (!fastOK[i]) {
+        rest.push_back(i);
+      }
+    }
+  } else {
+    rest.resize(npoints);
+    std::iota(rest.begin(), rest.end(), 0);
+  }
+
+  // points within the measured map are evaluated in a single batch, the others get the machine field
+  xyzMap.clear();
+  int nMap = 0;
+  for (auto i : rest) {
+    const Double_t* pnt = xyz + 3 * i;
+    if (mMeasuredMap && pnt[2] > mMeasuredMap->getMinZ() && pnt[2] < mMeasuredMap->getMaxZ()) {
+      xyzMap.insert(xyzMap.end(), pnt, pnt + 3);
+      rest[nMap++] = i;
+    } else {
+      MachineField(pnt, b + 3 * i);
+    }
+  }
+  if (!nMap) {
+    return;
+  }
+  bMap.resize(3 * nMap);
+  mMeasuredMap->Field(nMap, xyzMap.data(), bMap.data());
+  for (int im = 0; im < nMap; im++) {
+    const Double_t* pnt = &xyzMap[3 * im];
+    double fact = (pnt[2] > sSolenoidToDipoleZ || mDipoleOnOffFlag) ? mMultipicativeFactorSolenoid : mMultipicativeFactorDipole;
+    Double_t* bp = b + 3 * rest[im];
+    for (int j = 0; j < 3; j++) {
+      bp[j] = bMap[3 * im + j] * fact;
+    }
+  }
+}
+
 Double_t MagneticField::getBz(const Double_t* xyz) const
 {
   /*
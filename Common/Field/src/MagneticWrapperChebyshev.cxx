@@ -19,6 +19,7 @@
 #include <TSystem.h>    // for TSystem, gSystem
 #include <cstdio>       // for printf, fprintf, fclose, fopen, FILE
 #include <cstring>      // for memcpy
+#include <vector>       // for vector
 #include "FairLogger.h" // for FairLogger
 #include "TMath.h"      // for BinarySearch, Sort
 #include "TMathBase.h"  // for Abs
@@ -445,6 +446,82 @@ void MagneticWrapperChebyshev::Field(const Double_t* xyz, Double_t* b) const
   par->Eval(xyz, b);
 }
 
+void MagneticWrapperChebyshev::Field(Int_t npoints, const Double_t* xyz, Double_t* b) const
+{
+  static thread_local std::vector<int> segID, order;
+  static thread_local std::vector<Double_t> rphiz;
+  const int nSol = mNumberOfParameterizationSolenoid, nSeg = nSol + mNumberOfParameterizationDipole;
+  segID.resize(npoints);
+  order.resize(npoints);
+  rphiz.resize(3 * npoints);
+  std::vector<int> counts(nSeg + 1, 0);
+
+  // assign the parameterization piece to each point: solenoid pieces first, then dipole ones
+  for (int i = 0; i < npoints; i++) {
+    const Double_t* pnt = xyz + 3 * i;
+#ifndef _BRING_TO_BOUNDARY_ // exact matching to fitted volume is requested
+    b[3 * i] = b[3 * i + 1] = b[3 * i + 2] = 0;
+#endif
+    int id = -1;
+    if (pnt[2] > mMinZSolenoid) {
+      cartesianToCylindrical(pnt, &rphiz[3 * i]);
+      id = findSolenoidSegment(&rphiz[3 * i]);
+    } else {
+      id = findDipoleSegment(pnt);
+      if (id >= 0) {
+        id += nSol;
+      }
+    }
+    segID[i] = id;
+    if (id >= 0) {
+      counts[id + 1]++;
+    }
+  }
+  for (int is = 0; is < nSeg; is++) {
+    counts[is + 1] += counts[is];
+  }
+  for (int i = 0; i < npoints; i++) {
+    if (segID[i] >= 0) {
+      order[counts[segID[i]]++] = i;
+    }
+  }
+
+  // evaluate piece by piece, after the fill counts[is] points to the end of the piece is
+  int first = 0;
+  for (int is = 0; is < nSeg; is++) {
+    int last = counts[is];
+    if (first == last) {
+      continue;
+    }
+    if (is < nSol) {
+      Chebyshev3D* par = getParameterSolenoid(is);
+      for (int ip = first; ip < last; ip++) {
+        int i = order[ip];
+        const Double_t* rpz = &rphiz[3 * i];
+#ifndef _BRING_TO_BOUNDARY_
+        if (!par->isInside(rpz)) {
+          continue;
+        }
+#endif
+        par->Eval(rpz, b + 3 * i);
+        cylindricalToCartesianCylB(rpz, b + 3 * i, b + 3 * i);
+      }
+    } else {
+      Chebyshev3D* par = getParameterDipole(is - nSol);
+      for (int ip = first; ip < last; ip++) {
+        int i = order[ip];
+#ifndef _BRING_TO_BOUNDARY_
+        if (!par->isInside(xyz + 3 * i)) {
+          continue;
+        }
+#endif
+        par->Eval(xyz + 3 * i, b + 3 * i);
+      }
+    }
+    first = last;
+  }
+}
+
 Double_t MagneticWrapperChebyshev::getBz(const Double_t* xyz) const
 {
   Double_t rphiz[3];
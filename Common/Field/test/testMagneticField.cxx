@@ -17,6 +17,7 @@
 #include "Field/MagneticField.h"
 #include "Field/MagFieldFast.h"
 #include <memory>
+#include <vector>
 #include "FairLogger.h" // for FairLogger
 #include <TStopwatch.h>
 #include <TRandom.h>
@@ -98,3 +99,30 @@ BOOST_AUTO_TEST_CASE(MagneticField_test)
     BOOST_CHECK(TMath::Abs(rms[i] / nomBz) < 1.e-3);
   }
 }
+
+BOOST_AUTO_TEST_CASE(MagneticField_batch_test)
+{
+  // batched field query must reproduce the single point one
+  std::unique_ptr<MagneticField> fld = std::make_unique<MagneticField>("Maps", "Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+
+  const int ntst = 10000;
+  float rnd[3];
+  std::vector<double> xyz(3 * ntst), bxyz(3 * ntst), bbatch(3 * ntst);
+  for (int it = ntst; it--;) {
+    gRandom->RndmArray(3, rnd);
+    xyz[3 * it + 0] = (rnd[0] - 0.5) * 1000.;
+    xyz[3 * it + 1] = (rnd[1] - 0.5) * 1000.;
+    xyz[3 * it + 2] = (rnd[2] - 0.5) * 2000.; // cover also the dipole region
+  }
+
+  for (int fast = 0; fast < 2; fast++) {
+    fld->AllowFastField(fast == 1);
+    for (int it = ntst; it--;) {
+      fld->Field(&xyz[3 * it], &bxyz[3 * it]);
+    }
+    fld->Field(ntst, xyz.data(), bbatch.data());
+    for (int i = 3 * ntst; i--;) {
+      BOOST_CHECK_CLOSE(bxyz[i], bbatch[i], 1.e-6);
+    }
+  }
+}
@@ -0,0 +1,211 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ChunkedMCTruthContainer.h
+/// \brief An append-only MC truth container built from chunks, to accumulate labels without reallocation
+
+#ifndef O2_CHUNKEDMCTRUTHCONTAINER_H
+#define O2_CHUNKEDMCTRUTHCONTAINER_H
+
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+namespace dataformats
+{
+
+/// @class ChunkedMCTruthContainer
+/// @brief Append-only accumulator of MC truth labels, stored as a sequence of MCTruthContainer chunks
+///
+/// Each chunk is a normal MCTruthContainer whose header indices are relative to the chunk, such that
+/// - adding an element never moves the already accumulated data: a new chunk is started once the
+///   current one holds more than the chunk capacity, instead of reallocating one big array
+/// - merging the MCTruthContainer produced e.g. by a digitizer for one collision moves its storage
+///   into the accumulator as a new chunk, small containers are copied to the last chunk to limit
+///   the number of chunks (every label is copied at most once)
+///
+/// The accumulated labels are sent by flattening them once, directly to the message memory
+/// obtained from DPL, in the same format as MCTruthContainer::flatten_to:
+///   auto& sharedlabels = pc.outputs().make<ConstMCTruthContainer<MCCompLabel>>(Output{...});
+///   labelsAccum.flatten_to(sharedlabels);
+/// so that the receivers access them without copy via ConstMCTruthContainerView.
+template <typename TruthElement>
+class ChunkedMCTruthContainer
+{
+ public:
+  using Chunk = MCTruthContainer<TruthElement>;
+  using FlatHeader = typename Chunk::FlatHeader;
+  static constexpr size_t DefaultChunkCapacity = 1 << 18; // number of elements after which a new chunk is started
+
+  ChunkedMCTruthContainer(size_t chunkCapacity = DefaultChunkCapacity) : mChunkCapacity(chunkCapacity) {}
+
+  // return the number of original data indexed here
+  size_t getIndexedSize() const { return mChunks.empty() ? 0 : mChunkFirstIndex.back() + mChunks.back().getIndexedSize(); }
+
+  // return the number of elements managed in this container
+  size_t getNElements() const
+  {
+    size_t n = 0;
+    for (const auto& chunk : mChunks) {
+      n += chunk.getNElements();
+    }
+    return n;
+  }
+
+  size_t getNChunks() const { return mChunks.size(); }
+  const Chunk& getChunk(size_t i) const { return mChunks[i]; }
+  // return the dataindex of the first entry of the chunk
+  uint32_t getChunkFirstIndex(size_t i) const { return mChunkFirstIndex[i]; }
+
+  size_t getChunkCapacity() const { return mChunkCapacity; }
+  void setChunkCapacity(size_t n) { mChunkCapacity = n; }
+
+  // get individual const "view" container for a given data index
+  gsl::span<const TruthElement> getLabels(uint32_t dataindex) const
+  {
+    if (dataindex >= getIndexedSize()) {
+      return gsl::span<const TruthElement>();
+    }
+    // the chunk containing the dataindex is the last one starting at or before it
+    auto ichunk = std::upper_bound(mChunkFirstIndex.begin(), mChunkFirstIndex.end(), dataindex) - mChunkFirstIndex.begin() - 1;
+    return mChunks[ichunk].getLabels(dataindex - mChunkFirstIndex[ichunk]);
+  }
+
+  void clear()
+  {
+    mChunks.clear();
+    mChunkFirstIndex.clear();
+  }
+
+  // add element for a particular dataindex, same rules as for MCTruthContainer::addElement
+  void addElement(uint32_t dataindex, TruthElement const& element)
+  {
+    const auto size = getIndexedSize();
+    if (dataindex < size) {
+      if (dataindex != size - 1) {
+        throw std::runtime_error("ChunkedMCTruthContainer: unsupported code path");
+      }
+    } else if (mChunks.empty() || mChunks.back().getNElements() >= mChunkCapacity) {
+      // new dataindex and the current chunk is full: the holes, if any, go to the new chunk
+      mChunks.emplace_back();
+      mChunkFirstIndex.push_back(size);
+    }
+    mChunks.back().addElement(dataindex - mChunkFirstIndex.back(), element);
+  }
+
+  // convenience interface to add multiple labels at once
+  template <typename CompatibleLabel>
+  void addElements(uint32_t dataindex, gsl::span<CompatibleLabel> elements)
+  {
+    for (auto& e : elements) {
+      addElement(dataindex, e);
+    }
+  }
+
+  // merge another container to the back of this one, taking over its storage
+  void mergeAtBack(Chunk&& other)
+  {
+    if (!other.getIndexedSize()) {
+      return;
+    }
+    if (fitsLastChunk(other)) {
+      mChunks.back().mergeAtBack(other);
+    } else {
+      mChunkFirstIndex.push_back(getIndexedSize());
+      mChunks.emplace_back(std::move(other));
+    }
+    other.clear();
+  }
+
+  // merge a copy of another container to the back of this one
+  void mergeAtBack(Chunk const& other)
+  {
+    if (!other.getIndexedSize()) {
+      return;
+    }
+    if (fitsLastChunk(other)) {
+      mChunks.back().mergeAtBack(other);
+    } else {
+      mChunkFirstIndex.push_back(getIndexedSize());
+      mChunks.emplace_back(other);
+    }
+  }
+
+  // merge the chunks of another chunked container to the back of this one, taking over their storage
+  void mergeAtBack(ChunkedMCTruthContainer&& other)
+  {
+    for (auto& chunk : other.mChunks) {
+      mergeAtBack(std::move(chunk));
+    }
+    other.clear();
+  }
+
+  /// Flatten the chunks to the provided container, with the same layout as MCTruthContainer::flatten_to.
+  /// The container is resized once, the header indices are made absolute while copying.
+  template <typename ContainerType>
+  size_t flatten_to(ContainerType& container) const
+  {
+    const size_t nHeaders = getIndexedSize(), nElements = getNElements();
+    size_t bufferSize = sizeof(FlatHeader) + sizeof(MCTruthHeaderElement) * nHeaders + sizeof(TruthElement) * nElements;
+    container.resize((bufferSize / sizeof(typename ContainerType::value_type)) + ((bufferSize % sizeof(typename ContainerType::value_type)) > 0 ? 1 : 0));
+    char* target = reinterpret_cast<char*>(container.data());
+    auto& flatheader = *reinterpret_cast<FlatHeader*>(target);
+    flatheader.version = 1;
+    flatheader.sizeofHeaderElement = sizeof(MCTruthHeaderElement);
+    flatheader.sizeofTruthElement = sizeof(TruthElement);
+    flatheader.reserved = 0;
+    flatheader.nofHeaderElements = nHeaders;
+    flatheader.nofTruthElements = nElements;
+    auto* headers = reinterpret_cast<MCTruthHeaderElement*>(target + sizeof(FlatHeader));
+    auto* labels = reinterpret_cast<char*>(headers + nHeaders);
+    uint32_t offset = 0;
+    for (const auto& chunk : mChunks) {
+      const auto nh = chunk.getIndexedSize();
+      if (nh) {
+        memcpy(headers, &chunk.getMCTruthHeader(0), nh * sizeof(MCTruthHeaderElement));
+        for (size_t i = 0; i < nh; i++) {
+          headers[i].index += offset;
+        }
+        headers += nh;
+      }
+      const auto nl = chunk.getNElements();
+      if (nl) {
+        memcpy(labels, chunk.getTruthArray().data(), nl * sizeof(TruthElement));
+        labels += nl * sizeof(TruthElement);
+      }
+      offset += nl;
+    }
+    return bufferSize;
+  }
+
+ private:
+  // small containers are copied to the last chunk rather than starting a new one
+  bool fitsLastChunk(Chunk const& other) const
+  {
+    return !mChunks.empty() && mChunks.back().getNElements() + other.getNElements() <= mChunkCapacity;
+  }
+
+  size_t mChunkCapacity = DefaultChunkCapacity; // number of elements after which a new chunk is started
+  std::vector<Chunk> mChunks;                   // chunks with indices relative to the chunk
+  std::vector<uint32_t> mChunkFirstIndex;       // dataindex of the first entry of each chunk
+};
+
+using ChunkedMCLabelContainer = o2::dataformats::ChunkedMCTruthContainer<o2::MCCompLabel>;
+
+} // namespace dataformats
+} // namespace o2
+
+#endif // O2_CHUNKEDMCTRUTHCONTAINER_H
@@ -15,6 +15,7 @@
 #include <boost/test/unit_test.hpp>
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "SimulationDataFormat/ConstMCTruthContainer.h"
+#include "SimulationDataFormat/ChunkedMCTruthContainer.h"
 #include "SimulationDataFormat/LabelContainer.h"
 #include "SimulationDataFormat/IOMCTruthContainerView.h"
 #include <algorithm>
@@ -323,6 +324,66 @@ BOOST_AUTO_TEST_CASE(MCTruthContainer_move)
   BOOST_CHECK(container.getNElements() == 4);
 }
 
+BOOST_AUTO_TEST_CASE(ChunkedMCTruthContainer)
+{
+  using TruthElement = long;
+  using Container = dataformats::MCTruthContainer<TruthElement>;
+  using ChunkedContainer = dataformats::ChunkedMCTruthContainer<TruthElement>;
+  // reference filled with the same elements as the chunked container
+  Container reference;
+  ChunkedContainer chunked(5);
+  for (int i = 0; i < 20; ++i) {
+    if (i % 7 == 3) {
+      continue; // leave a hole
+    }
+    for (int j = 0; j <= i % 3; ++j) {
+      reference.addElement(i, TruthElement(10 * i + j));
+      chunked.addElement(i, TruthElement(10 * i + j));
+    }
+  }
+  // not supported, must throw
+  BOOST_CHECK_THROW(chunked.addElement(0, TruthElement(0)), std::runtime_error);
+  BOOST_CHECK(chunked.getNChunks() > 1);
+
+  // merge containers of the "digitizer", small ones are appended to the last chunk
+  for (int n : {2, 12}) {
+    Container part;
+    for (int i = 0; i < n; ++i) {
+      part.addElement(i, TruthElement(1000 + i));
+    }
+    reference.mergeAtBack(part);
+    const auto nchunks = chunked.getNChunks();
+    const bool fits = chunked.getChunk(nchunks - 1).getNElements() + n <= chunked.getChunkCapacity();
+    chunked.mergeAtBack(std::move(part));
+    BOOST_CHECK(part.getIndexedSize() == 0);
+    BOOST_CHECK(chunked.getNChunks() == (fits ? nchunks : nchunks + 1));
+  }
+  ChunkedContainer other(5);
+  other.addElement(1, TruthElement(-1));
+  other.addElement(1, TruthElement(-2));
+  chunked.mergeAtBack(std::move(other));
+  BOOST_CHECK(other.getIndexedSize() == 0);
+  reference.addElement(reference.getIndexedSize() + 1, TruthElement(-1));
+  reference.addElement(reference.getIndexedSize() - 1, TruthElement(-2));
+
+  BOOST_CHECK(chunked.getIndexedSize() == reference.getIndexedSize());
+  BOOST_CHECK(chunked.getNElements() == reference.getNElements());
+  for (uint32_t i = 0; i <= reference.getIndexedSize(); ++i) {
+    auto labels = chunked.getLabels(i);
+    auto refLabels = reference.getLabels(i);
+    BOOST_CHECK(std::equal(labels.begin(), labels.end(), refLabels.begin(), refLabels.end()));
+  }
+
+  // the flat buffer is identical to the one of the reference
+  std::vector<char> buffer, refBuffer;
+  BOOST_CHECK(chunked.flatten_to(buffer) == reference.flatten_to(refBuffer));
+  BOOST_CHECK(buffer == refBuffer);
+  dataformats::ConstMCTruthContainerView<TruthElement> view(buffer);
+  BOOST_CHECK(view.getIndexedSize() == reference.getIndexedSize());
+  BOOST_CHECK(view.getLabels(19).size() == 2);
+  BOOST_CHECK(view.getLabels(19)[1] == 191);
+}
+
 BOOST_AUTO_TEST_CASE(MCTruthContainer_ROOTIO)
 {
   using TruthElement = o2::MCCompLabel;
@@ -50,6 +50,7 @@ namespace align
 {
 
 class Mille;
+class GlobalSolver;
 
 class AlignableDetector;
 class AlignableVolume;
@@ -86,7 +87,8 @@ class Controller : public TObject
          kMaxStat };
   enum MPOut_t { kMille = BIT(0),
                  kMPRec = BIT(1),
-                 kContR = BIT(2) };
+                 kContR = BIT(2),
+                 kSolver = BIT(3) };
   enum { kInitGeomDone = BIT(14),
          kInitDOFsDone = BIT(15),
          kMPAlignDone = BIT(16) };
@@ -235,6 +237,8 @@ class Controller : public TObject
   //
   //----------------------------------------
   bool readParameters(const char* parfile = "millepede.res", bool useErrors = true);
+  bool solveGlobal(const char* milleFiles = nullptr);
+  GlobalSolver* getSolver();
   float* getGloParVal() const { return (float*)mGloParVal; }
   float* getGloParErr() const { return (float*)mGloParErr; }
   int* getGloParLab() const { return (int*)mGloParLab; }
@@ -330,11 +334,20 @@ class Controller : public TObject
       mMPOutType &= ~kContR;
     }
   }
+  void produceSolverData(bool v = true)
+  {
+    if (v) {
+      mMPOutType |= kSolver;
+    } else {
+      mMPOutType &= ~kSolver;
+    }
+  }
   int getMPOutType() const { return mMPOutType; }
   bool getDoKalmanResid() const { return mDoKalmanResid; }
   bool getProduceMPData() const { return mMPOutType & kMille; }
   bool getProduceMPRecord() const { return mMPOutType & kMPRec; }
   bool getProduceControlRes() const { return mMPOutType & kContR; }
+  bool getProduceSolverData() const { return mMPOutType & kSolver; }
   void closeMPRecOutput();
   void closeMilleOutput();
   void closeResidOutput();
@@ -446,6 +459,7 @@ class Controller : public TObject
   float mControlFrac;           //  fraction of tracks to process control residuals
   int mMPOutType;               // What to store as an output, see storeProcessedTrack
   Mille* mMille;                //! Mille interface
+  GlobalSolver* mSolver;        //! in-process global solver
   Millepede2Record* mMPRecord;  //! MP record
   ResidualsController* mCResid; //! control residuals
   TTree* mMPRecTree;            //! tree to store MP record
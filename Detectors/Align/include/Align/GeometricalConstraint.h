@@ -37,6 +37,8 @@ namespace o2
 namespace align
 {
 
+class GlobalSolver;
+
 class GeometricalConstraint : public TNamed
 {
  public:
@@ -74,6 +76,7 @@ class GeometricalConstraint : public TNamed
   //
   void Print(const Option_t* opt = "") const final;
   virtual void writeChildrenConstraints(FILE* conOut) const;
+  virtual void addChildrenConstraints(GlobalSolver& solver) const;
   virtual void checkConstraint() const;
   virtual const char* getDOFName(int i) const { return AlignableVolume::getGeomDOFName(i); }
   //
@@ -82,6 +85,8 @@ class GeometricalConstraint : public TNamed
   GeometricalConstraint(const GeometricalConstraint&);
   GeometricalConstraint& operator=(const GeometricalConstraint&);
   //
+  void fillJacobians(float* cstrArr, int* nContCh) const;
+  //
  protected:
   uint32_t mConstraint;           // bit pattern of constraint
   double mSigma[kNDOFGeom];       // optional sigma if constraint is gaussian
@@ -0,0 +1,193 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   GlobalSolver.h
+/// @brief  In-process solver of the global alignment problem
+
+/**
+ * In-process replacement of the Millepede-II global fit.
+ *
+ * The tracks are fed measurement by measurement, exactly as to Mille (mille() per
+ * measurement, end() per track), but instead of being written to file each track is
+ * fitted immediately: its local parameters are eliminated and its contribution to the
+ * global normal equations C p = b is accumulated, with C stored as sparse symmetric
+ * matrix of dense kBlockSize x kBlockSize blocks.
+ * Each thread must use its own Accumulator (see getAccumulator(slot)), the accumulators
+ * are merged before solving.
+ *
+ * The constraints (exact ones via Lagrange multipliers, gaussian ones as regularized
+ * multipliers) extend C to a symmetric indefinite system, which is solved by the
+ * MINRES method with a diagonal preconditioner, the matrix-vector products and vector
+ * operations being parallelized with OpenMP.
+ * As with pede, parameters with negative presigma are fixed, positive presigma
+ * adds a gaussian prior for the parameter. The parameters start from their initial
+ * values: the fit determines the corrections to them (the fixed parameters keep their
+ * initial values, the priors constrain the corrections) while the constraints apply to
+ * the full parameter values.
+ */
+
+#ifndef GLOBALSOLVER_H
+#define GLOBALSOLVER_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace o2
+{
+namespace align
+{
+
+class GlobalSolver
+{
+ public:
+  static constexpr int kBlockSize = 8;
+  using Block = std::array<double, kBlockSize * kBlockSize>;
+
+  /// linear constraint sum_k coef_k * par(parID_k) = value, exact if sigma = 0, gaussian otherwise
+  struct Constraint {
+    std::vector<int> parID{};   // IDs of the constrained parameters
+    std::vector<double> coef{}; // their coefficients
+    double value = 0.;          // constraint value
+    double sigma = 0.;          // 0 for exact constraint, otherwise sigma of the gaussian constraint
+  };
+
+  /// accumulator of the global normal equations, to be used by a single thread
+  class Accumulator
+  {
+   public:
+    /// add measurement to the current track, same conventions as Mille::mille but with parameter IDs instead of labels
+    void mille(int nLoc, const float* derLoc, int nGlo, const float* derGlo, const int* parID, float resid, float sigma);
+    /// discard the current track
+    void kill();
+    /// fit the local parameters of the current track and add it to the normal equations, false if the track is rejected
+    bool end();
+    /// add the track stored in the Mille binary record format, returns the result of end()
+    bool addMilleRecord(const float* bufF, const int* bufI, int nWords, const std::function<int(int)>& label2ParID);
+    /// add the normal equations of another accumulator
+    void merge(const Accumulator& other);
+    void clear();
+    //
+    long getNTracks() const { return mNTracks; }
+    long getNRejected() const { return mNRejected; }
+    long getNDF() const { return mNDF; }
+    double getChi2() const { return mChi2; }
+    const std::vector<int>& getEntries() const { return mEntries; }
+    //
+   private:
+    struct Measurement {
+      int locFirst, gloFirst; // first local and global derivative
+      int nLoc, nGlo;         // number of local and global derivatives
+      double resid, weight;   // residual and its weight 1/sigma^2
+    };
+    void addToBlocks(const std::vector<int>& ids, const std::vector<double>& mat);
+    //
+    // current track
+    std::vector<Measurement> mMeas{};
+    std::vector<int> mLocID{};
+    std::vector<double> mLocDer{};
+    std::vector<int> mGloID{};
+    std::vector<double> mGloDer{};
+    // work space for the local fit
+    std::vector<int> mTrkLoc{}, mTrkGlo{};
+    std::vector<double> mLocMat{}, mLocRHS{}, mGloMat{}, mGloRHS{}, mCross{}, mWork{};
+    // normal equations
+    std::unordered_map<uint64_t, Block> mBlocks{}; // blocks of C for block row <= block column
+    std::vector<double> mRHS{};                    // b
+    std::vector<int> mEntries{};                   // number of measurements per parameter
+    long mNTracks = 0;                             // accepted tracks
+    long mNRejected = 0;                           // tracks with failed local fit
+    long mNDF = 0;                                 // total number of degrees of freedom
+    double mChi2 = 0.;                             // total chi2 of local fits
+    //
+    friend class GlobalSolver;
+  };
+
+  GlobalSolver(int nPar = 0) { setNPar(nPar); }
+  //
+  void setNPar(int n);
+  int getNPar() const { return mNPar; }
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+  void setMinEntries(int n) { mMinEntries = n; }
+  int getMinEntries() const { return mMinEntries; }
+  void setMaxIterations(int n) { mMaxIter = n; }
+  int getMaxIterations() const { return mMaxIter; }
+  void setTolerance(double tol) { mTolerance = tol; }
+  double getTolerance() const { return mTolerance; }
+  /// pede-like presigma: < 0 fixed parameter, 0 free, > 0 gaussian prior
+  void setPreSigma(int parID, double sig) { mPreSigma[parID] = sig; }
+  double getPreSigma(int parID) const { return mPreSigma[parID]; }
+  /// pede-like initial value of the parameter
+  void setInitialValue(int parID, double val) { mInitial[parID] = val; }
+  double getInitialValue(int parID) const { return mInitial[parID]; }
+  //
+  /// accumulator for given slot (e.g. thread ID), created on demand. Not thread safe, create all slots before the parallel processing
+  Accumulator& getAccumulator(int slot = 0);
+  int getNAccumulators() const { return mAccumulators.size(); }
+  /// add tracks from Mille binary file, processing the records in parallel. Returns number of accepted tracks or -1
+  long addMilleFile(const std::string& fileName, const std::function<int(int)>& label2ParID, int chunkSize = 10000);
+  //
+  void addConstraint(const Constraint& cs) { mConstraints.push_back(cs); }
+  void clearConstraints() { mConstraints.clear(); }
+  int getNConstraints() const { return mConstraints.size(); }
+  //
+  /// merge the accumulators and solve the normal equations with constraints
+  bool solve();
+  const std::vector<double>& getSolution() const { return mSolution; }
+  const std::vector<double>& getLagrangeMultipliers() const { return mLagrange; }
+  int getNIterations() const { return mNIterDone; }
+  double getRelResidual() const { return mRelResidual; }
+  void reset();
+  //
+ private:
+  void buildSystem();
+  void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+  double dot(const std::vector<double>& a, const std::vector<double>& b) const;
+  bool minres(const std::vector<double>& rhs, std::vector<double>& x);
+  //
+  int mNPar = 0;                   // number of global parameters
+  int mNThreads = 1;               // number of threads
+  int mMinEntries = 0;             // min number of measurements to vary a parameter
+  int mMaxIter = 10000;            // max number of MINRES iterations
+  double mTolerance = 1e-10;       // relative residual to stop the iterations
+  std::vector<double> mPreSigma{}; // presigma per parameter
+  std::vector<double> mInitial{};  // initial value per parameter
+  std::vector<Accumulator> mAccumulators{};
+  std::vector<Constraint> mConstraints{};
+  //
+  // system in block-sparse row format: global parameters padded to full blocks, then one row per constraint
+  int mNBlocks = 0;                   // number of block rows
+  int mNCons = 0;                     // number of active constraints
+  std::vector<int> mRowStart{};       // first block of each block row
+  std::vector<int> mBlockCol{};       // block column of each block
+  std::vector<Block> mBlockVal{};     // blocks
+  std::vector<int> mConsStart{};      // first coefficient of each constraint row
+  std::vector<int> mConsPar{};        // parameter of each coefficient
+  std::vector<double> mConsCoef{};    // coefficients
+  std::vector<int> mParConsStart{};   // transposed constraints: first entry for each parameter
+  std::vector<int> mParConsID{};      // constraint of each entry
+  std::vector<double> mParConsCoef{}; // coefficients
+  std::vector<double> mConsDiag{};    // -sigma^2 of the constraints
+  std::vector<double> mPrecond{};     // inverse of the diagonal preconditioner
+  std::vector<double> mRHSFull{};     // right hand side of the full system
+  std::vector<double> mSolution{};    // solution for the global parameters, initial values included
+  std::vector<double> mLagrange{};    // Lagrange multipliers of the constraints
+  int mNIterDone = 0;                 // number of iterations done
+  double mRelResidual = 0.;           // final relative residual
+};
+
+} // namespace align
+} // namespace o2
+#endif
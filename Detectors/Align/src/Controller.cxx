@@ -40,6 +40,7 @@
 //#include "AliCDBManager.h"
 //#include "AliCDBEntry.h"
 #include "Align/Mille.h"
+#include "Align/GlobalSolver.h"
 #include <TMath.h>
 #include <TString.h>
 #include <TTree.h>
@@ -105,6 +106,7 @@ Controller::Controller(const char* configMacro, int refRun)
     mControlFrac(1.0),
     mMPOutType(kMille | kMPRec | kContR),
     mMille(nullptr),
+    mSolver(nullptr),
     mMPRecord(nullptr),
     mCResid(nullptr),
     mMPRecTree(nullptr),
@@ -191,6 +193,7 @@ Controller::~Controller()
   if (mResidFile) {
     closeResidOutput();
   }
+  delete mSolver;
   //
   delete mAlgTrack;
   delete[] mGloParVal;
@@ -800,7 +803,7 @@ bool Controller::storeProcessedTrack(int what)
 {
   // write alignment track
   bool res = true;
-  if ((what & kMille)) {
+  if ((what & (kMille | kSolver))) {
     res &= fillMilleData();
   }
   if ((what & kMPRec)) {
@@ -816,8 +819,10 @@ bool Controller::storeProcessedTrack(int what)
 //_________________________________________________________
 bool Controller::fillMilleData()
 {
-  // store MP2 data in Mille format
-  if (!mMille) {
+  // store MP2 data in Mille format and/or feed it to the in-process solver
+  bool toSolver = getProduceSolverData(), toMille = getProduceMPData() || !toSolver;
+  GlobalSolver::Accumulator* solAcc = toSolver ? &getSolver()->getAccumulator() : nullptr;
+  if (toMille && !mMille) {
     TString mo = Form("%s%s", mMPDatFileName.Data(), sMPDataExt);
     mMille = new Mille(mo.Data(), mMilleOutBin);
     if (!mMille) {
@@ -833,7 +838,7 @@ bool Controller::fillMilleData()
   int nParETP(mAlgTrack->getNLocExtPar());      // numnber of local parameters for reference track param
   int nVarLoc(mAlgTrack->getNLocPar());         // number of local degrees of freedom in the track
   float *buffDL(nullptr), *buffDG(nullptr);     // faster acces arrays
-  int* buffI(nullptr);
+  int *buffI(nullptr), *buffP(nullptr);
   //
   const int* gloParID(mAlgTrack->getGloParID()); // IDs of global DOFs this track depends on
   for (int ip = 0; ip < np; ip++) {
@@ -849,12 +854,13 @@ bool Controller::fillMilleData()
         if (mMilleDBuffer.GetSize() < nVarLoc + nDGlo) {
           mMilleDBuffer.Set(100 + nVarLoc + nDGlo);
         }
-        if (mMilleIBuffer.GetSize() < nDGlo) {
-          mMilleIBuffer.Set(100 + nDGlo);
+        if (mMilleIBuffer.GetSize() < 2 * nDGlo) {
+          mMilleIBuffer.Set(100 + 2 * nDGlo);
         }
         buffDL = mMilleDBuffer.GetArray(); // faster acces
         buffDG = buffDL + nVarLoc;         // faster acces
         buffI = mMilleIBuffer.GetArray();  // faster acces
+        buffP = buffI + nDGlo;             // parameter IDs for the solver
       }
       // local der. array cannot be 0-suppressed by Mille construction, need to reset all to 0
       //
@@ -879,11 +885,17 @@ bool Controller::fillMilleData()
         for (int j = 0; j < nDGlo; j++) {
           if (!isZeroAbs(deriv[j])) {
             buffDG[nGlo] = deriv[j];                 // value of derivative
+            buffP[nGlo] = gloIDP[j];                 // global DOF ID
             buffI[nGlo++] = getGloParLab(gloIDP[j]); // global DOF ID + 1 (Millepede needs positive labels)
           }
         }
-        mMille->mille(nVarLoc, buffDL, nGlo, buffDG, buffI,
-                      mAlgTrack->getResidual(idim, ip), Sqrt(pnt->getErrDiag(idim)));
+        if (toMille) {
+          mMille->mille(nVarLoc, buffDL, nGlo, buffDG, buffI,
+                        mAlgTrack->getResidual(idim, ip), Sqrt(pnt->getErrDiag(idim)));
+        }
+        if (toSolver) {
+          solAcc->mille(nVarLoc, buffDL, nGlo, buffDG, buffP, mAlgTrack->getResidual(idim, ip), Sqrt(pnt->getErrDiag(idim)));
+        }
         nDGloTot += nGlo;
         //
       }
@@ -900,7 +912,12 @@ bool Controller::fillMilleData()
         buffDL[j1] = 1.0; // only 1 non-0 derivative
         //mMille->mille(nVarLoc,buffDL,0,buffDG,buffI,expMatCorr[j],Sqrt(expMatCov[j]));
         // expectation for MS effect is 0
-        mMille->mille(nVarLoc, buffDL, 0, buffDG, buffI, 0, Sqrt(expMatCov[j]));
+        if (toMille) {
+          mMille->mille(nVarLoc, buffDL, 0, buffDG, buffI, 0, Sqrt(expMatCov[j]));
+        }
+        if (toSolver) {
+          solAcc->mille(nVarLoc, buffDL, 0, buffDG, buffP, 0, Sqrt(expMatCov[j]));
+        }
         buffDL[j1] = 0.0; // reset buffer
       }
     } // material "measurement"
@@ -908,10 +925,20 @@ bool Controller::fillMilleData()
   //
   if (!nDGloTot) {
     LOG(INFO) << "Track does not depend on free global parameters, discard";
-    mMille->kill();
+    if (toMille) {
+      mMille->kill();
+    }
+    if (toSolver) {
+      solAcc->kill();
+    }
     return false;
   }
-  mMille->end(); // store the record
+  if (toMille) {
+    mMille->end(); // store the record
+  }
+  if (toSolver) {
+    solAcc->end(); // fit local params and accumulate normal equations
+  }
   return true;
 }
 
@@ -1801,6 +1828,55 @@ bool Controller::readParameters(const char* parfile, bool useErrors)
   return true;
 }
 
+//______________________________________________________
+GlobalSolver* Controller::getSolver()
+{
+  // in-process solver of the global problem, created on demand
+  if (!mSolver) {
+    mSolver = new GlobalSolver(mNDOFs);
+  }
+  return mSolver;
+}
+
+//______________________________________________________
+bool Controller::solveGlobal(const char* milleFiles)
+{
+  // Solve the global problem in process instead of pede, using the tracks accumulated with kSolver
+  // output and/or stored in the comma-separated list of Mille files.
+  // The initial values, constraints and fixed parameters are the same as written for pede, the solution is
+  // stored with the same convention as in readParameters. The errors are not evaluated.
+  if (mNDOFs < 1 || !mGloParVal || !mGloParErr) {
+    LOG(ERROR) << "Something is wrong in init: mNDOFs=" << mNDOFs << " mGloParVal=" << mGloParVal << " mGloParErr=" << mGloParErr;
+    return false;
+  }
+  GlobalSolver* solver = getSolver();
+  if (milleFiles && milleFiles[0]) {
+    TString inpList = milleFiles;
+    TObjArray* arr = inpList.Tokenize(",");
+    for (int i = 0; i < arr->GetEntriesFast(); i++) {
+      if (solver->addMilleFile(arr->At(i)->GetName(), [this](int lab) { return label2ParID(lab); }) < 0) {
+        LOG(ERROR) << "Failed to read " << arr->At(i)->GetName();
+      }
+    }
+    delete arr;
+  }
+  for (int i = 0; i < mNDOFs; i++) {
+    solver->setPreSigma(i, mGloParErr[i]);
+    solver->setInitialValue(i, mGloParVal[i]); // as written by AlignableVolume::writePedeInfo
+  }
+  solver->clearConstraints();
+  int ncon = getNConstraints();
+  for (int icon = 0; icon < ncon; icon++) {
+    getConstraint(icon)->addChildrenConstraints(*solver);
+  }
+  bool res = solver->solve();
+  const auto& sol = solver->getSolution();
+  for (int i = 0; i < mNDOFs; i++) {
+    mGloParVal[i] = -sol[i];
+  }
+  return res;
+}
+
 //______________________________________________________
 void Controller::checkConstraints(const char* params)
 {
@@ -15,6 +15,7 @@
 /// @brief  Descriptor of geometrical constraint
 
 #include "Align/GeometricalConstraint.h"
+#include "Align/GlobalSolver.h"
 #include "DetectorsCommonDataFormats/AlignParam.h"
 #include "Align/utils.h"
 #include "Framework/Logger.h"
@@ -64,22 +65,15 @@ void GeometricalConstraint::setParent(const AlignableVolume* par)
 }
 
 //______________________________________________________
-void GeometricalConstraint::writeChildrenConstraints(FILE* conOut) const
+void GeometricalConstraint::fillJacobians(float* cstrArr, int* nContCh) const
 {
-  // write for PEDE eventual constraints on children movement in parent frame
-  //
-  enum { kOff,
-         kOn,
-         kOnOn };
-  enum { kConstr,
-         kMeas };
-  const char* comment[3] = {"  ", "! ", "!!"};
-  const char* kKeyConstr[2] = {"constraint", "measurement"};
+  // fill for each child the jacobian [kNDOFGeom][kNDOFGeom] of parent DOFs vs child DOFs and count
+  // the free child DOFs contributing to each constraint
   //
   bool doJac = !getNoJacobian(); // do we need jacobian evaluation?
   int nch = getNChildren();
-  float* cstrArr = new float[nch * kNDOFGeom * kNDOFGeom];
   memset(cstrArr, 0, nch * kNDOFGeom * kNDOFGeom * sizeof(float));
+  memset(nContCh, 0, kNDOFGeom * sizeof(int));
   // we need for each children the matrix for vector transformation from children frame
   // (in which its DOFs are defined, LOC or TRA) to this parent variation frame
   // matRel = mPar^-1*mChild
@@ -98,7 +92,6 @@ void GeometricalConstraint::writeChildrenConstraints(FILE* conOut) const
   }
   //
   float* jac = cstrArr;
-  int nContCh[kNDOFGeom] = {0}; // we need at least on contributing children DOF to constrain the parent DOF
   for (int ich = 0; ich < nch; ich++) {
     AlignableVolume* child = getChild(ich);
     //
@@ -132,6 +125,27 @@ void GeometricalConstraint::writeChildrenConstraints(FILE* conOut) const
     }
     jac += kNDOFGeom * kNDOFGeom; // matrix for next slot
   }
+}
+
+//______________________________________________________
+void GeometricalConstraint::writeChildrenConstraints(FILE* conOut) const
+{
+  // write for PEDE eventual constraints on children movement in parent frame
+  //
+  enum { kOff,
+         kOn,
+         kOnOn };
+  enum { kConstr,
+         kMeas };
+  const char* comment[3] = {"  ", "! ", "!!"};
+  const char* kKeyConstr[2] = {"constraint", "measurement"};
+  //
+  bool doJac = !getNoJacobian(); // do we need jacobian evaluation?
+  int nch = getNChildren();
+  float* cstrArr = new float[nch * kNDOFGeom * kNDOFGeom];
+  int nContCh[kNDOFGeom] = {0}; // we need at least on contributing children DOF to constrain the parent DOF
+  fillJacobians(cstrArr, nContCh);
+  float* jac = cstrArr;
   //
   for (int ics = 0; ics < kNDOFGeom; ics++) {
     if (!isDOFConstrained(ics)) {
@@ -180,6 +194,41 @@ void GeometricalConstraint::writeChildrenConstraints(FILE* conOut) const
   delete[] cstrArr;
 }
 
+//______________________________________________________
+void GeometricalConstraint::addChildrenConstraints(GlobalSolver& solver) const
+{
+  // add to in-process solver the constraints on children movement in parent frame, same selection as for PEDE
+  //
+  int nch = getNChildren();
+  float* cstrArr = new float[nch * kNDOFGeom * kNDOFGeom];
+  int nContCh[kNDOFGeom] = {0};
+  fillJacobians(cstrArr, nContCh);
+  for (int ics = 0; ics < kNDOFGeom; ics++) {
+    if (!isDOFConstrained(ics)) {
+      continue;
+    }
+    if (!nContCh[ics]) {
+      LOG(INFO) << "No contributors to constraint of " << getDOFName(ics) << " of " << GetName();
+      continue;
+    }
+    GlobalSolver::Constraint cs;
+    cs.sigma = mSigma[ics] > 0 ? mSigma[ics] : 0.;
+    for (int ich = 0; ich < nch; ich++) {
+      AlignableVolume* child = getChild(ich);
+      const float* jac = cstrArr + kNDOFGeom * kNDOFGeom * ich;
+      for (int ip = 0; ip < kNDOFGeom; ip++) {
+        float jv = jac[ics * kNDOFGeom + ip];
+        if (child->isFreeDOF(ip) && !isZeroAbs(jv) && child->getParErr(ip) >= 0) {
+          cs.parID.push_back(child->getFirstParGloID() + ip);
+          cs.coef.push_back(jv);
+        }
+      }
+    }
+    solver.addConstraint(cs);
+  }
+  delete[] cstrArr;
+}
+
 //______________________________________________________
 void GeometricalConstraint::checkConstraint() const
 {
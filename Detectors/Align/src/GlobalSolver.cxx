@@ -0,0 +1,746 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   GlobalSolver.cxx
+/// @brief  In-process solver of the global alignment problem
+
+#include "Align/GlobalSolver.h"
+#include "Framework/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <tuple>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace o2
+{
+namespace align
+{
+
+namespace
+{
+//_________________________________________________________
+bool choleskyDecompose(std::vector<double>& mat, int n)
+{
+  // in place Cholesky decomposition mat = L L^T of symmetric positive definite matrix, L is stored in the lower triangle
+  for (int j = 0; j < n; j++) {
+    double* rowJ = &mat[j * n];
+    double diag = rowJ[j];
+    for (int k = 0; k < j; k++) {
+      diag -= rowJ[k] * rowJ[k];
+    }
+    if (diag <= std::numeric_limits<double>::epsilon() * std::abs(rowJ[j]) || diag <= 0.) {
+      return false;
+    }
+    diag = std::sqrt(diag);
+    rowJ[j] = diag;
+    for (int i = j + 1; i < n; i++) {
+      double* rowI = &mat[i * n];
+      double sum = rowI[j];
+      for (int k = 0; k < j; k++) {
+        sum -= rowI[k] * rowJ[k];
+      }
+      rowI[j] = sum / diag;
+    }
+  }
+  return true;
+}
+
+//_________________________________________________________
+void choleskySolve(const std::vector<double>& mat, int n, double* vec)
+{
+  // solve L L^T x = vec in place
+  for (int i = 0; i < n; i++) {
+    const double* rowI = &mat[i * n];
+    double sum = vec[i];
+    for (int k = 0; k < i; k++) {
+      sum -= rowI[k] * vec[k];
+    }
+    vec[i] = sum / rowI[i];
+  }
+  for (int i = n; i--;) {
+    double sum = vec[i];
+    for (int k = i + 1; k < n; k++) {
+      sum -= mat[k * n + i] * vec[k];
+    }
+    vec[i] = sum / mat[i * n + i];
+  }
+}
+
+//_________________________________________________________
+int compressedIndex(const std::vector<int>& ids, int id)
+{
+  return std::lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+}
+} // namespace
+
+//_________________________________________________________
+void GlobalSolver::Accumulator::mille(int nLoc, const float* derLoc, int nGlo, const float* derGlo, const int* parID, float resid, float sigma)
+{
+  // add measurement to the current track, only non-0 derivatives are stored
+  if (sigma <= 0.) {
+    return;
+  }
+  Measurement meas{int(mLocID.size()), int(mGloID.size()), 0, 0, resid, 1. / (double(sigma) * sigma)};
+  for (int i = 0; i < nLoc; i++) {
+    if (derLoc[i] != 0.) {
+      mLocID.push_back(i);
+      mLocDer.push_back(derLoc[i]);
+      meas.nLoc++;
+    }
+  }
+  for (int i = 0; i < nGlo; i++) {
+    if (derGlo[i] != 0. && parID[i] >= 0) {
+      mGloID.push_back(parID[i]);
+      mGloDer.push_back(derGlo[i]);
+      meas.nGlo++;
+    }
+  }
+  mMeas.push_back(meas);
+}
+
+//_________________________________________________________
+void GlobalSolver::Accumulator::kill()
+{
+  // discard the current track
+  mMeas.clear();
+  mLocID.clear();
+  mLocDer.clear();
+  mGloID.clear();
+  mGloDer.clear();
+}
+
+//_________________________________________________________
+bool GlobalSolver::Accumulator::end()
+{
+  // Fit the local parameters of the current track and add its contribution to the global normal
+  // equations after the elimination of the local parameters:
+  // C += Cg - H G^-1 H^T, b += bg - H G^-1 bl
+  // with G, bl the local normal matrix and rhs, Cg, bg the global ones and H the mixed derivatives
+  //
+  // compress the local and global parameters this track depends on
+  mTrkLoc = mLocID;
+  std::sort(mTrkLoc.begin(), mTrkLoc.end());
+  mTrkLoc.erase(std::unique(mTrkLoc.begin(), mTrkLoc.end()), mTrkLoc.end());
+  mTrkGlo = mGloID;
+  std::sort(mTrkGlo.begin(), mTrkGlo.end());
+  mTrkGlo.erase(std::unique(mTrkGlo.begin(), mTrkGlo.end()), mTrkGlo.end());
+  const int nL = mTrkLoc.size(), nG = mTrkGlo.size(), ndf = int(mMeas.size()) - nL;
+  if (!nG || ndf < 1) {
+    if (nG) {
+      mNRejected++;
+    }
+    kill();
+    return false;
+  }
+  for (auto& id : mLocID) {
+    id = compressedIndex(mTrkLoc, id);
+  }
+  for (auto& id : mGloID) {
+    id = compressedIndex(mTrkGlo, id);
+  }
+  //
+  mLocMat.assign(nL * nL, 0.);
+  mLocRHS.assign(nL, 0.);
+  mGloMat.assign(nG * nG, 0.);
+  mGloRHS.assign(nG, 0.);
+  mCross.assign(nG * nL, 0.);
+  double chi2 = 0.;
+  for (const auto& meas : mMeas) {
+    const double wr = meas.weight * meas.resid;
+    chi2 += wr * meas.resid;
+    for (int a = meas.locFirst; a < meas.locFirst + meas.nLoc; a++) {
+      const double da = meas.weight * mLocDer[a];
+      double* row = &mLocMat[mLocID[a] * nL];
+      mLocRHS[mLocID[a]] += mLocDer[a] * wr;
+      for (int b = meas.locFirst; b < meas.locFirst + meas.nLoc; b++) {
+        row[mLocID[b]] += da * mLocDer[b];
+      }
+    }
+    for (int a = meas.gloFirst; a < meas.gloFirst + meas.nGlo; a++) {
+      const double da = meas.weight * mGloDer[a];
+      double* row = &mGloMat[mGloID[a] * nG];
+      double* rowCross = &mCross[mGloID[a] * nL];
+      mGloRHS[mGloID[a]] += mGloDer[a] * wr;
+      for (int b = meas.gloFirst; b < meas.gloFirst + meas.nGlo; b++) {
+        row[mGloID[b]] += da * mGloDer[b];
+      }
+      for (int b = meas.locFirst; b < meas.locFirst + meas.nLoc; b++) {
+        rowCross[mLocID[b]] += da * mLocDer[b];
+      }
+    }
+  }
+  //
+  if (!choleskyDecompose(mLocMat, nL)) {
+    mNRejected++;
+    kill();
+    return false;
+  }
+  // local solution and chi2 of the local fit
+  mWork = mLocRHS;
+  choleskySolve(mLocMat, nL, mWork.data());
+  for (int a = 0; a < nL; a++) {
+    chi2 -= mLocRHS[a] * mWork[a];
+  }
+  for (int a = 0; a < nG; a++) {
+    const double* rowCross = &mCross[a * nL];
+    double sum = 0.;
+    for (int k = 0; k < nL; k++) {
+      sum += rowCross[k] * mWork[k];
+    }
+    mGloRHS[a] -= sum;
+  }
+  // G^-1 H^T
+  mWork.resize(nG * nL);
+  std::copy(mCross.begin(), mCross.end(), mWork.begin());
+  for (int b = 0; b < nG; b++) {
+    choleskySolve(mLocMat, nL, &mWork[b * nL]);
+  }
+  for (int a = 0; a < nG; a++) {
+    const double* rowCross = &mCross[a * nL];
+    for (int b = a; b < nG; b++) {
+      const double* colInv = &mWork[b * nL];
+      double sum = 0.;
+      for (int k = 0; k < nL; k++) {
+        sum += rowCross[k] * colInv[k];
+      }
+      mGloMat[a * nG + b] -= sum;
+    }
+  }
+  //
+  // add to the normal equations
+  addToBlocks(mTrkGlo, mGloMat);
+  if (int(mRHS.size()) <= mTrkGlo.back()) {
+    mRHS.resize(mTrkGlo.back() + 1, 0.);
+    mEntries.resize(mTrkGlo.back() + 1, 0);
+  }
+  for (int a = 0; a < nG; a++) {
+    mRHS[mTrkGlo[a]] += mGloRHS[a];
+  }
+  for (auto id : mGloID) {
+    mEntries[mTrkGlo[id]]++;
+  }
+  mNTracks++;
+  mNDF += ndf;
+  mChi2 += std::max(chi2, 0.);
+  kill();
+  return true;
+}
+
+//_________________________________________________________
+void GlobalSolver::Accumulator::addToBlocks(const std::vector<int>& ids, const std::vector<double>& mat)
+{
+  // add upper triangle of symmetric matrix for sorted parameter IDs to the blocks, diagonal blocks are stored in full
+  const int n = ids.size();
+  uint64_t lastKey = std::numeric_limits<uint64_t>::max();
+  Block* blk = nullptr;
+  for (int a = 0; a < n; a++) {
+    const int bi = ids[a] / kBlockSize, ii = ids[a] % kBlockSize;
+    for (int b = a; b < n; b++) {
+      const int bj = ids[b] / kBlockSize, jj = ids[b] % kBlockSize;
+      const uint64_t key = (uint64_t(bi) << 32) | uint32_t(bj);
+      if (key != lastKey) {
+        blk = &mBlocks[key];
+        lastKey = key;
+      }
+      const double val = mat[a * n + b];
+      (*blk)[ii * kBlockSize + jj] += val;
+      if (bi == bj && ii != jj) {
+        (*blk)[jj * kBlockSize + ii] += val;
+      }
+    }
+  }
+}
+
+//_________________________________________________________
+bool GlobalSolver::Accumulator::addMilleRecord(const float* bufF, const int* bufI, int nWords, const std::function<int(int)>& label2ParID)
+{
+  // add track stored by Mille::end: for each measurement (resid,0), local derivatives (der,index+1),
+  // (sigma,0), global derivatives (der,label). The special data (0,0),(-n,0) + n words are skipped
+  kill();
+  int pos = 1; // 1st word is (0,0)
+  while (pos < nWords) {
+    if (bufI[pos] == 0 && bufF[pos] == 0.f && pos + 1 < nWords && bufI[pos + 1] == 0 && bufF[pos + 1] < 0.f) {
+      pos += 2 + int(-bufF[pos + 1]);
+      continue;
+    }
+    Measurement meas{int(mLocID.size()), int(mGloID.size()), 0, 0, bufF[pos++], 0.};
+    for (; pos < nWords && bufI[pos]; pos++) {
+      mLocID.push_back(bufI[pos] - 1);
+      mLocDer.push_back(bufF[pos]);
+      meas.nLoc++;
+    }
+    if (pos >= nWords) {
+      break; // malformed record
+    }
+    const double sigma = bufF[pos++];
+    for (; pos < nWords && bufI[pos]; pos++) {
+      int id = label2ParID(bufI[pos]);
+      if (id >= 0) {
+        mGloID.push_back(id);
+        mGloDer.push_back(bufF[pos]);
+        meas.nGlo++;
+      }
+    }
+    if (sigma > 0.) {
+      meas.weight = 1. / (sigma * sigma);
+      mMeas.push_back(meas);
+    }
+  }
+  return end();
+}
+
+//_________________________________________________________
+void GlobalSolver::Accumulator::merge(const Accumulator& other)
+{
+  // add normal equations of other accumulator
+  for (const auto& [key, blk] : other.mBlocks) {
+    auto& dest = mBlocks[key];
+    for (int i = 0; i < kBlockSize * kBlockSize; i++) {
+      dest[i] += blk[i];
+    }
+  }
+  if (mRHS.size() < other.mRHS.size()) {
+    mRHS.resize(other.mRHS.size(), 0.);
+    mEntries.resize(other.mRHS.size(), 0);
+  }
+  for (size_t i = 0; i < other.mRHS.size(); i++) {
+    mRHS[i] += other.mRHS[i];
+    mEntries[i] += other.mEntries[i];
+  }
+  mNTracks += other.mNTracks;
+  mNRejected += other.mNRejected;
+  mNDF += other.mNDF;
+  mChi2 += other.mChi2;
+}
+
+//_________________________________________________________
+void GlobalSolver::Accumulator::clear()
+{
+  kill();
+  mBlocks.clear();
+  mRHS.clear();
+  mEntries.clear();
+  mNTracks = mNRejected = mNDF = 0;
+  mChi2 = 0.;
+}
+
+//_________________________________________________________
+void GlobalSolver::setNPar(int n)
+{
+  mNPar = n;
+  mPreSigma.resize(n, 0.);
+  mInitial.resize(n, 0.);
+}
+
+//_________________________________________________________
+GlobalSolver::Accumulator& GlobalSolver::getAccumulator(int slot)
+{
+  if (slot >= int(mAccumulators.size())) {
+    mAccumulators.resize(slot + 1);
+  }
+  return mAccumulators[slot];
+}
+
+//_________________________________________________________
+long GlobalSolver::addMilleFile(const std::string& fileName, const std::function<int(int)>& label2ParID, int chunkSize)
+{
+  // read Mille binary records in chunks and accumulate them in parallel, each thread in its own accumulator
+  std::ifstream inp(fileName, std::ios::binary);
+  if (!inp.good()) {
+    LOG(ERROR) << "Failed to open Mille file " << fileName;
+    return -1;
+  }
+  getAccumulator(mNThreads - 1); // book all slots before the parallel processing
+  std::vector<std::vector<float>> recF(chunkSize);
+  std::vector<std::vector<int>> recI(chunkSize);
+  long nRec = 0, nAcc = 0;
+  bool eof = false;
+  while (!eof) {
+    int nRead = 0;
+    for (; nRead < chunkSize; nRead++) {
+      int nWords = 0;
+      if (!inp.read(reinterpret_cast<char*>(&nWords), sizeof(nWords))) {
+        eof = true;
+        break;
+      }
+      nWords /= 2;
+      recF[nRead].resize(nWords);
+      recI[nRead].resize(nWords);
+      inp.read(reinterpret_cast<char*>(recF[nRead].data()), nWords * sizeof(float));
+      inp.read(reinterpret_cast<char*>(recI[nRead].data()), nWords * sizeof(int));
+      if (!inp) {
+        LOG(ERROR) << "Truncated record " << nRec + nRead << " in " << fileName;
+        eof = true;
+        break;
+      }
+    }
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic, 16) reduction(+ : nAcc)
+    for (int ir = 0; ir < nRead; ir++) {
+#ifdef WITH_OPENMP
+      auto& acc = mAccumulators[omp_get_thread_num()];
+#else
+      auto& acc = mAccumulators[0];
+#endif
+      nAcc += acc.addMilleRecord(recF[ir].data(), recI[ir].data(), recF[ir].size(), label2ParID);
+    }
+    nRec += nRead;
+  }
+  LOG(INFO) << "Accepted " << nAcc << " of " << nRec << " tracks from " << fileName;
+  return nAcc;
+}
+
+//_________________________________________________________
+bool GlobalSolver::solve()
+{
+  // merge the accumulators, build the system including constraints and solve it
+  if (mAccumulators.empty()) {
+    LOG(ERROR) << "No data was accumulated";
+    return false;
+  }
+  auto& total = mAccumulators[0];
+  for (size_t i = 1; i < mAccumulators.size(); i++) {
+    total.merge(mAccumulators[i]);
+    mAccumulators[i].clear();
+  }
+  LOG(INFO) << "Global fit of " << mNPar << " parameters with " << total.getNTracks() << " tracks (" << total.getNRejected()
+            << " rejected), local fits chi2/ndf = " << (total.getNDF() ? total.getChi2() / total.getNDF() : 0.);
+  buildSystem();
+  std::vector<double> sol;
+  bool res = minres(mRHSFull, sol);
+  const int nPad = mNBlocks * kBlockSize;
+  mSolution.assign(sol.begin(), sol.begin() + mNPar);
+  for (int i = 0; i < mNPar; i++) {
+    mSolution[i] += mInitial[i];
+  }
+  mLagrange.assign(sol.begin() + nPad, sol.end());
+  LOG(INFO) << "MINRES " << (res ? "converged" : "did not converge") << " after " << mNIterDone << " iterations, relative residual "
+            << mRelResidual << ", " << mNCons << " constraints";
+  return res;
+}
+
+//_________________________________________________________
+void GlobalSolver::buildSystem()
+{
+  // Convert accumulated normal equations to block-sparse row format with both triangles stored, apply the
+  // presigmas and fixed parameters and add the constraints as extra rows for the corrections dp to the initial values p0:
+  //  | C   A^T | |dp|   |b - C p0|
+  //  | A   D   | |l | = |v - A p0|  with D = -sigma^2 of gaussian constraints, 0 for exact ones
+  const auto& total = mAccumulators[0];
+  mNBlocks = (mNPar + kBlockSize - 1) / kBlockSize;
+  const int nPad = mNBlocks * kBlockSize;
+  std::vector<char> fixed(nPad, 1);
+  int nFixed = 0;
+  for (int i = 0; i < mNPar; i++) {
+    int entries = i < int(total.mEntries.size()) ? total.mEntries[i] : 0;
+    fixed[i] = mPreSigma[i] < 0 || !entries || entries < mMinEntries;
+    nFixed += fixed[i];
+  }
+  //
+  // blocks sorted in row and column, (row, col, source, transposed)
+  std::vector<std::tuple<int, int, const Block*, bool>> blocks;
+  blocks.reserve(2 * total.mBlocks.size() + mNBlocks);
+  std::vector<char> hasDiag(mNBlocks, 0);
+  for (const auto& [key, blk] : total.mBlocks) {
+    int br = key >> 32, bc = key & 0xffffffff;
+    if (br >= mNBlocks || bc >= mNBlocks) {
+      continue;
+    }
+    blocks.emplace_back(br, bc, &blk, false);
+    if (br != bc) {
+      blocks.emplace_back(bc, br, &blk, true);
+    } else {
+      hasDiag[br] = 1;
+    }
+  }
+  for (int br = 0; br < mNBlocks; br++) {
+    if (!hasDiag[br]) {
+      blocks.emplace_back(br, br, nullptr, false);
+    }
+  }
+  std::sort(blocks.begin(), blocks.end(), [](const auto& a, const auto& b) { return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b)); });
+  const int nBlk = blocks.size();
+  mRowStart.assign(mNBlocks + 1, 0);
+  mBlockCol.resize(nBlk);
+  mBlockVal.resize(nBlk);
+  for (const auto& blk : blocks) {
+    mRowStart[std::get<0>(blk) + 1]++;
+  }
+  for (int br = 0; br < mNBlocks; br++) {
+    mRowStart[br + 1] += mRowStart[br];
+  }
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic, 64)
+  for (int ib = 0; ib < nBlk; ib++) {
+    const auto& [br, bc, src, transp] = blocks[ib];
+    Block& dest = mBlockVal[ib];
+    mBlockCol[ib] = bc;
+    for (int i = 0; i < kBlockSize; i++) {
+      for (int j = 0; j < kBlockSize; j++) {
+        const int row = br * kBlockSize + i, col = bc * kBlockSize + j;
+        double val = src ? (transp ? (*src)[j * kBlockSize + i] : (*src)[i * kBlockSize + j]) : 0.;
+        if (fixed[row] || fixed[col]) {
+          val = row == col ? 1. : 0.;
+        } else if (row == col && mPreSigma[row] > 0) {
+          val += 1. / (mPreSigma[row] * mPreSigma[row]);
+        }
+        dest[i * kBlockSize + j] = val;
+      }
+    }
+  }
+  //
+  // constraints on the free parameters
+  mConsStart.assign(1, 0);
+  mConsPar.clear();
+  mConsCoef.clear();
+  mConsDiag.clear();
+  std::vector<double> consValue;
+  for (const auto& cs : mConstraints) {
+    int nCoef = 0;
+    double value = cs.value;
+    for (size_t k = 0; k < cs.parID.size(); k++) {
+      int id = cs.parID[k];
+      if (id < 0 || id >= mNPar) {
+        continue;
+      }
+      value -= cs.coef[k] * mInitial[id];
+      if (!fixed[id] && cs.coef[k] != 0.) {
+        mConsPar.push_back(id);
+        mConsCoef.push_back(cs.coef[k]);
+        nCoef++;
+      }
+    }
+    if (nCoef) {
+      mConsStart.push_back(mConsPar.size());
+      mConsDiag.push_back(-cs.sigma * cs.sigma);
+      consValue.push_back(value);
+    }
+  }
+  mNCons = mConsDiag.size();
+  if (mNCons < int(mConstraints.size())) {
+    LOG(INFO) << mConstraints.size() - mNCons << " constraints without free parameters are ignored";
+  }
+  mParConsStart.assign(nPad + 1, 0);
+  for (auto id : mConsPar) {
+    mParConsStart[id + 1]++;
+  }
+  for (int i = 0; i < nPad; i++) {
+    mParConsStart[i + 1] += mParConsStart[i];
+  }
+  mParConsID.resize(mConsPar.size());
+  mParConsCoef.resize(mConsPar.size());
+  std::vector<int> fill(mParConsStart.begin(), mParConsStart.end() - 1);
+  for (int ic = 0; ic < mNCons; ic++) {
+    for (int k = mConsStart[ic]; k < mConsStart[ic + 1]; k++) {
+      int pos = fill[mConsPar[k]]++;
+      mParConsID[pos] = ic;
+      mParConsCoef[pos] = mConsCoef[k];
+    }
+  }
+  //
+  // right hand side and diagonal preconditioner
+  mRHSFull.assign(nPad + mNCons, 0.);
+  mPrecond.assign(nPad + mNCons, 1.);
+  for (int i = 0; i < mNPar; i++) {
+    if (!fixed[i] && i < int(total.mRHS.size())) {
+      mRHSFull[i] = total.mRHS[i];
+    }
+  }
+  if (std::any_of(mInitial.begin(), mInitial.end(), [](double v) { return v != 0.; })) {
+    // residuals evaluated at the initial values: subtract C p0 using the accumulated upper triangle blocks
+    std::vector<double> cp0(nPad, 0.);
+    for (const auto& [key, blk] : total.mBlocks) {
+      int br = key >> 32, bc = key & 0xffffffff;
+      if (br >= mNBlocks || bc >= mNBlocks) {
+        continue;
+      }
+      for (int i = 0; i < kBlockSize; i++) {
+        const int row = br * kBlockSize + i;
+        for (int j = 0; j < kBlockSize; j++) {
+          const int col = bc * kBlockSize + j;
+          const double val = blk[i * kBlockSize + j];
+          cp0[row] += val * (col < mNPar ? mInitial[col] : 0.);
+          if (br != bc) {
+            cp0[col] += val * (row < mNPar ? mInitial[row] : 0.);
+          }
+        }
+      }
+    }
+    for (int i = 0; i < mNPar; i++) {
+      if (!fixed[i]) {
+        mRHSFull[i] -= cp0[i];
+      }
+    }
+  }
+  for (int br = 0; br < mNBlocks; br++) {
+    for (int ib = mRowStart[br]; ib < mRowStart[br + 1]; ib++) {
+      if (mBlockCol[ib] == br) {
+        for (int i = 0; i < kBlockSize; i++) {
+          double diag = mBlockVal[ib][i * kBlockSize + i];
+          mPrecond[br * kBlockSize + i] = diag > 0. ? 1. / diag : 1.;
+        }
+      }
+    }
+  }
+  for (int ic = 0; ic < mNCons; ic++) {
+    double diag = -mConsDiag[ic];
+    for (int k = mConsStart[ic]; k < mConsStart[ic + 1]; k++) {
+      diag += mConsCoef[k] * mConsCoef[k] * mPrecond[mConsPar[k]];
+    }
+    mRHSFull[nPad + ic] = consValue[ic];
+    mPrecond[nPad + ic] = diag > 0. ? 1. / diag : 1.;
+  }
+  LOG(INFO) << "Built system with " << nBlk << " blocks of " << kBlockSize << "x" << kBlockSize << " for " << mNPar - nFixed
+            << " free parameters (" << nFixed << " fixed) and " << mNCons << " constraints";
+}
+
+//_________________________________________________________
+void GlobalSolver::multiply(const std::vector<double>& x, std::vector<double>& y) const
+{
+  // y = K x for the full system
+  const int nPad = mNBlocks * kBlockSize;
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic, 64)
+  for (int br = 0; br < mNBlocks; br++) {
+    double acc[kBlockSize] = {0.};
+    for (int ib = mRowStart[br]; ib < mRowStart[br + 1]; ib++) {
+      const Block& blk = mBlockVal[ib];
+      const double* xc = &x[mBlockCol[ib] * kBlockSize];
+      for (int i = 0; i < kBlockSize; i++) {
+        for (int j = 0; j < kBlockSize; j++) {
+          acc[i] += blk[i * kBlockSize + j] * xc[j];
+        }
+      }
+    }
+    for (int i = 0; i < kBlockSize; i++) {
+      const int row = br * kBlockSize + i;
+      for (int k = mParConsStart[row]; k < mParConsStart[row + 1]; k++) {
+        acc[i] += mParConsCoef[k] * x[nPad + mParConsID[k]];
+      }
+      y[row] = acc[i];
+    }
+  }
+#pragma omp parallel for num_threads(mNThreads) schedule(dynamic, 64)
+  for (int ic = 0; ic < mNCons; ic++) {
+    double sum = mConsDiag[ic] * x[nPad + ic];
+    for (int k = mConsStart[ic]; k < mConsStart[ic + 1]; k++) {
+      sum += mConsCoef[k] * x[mConsPar[k]];
+    }
+    y[nPad + ic] = sum;
+  }
+}
+
+//_________________________________________________________
+double GlobalSolver::dot(const std::vector<double>& a, const std::vector<double>& b) const
+{
+  const int n = a.size();
+  double sum = 0.;
+#pragma omp parallel for num_threads(mNThreads) reduction(+ : sum)
+  for (int i = 0; i < n; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+//_________________________________________________________
+bool GlobalSolver::minres(const std::vector<double>& rhs, std::vector<double>& x)
+{
+  // preconditioned MINRES (Paige, Saunders) for the symmetric indefinite system, starting from x = 0
+  const int n = rhs.size();
+  x.assign(n, 0.);
+  std::vector<double> r1(rhs), r2(rhs), y(n), v(n), w(n, 0.), w2(n, 0.);
+  for (int i = 0; i < n; i++) {
+    y[i] = mPrecond[i] * r1[i];
+  }
+  mNIterDone = 0;
+  mRelResidual = 0.;
+  double beta1 = dot(r1, y);
+  if (beta1 <= 0.) {
+    return beta1 == 0.; // nothing to solve
+  }
+  beta1 = std::sqrt(beta1);
+  double oldb = 0., beta = beta1, dbar = 0., epsln = 0., phibar = beta1, cs = -1., sn = 0.;
+  for (int itn = 1; itn <= mMaxIter; itn++) {
+    mNIterDone = itn;
+    const double s = 1. / beta;
+#pragma omp parallel for num_threads(mNThreads)
+    for (int i = 0; i < n; i++) {
+      v[i] = s * y[i];
+    }
+    multiply(v, y);
+    if (itn > 1) {
+      const double f = beta / oldb;
+#pragma omp parallel for num_threads(mNThreads)
+      for (int i = 0; i < n; i++) {
+        y[i] -= f * r1[i];
+      }
+    }
+    const double alfa = dot(v, y);
+    const double f = alfa / beta;
+#pragma omp parallel for num_threads(mNThreads)
+    for (int i = 0; i < n; i++) {
+      y[i] -= f * r2[i];
+      r1[i] = r2[i];
+      r2[i] = y[i];
+      y[i] = mPrecond[i] * r2[i];
+    }
+    oldb = beta;
+    beta = dot(r2, y);
+    if (beta < 0.) {
+      LOG(ERROR) << "MINRES: preconditioner is not positive definite";
+      return false;
+    }
+    beta = std::sqrt(beta);
+    // plane rotation
+    const double oldeps = epsln;
+    const double delta = cs * dbar + sn * alfa;
+    const double gbar = sn * dbar - cs * alfa;
+    epsln = sn * beta;
+    dbar = -cs * beta;
+    const double gamma = std::max(std::hypot(gbar, beta), std::numeric_limits<double>::epsilon());
+    cs = gbar / gamma;
+    sn = beta / gamma;
+    const double phi = cs * phibar;
+    phibar *= sn;
+    // update solution
+    const double denom = 1. / gamma;
+#pragma omp parallel for num_threads(mNThreads)
+    for (int i = 0; i < n; i++) {
+      const double w1 = w2[i];
+      w2[i] = w[i];
+      w[i] = (v[i] - oldeps * w1 - delta * w2[i]) * denom;
+      x[i] += phi * w[i];
+    }
+    mRelResidual = phibar / beta1;
+    if (mRelResidual < mTolerance || beta == 0.) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//_________________________________________________________
+void GlobalSolver::reset()
+{
+  // clear accumulated data and results
+  for (auto& acc : mAccumulators) {
+    acc.clear();
+  }
+  mSolution.clear();
+  mLagrange.clear();
+  mNIterDone = 0;
+  mRelResidual = 0.;
+}
+
+} // namespace align
+} // namespace o2
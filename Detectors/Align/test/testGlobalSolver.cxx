@@ -0,0 +1,386 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test GlobalSolver
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Align/GlobalSolver.h"
+#include "Align/Mille.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace o2::align;
+
+// Toy telescope: straight tracks y = a + b * x (2 local parameters) measured in NLayers layers.
+// Each layer has an offset (derivative 1) and a tilt (derivative z, the coordinate of the track along the layer)
+// as global parameters. The offsets are determined by the tracks up to a global shift and rotation.
+constexpr int NLayers = 12;
+constexpr int NPar = 2 * NLayers; // spans several blocks of the solver
+constexpr int NTracks = 300;
+constexpr int LabelOffset = 100; // Mille labels must be positive
+constexpr double Tolerance = 1e-6;
+
+struct Hit {
+  int layer;
+  float z, y, sigma;
+};
+using Track = std::vector<Hit>;
+
+float getLayerX(int layer) { return 10.f + 5.f * layer; }
+
+std::vector<Track> generateTracks()
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> uni(-1.f, 1.f);
+  std::normal_distribution<float> gaus(0.f, 1.f);
+  std::vector<double> truth(NPar);
+  for (int l = 0; l < NLayers; l++) {
+    truth[2 * l] = 0.1 * uni(rng);
+    truth[2 * l + 1] = 0.01 * uni(rng);
+  }
+  std::vector<Track> tracks(NTracks);
+  for (auto& trc : tracks) {
+    float a = uni(rng), b = 0.1f * uni(rng);
+    for (int l = 0; l < NLayers; l++) {
+      if (trc.size() > 3 && rng() % 5 == 0) { // some missing hits
+        continue;
+      }
+      float sigma = 0.005f * (1 + l % 3), z = 5.f * uni(rng);
+      float y = a + b * getLayerX(l) + truth[2 * l] + truth[2 * l + 1] * z + sigma * gaus(rng);
+      trc.push_back(Hit{l, z, y, sigma});
+    }
+  }
+  // track without degree of freedom, must be rejected
+  tracks.push_back(Track{Hit{0, 1.f, 0.5f, 0.005f}, Hit{5, -1.f, 0.2f, 0.005f}});
+  return tracks;
+}
+
+const std::vector<Track>& getTracks()
+{
+  static const auto tracks = generateTracks();
+  return tracks;
+}
+
+bool isRejected(const Track& trc) { return trc.size() <= 2; }
+
+void feedTrack(GlobalSolver::Accumulator& acc, const Track& trc)
+{
+  for (const auto& hit : trc) {
+    float derLoc[2] = {1.f, getLayerX(hit.layer)};
+    float derGlo[2] = {1.f, hit.z};
+    int parID[2] = {2 * hit.layer, 2 * hit.layer + 1};
+    acc.mille(2, derLoc, 2, derGlo, parID, hit.y, hit.sigma);
+  }
+  acc.end();
+}
+
+// pede-like settings of the problem
+struct Setup {
+  std::vector<double> preSigma = std::vector<double>(NPar, 0.);
+  std::vector<double> initial = std::vector<double>(NPar, 0.);
+  std::vector<GlobalSolver::Constraint> constraints{};
+};
+
+// the constraints on the global shift and rotation of the offsets
+void addOffsetConstraints(Setup& setup, double sigmaShift, double sigmaRot)
+{
+  GlobalSolver::Constraint shift, rot;
+  for (int l = 0; l < NLayers; l++) {
+    shift.parID.push_back(2 * l);
+    shift.coef.push_back(1.);
+    rot.parID.push_back(2 * l);
+    rot.coef.push_back(getLayerX(l));
+  }
+  shift.sigma = sigmaShift;
+  rot.sigma = sigmaRot;
+  rot.value = 0.05;
+  setup.constraints.push_back(shift);
+  setup.constraints.push_back(rot);
+}
+
+void configure(GlobalSolver& solver, const Setup& setup)
+{
+  solver.setTolerance(1e-14);
+  for (int i = 0; i < NPar; i++) {
+    solver.setPreSigma(i, setup.preSigma[i]);
+    solver.setInitialValue(i, setup.initial[i]);
+  }
+  for (const auto& cs : setup.constraints) {
+    solver.addConstraint(cs);
+  }
+}
+
+// Reference: dense least squares fit of all local and global parameters together, with the gaussian constraints
+// and priors as pseudo-measurements and the exact constraints via Lagrange multipliers, solved by Gauss elimination
+std::vector<double> solveDense(const Setup& setup)
+{
+  const auto& tracks = getTracks();
+  int nTrk = 0;
+  for (const auto& trc : tracks) {
+    nTrk += !isRejected(trc);
+  }
+  int nExact = 0;
+  for (const auto& cs : setup.constraints) {
+    nExact += cs.sigma == 0.;
+  }
+  const int nLoc = 2 * nTrk, n = nLoc + NPar + nExact;
+  std::vector<std::vector<double>> mat(n, std::vector<double>(n + 1, 0.)); // last column is the rhs
+  auto addMeasurement = [&mat, n](const std::vector<std::pair<int, double>>& der, double val, double weight) {
+    for (const auto& [i, di] : der) {
+      for (const auto& [j, dj] : der) {
+        mat[i][j] += weight * di * dj;
+      }
+      mat[i][n] += weight * di * val;
+    }
+  };
+  int itr = 0;
+  for (const auto& trc : tracks) {
+    if (isRejected(trc)) {
+      continue;
+    }
+    for (const auto& hit : trc) {
+      addMeasurement({{2 * itr, 1.}, {2 * itr + 1, getLayerX(hit.layer)}, {nLoc + 2 * hit.layer, 1.}, {nLoc + 2 * hit.layer + 1, hit.z}},
+                     hit.y, 1. / (double(hit.sigma) * hit.sigma));
+    }
+    itr++;
+  }
+  for (int i = 0; i < NPar; i++) {
+    if (setup.preSigma[i] > 0) {
+      addMeasurement({{nLoc + i, 1.}}, setup.initial[i], 1. / (setup.preSigma[i] * setup.preSigma[i]));
+    }
+  }
+  int iExact = nLoc + NPar;
+  for (const auto& cs : setup.constraints) {
+    std::vector<std::pair<int, double>> der;
+    for (size_t k = 0; k < cs.parID.size(); k++) {
+      der.emplace_back(nLoc + cs.parID[k], cs.coef[k]);
+    }
+    if (cs.sigma > 0) {
+      addMeasurement(der, cs.value, 1. / (cs.sigma * cs.sigma));
+    } else {
+      for (const auto& [i, di] : der) {
+        mat[iExact][i] = mat[i][iExact] = di;
+      }
+      mat[iExact++][n] = cs.value;
+    }
+  }
+  for (int i = 0; i < NPar; i++) { // fixed parameters keep their initial value
+    if (setup.preSigma[i] < 0) {
+      const int ip = nLoc + i;
+      for (int j = 0; j < n; j++) {
+        mat[j][n] -= mat[j][ip] * setup.initial[i];
+        mat[j][ip] = mat[ip][j] = 0.;
+      }
+      mat[ip][ip] = 1.;
+      mat[ip][n] = setup.initial[i];
+    }
+  }
+  // Gauss elimination with partial pivoting, the system is indefinite with exact constraints
+  for (int k = 0; k < n; k++) {
+    int piv = k;
+    for (int i = k + 1; i < n; i++) {
+      if (std::abs(mat[i][k]) > std::abs(mat[piv][k])) {
+        piv = i;
+      }
+    }
+    std::swap(mat[k], mat[piv]);
+    for (int i = k + 1; i < n; i++) {
+      const double f = mat[i][k] / mat[k][k];
+      if (f != 0.) {
+        for (int j = k; j <= n; j++) {
+          mat[i][j] -= f * mat[k][j];
+        }
+      }
+    }
+  }
+  std::vector<double> sol(n);
+  for (int i = n; i--;) {
+    double sum = mat[i][n];
+    for (int j = i + 1; j < n; j++) {
+      sum -= mat[i][j] * sol[j];
+    }
+    sol[i] = sum / mat[i][i];
+  }
+  return std::vector<double>(sol.begin() + nLoc, sol.begin() + nLoc + NPar);
+}
+
+void compareSolutions(const std::vector<double>& sol, const std::vector<double>& ref, double tolerance = Tolerance)
+{
+  BOOST_REQUIRE_EQUAL(sol.size(), ref.size());
+  for (size_t i = 0; i < ref.size(); i++) {
+    BOOST_TEST_CONTEXT("parameter " << i)
+    {
+      BOOST_CHECK_SMALL(sol[i] - ref[i], tolerance);
+    }
+  }
+}
+
+// solve with all the tracks fed to a single accumulator
+std::vector<double> solveSingle(const Setup& setup)
+{
+  GlobalSolver solver(NPar);
+  configure(solver, setup);
+  auto& acc = solver.getAccumulator();
+  for (const auto& trc : getTracks()) {
+    feedTrack(acc, trc);
+  }
+  BOOST_CHECK_EQUAL(acc.getNTracks(), NTracks);
+  BOOST_CHECK_EQUAL(acc.getNRejected(), 1);
+  BOOST_CHECK(solver.solve());
+  return solver.getSolution();
+}
+
+std::vector<Setup> getSetups()
+{
+  std::vector<Setup> setups;
+  // 1) no constraints: the offsets of the first and last layers are fixed
+  Setup fixedEnds;
+  fixedEnds.preSigma[0] = fixedEnds.preSigma[NPar - 2] = -1.;
+  setups.push_back(fixedEnds);
+  // 2) exact constraints
+  Setup exact;
+  addOffsetConstraints(exact, 0., 0.);
+  setups.push_back(exact);
+  // 3) gaussian constraints and priors on the tilts
+  Setup gaussian;
+  addOffsetConstraints(gaussian, 1e-3, 1e-2);
+  for (int l = 0; l < NLayers; l++) {
+    gaussian.preSigma[2 * l + 1] = 2e-3;
+  }
+  setups.push_back(gaussian);
+  // 4) exact constraints, a fixed parameter and priors with non-0 initial values
+  Setup initial = exact;
+  for (int i = 0; i < NPar; i++) {
+    initial.initial[i] = 0.01 * ((i % 5) - 2);
+  }
+  initial.preSigma[3] = -1.;
+  initial.preSigma[5] = 1e-3;
+  initial.preSigma[NPar - 1] = 1e-3;
+  setups.push_back(initial);
+  // 5) fixed ends and gaussian constraint including a fixed parameter, with non-0 initial values
+  Setup fixedInitial = fixedEnds;
+  addOffsetConstraints(fixedInitial, 1e-3, 1e-2);
+  for (int i = 0; i < NPar; i++) {
+    fixedInitial.initial[i] = 0.02 * ((i % 3) - 1);
+  }
+  setups.push_back(fixedInitial);
+  return setups;
+}
+
+BOOST_AUTO_TEST_CASE(GlobalSolver_dense)
+{
+  const auto setups = getSetups();
+  for (size_t is = 0; is < setups.size(); is++) {
+    BOOST_TEST_CONTEXT("setup " << is)
+    {
+      const auto sol = solveSingle(setups[is]);
+      compareSolutions(sol, solveDense(setups[is]));
+      for (int i = 0; i < NPar; i++) {
+        if (setups[is].preSigma[i] < 0) {
+          BOOST_CHECK_EQUAL(sol[i], setups[is].initial[i]);
+        }
+      }
+    }
+  }
+}
+
+// the tracks written to a Mille file and read back give the same solution as the tracks fed directly
+BOOST_AUTO_TEST_CASE(GlobalSolver_milleFile)
+{
+  const std::string fileName = "testGlobalSolver.mille";
+  {
+    Mille mille(fileName.c_str());
+    int itr = 0;
+    for (const auto& trc : getTracks()) {
+      if (itr++ % 7 == 0) { // special data must be skipped
+        float specF[2] = {1.5f, -2.f};
+        int specI[2] = {3, 4};
+        mille.special(2, specF, specI);
+      }
+      for (const auto& hit : trc) {
+        float derLoc[2] = {1.f, getLayerX(hit.layer)};
+        float derGlo[2] = {1.f, hit.z};
+        int labels[2] = {LabelOffset + 2 * hit.layer, LabelOffset + 2 * hit.layer + 1};
+        mille.mille(2, derLoc, 2, derGlo, labels, hit.y, hit.sigma);
+      }
+      mille.end();
+    }
+  }
+  const auto setups = getSetups();
+  for (int nThreads : {1, 4}) {
+    for (size_t is = 0; is < setups.size(); is++) {
+      BOOST_TEST_CONTEXT("threads " << nThreads << " setup " << is)
+      {
+        GlobalSolver solver(NPar);
+        solver.setNThreads(nThreads);
+        configure(solver, setups[is]);
+        // small chunks to read the file in several passes
+        BOOST_CHECK_EQUAL(solver.addMilleFile(fileName, [](int lab) { return lab - LabelOffset; }, 64), NTracks);
+        BOOST_CHECK(solver.solve());
+        compareSolutions(solver.getSolution(), solveSingle(setups[is]), 1e-9);
+      }
+    }
+  }
+  std::remove(fileName.c_str());
+  GlobalSolver solver(NPar);
+  BOOST_CHECK_EQUAL(solver.addMilleFile("nonExisting.mille", [](int lab) { return lab - LabelOffset; }), -1);
+}
+
+// the accumulators filled in parallel and merged give the same normal equations and solution as a single one
+BOOST_AUTO_TEST_CASE(GlobalSolver_merge)
+{
+  constexpr int NThreads = 4;
+  const auto setups = getSetups();
+  const auto& tracks = getTracks();
+  for (size_t is = 0; is < setups.size(); is++) {
+    BOOST_TEST_CONTEXT("setup " << is)
+    {
+      GlobalSolver solver(NPar);
+      solver.setNThreads(NThreads);
+      configure(solver, setups[is]);
+      for (int ith = 0; ith < NThreads; ith++) {
+        solver.getAccumulator(ith);
+      }
+      std::vector<std::thread> threads;
+      for (int ith = 0; ith < NThreads; ith++) {
+        threads.emplace_back([&solver, &tracks, ith]() {
+          auto& acc = solver.getAccumulator(ith);
+          for (size_t itr = ith; itr < tracks.size(); itr += NThreads) {
+            feedTrack(acc, tracks[itr]);
+          }
+        });
+      }
+      for (auto& th : threads) {
+        th.join();
+      }
+      BOOST_CHECK_EQUAL(solver.getNAccumulators(), NThreads);
+      BOOST_CHECK(solver.solve());
+      const auto& merged = solver.getAccumulator(0);
+      BOOST_CHECK_EQUAL(merged.getNTracks(), NTracks);
+      BOOST_CHECK_EQUAL(merged.getNRejected(), 1);
+
+      GlobalSolver single(NPar);
+      auto& acc = single.getAccumulator();
+      for (const auto& trc : tracks) {
+        feedTrack(acc, trc);
+      }
+      BOOST_CHECK_EQUAL(merged.getNDF(), acc.getNDF());
+      BOOST_CHECK_CLOSE(merged.getChi2(), acc.getChi2(), 1e-9);
+      BOOST_CHECK(merged.getEntries() == acc.getEntries());
+      compareSolutions(solver.getSolution(), solveSingle(setups[is]), 1e-9);
+    }
+  }
+}
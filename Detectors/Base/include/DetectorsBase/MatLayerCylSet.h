@@ -77,9 +77,19 @@ class MatLayerCylSet : public o2::gpu::FlatObject
 
   void dumpToTree(const std::string outName = "matbudTree.root") const;
   void writeToFile(std::string outFName = "matbud.root", std::string name = "MatBud");
+  /// load the LUT from a ROOT file or, if inpFName is in the flat format, map it with mapFromFlatFile
   static MatLayerCylSet* loadFromFile(std::string inpFName = "matbud.root", std::string name = "MatBud");
   void flatten();
 
+  /// store the flat buffer in a versioned binary file which can be mapped by mapFromFlatFile
+  bool writeToFlatFile(std::string outFName = "matbud.bin") const;
+  /// map read-only a file produced by writeToFlatFile: the cells are never copied, so that all
+  /// the processes using the same file share a single copy of them in the page cache.
+  /// The mapping stays valid until the end of the process.
+  static MatLayerCylSet* mapFromFlatFile(std::string inpFName = "matbud.bin");
+  /// check if the file was produced by writeToFlatFile
+  static bool isFlatFile(const std::string& inpFName);
+
 #endif // !GPUCA_ALIGPUCODE
 
 #ifndef GPUCA_ALIGPUCODE // this part is unvisible on GPU version
@@ -88,6 +98,11 @@ class MatLayerCylSet : public o2::gpu::FlatObject
     // get material budget traversed on the line between point0 and point1
     return getMatBudget(point0.X(), point0.Y(), point0.Z(), point1.X(), point1.Y(), point1.Z());
   }
+
+  /// material budget of n segments, from points0[i] to points1[i], stored in budgets[i].
+  /// Segments are processed in the order of the layers and phi slices they cross, so that
+  /// consecutive lookups hit the same cells.
+  void getMatBudget(const math_utils::Point3D<float>* points0, const math_utils::Point3D<float>* points1, MatBudget* budgets, int n) const;
 #endif // !GPUCA_ALIGPUCODE
   GPUd() MatBudget getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const;
 
@@ -113,6 +128,10 @@ class MatLayerCylSet : public o2::gpu::FlatObject
   static constexpr size_t getBufferAlignmentBytes() { return 8; }
 #endif // !GPUCA_GPUCODE
 
+ private:
+  // accumulate the material budget along the ray crossing the layers lmin to lmax
+  GPUd() MatBudget accumulateMatBudget(Ray& ray, short lmin, short lmax) const;
+
   ClassDefNV(MatLayerCylSet, 1);
 };
 
@@ -93,6 +93,35 @@ class PropagatorImpl
     return bzOnly ? propagateToX(track, x, getNominalBz(), maxSnp, maxStep, matCorr, tofInfo, signCorr) : PropagateToXBxByBz(track, x, maxSnp, maxStep, matCorr, tofInfo, signCorr);
   }
 
+#ifndef GPUCA_GPUCODE
+  /// Batched propagation of ntracks tracks to the plane X=x of their own frames (or to X=x[i] for the
+  /// versions taking an array of targets), as with propagateTo for each track. The tracks are advanced in
+  /// lockstep, so that at every step the field and the material of all the tracks still on the way are
+  /// obtained in a single batched query.
+  /// status[i] (if provided) tells if the track i was propagated, a failed track is left at the point
+  /// where the failure occured. tofInfo, if provided, must have ntracks entries.
+  /// @return number of successfully propagated tracks
+  int propagateBatchToX(TrackParCov_t* tracks, int ntracks, value_type x, bool bzOnly = false, value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP,
+                        MatCorrType matCorr = MatCorrType::USEMatCorrLUT, bool* status = nullptr, track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
+
+  int propagateBatchToX(TrackPar_t* tracks, int ntracks, value_type x, bool bzOnly = false, value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP,
+                        MatCorrType matCorr = MatCorrType::USEMatCorrLUT, bool* status = nullptr, track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
+
+  int propagateBatchToX(TrackParCov_t* tracks, int ntracks, const value_type* x, bool bzOnly = false, value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP,
+                        MatCorrType matCorr = MatCorrType::USEMatCorrLUT, bool* status = nullptr, track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
+
+  int propagateBatchToX(TrackPar_t* tracks, int ntracks, const value_type* x, bool bzOnly = false, value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP,
+                        MatCorrType matCorr = MatCorrType::USEMatCorrLUT, bool* status = nullptr, track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
+
+  /// Batched propagation of ntracks tracks, in their own frames, to the X at which they cross the lab. radius r
+  /// (see TrackParametrization::getXatLabR, evaluated with the nominal field). Tracks not reaching r are failed.
+  int propagateBatchToR(TrackParCov_t* tracks, int ntracks, value_type r, bool bzOnly = false, value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP,
+                        MatCorrType matCorr = MatCorrType::USEMatCorrLUT, bool* status = nullptr, track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
+
+  int propagateBatchToR(TrackPar_t* tracks, int ntracks, value_type r, bool bzOnly = false, value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP,
+                        MatCorrType matCorr = MatCorrType::USEMatCorrLUT, bool* status = nullptr, track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
+#endif
+
   GPUd() bool propagateToDCA(const o2::dataformats::VertexBase& vtx, o2::track::TrackParametrizationWithError<value_type>& track, value_type bZ,
                              value_type maxStep = MAX_STEP, MatCorrType matCorr = MatCorrType::USEMatCorrLUT,
                              o2::dataformats::DCA* dcaInfo = nullptr, track::TrackLTIntegral* tofInfo = nullptr,
@@ -142,10 +171,22 @@ class PropagatorImpl
 
   GPUd() MatBudget getMatBudget(MatCorrType corrType, const o2::math_utils::Point3D<value_type>& p0, const o2::math_utils::Point3D<value_type>& p1) const;
 
+#ifndef GPUCA_GPUCODE
+  /// batched material query for n segments p0[i]:p1[i]
+  void getMatBudget(MatCorrType corrType, const o2::math_utils::Point3D<value_type>* p0, const o2::math_utils::Point3D<value_type>* p1, MatBudget* budgets, int n) const;
+#endif
+
   GPUd() void getFieldXYZ(const math_utils::Point3D<float> xyz, float* bxyz) const;
 
   GPUd() void getFieldXYZ(const math_utils::Point3D<double> xyz, double* bxyz) const;
 
+#ifndef GPUCA_GPUCODE
+  /// batched field query for npoints points, bxyz is filled with 3 components per point
+  void getFieldXYZ(int npoints, const math_utils::Point3D<float>* xyz, float* bxyz) const;
+
+  void getFieldXYZ(int npoints, const math_utils::Point3D<double>* xyz, double* bxyz) const;
+#endif
+
  private:
 #ifndef GPUCA_GPUCODE
   PropagatorImpl(bool uninitialized = false);
@@ -154,6 +195,17 @@ class PropagatorImpl
 
   template <typename T>
   GPUd() void getFieldXYZImpl(const math_utils::Point3D<T> xyz, T* bxyz) const;
+#ifndef GPUCA_GPUCODE
+  template <typename T>
+  void getFieldXYZBatchImpl(int npoints, const math_utils::Point3D<T>* xyz, T* bxyz) const;
+
+  template <typename track_T>
+  int propagateBatchImpl(track_T* tracks, int ntracks, const value_type* xToGo, value_type x, bool bzOnly, value_type maxSnp, value_type maxStep,
+                         MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const;
+  template <typename track_T>
+  int propagateBatchToRImpl(track_T* tracks, int ntracks, value_type r, bool bzOnly, value_type maxSnp, value_type maxStep,
+                            MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const;
+#endif
 
   const o2::field::MagFieldFast* mField = nullptr; ///< External fast field (barrel only for the moment)
   value_type mBz = 0;                              // nominal field
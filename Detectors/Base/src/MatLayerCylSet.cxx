@@ -20,6 +20,14 @@
 #include "GPUCommonLogger.h"
 #include <TFile.h>
 #include "CommonUtils/TreeStreamRedirector.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 //#define _DBG_LOC_ // for local debugging only
 
 #endif // !GPUCA_ALIGPUCODE
@@ -175,6 +183,9 @@ void MatLayerCylSet::writeToFile(std::string outFName, std::string name)
 //________________________________________________________________________________
 MatLayerCylSet* MatLayerCylSet::loadFromFile(std::string inpFName, std::string name)
 {
+  if (isFlatFile(inpFName)) {
+    return mapFromFlatFile(inpFName);
+  }
   if (name.empty()) {
     name = "MatBud";
   }
@@ -186,11 +197,155 @@ MatLayerCylSet* MatLayerCylSet::loadFromFile(std::string inpFName, std::string n
   MatLayerCylSet* mb = reinterpret_cast<MatLayerCylSet*>(inpf.GetObjectChecked(name.data(), Class()));
   if (!mb) {
     LOG(ERROR) << "Failed to load " << name << " from " << inpFName;
+    return nullptr;
   }
   mb->fixPointers();
   return mb;
 }
 
+namespace
+{
+/// Header of the flat LUT file. It is followed, at bufferOffset, by the flat buffer as it was in memory.
+struct MatLUTFlatHeader {
+  static constexpr char Magic[8] = {'O', '2', 'M', 'A', 'T', 'L', 'U', 'T'};
+  static constexpr uint32_t Version = 1;
+  static constexpr uint64_t BufferAlignment = 4096; // page aligned, so that the buffer can be mapped
+
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint32_t layoutSize; // sizes of the classes stored in the buffer, to reject incompatible layouts
+  uint32_t layerSize;
+  uint32_t cellSize;
+  uint32_t reserved;
+  uint64_t bufferOffset;
+  uint64_t bufferSize;
+  uint64_t bufferBase; // address of the buffer when it was written, to relocate its pointers
+};
+} // namespace
+
+//________________________________________________________________________________
+bool MatLayerCylSet::writeToFlatFile(std::string outFName) const
+{
+  /// store the flat buffer with a header describing it
+  if (mConstructionMask != Constructed) {
+    LOG(ERROR) << "Only a flattened LUT can be stored in the flat format";
+    return false;
+  }
+  MatLUTFlatHeader header{};
+  memcpy(header.magic, MatLUTFlatHeader::Magic, sizeof(header.magic));
+  header.version = MatLUTFlatHeader::Version;
+  header.headerSize = sizeof(MatLUTFlatHeader);
+  header.layoutSize = sizeof(MatLayerCylSetLayout);
+  header.layerSize = sizeof(MatLayerCyl);
+  header.cellSize = sizeof(MatCell);
+  header.bufferOffset = alignSize(sizeof(MatLUTFlatHeader), MatLUTFlatHeader::BufferAlignment);
+  header.bufferSize = getFlatBufferSize();
+  header.bufferBase = reinterpret_cast<uint64_t>(mFlatBufferPtr);
+
+  std::ofstream outf(outFName, std::ios::binary | std::ios::trunc);
+  if (!outf.is_open()) {
+    LOG(ERROR) << "Failed to open output file " << outFName;
+    return false;
+  }
+  std::vector<char> padding(header.bufferOffset - sizeof(MatLUTFlatHeader), 0);
+  outf.write(reinterpret_cast<const char*>(&header), sizeof(MatLUTFlatHeader));
+  outf.write(padding.data(), padding.size());
+  outf.write(mFlatBufferPtr, header.bufferSize);
+  if (!outf.good()) {
+    LOG(ERROR) << "Failed to write " << outFName;
+    return false;
+  }
+  return true;
+}
+
+//________________________________________________________________________________
+bool MatLayerCylSet::isFlatFile(const std::string& inpFName)
+{
+  char magic[sizeof(MatLUTFlatHeader::Magic)] = {0};
+  std::ifstream inpf(inpFName, std::ios::binary);
+  return inpf.read(magic, sizeof(magic)) && memcmp(magic, MatLUTFlatHeader::Magic, sizeof(magic)) == 0;
+}
+
+//________________________________________________________________________________
+MatLayerCylSet* MatLayerCylSet::mapFromFlatFile(std::string inpFName)
+{
+  int fd = open(inpFName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Failed to open input file " << inpFName;
+    return nullptr;
+  }
+  MatLUTFlatHeader header;
+  struct stat st;
+  if (pread(fd, &header, sizeof(header), 0) != sizeof(header) || fstat(fd, &st) != 0 ||
+      memcmp(header.magic, MatLUTFlatHeader::Magic, sizeof(header.magic)) != 0 ||
+      header.version != MatLUTFlatHeader::Version || header.headerSize != sizeof(MatLUTFlatHeader) ||
+      header.layoutSize != sizeof(MatLayerCylSetLayout) || header.layerSize != sizeof(MatLayerCyl) || header.cellSize != sizeof(MatCell) ||
+      header.bufferOffset + header.bufferSize > uint64_t(st.st_size)) {
+    LOG(ERROR) << inpFName << " is not a compatible flat material LUT file";
+    close(fd);
+    return nullptr;
+  }
+  // The mapping is private: relocating the pointers touches only the pages of the layout and of
+  // the layer descriptors at the beginning of the buffer, which get copied, while the pages with
+  // the cells are never written and stay shared with the other processes mapping the same file.
+  size_t mapSize = header.bufferOffset + header.bufferSize;
+  void* ptr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map " << inpFName;
+    return nullptr;
+  }
+  char* buffer = static_cast<char*>(ptr) + header.bufferOffset;
+  auto* mb = new MatLayerCylSet();
+  mb->mFlatBufferSize = header.bufferSize;
+  mb->mFlatBufferPtr = buffer;
+  mb->mConstructionMask = Constructed;
+  mb->fixPointers(reinterpret_cast<char*>(header.bufferBase), buffer);
+  mprotect(ptr, mapSize, PROT_READ); // from now on the buffer is read-only
+  return mb;
+}
+
+//________________________________________________________________________________
+void MatLayerCylSet::getMatBudget(const math_utils::Point3D<float>* points0, const math_utils::Point3D<float>* points1, MatBudget* budgets, int n) const
+{
+  // material budget of many segments at once
+  struct Segment {
+    uint64_t key; // outermost layer, its phi slice and Z bin at the first point
+    int id;
+    short lmin, lmax;
+    bool operator<(const Segment& other) const { return key < other.key || (key == other.key && id < other.id); }
+  };
+  static thread_local std::vector<Segment> segments;
+  segments.clear();
+  for (int i = 0; i < n; i++) {
+    const auto &p0 = points0[i], &p1 = points1[i];
+    Ray ray(p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z());
+    short lmin, lmax;
+    if (ray.isTooShort() || !getLayersRange(ray, lmin, lmax)) {
+      budgets[i] = MatBudget();
+      budgets[i].length = ray.getDist();
+      continue;
+    }
+    const auto& lr = getLayer(lmax);
+    float phi = std::atan2(p0.Y(), p0.X());
+    if (phi < 0.f) {
+      phi += o2::constants::math::TwoPI;
+    }
+    int phiSlice = phi < o2::constants::math::TwoPI ? lr.getPhiSliceID(phi) : 0;
+    int zBin = lr.isZOutside(p0.Z()) == MatLayerCyl::Within ? lr.getZBinID(p0.Z()) : (p0.Z() < 0.f ? 0 : lr.getNZBins() - 1);
+    uint64_t key = (uint64_t(lmax) << 32) | (uint64_t(phiSlice) << 16) | uint64_t(zBin);
+    segments.push_back({key, i, lmin, lmax});
+  }
+  // walking the segments in this order, the consecutive lookups go to the same layers and cells
+  std::sort(segments.begin(), segments.end());
+  for (const auto& seg : segments) {
+    const auto &p0 = points0[seg.id], &p1 = points1[seg.id];
+    Ray ray(p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z());
+    budgets[seg.id] = accumulateMatBudget(ray, seg.lmin, seg.lmax);
+  }
+}
+
 //________________________________________________________________________________
 void MatLayerCylSet::optimizePhiSlices(float maxRelDiff)
 {
@@ -244,13 +399,21 @@ std::size_t MatLayerCylSet::estimateFlatBufferSize() const
 GPUd() MatBudget MatLayerCylSet::getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const
 {
   // get material budget traversed on the line between point0 and point1
-  MatBudget rval;
   Ray ray(x0, y0, z0, x1, y1, z1);
   short lmin, lmax; // get innermost and outermost relevant layer
   if (ray.isTooShort() || !getLayersRange(ray, lmin, lmax)) {
+    MatBudget rval;
     rval.length = ray.getDist();
     return rval;
   }
+  return accumulateMatBudget(ray, lmin, lmax);
+}
+
+//_________________________________________________________________________________________________
+GPUd() MatBudget MatLayerCylSet::accumulateMatBudget(Ray& ray, short lmin, short lmax) const
+{
+  // accumulate material budget along the ray, crossing the layers lmin to lmax
+  MatBudget rval;
   short lrID = lmax;
   while (lrID >= lmin) { // go from outside to inside
     const auto& lr = getLayer(lrID);
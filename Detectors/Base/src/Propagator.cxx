@@ -21,6 +21,8 @@ using namespace o2::gpu;
 
 #if !defined(GPUCA_GPUCODE)
 #include "Field/MagFieldFast.h" // Don't use this on the GPU
+#include <type_traits>
+#include <vector>
 #endif
 
 #if !defined(GPUCA_STANDALONE) && !defined(GPUCA_GPUCODE)
@@ -620,6 +622,246 @@ GPUd() void PropagatorImpl<value_T>::getFieldXYZ(const math_utils::Point3D<doubl
   getFieldXYZImpl<double>(xyz, bxyz);
 }
 
+#ifndef GPUCA_GPUCODE
+template <typename value_T>
+template <typename T>
+void PropagatorImpl<value_T>::getFieldXYZBatchImpl(int npoints, const math_utils::Point3D<T>* xyz, T* bxyz) const
+{
+  if (mGPUField) {
+    for (int i = 0; i < npoints; i++) {
+      getFieldXYZImpl<T>(xyz[i], bxyz + 3 * i);
+    }
+  } else {
+    mField->Field(npoints, xyz, bxyz); // points are bucketed by field segment and evaluated in vectorized loops
+  }
+}
+
+template <typename value_T>
+void PropagatorImpl<value_T>::getFieldXYZ(int npoints, const math_utils::Point3D<float>* xyz, float* bxyz) const
+{
+  getFieldXYZBatchImpl<float>(npoints, xyz, bxyz);
+}
+
+template <typename value_T>
+void PropagatorImpl<value_T>::getFieldXYZ(int npoints, const math_utils::Point3D<double>* xyz, double* bxyz) const
+{
+  getFieldXYZBatchImpl<double>(npoints, xyz, bxyz);
+}
+
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToX(TrackParCov_t* tracks, int ntracks, value_type x, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                               PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  return propagateBatchImpl(tracks, ntracks, nullptr, x, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+}
+
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToX(TrackPar_t* tracks, int ntracks, value_type x, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                               PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  return propagateBatchImpl(tracks, ntracks, nullptr, x, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+}
+
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToX(TrackParCov_t* tracks, int ntracks, const value_type* x, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                               PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  return propagateBatchImpl(tracks, ntracks, x, 0, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+}
+
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToX(TrackPar_t* tracks, int ntracks, const value_type* x, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                               PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  return propagateBatchImpl(tracks, ntracks, x, 0, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+}
+
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToR(TrackParCov_t* tracks, int ntracks, value_type r, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                               PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  return propagateBatchToRImpl(tracks, ntracks, r, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+}
+
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToR(TrackPar_t* tracks, int ntracks, value_type r, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                               PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  return propagateBatchToRImpl(tracks, ntracks, r, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+}
+
+//____________________________________________________________
+template <typename value_T>
+void PropagatorImpl<value_T>::getMatBudget(PropagatorImpl<value_type>::MatCorrType corrType, const math_utils::Point3D<value_type>* p0,
+                                           const math_utils::Point3D<value_type>* p1, MatBudget* budgets, int n) const
+{
+#ifndef GPUCA_ALIGPUCODE
+  if constexpr (std::is_same_v<value_type, float>) {
+    if (corrType == MatCorrType::USEMatCorrLUT && mMatLUT) {
+      mMatLUT->getMatBudget(p0, p1, budgets, n); // segments are sorted by the LUT cells they cross
+      return;
+    }
+  }
+#endif
+  for (int i = 0; i < n; i++) {
+    budgets[i] = getMatBudget(corrType, p0[i], p1[i]);
+  }
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+template <typename track_T>
+int PropagatorImpl<value_T>::propagateBatchImpl(track_T* tracks, int ntracks, const value_type* xToGo, value_type xCommon, bool bzOnly,
+                                                value_type maxSnp, value_type maxStep, PropagatorImpl<value_T>::MatCorrType matCorr,
+                                                bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  // Same as propagateTo for every track, but the tracks are moved step by step together and the field and
+  // material of each step are obtained for all the active tracks with a single batched query
+  constexpr bool WithCov = std::is_same_v<track_T, TrackParCov_t>;
+  const value_type Epsilon = 0.00001;
+  std::vector<int> active, next;
+  std::vector<math_utils::Point3D<value_type>> xyz0, xyz1;
+  std::vector<value_type> bxyz;
+  std::vector<MatBudget> budgets;
+  std::vector<signed char> signs(ntracks);
+  active.reserve(ntracks);
+  next.reserve(ntracks);
+  for (int i = 0; i < ntracks; i++) {
+    if (status) {
+      status[i] = false;
+    }
+    auto dx = (xToGo ? xToGo[i] : xCommon) - tracks[i].getX();
+    signs[i] = signCorr ? signCorr : (dx > 0.f ? -1 : 1); // sign of eloss correction is not imposed
+    active.push_back(i);
+  }
+
+  int nDone = 0;
+  while (!active.empty()) {
+    // retire the tracks which arrived, collect the starting points of the others
+    next.clear();
+    xyz0.clear();
+    for (auto i : active) {
+      auto& track = tracks[i];
+      auto x = xToGo ? xToGo[i] : xCommon;
+      if (math_utils::detail::abs<value_type>(x - track.getX()) > Epsilon) {
+        next.push_back(i);
+        xyz0.push_back(track.getXYZGlo());
+        continue;
+      }
+      track.setX(x);
+      if (status) {
+        status[i] = true;
+      }
+      nDone++;
+    }
+    active.swap(next);
+    int nact = active.size();
+    if (!nact) {
+      break;
+    }
+    if (!bzOnly) {
+      bxyz.resize(3 * nact);
+      getFieldXYZ(nact, xyz0.data(), bxyz.data());
+    }
+
+    // propagate by one step, dropping the failed tracks
+    next.clear();
+    xyz1.clear();
+    for (int j = 0; j < nact; j++) {
+      auto& track = tracks[active[j]];
+      auto dx = (xToGo ? xToGo[active[j]] : xCommon) - track.getX();
+      auto step = math_utils::detail::min<value_type>(math_utils::detail::abs<value_type>(dx), maxStep);
+      auto x = track.getX() + (dx < 0 ? -step : step);
+      bool ok;
+      if (bzOnly) {
+        if constexpr (WithCov) {
+          ok = track.propagateTo(x, mBz);
+        } else {
+          ok = track.propagateParamTo(x, mBz);
+        }
+      } else {
+        gpu::gpustd::array<value_type, 3> b{bxyz[3 * j], bxyz[3 * j + 1], bxyz[3 * j + 2]};
+        if constexpr (WithCov) {
+          ok = track.propagateTo(x, b);
+        } else {
+          ok = track.propagateParamTo(x, b);
+        }
+      }
+      if (!ok || (maxSnp > 0 && math_utils::detail::abs<value_type>(track.getSnp()) >= maxSnp)) {
+        continue;
+      }
+      xyz0[next.size()] = xyz0[j]; // keep the starting points aligned with the surviving tracks
+      next.push_back(active[j]);
+      xyz1.push_back(track.getXYZGlo());
+    }
+    active.swap(next);
+    nact = active.size();
+
+    if (matCorr != MatCorrType::USEMatCorrNONE) {
+      budgets.resize(nact);
+      getMatBudget(matCorr, xyz0.data(), xyz1.data(), budgets.data(), nact);
+      next.clear();
+      for (int j = 0; j < nact; j++) {
+        int i = active[j];
+        auto& track = tracks[i];
+        const auto& mb = budgets[j];
+        bool ok;
+        if constexpr (WithCov) {
+          ok = track.correctForMaterial(mb.meanX2X0, mb.getXRho(signs[i]));
+        } else {
+          ok = track.correctForELoss(mb.getXRho(signs[i]));
+        }
+        if (!ok) {
+          continue;
+        }
+        if (tofInfo) {
+          tofInfo[i].addStep(mb.length, track.getP2Inv()); // fill L,ToF info using already calculated step length
+          tofInfo[i].addX2X0(mb.meanX2X0);
+          if (WithCov && !bzOnly) { // as in propagateTo, only PropagateToXBxByBz with covariance integrates x*rho
+            tofInfo[i].addXRho(mb.getXRho(signs[i]));
+          }
+        }
+        next.push_back(i);
+      }
+      active.swap(next);
+    } else if (tofInfo) { // if tofInfo filling was requested w/o material correction, we need to calculate the step lenght
+      for (int j = 0; j < nact; j++) {
+        math_utils::Vector3D<value_type> stepV(xyz1[j].X() - xyz0[j].X(), xyz1[j].Y() - xyz0[j].Y(), xyz1[j].Z() - xyz0[j].Z());
+        tofInfo[active[j]].addStep(stepV.R(), tracks[active[j]].getP2Inv());
+      }
+    }
+  }
+  return nDone;
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+template <typename track_T>
+int PropagatorImpl<value_T>::propagateBatchToRImpl(track_T* tracks, int ntracks, value_type r, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                                   PropagatorImpl<value_T>::MatCorrType matCorr, bool* status, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  // find the X of the crossing with r for every track, those which cannot reach it are left in place by the batch
+  std::vector<value_type> xToGo(ntracks);
+  std::vector<char> unreachable(ntracks, false);
+  for (int i = 0; i < ntracks; i++) {
+    if (!tracks[i].getXatLabR(r, xToGo[i], mBz)) {
+      xToGo[i] = tracks[i].getX();
+      unreachable[i] = true;
+    }
+  }
+  int nDone = propagateBatchImpl(tracks, ntracks, xToGo.data(), 0, bzOnly, maxSnp, maxStep, matCorr, status, tofInfo, signCorr);
+  for (int i = 0; i < ntracks; i++) {
+    if (unreachable[i]) {
+      nDone--;
+      if (status) {
+        status[i] = false;
+      }
+    }
+  }
+  return nDone;
+}
+#endif
+
 namespace o2::base
 {
 template class PropagatorImpl<float>;
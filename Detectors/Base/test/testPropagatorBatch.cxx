@@ -0,0 +1,182 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Propagator batched propagation
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "buildMatBudLUT.C"
+#include "DetectorsBase/Propagator.h"
+#include "Field/MagneticField.h"
+#include "ReconstructionDataFormats/TrackLTIntegral.h"
+#include <TGeoGlobalMagField.h>
+#include <TRandom.h>
+#include <cmath>
+#include <vector>
+
+namespace o2
+{
+namespace base
+{
+
+using MatCorrType = Propagator::MatCorrType;
+using TrackPar = Propagator::TrackPar_t;
+using TrackParCov = Propagator::TrackParCov_t;
+
+constexpr int NTracks = 500;
+
+// geometry, field and material LUT, set up once for all the test cases
+Propagator* getPropagator()
+{
+  static Propagator* propagator = nullptr;
+  if (!propagator) {
+    BOOST_REQUIRE(buildMatBudLUT(2, 20)); // loads the geometry and builds the LUT of the inner layers
+    auto field = o2::field::MagneticField::createNominalField(5);
+    TGeoGlobalMagField::Instance()->SetField(field);
+    TGeoGlobalMagField::Instance()->Lock();
+    propagator = Propagator::Instance();
+    propagator->setMatLUT(&mbLUT);
+  }
+  return propagator;
+}
+
+// tracks from the beam line with various directions and momenta, some of them too soft to reach the outer
+// layers: they fail midway on the sin(phi) limit or the energy loss
+std::vector<TrackParCov> createTracks()
+{
+  std::vector<TrackParCov> tracks;
+  gRandom->SetSeed(1234);
+  for (int i = 0; i < NTracks; i++) {
+    const float pt = i % 5 ? gRandom->Uniform(0.2, 5.) : gRandom->Uniform(0.02, 0.1);
+    const float alpha = gRandom->Uniform(-M_PI, M_PI);
+    const std::array<float, 5> par{gRandom->Gaus(0., 0.1), gRandom->Gaus(0., 5.), gRandom->Uniform(-0.4, 0.4),
+                                   gRandom->Uniform(-1., 1.), (i % 2 ? 1.f : -1.f) / pt};
+    const std::array<float, 15> cov{1e-4, 0., 1e-4, 0., 0., 1e-5, 0., 0., 0., 1e-5, 0., 0., 0., 0., 1e-3};
+    tracks.emplace_back(0.5f, alpha, par, cov);
+  }
+  return tracks;
+}
+
+template <typename Track>
+std::vector<Track> convert(const std::vector<TrackParCov>& tracks)
+{
+  return std::vector<Track>(tracks.begin(), tracks.end());
+}
+
+void checkClose(float a, float b)
+{
+  BOOST_CHECK_SMALL(a - b, 1e-4f * (1.f + std::abs(a)));
+}
+
+void compareTracks(const TrackPar& batch, const TrackPar& scalar)
+{
+  BOOST_CHECK_EQUAL(batch.getAlpha(), scalar.getAlpha());
+  checkClose(batch.getX(), scalar.getX());
+  for (int i = 0; i < 5; i++) {
+    checkClose(batch.getParam(i), scalar.getParam(i));
+  }
+}
+
+void compareTracks(const TrackParCov& batch, const TrackParCov& scalar)
+{
+  compareTracks(static_cast<const TrackPar&>(batch), static_cast<const TrackPar&>(scalar));
+  for (int i = 0; i < 15; i++) {
+    checkClose(batch.getCov()[i], scalar.getCov()[i]);
+  }
+}
+
+void compareTOFInfo(const track::TrackLTIntegral& batch, const track::TrackLTIntegral& scalar)
+{
+  checkClose(batch.getL(), scalar.getL());
+  checkClose(batch.getX2X0(), scalar.getX2X0());
+  checkClose(batch.getXRho(), scalar.getXRho());
+  for (int id = 0; id < track::TrackLTIntegral::getNTOFs(); id++) {
+    checkClose(batch.getTOF(id), scalar.getTOF(id));
+  }
+}
+
+// propagate with the batched method and track by track with propagateTo, and compare the results
+// xTarget: common target, or per-track targets if rTarget is 0; rTarget > 0: propagation to the radius
+template <typename Track>
+void compareBatch(bool bzOnly, MatCorrType matCorr, float xTarget, float rTarget, bool perTrackX)
+{
+  auto propagator = getPropagator();
+  auto batch = convert<Track>(createTracks());
+  auto scalar = batch;
+  std::vector<float> xToGo(NTracks, xTarget);
+  if (perTrackX) {
+    for (int i = 0; i < NTracks; i++) {
+      xToGo[i] = xTarget - (i % 30);
+    }
+  }
+  std::vector<track::TrackLTIntegral> batchTOF(NTracks), scalarTOF(NTracks);
+  bool batchStatus[NTracks];
+
+  int nBatch = 0;
+  if (rTarget > 0) {
+    nBatch = propagator->propagateBatchToR(batch.data(), NTracks, rTarget, bzOnly, Propagator::MAX_SIN_PHI, Propagator::MAX_STEP, matCorr, batchStatus, batchTOF.data());
+  } else if (perTrackX) {
+    nBatch = propagator->propagateBatchToX(batch.data(), NTracks, xToGo.data(), bzOnly, Propagator::MAX_SIN_PHI, Propagator::MAX_STEP, matCorr, batchStatus, batchTOF.data());
+  } else {
+    nBatch = propagator->propagateBatchToX(batch.data(), NTracks, xTarget, bzOnly, Propagator::MAX_SIN_PHI, Propagator::MAX_STEP, matCorr, batchStatus, batchTOF.data());
+  }
+
+  int nScalar = 0, nFailed = 0;
+  for (int i = 0; i < NTracks; i++) {
+    bool ok = true;
+    float x = xToGo[i];
+    if (rTarget > 0) {
+      ok = scalar[i].getXatLabR(rTarget, x, propagator->getNominalBz());
+    }
+    ok = ok && propagator->propagateTo(scalar[i], x, bzOnly, Propagator::MAX_SIN_PHI, Propagator::MAX_STEP, matCorr, &scalarTOF[i]);
+    nScalar += ok;
+    nFailed += !ok;
+    BOOST_CHECK_EQUAL(batchStatus[i], ok);
+    compareTracks(batch[i], scalar[i]); // failed tracks are left where they failed
+    compareTOFInfo(batchTOF[i], scalarTOF[i]);
+  }
+  BOOST_CHECK_EQUAL(nBatch, nScalar);
+  // make sure that both the successful and the failed propagations are tested
+  BOOST_CHECK(nScalar > NTracks / 2);
+  BOOST_CHECK(nFailed > 0);
+}
+
+BOOST_AUTO_TEST_CASE(PropagatorBatch_toX)
+{
+  for (bool bzOnly : {true, false}) {
+    for (auto matCorr : {MatCorrType::USEMatCorrNONE, MatCorrType::USEMatCorrLUT}) {
+      for (bool perTrackX : {false, true}) {
+        BOOST_TEST_CONTEXT("bzOnly " << bzOnly << " matCorr " << int(matCorr) << " per-track X " << perTrackX)
+        {
+          compareBatch<TrackPar>(bzOnly, matCorr, 40.f, 0.f, perTrackX);
+          compareBatch<TrackParCov>(bzOnly, matCorr, 40.f, 0.f, perTrackX);
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PropagatorBatch_toR)
+{
+  for (bool bzOnly : {true, false}) {
+    for (auto matCorr : {MatCorrType::USEMatCorrNONE, MatCorrType::USEMatCorrLUT}) {
+      BOOST_TEST_CONTEXT("bzOnly " << bzOnly << " matCorr " << int(matCorr))
+      {
+        compareBatch<TrackPar>(bzOnly, matCorr, 0.f, 30.f, false);
+        compareBatch<TrackParCov>(bzOnly, matCorr, 0.f, 30.f, false);
+      }
+    }
+  }
+}
+
+} // namespace base
+} // namespace o2
@@ -0,0 +1,67 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef DETECTOR_CALIB_SLOTFILLPOOL_H_
+#define DETECTOR_CALIB_SLOTFILLPOOL_H_
+
+/// @brief Persistent threads for the parallel filling of the time slots
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+namespace calibration
+{
+
+class SlotFillPool
+{
+ public:
+  /// function processing the part i of the data
+  using Job = std::function<void(int i)>;
+
+  /// the calling thread is used as well, so that nThreads - 1 workers are started
+  explicit SlotFillPool(int nThreads);
+  ~SlotFillPool();
+
+  SlotFillPool(const SlotFillPool&) = delete;
+  SlotFillPool& operator=(const SlotFillPool&) = delete;
+
+  /// call job(i) for i = 0 ... nParts - 1, part i being processed by thread i % getNThreads(), where
+  /// thread 0 is the calling one. Returns when all the parts are done, rethrowing the exception of the
+  /// first failed part, if any
+  void run(int nParts, const Job& job);
+  int getNThreads() const { return mThreads.size() + 1; }
+
+ private:
+  void work(int thread);
+  void process(int thread);
+
+  std::vector<std::thread> mThreads;
+  std::vector<std::exception_ptr> mErrors; // error of each part of the current run
+  const Job* mJob = nullptr;               // job of the current run
+  int mNParts = 0;
+  int mNBusy = 0;         // number of workers still processing the current run
+  uint64_t mRunCount = 0; // incremented at each run, to wake up the workers
+  std::mutex mMutex;
+  std::condition_variable mWorkAvailable;
+  std::condition_variable mWorkDone;
+  bool mStop = false;
+};
+
+} // namespace calibration
+} // namespace o2
+
+#endif
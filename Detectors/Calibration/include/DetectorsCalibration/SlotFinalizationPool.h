@@ -0,0 +1,78 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef DETECTOR_CALIB_SLOTFINALIZATIONPOOL_H_
+#define DETECTOR_CALIB_SLOTFINALIZATIONPOOL_H_
+
+/// @brief Worker threads for the asynchronous finalization of the time slots
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+namespace calibration
+{
+
+class SlotFinalizationPool
+{
+ public:
+  /// function storing the result of a finalization in the calibrator output
+  using Publisher = std::function<void()>;
+  /// heavy part of the finalization, run in a worker thread
+  using Task = std::function<Publisher()>;
+
+  explicit SlotFinalizationPool(int nThreads);
+  /// waits for the running tasks and drops the ones not started yet, without publishing any result
+  ~SlotFinalizationPool();
+
+  SlotFinalizationPool(const SlotFinalizationPool&) = delete;
+  SlotFinalizationPool& operator=(const SlotFinalizationPool&) = delete;
+
+  /// submit a new task, its result will be published after the ones of the tasks submitted earlier
+  void push(Task task);
+  /// run, in the calling thread, the publishers of the completed tasks, in submission order,
+  /// stopping at the first one which is still running, unless @a wait is true
+  /// @return number of published results
+  int collect(bool wait = false);
+  /// number of submitted tasks whose result was not published yet
+  size_t getNPending() const;
+  int getNThreads() const { return mThreads.size(); }
+
+ private:
+  struct Entry {
+    Task task;
+    Publisher publisher;
+    std::exception_ptr error;
+    bool done = false;
+  };
+
+  void work();
+
+  std::vector<std::thread> mThreads;
+  std::deque<std::shared_ptr<Entry>> mPending; // all the entries not yet published, in submission order
+  std::deque<std::shared_ptr<Entry>> mQueue;   // entries not yet picked up by a worker
+  mutable std::mutex mMutex;
+  std::condition_variable mWorkAvailable;
+  std::condition_variable mWorkDone;
+  bool mStop = false;
+};
+
+} // namespace calibration
+} // namespace o2
+
+#endif
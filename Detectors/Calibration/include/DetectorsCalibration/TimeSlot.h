@@ -13,6 +13,7 @@
 #define DETECTOR_CALIB_TIMESLOT_H_
 
 #include <memory>
+#include <vector>
 #include <Rtypes.h>
 #include "Framework/Logger.h"
 
@@ -31,16 +32,23 @@ class TimeSlot
  public:
   TimeSlot() = default;
   TimeSlot(TFType tfS, TFType tfE) : mTFStart(tfS), mTFEnd(tfE) {}
-  TimeSlot(const TimeSlot& src) : mTFStart(src.mTFStart), mTFEnd(src.mTFEnd), mContainer(std::make_unique<Container>(*src.getContainer())) {}
+  // the copy includes the shards not merged yet, so that it holds the same data as the source
+  TimeSlot(const TimeSlot& src) : mTFStart(src.mTFStart), mTFEnd(src.mTFEnd), mContainer(std::make_unique<Container>(*src.getContainer()))
+  {
+    copyShards(src);
+  }
+  TimeSlot(TimeSlot&& src) = default;
   TimeSlot& operator=(const TimeSlot& src)
   {
     if (&src != this) {
       mTFStart = src.mTFStart;
       mTFEnd = src.mTFEnd;
       mContainer = std::make_unique<Container>(*src.getContainer());
+      copyShards(src);
     }
     return *this;
   }
+  TimeSlot& operator=(TimeSlot&& src) = default;
 
   ~TimeSlot() = default;
 
@@ -59,10 +67,34 @@ class TimeSlot
   // merge data of previous slot to this one and extend the mTFStart to cover prev
   void mergeToPrevious(TimeSlot& prev)
   {
+    mergeShards();
+    prev.mergeShards();
     mContainer->merge(prev.mContainer.get());
     mTFStart = prev.mTFStart;
   }
 
+  // Per-thread containers, used when the data of a TF are filled in parallel.
+  // They are copies of the empty container of the slot, recorded by keepPrototype(),
+  // and are merged to the main container by mergeShards().
+  void keepPrototype() { mPrototype = std::make_unique<Container>(*mContainer); }
+  bool hasPrototype() const { return mPrototype != nullptr; }
+  int getNShards() const { return mShards.size() + 1; }
+  // shard 0 is the main container
+  Container* getShard(int i) { return i == 0 ? mContainer.get() : mShards[i - 1].get(); }
+  void prepareShards(int n)
+  {
+    while (int(mShards.size()) < n - 1) {
+      mShards.emplace_back(std::make_unique<Container>(*mPrototype));
+    }
+  }
+  void mergeShards()
+  {
+    for (auto& shard : mShards) {
+      mContainer->merge(shard.get());
+    }
+    mShards.clear();
+  }
+
   void print() const
   {
     LOGF(INFO, "Calibration slot %5d <=TF<=  %5d", mTFStart, mTFEnd);
@@ -70,10 +102,21 @@ class TimeSlot
   }
 
  private:
+  void copyShards(const TimeSlot& src)
+  {
+    mPrototype = src.mPrototype ? std::make_unique<Container>(*src.mPrototype) : nullptr;
+    mShards.clear();
+    for (const auto& shard : src.mShards) {
+      mShards.emplace_back(std::make_unique<Container>(*shard));
+    }
+  }
+
   TFType mTFStart = 0;
   TFType mTFEnd = 0;
   size_t mEntries = 0;
   std::unique_ptr<Container> mContainer; // user object to accumulate the calibration data for this slot
+  std::unique_ptr<Container> mPrototype;              //! empty container to create the shards
+  std::vector<std::unique_ptr<Container>> mShards;    //! containers filled by the extra threads, not yet merged
 
   ClassDefNV(TimeSlot, 1);
 };
@@ -15,9 +15,15 @@
 /// @brief Processor for the multiple time slots calibration
 
 #include "DetectorsCalibration/TimeSlot.h"
+#include "DetectorsCalibration/SlotFinalizationPool.h"
+#include "DetectorsCalibration/SlotFillPool.h"
+#include <algorithm>
 #include <deque>
+#include <functional>
 #include <gsl/gsl>
 #include <limits>
+#include <memory>
+#include <type_traits>
 
 namespace o2
 {
@@ -49,6 +55,33 @@ class TimeSlotCalibration
 
   void setUpdateAtTheEndOfRunOnly() { mUpdateAtTheEndOfRunOnly = kTRUE; }
 
+  // Fill the data of a TF in n threads when there are at least minSize entries. Each thread fills its own
+  // copy of the slot container, the copies are merged (with Container::merge) before the slot is checked or
+  // finalized. Containers must be copyable, and their content must not depend on the order of filling.
+  // The threads are started here and kept for the whole run. To be called before the first TF is processed.
+  void setNFillThreads(int n, size_t minSize = 10000)
+  {
+    mNFillThreads = n < 1 ? 1 : n;
+    mMinParallelFillSize = minSize;
+    mFillPool.reset();
+    if (mNFillThreads > 1) {
+      mFillPool = std::make_unique<SlotFillPool>(mNFillThreads);
+    }
+  }
+  int getNFillThreads() const { return mNFillThreads; }
+
+  // Finalize the slots in n background threads (0: synchronous finalization, the default).
+  // The tasks returned by prepareSlotFinalization for the closed slots run in the workers while process()
+  // keeps filling the newer slots; the results are published in slot order by collectFinalizedSlots,
+  // which is called at every process() and, waiting for all of them, at the end of run.
+  // The destruction of the calibrator waits for the running tasks and drops the unpublished results.
+  void setNAsyncFinalizationThreads(int n);
+  int getNAsyncFinalizationThreads() const { return mFinalizationPool ? mFinalizationPool->getNThreads() : 0; }
+  void stopAsyncFinalization() { mFinalizationPool.reset(); }
+  // publish the results of the slots whose asynchronous finalization is over; returns their number
+  int collectFinalizedSlots(bool wait = false) { return mFinalizationPool ? mFinalizationPool->collect(wait) : 0; }
+  size_t getNPendingFinalizations() const { return mFinalizationPool ? mFinalizationPool->getNPending() : 0; }
+
   int getNSlots() const { return mSlots.size(); }
   Slot& getSlotForTF(TFType tf);
   Slot& getSlot(int i) { return (Slot&)mSlots.at(i); }
@@ -70,6 +103,17 @@ class TimeSlotCalibration
   virtual Slot& emplaceNewSlot(bool front, TFType tstart, TFType tend) = 0;
   // check if the slot has enough data to be finalized
   virtual bool hasEnoughData(const Slot& slot) const = 0;
+  // for the asynchronous finalization, called from the thread calling process(): return the task processing
+  // the time slot container in a worker thread. The task must only use the slot and what it captured by value,
+  // never the calibrator itself, which may be destroyed while the task runs. It returns the function adding
+  // the results to the output, which is called from the thread calling process() and can access the calibrator.
+  // By default the whole finalizeSlot is deferred to the publishing, override it to really offload the work.
+  virtual SlotFinalizationPool::Task prepareSlotFinalization(std::shared_ptr<Slot> slot)
+  {
+    return [this, slot]() -> SlotFinalizationPool::Publisher {
+      return [this, slot]() { finalizeSlot(*slot); };
+    };
+  }
 
   virtual void print() const;
 
@@ -78,8 +122,13 @@ class TimeSlotCalibration
 
  private:
   TFType tf2SlotMin(TFType tf) const;
+  void finalizeOrSchedule(Slot& slot);
+  Slot& emplaceSlot(bool front, TFType tstart, TFType tend);
+  void fillSlot(Slot& slot, const gsl::span<const Input> data);
 
   std::deque<Slot> mSlots;
+  std::unique_ptr<SlotFinalizationPool> mFinalizationPool; //! workers for the asynchronous finalization
+  std::unique_ptr<SlotFillPool> mFillPool;                 //! workers for the parallel filling
 
   TFType mLastClosedTF = 0;
   TFType mFirstTF = 0;
@@ -87,6 +136,8 @@ class TimeSlotCalibration
   uint64_t mSlotLength = 1;
   uint64_t mMaxSlotsDelay = 3;
   bool mUpdateAtTheEndOfRunOnly = false;
+  int mNFillThreads = 1;               // number of threads used to fill the data of a TF
+  size_t mMinParallelFillSize = 10000; // minimum number of entries to use more than 1 thread
   uint64_t mCheckIntervalInfiniteSlot = 1;      // will be used if the TF length is INFINITE_TF_int64 to decide
                                                 // when to check if to call the finalize; otherwise it is called
                                                 // at every new TF; note that this is an approximation,
@@ -108,6 +159,9 @@ bool TimeSlotCalibration<Input, Container>::process(TFType tf, const gsl::span<c
 
   // process current TF
 
+  // publish what was finalized in the background since the last call
+  collectFinalizedSlots();
+
   int maxDelay = mMaxSlotsDelay * mSlotLength;
   if (!mUpdateAtTheEndOfRunOnly) {                                                               // if you update at the end of run only, then you accept everything
     if (tf < mLastClosedTF || (!mSlots.empty() && getLastSlot().getTFStart() > tf + maxDelay)) { // ignore TF; note that if you have only 1 timeslot
@@ -120,7 +174,7 @@ bool TimeSlotCalibration<Input, Container>::process(TFType tf, const gsl::span<c
   }
 
   auto& slotTF = getSlotForTF(tf);
-  slotTF.getContainer()->fill(data);
+  fillSlot(slotTF, data);
   if (tf > mMaxSeenTF) {
     mMaxSeenTF = tf; // keep track of the most recent TF processed
   }
@@ -159,18 +213,19 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
         LOG(INFO) << "Update interval passed (" << checkInterval << "), checking slot for " << mSlots[0].getTFStart() << " <= TF <= " << mSlots[0].getTFEnd();
       }
       mLastCheckedTFInfiniteSlot = tf;
+      mSlots[0].mergeShards();
       if (hasEnoughData(mSlots[0])) {
         mWasCheckedInfiniteSlot = false;
         mSlots[0].setTFStart(mLastClosedTF);
         mSlots[0].setTFEnd(mMaxSeenTF);
         LOG(INFO) << "Finalizing slot for " << mSlots[0].getTFStart() << " <= TF <= " << mSlots[0].getTFEnd();
-        finalizeSlot(mSlots[0]);                  // will be removed after finalization
+        finalizeOrSchedule(mSlots[0]);            // will be removed after finalization
         mLastClosedTF = mSlots[0].getTFEnd() + 1; // will not accept any TF below this
         mSlots.erase(mSlots.begin());
         // creating a new slot if we are not at the end of run
         if (tf != INFINITE_TF) {
           LOG(INFO) << "Creating new slot for " << mLastClosedTF << " <= TF <= " << INFINITE_TF_int64;
-          emplaceNewSlot(true, mLastClosedTF, INFINITE_TF_int64);
+          emplaceSlot(true, mLastClosedTF, INFINITE_TF_int64);
         }
       } else {
         LOG(INFO) << "Not enough data to calibrate";
@@ -184,9 +239,10 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
     for (auto slot = mSlots.begin(); slot != mSlots.end();) {
       //if (maxDelay == 0 || (slot->getTFEnd() + maxDelay) < tf) {
       if ((slot->getTFEnd() + maxDelay) < tf) {
+        slot->mergeShards();
         if (hasEnoughData(*slot)) {
           LOG(DEBUG) << "Finalizing slot for " << slot->getTFStart() << " <= TF <= " << slot->getTFEnd();
-          finalizeSlot(*slot); // will be removed after finalization
+          finalizeOrSchedule(*slot); // will be removed after finalization
         } else if ((slot + 1) != mSlots.end()) {
           LOG(INFO) << "Merging underpopulated slot " << slot->getTFStart() << " <= TF <= " << slot->getTFEnd()
                     << " to slot " << (slot + 1)->getTFStart() << " <= TF <= " << (slot + 1)->getTFEnd();
@@ -203,6 +259,9 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
       }
     }
   }
+  if (tf == INFINITE_TF) { // end of run: all results must be available
+    collectFinalizedSlots(true);
+  }
 }
 
 //_________________________________________________
@@ -214,11 +273,85 @@ void TimeSlotCalibration<Input, Container>::finalizeOldestSlot()
     LOG(WARNING) << "There are no slots defined";
     return;
   }
+  collectFinalizedSlots(true); // keep the results in slot order
+  mSlots.front().mergeShards();
   finalizeSlot(mSlots.front());
   mLastClosedTF = mSlots.front().getTFEnd() + 1; // do not accept any TF below this
   mSlots.erase(mSlots.begin());
 }
 
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::setNAsyncFinalizationThreads(int n)
+{
+  if (mFinalizationPool) {
+    collectFinalizedSlots(true);
+    mFinalizationPool.reset();
+  }
+  if (n > 0) {
+    mFinalizationPool = std::make_unique<SlotFinalizationPool>(n);
+  }
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::finalizeOrSchedule(Slot& slot)
+{
+  // Finalize the slot, or hand it to the workers if the asynchronous finalization is enabled.
+  // In the latter case the slot content is moved away, the caller can remove it as usual.
+  if (!mFinalizationPool) {
+    finalizeSlot(slot);
+    return;
+  }
+  auto closed = std::make_shared<Slot>(std::move(slot));
+  auto task = prepareSlotFinalization(closed);
+  mFinalizationPool->push([task = std::move(task), closed]() -> SlotFinalizationPool::Publisher {
+    auto publish = task();
+    // the slot must stay alive until the result is published
+    return [publish = std::move(publish), closed]() {
+      if (publish) {
+        publish();
+      }
+    };
+  });
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+TimeSlot<Container>& TimeSlotCalibration<Input, Container>::emplaceSlot(bool front, TFType tstart, TFType tend)
+{
+  auto& slot = emplaceNewSlot(front, tstart, tend);
+  if constexpr (std::is_copy_constructible_v<Container>) {
+    if (mNFillThreads > 1) {
+      slot.keepPrototype(); // the container is still empty
+    }
+  }
+  return slot;
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::fillSlot(Slot& slot, const gsl::span<const Input> data)
+{
+  // fill the slot container, splitting large inputs among several threads, each with its own container
+  if constexpr (!std::is_copy_constructible_v<Container>) {
+    slot.getContainer()->fill(data);
+  } else {
+    if (mNFillThreads < 2 || data.size() < mMinParallelFillSize || !slot.hasPrototype()) {
+      slot.getContainer()->fill(data);
+      return;
+    }
+    slot.prepareShards(mNFillThreads);
+    const size_t chunk = (data.size() + mNFillThreads - 1) / mNFillThreads;
+    mFillPool->run(mNFillThreads, [&slot, &data, chunk](int i) {
+      const size_t first = i * chunk;
+      if (first < data.size()) {
+        slot.getShard(i)->fill(data.subspan(first, std::min(chunk, data.size() - first)));
+      }
+    });
+  }
+}
+
 //________________________________________
 template <typename Input, typename Container>
 inline TFType TimeSlotCalibration<Input, Container>::tf2SlotMin(TFType tf) const
@@ -246,7 +379,7 @@ TimeSlot<Container>& TimeSlotCalibration<Input, Container>::getSlotForTF(TFType
     if (!mSlots.empty() && mSlots.back().getTFEnd() < tf) {
       mSlots.back().setTFEnd(tf);
     } else if (mSlots.empty()) {
-      emplaceNewSlot(true, mFirstTF, tf);
+      emplaceSlot(true, mFirstTF, tf);
     }
     return mSlots.back();
   }
@@ -256,7 +389,7 @@ TimeSlot<Container>& TimeSlotCalibration<Input, Container>::getSlotForTF(TFType
     auto tftgt = tf2SlotMin(tf);                             // min TF of the slot to which the TF "tf" would belong
     while (tfmn >= tftgt) {
       LOG(INFO) << "Adding new slot for " << tfmn << " <= TF <= " << tfmn + mSlotLength - 1;
-      emplaceNewSlot(true, tfmn, tfmn + mSlotLength - 1);
+      emplaceSlot(true, tfmn, tfmn + mSlotLength - 1);
       if (!tfmn) {
         break;
       }
@@ -274,7 +407,7 @@ TimeSlot<Container>& TimeSlotCalibration<Input, Container>::getSlotForTF(TFType
   auto tfmn = mSlots.empty() ? tf2SlotMin(tf) : tf2SlotMin(mSlots.back().getTFEnd() + 1);
   do {
     LOG(INFO) << "Adding new slot for " << tfmn << " <= TF <= " << tfmn + mSlotLength - 1;
-    emplaceNewSlot(false, tfmn, tfmn + mSlotLength - 1);
+    emplaceSlot(false, tfmn, tfmn + mSlotLength - 1);
     tfmn = tf2SlotMin(mSlots.back().getTFEnd() + 1);
   } while (tf > mSlots.back().getTFEnd());
 
@@ -0,0 +1,95 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "DetectorsCalibration/SlotFillPool.h"
+
+using namespace o2::calibration;
+
+//_________________________________________________
+SlotFillPool::SlotFillPool(int nThreads)
+{
+  for (int i = 1; i < nThreads; i++) {
+    mThreads.emplace_back([this, i]() { work(i); });
+  }
+}
+
+//_________________________________________________
+SlotFillPool::~SlotFillPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mWorkAvailable.notify_all();
+  for (auto& t : mThreads) {
+    t.join();
+  }
+}
+
+//_________________________________________________
+void SlotFillPool::run(int nParts, const Job& job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJob = &job;
+    mNParts = nParts;
+    mErrors.assign(nParts > 0 ? nParts : 0, nullptr);
+    mNBusy = mThreads.size();
+    mRunCount++;
+  }
+  mWorkAvailable.notify_all();
+  process(0);
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkDone.wait(lock, [this]() { return mNBusy == 0; });
+    mJob = nullptr;
+  }
+  for (auto& e : mErrors) {
+    if (e) {
+      std::rethrow_exception(e);
+    }
+  }
+}
+
+//_________________________________________________
+void SlotFillPool::process(int thread)
+{
+  // each part has its own error slot, no lock is needed
+  for (int i = thread; i < mNParts; i += getNThreads()) {
+    try {
+      (*mJob)(i);
+    } catch (...) {
+      mErrors[i] = std::current_exception();
+    }
+  }
+}
+
+//_________________________________________________
+void SlotFillPool::work(int thread)
+{
+  uint64_t seenRuns = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mWorkAvailable.wait(lock, [this, seenRuns]() { return mStop || mRunCount != seenRuns; });
+      if (mStop) {
+        return;
+      }
+      seenRuns = mRunCount;
+    }
+    process(thread);
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mNBusy--;
+    }
+    mWorkDone.notify_one();
+  }
+}
@@ -0,0 +1,119 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "DetectorsCalibration/SlotFinalizationPool.h"
+
+using namespace o2::calibration;
+
+//_________________________________________________
+SlotFinalizationPool::SlotFinalizationPool(int nThreads)
+{
+  for (int i = 0; i < nThreads; i++) {
+    mThreads.emplace_back([this]() { work(); });
+  }
+}
+
+//_________________________________________________
+SlotFinalizationPool::~SlotFinalizationPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+    mQueue.clear();
+  }
+  mWorkAvailable.notify_all();
+  for (auto& t : mThreads) {
+    t.join();
+  }
+}
+
+//_________________________________________________
+void SlotFinalizationPool::push(Task task)
+{
+  auto entry = std::make_shared<Entry>();
+  entry->task = std::move(task);
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.push_back(entry);
+    mQueue.push_back(entry);
+  }
+  mWorkAvailable.notify_one();
+}
+
+//_________________________________________________
+int SlotFinalizationPool::collect(bool wait)
+{
+  int nPublished = 0;
+  while (true) {
+    std::shared_ptr<Entry> entry;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (mPending.empty()) {
+        break;
+      }
+      if (wait) {
+        mWorkDone.wait(lock, [this]() { return mPending.front()->done; });
+      } else if (!mPending.front()->done) {
+        break;
+      }
+      entry = std::move(mPending.front());
+      mPending.pop_front();
+    }
+    // publishing happens outside of the lock, in the calling thread
+    if (entry->error) {
+      std::rethrow_exception(entry->error);
+    }
+    if (entry->publisher) {
+      entry->publisher();
+    }
+    nPublished++;
+  }
+  return nPublished;
+}
+
+//_________________________________________________
+size_t SlotFinalizationPool::getNPending() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mPending.size();
+}
+
+//_________________________________________________
+void SlotFinalizationPool::work()
+{
+  while (true) {
+    std::shared_ptr<Entry> entry;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mWorkAvailable.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+      if (mQueue.empty()) { // stop requested and nothing left to do
+        return;
+      }
+      entry = std::move(mQueue.front());
+      mQueue.pop_front();
+    }
+    Publisher publisher;
+    std::exception_ptr error;
+    try {
+      publisher = entry->task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      entry->publisher = std::move(publisher);
+      entry->error = error;
+      entry->done = true;
+      entry->task = nullptr;
+    }
+    mWorkDone.notify_all();
+  }
+}
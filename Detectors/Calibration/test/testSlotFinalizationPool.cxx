@@ -0,0 +1,122 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test SlotFinalizationPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "DetectorsCalibration/SlotFinalizationPool.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace o2::calibration;
+using Publisher = SlotFinalizationPool::Publisher;
+
+// the results are published in submission order, even if the later tasks complete first
+BOOST_AUTO_TEST_CASE(SlotFinalizationPool_order)
+{
+  constexpr int NTasks = 8;
+  SlotFinalizationPool pool(4);
+  std::vector<int> published;
+  for (int i = 0; i < NTasks; i++) {
+    pool.push([i, &published]() -> Publisher {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5 * (NTasks - i)));
+      return [i, &published]() { published.push_back(i); };
+    });
+  }
+  BOOST_CHECK_EQUAL(pool.collect(true), NTasks);
+  BOOST_REQUIRE_EQUAL(published.size(), NTasks);
+  for (int i = 0; i < NTasks; i++) {
+    BOOST_CHECK_EQUAL(published[i], i);
+  }
+  BOOST_CHECK_EQUAL(pool.getNPending(), 0);
+}
+
+// without waiting, the publishing stops at the first task still running
+BOOST_AUTO_TEST_CASE(SlotFinalizationPool_nowait)
+{
+  SlotFinalizationPool pool(2);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic<bool> secondDone{false};
+  std::vector<int> published;
+  pool.push([released, &published]() -> Publisher {
+    released.wait();
+    return [&published]() { published.push_back(0); };
+  });
+  pool.push([&published, &secondDone]() -> Publisher {
+    secondDone = true;
+    return [&published]() { published.push_back(1); };
+  });
+  while (!secondDone) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_CHECK_EQUAL(pool.collect(), 0);
+  BOOST_CHECK(published.empty());
+  BOOST_CHECK_EQUAL(pool.getNPending(), 2);
+  release.set_value();
+  BOOST_CHECK_EQUAL(pool.collect(true), 2);
+  BOOST_REQUIRE_EQUAL(published.size(), 2);
+  BOOST_CHECK_EQUAL(published[0], 0);
+  BOOST_CHECK_EQUAL(published[1], 1);
+}
+
+// an exception thrown by a task is rethrown by collect in the calling thread, in submission order
+BOOST_AUTO_TEST_CASE(SlotFinalizationPool_exception)
+{
+  SlotFinalizationPool pool(2);
+  std::vector<int> published;
+  for (int i = 0; i < 3; i++) {
+    pool.push([i, &published]() -> Publisher {
+      if (i == 1) {
+        throw std::runtime_error("failed finalization");
+      }
+      return [i, &published]() { published.push_back(i); };
+    });
+  }
+  BOOST_CHECK_THROW(pool.collect(true), std::runtime_error);
+  BOOST_REQUIRE_EQUAL(published.size(), 1);
+  BOOST_CHECK_EQUAL(published[0], 0);
+  // the failed task is consumed, the following ones can still be published
+  BOOST_CHECK_EQUAL(pool.collect(true), 1);
+  BOOST_REQUIRE_EQUAL(published.size(), 2);
+  BOOST_CHECK_EQUAL(published[1], 2);
+}
+
+// the destruction waits for the running task, drops the queued ones and publishes nothing
+BOOST_AUTO_TEST_CASE(SlotFinalizationPool_destruction)
+{
+  std::atomic<bool> started{false}, finished{false}, queuedRan{false};
+  bool published = false;
+  {
+    SlotFinalizationPool pool(1);
+    pool.push([&]() -> Publisher {
+      started = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      finished = true;
+      return [&published]() { published = true; };
+    });
+    pool.push([&]() -> Publisher {
+      queuedRan = true;
+      return [&published]() { published = true; };
+    });
+    while (!started) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  BOOST_CHECK(finished);
+  BOOST_CHECK(!queuedRan);
+  BOOST_CHECK(!published);
+}
@@ -159,6 +159,11 @@ class CaloRawFitter
                        double adcErr = 1,
                        double tau = 2.35) const;
 
+  /// \brief Parabola fit to the 3 samples following a time bin, e.g. as start values of the peak fit
+  /// \param maxTimeBin Time bin of the max. amplitude - 1
+  /// \return the fit parameters: amplitude, time.
+  std::tuple<float, float> doParabolaFit(int maxTimeBin) const;
+
  protected:
   std::array<double, constants::EMCAL_MAXTIMEBINS> mReversed; ///< Reversed sequence of samples (pedestalsubtracted)
 
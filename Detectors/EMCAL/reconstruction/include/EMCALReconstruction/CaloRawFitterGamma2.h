@@ -77,13 +77,6 @@ class CaloRawFitterGamma2 final : public CaloRawFitter
   /// \throw RawFitterError_t::FIT_ERROR in case of fit errors (insufficient number of time samples, matrix diagonalization error, ...)
   float doFit_1peak(int firstTimeBin, int nSamples, float& ampl, float& time);
 
-  /// \brief Fits the raw signal time distribution
-  /// \param maxTimeBin Time bin of the max. amplitude
-  /// \return the fit parameters: amplitude, time.
-  ///
-  /// Fit performed as parabola fit to the signal
-  std::tuple<float, float> doParabolaFit(int maxTimeBin) const;
-
   ClassDefNV(CaloRawFitterGamma2, 1);
 }; // End of CaloRawFitterGamma2
 
@@ -0,0 +1,129 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef __CALORAWFITTERGAMMA2BATCH_H__
+#define __CALORAWFITTERGAMMA2BATCH_H__
+
+#include <array>
+#include <optional>
+#include <vector>
+#include <Rtypes.h>
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloRawFitter.h"
+
+namespace o2
+{
+
+namespace emcal
+{
+
+/// \class CaloRawFitterGamma2Batch
+/// \brief  Raw data fitting: Gamma-2 function, many channels at once
+/// \ingroup EMCALreconstruction
+/// \since June 2021
+///
+/// Same algorithm and results as CaloRawFitterGamma2, but the channels of a readout
+/// are first collected with addChannel (selection of the bunch, pedestal subtraction
+/// and parabola pre-fit are done here), and then fitted together with fitBatch:
+/// the padded samples of LANES channels are stored in structure-of-arrays buffers
+/// and the Newton iterations run over all lanes in the same branch-free loops. Each
+/// lane has its own convergence: a lane whose fit converged or failed is refilled with
+/// the next pending channel.
+///
+/// Usage:
+///   fitter.clear();
+///   for (auto& chan : channels) fitter.addChannel(chan.getBunches(), cfg1, cfg2);
+///   fitter.fitBatch();
+///   for (int i = 0; i < fitter.getNChannels(); i++) auto res = fitter.getResult(i); // throws like evaluate
+class CaloRawFitterGamma2Batch final : public CaloRawFitter
+{
+
+ public:
+  static constexpr int LANES = 8; ///< number of channels fitted in the same loops
+
+  /// \brief Constructor
+  CaloRawFitterGamma2Batch();
+
+  /// \brief Destructor
+  ~CaloRawFitterGamma2Batch() final = default;
+
+  void setNiterationsMax(int n) { mNiterationsMax = n; }
+  int getNiterationsMax() { return mNiterationsMax; }
+
+  /// \brief Evaluation Amplitude and TOF of a single channel, via the batch engine
+  /// \param bunchvector ALTRO bunches for the current channel
+  /// \param altrocfg1 ALTRO config register 1 from RCU trailer
+  /// \param altrocfg2 ALTRO config register 2 from RCU trailer
+  /// \throw RawFitterError_t::FIT_ERROR in case the peak fit failed
+  /// \return Container with the fit results (amp, time, chi2, ...)
+  CaloFitResults evaluate(const gsl::span<const Bunch> bunchvector,
+                          std::optional<unsigned int> altrocfg1,
+                          std::optional<unsigned int> altrocfg2) final;
+
+  /// \brief Remove all channels of the previous batch
+  void clear();
+
+  /// \brief Add channel to the batch, to be fitted with the next call of fitBatch
+  ///
+  /// Errors in the selection of the bunch are not thrown here but by getResult for this channel
+  /// \param bunchvector ALTRO bunches for the current channel
+  /// \param altrocfg1 ALTRO config register 1 from RCU trailer
+  /// \param altrocfg2 ALTRO config register 2 from RCU trailer
+  /// \return Index of the channel in the batch
+  int addChannel(const gsl::span<const Bunch> bunchvector,
+                 std::optional<unsigned int> altrocfg1,
+                 std::optional<unsigned int> altrocfg2);
+
+  /// \brief Fit all channels added since the last clear
+  void fitBatch();
+
+  /// \brief Number of channels in the batch
+  int getNChannels() const { return mChannels.size(); }
+
+  /// \brief Fit results of a channel of the batch, after fitBatch
+  /// \param index Index of the channel returned by addChannel
+  /// \throw RawFitterError_t in case the bunch selection or the peak fit failed
+  /// \return Container with the fit results (amp, time, chi2, ...)
+  CaloFitResults getResult(int index) const;
+
+ private:
+  /// \struct ChannelInfo
+  /// \brief Pre-fit estimates of a channel
+  struct ChannelInfo {
+    float mAmpEstimate = 0;                 ///< max. amplitude after pedestal subtraction
+    float mPedestal = 0;                    ///< pedestal
+    short mMaxADC = 0;                      ///< max. ADC value
+    short mTimeEstimate = 0;                ///< time bin of the max. amplitude
+    int mTimebinOffset = 0;                 ///< offset of the time bins of the selected bunch
+    int mNsamples = 0;                      ///< number of samples used in the fit
+    int mFitIndex = -1;                     ///< slot in the fit buffers, -1 if no fit is needed
+    bool mValid = false;                    ///< significant signal found
+    std::optional<RawFitterError_t> mError; ///< error in the bunch selection
+  };
+
+  int mNiterationsMax = 15;           ///< max number of iteraions
+  std::vector<ChannelInfo> mChannels; ///<! channels of the batch
+  std::vector<int> mFitNsamples;      ///<! number of samples per fit slot
+  std::vector<double> mSamples;       ///<! samples of the fit slots, padded to EMCAL_MAXTIMEBINS: [slot][sample]
+  std::vector<float> mFitAmp;         ///<! amplitude per fit slot (start value and result)
+  std::vector<float> mFitTime;        ///<! time per fit slot (start value and result)
+  std::vector<float> mFitChi2;        ///<! chi2 per fit slot
+  std::vector<char> mFitOK;           ///<! fit converged, per fit slot
+
+  ClassDefNV(CaloRawFitterGamma2Batch, 1);
+}; // End of CaloRawFitterGamma2Batch
+
+} // namespace emcal
+
+} // namespace o2
+#endif
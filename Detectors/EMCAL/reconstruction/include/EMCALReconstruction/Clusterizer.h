@@ -15,11 +15,14 @@
 #define ALICEO2_EMCAL_CLUSTERIZER_H
 
 #include <array>
+#include <cstdint>
+#include <vector>
 #include <gsl/span>
 #include "Rtypes.h"
 #include "DataFormatsEMCAL/Cluster.h"
 #include "DataFormatsEMCAL/Digit.h"
 #include "DataFormatsEMCAL/Cell.h"
+#include "DataFormatsEMCAL/TriggerRecord.h"
 #include "EMCALBase/Geometry.h"
 
 namespace o2
@@ -41,6 +44,12 @@ using ClusterIndex = int;
 ///
 ///  Implementation of same algorithm version as in AliEMCALClusterizerv2,
 ///  but optimized.
+///
+///  The cost per event scales with the number of filled cells: only the cells filled
+///  in the previous event are reset in the topological maps, only cells above the seed
+///  threshold enter the sorted seed list, and the neighbours of a cell which are filled
+///  and not yet clustered are obtained from per-row bitmasks. The clusters are grown with
+///  an explicit stack, in the same order as the original recursive search.
 
 template <class InputType>
 class Clusterizer
@@ -59,10 +68,20 @@ class Clusterizer
   };
 
   struct InputwithIndex {
-    InputType* mInput;
+    const InputType* mInput;
     ClusterIndex mIndex;
   };
 
+  /// state of a cell in the iterative neighbour search: next direction to be checked
+  struct SearchFrame {
+    int row;
+    int column;
+    int nextDir;
+  };
+
+  static constexpr int NWORDS = (NCOLS + 63) / 64; ///< 64-bit words per row of the bitmasks
+  using RowMask = std::array<uint64_t, NWORDS>;
+
  public:
   Clusterizer(double timeCut, double timeMin, double timeMax, double gradientCut, bool doEnergyGradientCut, double thresholdSeedE, double thresholdCellE);
   Clusterizer();
@@ -75,18 +94,38 @@ class Clusterizer
   }
   void initialize(double timeCut, double timeMin, double timeMax, double gradientCut, bool doEnergyGradientCut, double thresholdSeedE, double thresholdCellE);
   void findClusters(const gsl::span<InputType const>& inputArray);
+  /// \brief Clusterize several events in one call, appending to the output containers
+  /// \param inputArray cells/digits of all events
+  /// \param triggers ranges of the events in inputArray
+  /// \param clusters output clusters, cell/digit index ranges relative to the trigger in indexTriggers
+  /// \param inputIndices output cell/digit indices, relative to the first cell/digit of the event
+  /// \param clusterTriggers ranges of the clusters of each event in clusters
+  /// \param indexTriggers ranges of the indices of each event in inputIndices
+  void findClustersBatch(const gsl::span<InputType const>& inputArray, const gsl::span<const TriggerRecord>& triggers,
+                         std::vector<Cluster>& clusters, std::vector<ClusterIndex>& inputIndices,
+                         std::vector<TriggerRecord>& clusterTriggers, std::vector<TriggerRecord>& indexTriggers);
   const std::vector<Cluster>* getFoundClusters() const { return &mFoundClusters; }
   const std::vector<ClusterIndex>* getFoundClustersInputIndices() const { return &mInputIndices; }
   void setGeometry(Geometry* geometry) { mEMCALGeometry = geometry; }
   Geometry* getGeometry() { return mEMCALGeometry; }
 
  private:
+  void findClustersEvent(const gsl::span<InputType const>& inputArray, std::vector<Cluster>& clusters, std::vector<ClusterIndex>& inputIndices);
   void getClusterFromNeighbours(std::vector<InputwithIndex>& clusterUnputs, int row, int column);
   void getTopologicalRowColumn(const InputType& input, int& row, int& column);
+  void resetMaps();
+  bool isFree(int row, int column) const { return (mFreeMask[row][column >> 6] >> (column & 63)) & 1; }
+  void setFree(int row, int column) { mFreeMask[row][column >> 6] |= uint64_t(1) << (column & 63); }
+  void setClustered(int row, int column) { mFreeMask[row][column >> 6] &= ~(uint64_t(1) << (column & 63)); }
+  /// \brief Filled and not yet clustered neighbours of a cell, bit i for direction i
+  unsigned int getFreeNeighbours(int row, int column) const;
   Geometry* mEMCALGeometry = nullptr;                             //!<! pointer to geometry for utilities
-  std::array<cellWithE, NROWS * NCOLS> mSeedList;                 //!<! seed array
+  std::vector<cellWithE> mSeedList;                               //!<! seed candidates above the seed threshold
+  std::vector<int> mFilledCells;                                  //!<! row * NCOLS + column of the cells filled in the maps
+  std::vector<SearchFrame> mSearchStack;                          //!<! stack of the neighbour search
+  std::vector<InputwithIndex> mClusterInputs;                     //!<! cells/digits of the current cluster
   std::array<std::array<InputwithIndex, NCOLS>, NROWS> mInputMap; //!<! topology arrays
-  std::array<std::array<bool, NCOLS>, NROWS> mCellMask;           //!<! topology arrays
+  std::array<RowMask, NROWS> mFreeMask;                           //!<! bitmask of filled and not yet clustered cells
 
   std::vector<Cluster> mFoundClusters;     ///<  vector of cluster objects
   std::vector<ClusterIndex> mInputIndices; ///<  vector of associated cell/digit tower ID, ordered by cluster
@@ -98,7 +137,7 @@ class Clusterizer
   bool mDoEnergyGradientCut;   ///<  cut on energy gradient
   double mThresholdSeedEnergy; ///<  minimum energy to seed a EC digit/cell in a cluster
   double mThresholdCellEnergy; ///<  minimum energy for a digit/cell to be a member of a cluster
-  ClassDefNV(Clusterizer, 1);
+  ClassDefNV(Clusterizer, 2);
 };
 
 using ClusterizerDigits = Clusterizer<Digit>;
@@ -14,6 +14,7 @@
 
 #include "FairLogger.h"
 #include <gsl/span>
+#include <cfloat>
 
 // ROOT sytem
 #include "TMath.h"
@@ -328,3 +329,27 @@ std::tuple<int, int, float, short, short, float, int, int> CaloRawFitter::preFit
 
   return std::make_tuple(nsamples, index, maxf, maxamp, maxrev, ped, first, last);
 }
+
+std::tuple<float, float> CaloRawFitter::doParabolaFit(int maxTimeBin) const
+{
+  float amp(0.), time(0.);
+
+  // The equation of parabola is "y = a*x^2 + b*x + c"
+  // We have to find "a", "b", and "c"
+
+  double a = (getReversed(maxTimeBin + 2) + getReversed(maxTimeBin) - 2. * getReversed(maxTimeBin + 1)) / 2.;
+
+  if (TMath::Abs(a) < DBL_EPSILON) {
+    amp = getReversed(maxTimeBin + 1);
+    time = maxTimeBin + 1;
+    return std::make_tuple(amp, time);
+  }
+
+  double b = getReversed(maxTimeBin + 1) - getReversed(maxTimeBin) - a * (2. * maxTimeBin + 1);
+  double c = getReversed(maxTimeBin) - b * maxTimeBin - a * maxTimeBin * maxTimeBin;
+
+  time = -b / 2. / a;
+  amp = a * time * time + b * time + c;
+
+  return std::make_tuple(amp, time);
+}
@@ -157,27 +157,3 @@ float CaloRawFitterGamma2::doFit_1peak(int firstTimeBin, int nSamples, float& am
 
   return chi2;
 }
-
-std::tuple<float, float> CaloRawFitterGamma2::doParabolaFit(int maxTimeBin) const
-{
-  float amp(0.), time(0.);
-
-  // The equation of parabola is "y = a*x^2 + b*x + c"
-  // We have to find "a", "b", and "c"
-
-  double a = (getReversed(maxTimeBin + 2) + getReversed(maxTimeBin) - 2. * getReversed(maxTimeBin + 1)) / 2.;
-
-  if (TMath::Abs(a) < DBL_EPSILON) {
-    amp = getReversed(maxTimeBin + 1);
-    time = maxTimeBin + 1;
-    return std::make_tuple(amp, time);
-  }
-
-  double b = getReversed(maxTimeBin + 1) - getReversed(maxTimeBin) - a * (2. * maxTimeBin + 1);
-  double c = getReversed(maxTimeBin) - b * maxTimeBin - a * maxTimeBin * maxTimeBin;
-
-  time = -b / 2. / a;
-  amp = a * time * time + b * time + c;
-
-  return std::make_tuple(amp, time);
-}
@@ -0,0 +1,247 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CaloRawFitterGamma2Batch.cxx
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <tuple>
+
+// ROOT sytem
+#include "TMath.h"
+
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "DataFormatsEMCAL/Constants.h"
+
+#include "EMCALReconstruction/CaloRawFitterGamma2Batch.h"
+
+using namespace o2::emcal;
+
+CaloRawFitterGamma2Batch::CaloRawFitterGamma2Batch() : CaloRawFitter("Chi Square ( Gamma2 )", "Gamma2")
+{
+  mAlgo = FitAlgorithm::Gamma2;
+}
+
+CaloFitResults CaloRawFitterGamma2Batch::evaluate(const gsl::span<const Bunch> bunchlist,
+                                                  std::optional<unsigned int> altrocfg1, std::optional<unsigned int> altrocfg2)
+{
+  clear();
+  addChannel(bunchlist, altrocfg1, altrocfg2);
+  fitBatch();
+  return getResult(0);
+}
+
+void CaloRawFitterGamma2Batch::clear()
+{
+  mChannels.clear();
+  mFitNsamples.clear();
+  mSamples.clear();
+  mFitAmp.clear();
+  mFitTime.clear();
+  mFitChi2.clear();
+  mFitOK.clear();
+}
+
+int CaloRawFitterGamma2Batch::addChannel(const gsl::span<const Bunch> bunchlist,
+                                         std::optional<unsigned int> altrocfg1, std::optional<unsigned int> altrocfg2)
+{
+  ChannelInfo info;
+  std::tuple<int, int, float, short, short, float, int, int> prefit;
+  try {
+    prefit = preFitEvaluateSamples(bunchlist, altrocfg1, altrocfg2, mAmpCut);
+  } catch (RawFitterError_t& e) {
+    // kept for getResult, the channel is not fitted
+    info.mError = e;
+    mChannels.push_back(info);
+    return mChannels.size() - 1;
+  }
+  auto [nsamples, bunchIndex, ampEstimate,
+        maxADC, timeEstimate, pedEstimate, first, last] = prefit;
+  info.mAmpEstimate = ampEstimate;
+  info.mPedestal = pedEstimate;
+  info.mMaxADC = maxADC;
+  info.mTimeEstimate = timeEstimate;
+  info.mNsamples = nsamples;
+
+  if (bunchIndex >= 0 && ampEstimate >= mAmpCut) {
+    info.mValid = true;
+    info.mTimebinOffset = bunchlist[bunchIndex].getStartTime() - (bunchlist[bunchIndex].getBunchLength() - 1);
+    if (nsamples > 2 && maxADC < constants::OVERFLOWCUT) {
+      // book a fit slot with the samples used by the fit and the start values from the parabola fit
+      info.mFitIndex = mFitNsamples.size();
+      mSamples.insert(mSamples.end(), mReversed.begin(), mReversed.begin() + nsamples);
+      mSamples.resize(mSamples.size() + constants::EMCAL_MAXTIMEBINS - nsamples, 0.);
+      auto [amp, time] = doParabolaFit(timeEstimate - 1);
+      mFitNsamples.push_back(nsamples);
+      mFitAmp.push_back(amp);
+      mFitTime.push_back(time);
+    }
+  }
+  mChannels.push_back(info);
+  return mChannels.size() - 1;
+}
+
+void CaloRawFitterGamma2Batch::fitBatch()
+{
+  // Same Newton iterations as CaloRawFitterGamma2::doFit_1peak, for LANES fit slots at once.
+  // A lane is released once its fit converged or failed and then refilled with the next pending slot,
+  // such that the lanes stay busy independent of the number of iterations needed by each fit.
+  const int nslots = mFitNsamples.size();
+  mFitChi2.assign(nslots, 0.);
+  mFitOK.assign(nslots, false);
+
+  double sig[constants::EMCAL_MAXTIMEBINS][LANES] = {{0}}; // samples of the lanes
+  float ampl[LANES] = {0}, time[LANES] = {0}, chi2[LANES] = {0};
+  int nsamples[LANES] = {0}, niter[LANES] = {0}, slot[LANES];
+  std::fill(slot, slot + LANES, -1);
+  int nextSlot = 0;
+
+  while (true) {
+    // fill the free lanes
+    int nactive = 0, maxsamples = 0;
+    for (int ilane = 0; ilane < LANES; ilane++) {
+      if (slot[ilane] < 0 && nextSlot < nslots) {
+        slot[ilane] = nextSlot++;
+        const double* samples = &mSamples[slot[ilane] * constants::EMCAL_MAXTIMEBINS];
+        for (int itbin = 0; itbin < constants::EMCAL_MAXTIMEBINS; itbin++) {
+          sig[itbin][ilane] = samples[itbin];
+        }
+        ampl[ilane] = mFitAmp[slot[ilane]];
+        time[ilane] = mFitTime[slot[ilane]];
+        nsamples[ilane] = mFitNsamples[slot[ilane]];
+        niter[ilane] = 0;
+      }
+      if (slot[ilane] >= 0) {
+        nactive++;
+        maxsamples = std::max(maxsamples, nsamples[ilane]);
+      }
+    }
+    if (!nactive) {
+      break;
+    }
+
+    double c11[LANES] = {0}, c12[LANES] = {0}, c21[LANES] = {0}, c22[LANES] = {0}, d1[LANES] = {0}, d2[LANES] = {0};
+    float chi2iter[LANES] = {0};
+    for (int itbin = 0; itbin < maxsamples; itbin++) {
+      // branch-free over the lanes, samples outside of the fit range and free lanes are not used
+      for (int ilane = 0; ilane < LANES; ilane++) {
+        double ti = (itbin - time[ilane]) / constants::TAU;
+        bool use = itbin < nsamples[ilane] && (ti + 1) >= 0;
+        double expo = TMath::Exp(-2 * ti); // as in the scalar fit, such that the results are identical
+        double g_1i = (ti + 1) * expo;
+        double g_i = (ti + 1) * g_1i;
+        double gp_i = 2 * (g_i - g_1i);
+        double q1_i = (2 * ti + 1) * expo;
+        double q2_i = g_1i * g_1i * (4 * ti + 1);
+        double delta = ampl[ilane] * g_i - sig[itbin][ilane];
+        c11[ilane] += use ? (sig[itbin][ilane] - ampl[ilane] * 2 * g_i) * gp_i : 0.;
+        c12[ilane] += use ? g_i * g_i : 0.;
+        c21[ilane] += use ? sig[itbin][ilane] * q1_i - ampl[ilane] * q2_i : 0.;
+        c22[ilane] += use ? g_i * g_1i : 0.;
+        d1[ilane] += use ? delta * g_i : 0.;
+        d2[ilane] += use ? delta * g_1i : 0.;
+        chi2iter[ilane] = use ? chi2iter[ilane] + delta * delta : chi2iter[ilane];
+      }
+    }
+
+    for (int ilane = 0; ilane < LANES; ilane++) {
+      if (slot[ilane] < 0) {
+        continue;
+      }
+      bool done = true, converged = false;
+      double D = c11[ilane] * c22[ilane] - c12[ilane] * c21[ilane];
+      if (TMath::Abs(D) >= DBL_EPSILON) {
+        double dt = (d1[ilane] * c22[ilane] - d2[ilane] * c12[ilane]) / D * constants::TAU;
+        double dA = (d1[ilane] * c21[ilane] - d2[ilane] * c11[ilane]) / D;
+        time[ilane] += dt;
+        ampl[ilane] += dA;
+        chi2[ilane] = chi2iter[ilane];
+        converged = !(TMath::Abs(dA) > 1 || TMath::Abs(dt) > 0.01);
+        // another iteration is needed, provided the max number is not exceeded (fit error otherwise)
+        done = converged || ++niter[ilane] > mNiterationsMax;
+      }
+      if (done) {
+        mFitAmp[slot[ilane]] = ampl[ilane];
+        mFitTime[slot[ilane]] = time[ilane];
+        mFitChi2[slot[ilane]] = chi2[ilane];
+        mFitOK[slot[ilane]] = converged;
+        slot[ilane] = -1;
+        nsamples[ilane] = 0;
+      }
+    }
+  }
+}
+
+CaloFitResults CaloRawFitterGamma2Batch::getResult(int index) const
+{
+  // same post-processing of the fit results as in CaloRawFitterGamma2::evaluate
+  const auto& info = mChannels[index];
+  if (info.mError) {
+    throw info.mError.value();
+  }
+  float time = 0;
+  float amp = 0;
+  float chi2 = 0;
+  int ndf = 0;
+  bool fitDone = false;
+  short timeEstimate = info.mTimeEstimate;
+  float ampEstimate = info.mAmpEstimate;
+
+  if (info.mValid) {
+    time = timeEstimate;
+    amp = ampEstimate;
+
+    if (info.mFitIndex >= 0) {
+      if (mFitOK[info.mFitIndex]) {
+        amp = mFitAmp[info.mFitIndex];
+        time = mFitTime[info.mFitIndex];
+        chi2 = mFitChi2[info.mFitIndex];
+        fitDone = true;
+      } else {
+        // Fit has failed, set values to estimates
+        amp = ampEstimate;
+        time = timeEstimate;
+        chi2 = 1.e9;
+      }
+
+      time += info.mTimebinOffset;
+      timeEstimate += info.mTimebinOffset;
+      ndf = info.mNsamples - 2;
+    }
+  }
+
+  if (fitDone) {
+    float ampAsymm = (amp - ampEstimate) / (amp + ampEstimate);
+    float timeDiff = time - timeEstimate;
+
+    if ((TMath::Abs(ampAsymm) > 0.1) || (TMath::Abs(timeDiff) > 2)) {
+      amp = ampEstimate;
+      time = timeEstimate;
+      fitDone = false;
+    }
+  }
+  if (amp >= mAmpCut) {
+    if (!fitDone) {
+      std::default_random_engine generator;
+      std::uniform_real_distribution<float> distribution(0.0, 1.0);
+      amp += (0.5 - distribution(generator));
+    }
+    time = time * constants::EMCAL_TIMESAMPLE;
+    time -= mL1Phase;
+
+    return CaloFitResults(info.mMaxADC, info.mPedestal, mAlgo, amp, time, (int)time, chi2, ndf);
+  }
+  // Fit failed, rethrow error
+  throw RawFitterError_t::FIT_ERROR;
+}
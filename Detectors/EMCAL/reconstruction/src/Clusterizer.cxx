@@ -11,6 +11,7 @@
 
 /// \file Clusterizer.cxx
 /// \brief Implementation of the EMCAL clusterizer
+#include <algorithm>
 #include <cstring>
 #include <gsl/span>
 #include "FairLogger.h" // for LOG
@@ -22,7 +23,7 @@ using namespace o2::emcal;
 /// Constructor
 //____________________________________________________________________________
 template <class InputType>
-Clusterizer<InputType>::Clusterizer(double timeCut, double timeMin, double timeMax, double gradientCut, bool doEnergyGradientCut, double thresholdSeedE, double thresholdCellE) : mSeedList(), mInputMap(), mCellMask(), mTimeCut(timeCut), mTimeMin(timeMin), mTimeMax(timeMax), mGradientCut(gradientCut), mDoEnergyGradientCut(doEnergyGradientCut), mThresholdSeedEnergy(thresholdSeedE), mThresholdCellEnergy(thresholdCellE)
+Clusterizer<InputType>::Clusterizer(double timeCut, double timeMin, double timeMax, double gradientCut, bool doEnergyGradientCut, double thresholdSeedE, double thresholdCellE) : mSeedList(), mFilledCells(), mSearchStack(), mClusterInputs(), mInputMap(), mFreeMask(), mTimeCut(timeCut), mTimeMin(timeMin), mTimeMax(timeMax), mGradientCut(gradientCut), mDoEnergyGradientCut(doEnergyGradientCut), mThresholdSeedEnergy(thresholdSeedE), mThresholdCellEnergy(thresholdCellE)
 {
 }
 
@@ -30,7 +31,7 @@ Clusterizer<InputType>::Clusterizer(double timeCut, double timeMin, double timeM
 /// Default constructor
 //____________________________________________________________________________
 template <class InputType>
-Clusterizer<InputType>::Clusterizer() : mSeedList(), mInputMap(), mCellMask(), mTimeCut(0), mTimeMin(0), mTimeMax(0), mGradientCut(0), mDoEnergyGradientCut(false), mThresholdSeedEnergy(0), mThresholdCellEnergy(0)
+Clusterizer<InputType>::Clusterizer() : mSeedList(), mFilledCells(), mSearchStack(), mClusterInputs(), mInputMap(), mFreeMask(), mTimeCut(0), mTimeMin(0), mTimeMax(0), mGradientCut(0), mDoEnergyGradientCut(false), mThresholdSeedEnergy(0), mThresholdCellEnergy(0)
 {
 }
 
@@ -50,41 +51,75 @@ void Clusterizer<InputType>::initialize(double timeCut, double timeMin, double t
 }
 
 ///
-/// Recursively search for neighbours (EMCAL)
+/// Filled and not yet clustered neighbours, in the order of the search directions
 //____________________________________________________________________________
 template <class InputType>
-void Clusterizer<InputType>::getClusterFromNeighbours(std::vector<InputwithIndex>& clusterInputs, int row, int column)
+unsigned int Clusterizer<InputType>::getFreeNeighbours(int row, int column) const
 {
-  // Recursion 0, add seed cell/digit to cluster
-  if (!clusterInputs.size()) {
-    clusterInputs.emplace_back(mInputMap[row][column]);
+  unsigned int neighbours = 0;
+  if (row > 0) {
+    neighbours |= static_cast<unsigned int>(isFree(row - 1, column));
   }
+  if (column > 0) {
+    neighbours |= static_cast<unsigned int>(isFree(row, column - 1)) << 1;
+  }
+  if (column + 1 < NCOLS) {
+    neighbours |= static_cast<unsigned int>(isFree(row, column + 1)) << 2;
+  }
+  if (row + 1 < NROWS) {
+    neighbours |= static_cast<unsigned int>(isFree(row + 1, column)) << 3;
+  }
+  return neighbours;
+}
 
-  // Mark the current cell as clustered
-  mCellMask[row][column] = kTRUE;
-
-  // Now go recursively to the next 4 neighbours and add them to the cluster if they fulfill the conditions
+///
+/// Search for neighbours (EMCAL)
+//____________________________________________________________________________
+template <class InputType>
+void Clusterizer<InputType>::getClusterFromNeighbours(std::vector<InputwithIndex>& clusterInputs, int row, int column)
+{
+  // Depth-first search with an explicit stack, visiting the cells/digits in the same order
+  // as the former recursive implementation: the seed is added first, any other cell/digit
+  // after all cells/digits reached from it.
   constexpr int rowDiffs[4] = {-1, 0, 0, 1};
   constexpr int colDiffs[4] = {0, -1, 1, 0};
-  for (int dir = 0; dir < 4; dir++) {
-    if ((row + rowDiffs[dir] < 0) || (row + rowDiffs[dir] >= NROWS)) {
-      continue;
-    }
-    if ((column + colDiffs[dir] < 0) || (column + colDiffs[dir] >= NCOLS)) {
-      continue;
-    }
 
-    if (mInputMap[row + rowDiffs[dir]][column + colDiffs[dir]].mInput) {
-      if (!mCellMask[row + rowDiffs[dir]][column + colDiffs[dir]]) {
-        if (mDoEnergyGradientCut && not(mInputMap[row + rowDiffs[dir]][column + colDiffs[dir]].mInput->getEnergy() > mInputMap[row][column].mInput->getEnergy() + mGradientCut)) {
-          if (not(TMath::Abs(mInputMap[row + rowDiffs[dir]][column + colDiffs[dir]].mInput->getTimeStamp() - mInputMap[row][column].mInput->getTimeStamp()) > mTimeCut)) {
-            getClusterFromNeighbours(clusterInputs, row + rowDiffs[dir], column + colDiffs[dir]);
-            // Add the cell/digit to the current cluster -- if we end up here, the selected cluster fulfills the condition
-            clusterInputs.emplace_back(mInputMap[row + rowDiffs[dir]][column + colDiffs[dir]]);
-          }
+  // Add seed cell/digit to cluster and mark it as clustered
+  clusterInputs.emplace_back(mInputMap[row][column]);
+  setClustered(row, column);
+  mSearchStack.clear();
+  mSearchStack.push_back({row, column, 0});
+
+  while (mSearchStack.size()) {
+    auto& current = mSearchStack.back();
+    const auto* currentInput = mInputMap[current.row][current.column].mInput;
+    // Go to the next of the 4 neighbours fulfilling the conditions
+    auto freeNeighbours = getFreeNeighbours(current.row, current.column);
+    int next = -1;
+    for (int dir = current.nextDir; dir < 4 && next < 0; dir++) {
+      if (!((freeNeighbours >> dir) & 1)) {
+        continue;
+      }
+      const auto* neighbourInput = mInputMap[current.row + rowDiffs[dir]][current.column + colDiffs[dir]].mInput;
+      if (mDoEnergyGradientCut && not(neighbourInput->getEnergy() > currentInput->getEnergy() + mGradientCut)) {
+        if (not(TMath::Abs(neighbourInput->getTimeStamp() - currentInput->getTimeStamp()) > mTimeCut)) {
+          next = dir;
         }
       }
     }
+    if (next >= 0) {
+      current.nextDir = next + 1;
+      int nextRow = current.row + rowDiffs[next], nextColumn = current.column + colDiffs[next];
+      setClustered(nextRow, nextColumn);
+      mSearchStack.push_back({nextRow, nextColumn, 0}); // invalidates current
+      continue;
+    }
+    // All neighbours done: add the cell/digit to the current cluster (the seed is already in)
+    auto done = mSearchStack.back();
+    mSearchStack.pop_back();
+    if (mSearchStack.size()) {
+      clusterInputs.emplace_back(mInputMap[done.row][done.column]);
+    }
   }
 }
 
@@ -119,6 +154,20 @@ void Clusterizer<InputType>::getTopologicalRowColumn(const InputType& input, int
   }
 }
 
+///
+/// Reset the cells/digits filled in the previous event in the maps and masks
+//____________________________________________________________________________
+template <class InputType>
+void Clusterizer<InputType>::resetMaps()
+{
+  for (auto cell : mFilledCells) {
+    int row = cell / NCOLS, column = cell % NCOLS;
+    mInputMap[row][column] = {nullptr, -1};
+    setClustered(row, column);
+  }
+  mFilledCells.clear();
+}
+
 ///
 /// Return number of found clusters. Start clustering from highest energy cell.
 //____________________________________________________________________________
@@ -126,33 +175,58 @@ template <class InputType>
 void Clusterizer<InputType>::findClusters(const gsl::span<InputType const>& inputArray)
 {
   clear();
+  findClustersEvent(inputArray, mFoundClusters, mInputIndices);
+}
+
+///
+/// Find clusters of several events, appending to the output containers
+//____________________________________________________________________________
+template <class InputType>
+void Clusterizer<InputType>::findClustersBatch(const gsl::span<InputType const>& inputArray, const gsl::span<const TriggerRecord>& triggers,
+                                               std::vector<Cluster>& clusters, std::vector<ClusterIndex>& inputIndices,
+                                               std::vector<TriggerRecord>& clusterTriggers, std::vector<TriggerRecord>& indexTriggers)
+{
+  for (const auto& trg : triggers) {
+    int currentStartClusters = clusters.size();
+    int currentStartIndices = inputIndices.size();
+    if (inputArray.size() && trg.getNumberOfObjects()) {
+      findClustersEvent(inputArray.subspan(trg.getFirstEntry(), trg.getNumberOfObjects()), clusters, inputIndices);
+    }
+    clusterTriggers.emplace_back(trg.getBCData(), currentStartClusters, clusters.size() - currentStartClusters);
+    indexTriggers.emplace_back(trg.getBCData(), currentStartIndices, inputIndices.size() - currentStartIndices);
+  }
+}
 
+///
+/// Find clusters of one event. The cluster ranges refer to the indices added in this call
+//____________________________________________________________________________
+template <class InputType>
+void Clusterizer<InputType>::findClustersEvent(const gsl::span<InputType const>& inputArray, std::vector<Cluster>& clusters, std::vector<ClusterIndex>& inputIndices)
+{
   // Algorithm
   // - Fill cells/digits in 2D topological map
-  // - Fill struct arrays (energy,x,y)  (to get mapping energy -> (x,y))
-  // - Create 2D bitmap (cell/digit is already clustered or not)
+  // - Fill struct arrays (energy,x,y) of seed candidates (to get mapping energy -> (x,y))
+  // - Fill 2D bitmap (cell/digit is filled and not yet clustered)
   // - Sort struct arrays with descending energy
   //
   // - Loop over arrays:
   // --> Check 2D bitmap (don't use cell/digit which are already clustered)
   // --> Take valid cell/digit with highest energy as seed (they are already sorted)
-  // --> Recursive to neighboughs and create cluster
-  // --> Seed cell and all neighbours belonging to cluster will be put in 2D bitmap
-
-  // Reset cell/digit maps and cell masks
-  // Loop over one array dim, then reset each array
-  for (auto iArr = 0; iArr < NROWS; iArr++) {
-    mCellMask[iArr].fill(kFALSE);
-    mInputMap[iArr].fill({nullptr, -1});
-  }
+  // --> Search neighbours and create cluster
+  // --> Seed cell and all neighbours belonging to cluster will be removed from 2D bitmap
+
+  // Reset cell/digit maps and cell masks, only where filled in the previous event
+  resetMaps();
+  mSeedList.clear();
+  int firstCluster = clusters.size();
+  int firstIndex = inputIndices.size();
 
   // Calibrate cells/digits and fill the maps/arrays
   int nCells = 0;
   double ehs = 0.0;
-  //for (auto dig : inputArray) {
   for (int iIndex = 0; iIndex < inputArray.size(); iIndex++) {
 
-    auto dig = inputArray[iIndex];
+    const auto& dig = inputArray[iIndex];
 
     Float_t inputEnergy = dig.getEnergy();
     Float_t time = dig.getTimeStamp();
@@ -168,44 +242,43 @@ void Clusterizer<InputType>::findClusters(const gsl::span<InputType const>& inpu
     // Put cell/digit to 2D map
     int row = 0, column = 0;
     getTopologicalRowColumn(dig, row, column);
-    mInputMap[row][column].mInput = &dig;   // mInputMap saves pointers to cells/digits, therefore use addr operator here
+    mInputMap[row][column].mInput = &dig;   // mInputMap saves pointers to cells/digits in the input array
     mInputMap[row][column].mIndex = iIndex; // mInputMap saves the position of cells/digits in the input array
-    mSeedList[nCells].energy = inputEnergy;
-    mSeedList[nCells].row = row;
-    mSeedList[nCells].column = column;
+    setFree(row, column);
+    mFilledCells.emplace_back(row * NCOLS + column);
+    // Only cells/digits fulfilling the energy constraint can seed a cluster
+    if (inputEnergy > mThresholdSeedEnergy) {
+      mSeedList.emplace_back(inputEnergy, row, column);
+    }
     nCells++;
   }
 
   // Sort struct arrays with ascending energy
-  std::sort(mSeedList.begin(), std::next(std::begin(mSeedList), nCells));
+  std::sort(mSeedList.begin(), mSeedList.end());
 
   // Take next valid cell/digit in calorimeter as seed (in descending energy order)
-  for (int i = nCells; i--;) {
+  for (int i = mSeedList.size(); i--;) {
     int row = mSeedList[i].row, column = mSeedList[i].column;
     // Continue if the cell is already masked (i.e. was already clustered)
-    if (mCellMask[row][column]) {
-      continue;
-    }
-    // Continue if energy constraints are not fulfilled
-    if (mSeedList[i].energy <= mThresholdSeedEnergy) {
+    if (!isFree(row, column)) {
       continue;
     }
 
-    // Seed is found, form cluster recursively
-    std::vector<InputwithIndex> clusterInputs;
-    getClusterFromNeighbours(clusterInputs, row, column);
+    // Seed is found, form cluster
+    mClusterInputs.clear();
+    getClusterFromNeighbours(mClusterInputs, row, column);
 
     // Add cells/digits for current cluster to cell/digit index vector
-    int inputIndexStart = mInputIndices.size();
-    for (auto dig : clusterInputs) {
-      mInputIndices.emplace_back(dig.mIndex);
+    int inputIndexStart = inputIndices.size();
+    for (const auto& dig : mClusterInputs) {
+      inputIndices.emplace_back(dig.mIndex);
     }
-    int inputIndexSize = mInputIndices.size() - inputIndexStart;
+    int inputIndexSize = inputIndices.size() - inputIndexStart;
 
     // Now form cluster object from cells/digits
-    mFoundClusters.emplace_back(mInputMap[row][column].mInput->getTimeStamp(), inputIndexStart, inputIndexSize); // Cluster object initialized w/ time of seed cell, start + size of associated cells
+    clusters.emplace_back(mInputMap[row][column].mInput->getTimeStamp(), inputIndexStart - firstIndex, inputIndexSize); // Cluster object initialized w/ time of seed cell, start + size of associated cells
   }
-  LOG(DEBUG) << mFoundClusters.size() << "clusters found from " << nCells << " cells/digits (total=" << inputArray.size() << ")-> ehs " << ehs << " (minE " << mThresholdCellEnergy << ")";
+  LOG(DEBUG) << clusters.size() - firstCluster << "clusters found from " << nCells << " cells/digits (total=" << inputArray.size() << ")-> ehs " << ehs << " (minE " << mThresholdCellEnergy << ")";
 }
 
 template class o2::emcal::Clusterizer<o2::emcal::Cell>;
@@ -100,25 +100,9 @@ void ClusterizerTask<InputType>::process(const std::string inputFileName, const
 
     auto InputVector = mInputReader->getInputArray();
 
-    int currentStartClusters = mClustersArray->size();
-    int currentStartIndices = mClustersInputIndices->size();
-
-    for (auto iTrgRcrd = mInputReader->getTriggerArray()->begin(); iTrgRcrd != mInputReader->getTriggerArray()->end(); ++iTrgRcrd) {
-
-      mClusterizer.findClusters(gsl::span<const InputType>(InputVector->data() + iTrgRcrd->getFirstEntry(), iTrgRcrd->getNumberOfObjects())); // Find clusters on cells/digits given in reader::mInputArray (pass by ref)
-
-      // Get found clusters + cell/digit indices for output
-      auto clusterstmp = mClusterizer.getFoundClusters();
-      auto clusterIndecestmp = mClusterizer.getFoundClustersInputIndices();
-      std::copy(clusterstmp->begin(), clusterstmp->end(), std::back_inserter(*mClustersArray));
-      std::copy(clusterIndecestmp->begin(), clusterIndecestmp->end(), std::back_inserter(*mClustersInputIndices));
-
-      mClusterTriggerRecordsClusters->emplace_back(iTrgRcrd->getBCData(), currentStartClusters, clusterstmp->size());
-      mClusterTriggerRecordsIndices->emplace_back(iTrgRcrd->getBCData(), currentStartIndices, clusterIndecestmp->size());
-
-      currentStartClusters = mClustersArray->size();
-      currentStartIndices = mClustersInputIndices->size();
-    }
+    // Find clusters on cells/digits given in reader::mInputArray for all trigger records, appending to the output containers
+    mClusterizer.findClustersBatch(gsl::span<const InputType>(*InputVector), gsl::span<const TriggerRecord>(*mInputReader->getTriggerArray()),
+                                   *mClustersArray, *mClustersInputIndices, *mClusterTriggerRecordsClusters, *mClusterTriggerRecordsIndices);
     outTree->Fill();
   }
 
@@ -0,0 +1,242 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test EMCAL Reconstruction
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2Batch.h"
+
+namespace o2
+{
+namespace emcal
+{
+
+using RawFitterError_t = CaloRawFitter::RawFitterError_t;
+using ChannelBunches = std::vector<Bunch>;
+
+/// \struct FitOutput
+/// \brief Result of the fit of a channel, or the error thrown by the fitter
+struct FitOutput {
+  std::optional<CaloFitResults> mResult;
+  std::optional<RawFitterError_t> mError;
+};
+
+/// \struct FitCounters
+/// \brief Number of channels per outcome of the fit
+struct FitCounters {
+  int mFitted = 0;      ///< fit converged
+  int mFailed = 0;      ///< fit did not converge, results from the estimates
+  int mOverflow = 0;    ///< no fit due to overflow, results from the estimates
+  int mBunchErrors = 0; ///< channel rejected with BUNCH_NOT_OK
+  int mFitErrors = 0;   ///< channel rejected with FIT_ERROR
+};
+
+/// Bunch with the samples given in increasing time, stored reversed as in the raw data
+Bunch makeBunch(const std::vector<double>& samples, int endTime)
+{
+  const int length = samples.size();
+  Bunch bunch(length, endTime + length - 1);
+  for (int i = length - 1; i >= 0; i--) {
+    bunch.addADC(std::clamp(std::lround(samples[i]), 0l, 1023l));
+  }
+  return bunch;
+}
+
+/// Gamma-2 pulse with the maximum amp at peak, on top of a pedestal, with gaussian noise
+std::vector<double> makePulse(std::mt19937& rng, int length, double amp, double peak, double ped, double noise)
+{
+  std::normal_distribution<double> gaus(0., noise);
+  std::vector<double> samples(length);
+  for (int i = 0; i < length; i++) {
+    double ti = (i - peak) / constants::TAU;
+    samples[i] = ped + (ti + 1 > 0 ? amp * (ti + 1) * (ti + 1) * std::exp(-2 * ti) : 0.) + (noise > 0 ? gaus(rng) : 0.);
+  }
+  return samples;
+}
+
+/// Channels covering all outcomes of the fit: regular pulses, overflow, distorted pulses for which
+/// the fit fails, maximum at the bunch edge, signal below the amplitude cut and no bunch at all
+std::vector<ChannelBunches> createChannels()
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<double> flat(0., 1.);
+  std::vector<ChannelBunches> channels;
+  for (int ichan = 0; ichan < 1000; ichan++) {
+    const int length = 10 + rng() % (constants::EMCAL_MAXTIMEBINS - 9);
+    const int endTime = rng() % 60;
+    const double ped = 20. + 30. * flat(rng);
+    const double peak = 2. + (length - 9) * flat(rng);
+    ChannelBunches bunches;
+    switch (ichan % 10) {
+      case 0: // overflow
+        bunches.push_back(makeBunch(makePulse(rng, length, 1000. + 20. * flat(rng), peak, ped, 1.), endTime));
+        break;
+      case 1: { // two pulses in the same bunch
+        auto samples = makePulse(rng, length, 50. + 200. * flat(rng), peak, ped, 1.);
+        auto second = makePulse(rng, length, 50. + 200. * flat(rng), peak + 2.5 + 2. * flat(rng), 0., 0.);
+        for (int i = 0; i < length; i++) {
+          samples[i] += second[i];
+        }
+        bunches.push_back(makeBunch(samples, endTime));
+        break;
+      }
+      case 2: { // noise with a spike
+        std::vector<double> samples(length);
+        for (auto& sample : samples) {
+          sample = ped + 10. * flat(rng);
+        }
+        samples[length / 2] += 20. + 50. * flat(rng);
+        bunches.push_back(makeBunch(samples, endTime));
+        break;
+      }
+      case 3: // maximum at the edge of the bunch
+        bunches.push_back(makeBunch(makePulse(rng, length, 100. + 200. * flat(rng), length - 1, ped, 0.), endTime));
+        break;
+      case 4: // below the amplitude cut
+        bunches.push_back(makeBunch(makePulse(rng, length, 2., peak, ped, 0.), endTime));
+        break;
+      case 5: // no bunch
+        break;
+      case 6: // two bunches, the larger one is fitted
+        bunches.push_back(makeBunch(makePulse(rng, length, 5. + 50. * flat(rng), peak, ped, 1.), endTime + 20));
+        bunches.push_back(makeBunch(makePulse(rng, length, 100. + 500. * flat(rng), peak, ped, 1.), endTime));
+        break;
+      default: // regular pulse, amplitude from a few ADC counts to close to the overflow
+        bunches.push_back(makeBunch(makePulse(rng, length, 5. * std::pow(180., flat(rng)), peak, ped, 1. + 2. * flat(rng)), endTime));
+        break;
+    }
+    channels.push_back(bunches);
+  }
+  return channels;
+}
+
+template <typename Fitter>
+FitOutput runFit(Fitter& fitter, const ChannelBunches& bunches)
+{
+  FitOutput output;
+  try {
+    output.mResult = fitter.evaluate(bunches, std::nullopt, std::nullopt);
+  } catch (RawFitterError_t& e) {
+    output.mError = e;
+  }
+  return output;
+}
+
+void checkSameOutput(const FitOutput& batch, const FitOutput& scalar)
+{
+  BOOST_REQUIRE_EQUAL(batch.mError.has_value(), scalar.mError.has_value());
+  if (scalar.mError) {
+    BOOST_CHECK_EQUAL(int(batch.mError.value()), int(scalar.mError.value()));
+    return;
+  }
+  const auto& res = batch.mResult.value();
+  const auto& ref = scalar.mResult.value();
+  BOOST_CHECK_EQUAL(res.getAmp(), ref.getAmp());
+  BOOST_CHECK_EQUAL(res.getTime(), ref.getTime());
+  BOOST_CHECK_EQUAL(res.getChi2(), ref.getChi2());
+  BOOST_CHECK_EQUAL(res.getNdf(), ref.getNdf());
+  BOOST_CHECK_EQUAL(res.getMaxSig(), ref.getMaxSig());
+  BOOST_CHECK_EQUAL(res.getPed(), ref.getPed());
+}
+
+/// Compares the fit of all channels in one batch with the scalar fitter, for the given max number of iterations.
+/// The results must be identical, also for the fits at the limit of convergence.
+FitCounters compareFitters(const std::vector<ChannelBunches>& channels, int niterationsMax)
+{
+  CaloRawFitterGamma2 scalarFitter;
+  CaloRawFitterGamma2Batch batchFitter;
+  scalarFitter.setNiterationsMax(niterationsMax);
+  batchFitter.setNiterationsMax(niterationsMax);
+
+  batchFitter.clear();
+  for (const auto& bunches : channels) {
+    batchFitter.addChannel(bunches, std::nullopt, std::nullopt);
+  }
+  BOOST_REQUIRE_EQUAL(batchFitter.getNChannels(), int(channels.size()));
+  batchFitter.fitBatch();
+
+  FitCounters counters;
+  for (size_t ichan = 0; ichan < channels.size(); ichan++) {
+    BOOST_TEST_CONTEXT("channel " << ichan)
+    {
+      auto scalar = runFit(scalarFitter, channels[ichan]);
+      FitOutput batch;
+      try {
+        batch.mResult = batchFitter.getResult(ichan);
+      } catch (RawFitterError_t& e) {
+        batch.mError = e;
+      }
+      checkSameOutput(batch, scalar);
+
+      if (scalar.mError) {
+        (scalar.mError.value() == RawFitterError_t::BUNCH_NOT_OK ? counters.mBunchErrors : counters.mFitErrors)++;
+      } else if (scalar.mResult->getMaxSig() >= constants::OVERFLOWCUT) {
+        BOOST_CHECK_EQUAL(int(scalar.mResult->getNdf()), 0);
+        counters.mOverflow++;
+      } else if (scalar.mResult->getChi2() >= 1.e9) {
+        counters.mFailed++;
+      } else {
+        counters.mFitted++;
+      }
+    }
+  }
+
+  // single channels via evaluate of the batch fitter, which is using the same engine
+  for (size_t ichan = 0; ichan < channels.size(); ichan += 7) {
+    BOOST_TEST_CONTEXT("single channel " << ichan)
+    {
+      checkSameOutput(runFit(batchFitter, channels[ichan]), runFit(scalarFitter, channels[ichan]));
+    }
+  }
+  BOOST_TEST_MESSAGE("max. iterations " << niterationsMax << ": " << counters.mFitted << " fitted, " << counters.mFailed << " failed, "
+                                        << counters.mOverflow << " overflow, " << counters.mBunchErrors << " bunch errors, " << counters.mFitErrors << " fit errors");
+  return counters;
+}
+
+/// \macro Test of the batched Gamma2 raw fitter against the scalar one
+///
+/// Test coverage:
+/// - converged fits
+/// - failed fits, with the default and small max number of iterations
+/// - overflow
+/// - errors: maximum at the bunch edge, signal below the amplitude cut, no bunch
+BOOST_AUTO_TEST_CASE(CaloRawFitterGamma2Batch_test)
+{
+  const auto channels = createChannels();
+
+  auto counters = compareFitters(channels, 15);
+  BOOST_CHECK(counters.mFitted > 0);
+  BOOST_CHECK(counters.mFailed > 0);
+  BOOST_CHECK(counters.mOverflow > 0);
+  BOOST_CHECK(counters.mBunchErrors > 0);
+  BOOST_CHECK(counters.mFitErrors > 0);
+
+  // fits which do not converge within the max number of iterations
+  for (int niterationsMax : {2, 0}) {
+    BOOST_TEST_CONTEXT("max. iterations " << niterationsMax)
+    {
+      auto countersMaxIter = compareFitters(channels, niterationsMax);
+      BOOST_CHECK(countersMaxIter.mFailed > counters.mFailed);
+      BOOST_CHECK_EQUAL(countersMaxIter.mOverflow, counters.mOverflow);
+    }
+  }
+}
+
+} // namespace emcal
+} // namespace o2
@@ -0,0 +1,329 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test EMCAL Reconstruction
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <gsl/span>
+#include "DataFormatsEMCAL/Cell.h"
+#include "DataFormatsEMCAL/Cluster.h"
+#include "DataFormatsEMCAL/TriggerRecord.h"
+#include "EMCALBase/Geometry.h"
+#include "EMCALReconstruction/Clusterizer.h"
+
+namespace o2
+{
+namespace emcal
+{
+
+constexpr double TIMECUT = 50.;
+constexpr double TIMEMIN = -100.;
+constexpr double TIMEMAX = 500.;
+constexpr double GRADIENTCUT = 0.03;
+constexpr double SEEDTHRESHOLD = 0.5;
+constexpr double CELLTHRESHOLD = 0.1;
+
+/// \struct RefCluster
+/// \brief Cluster of the reference clusterizer: time of the seed and indices of the cells
+struct RefCluster {
+  float mTime;
+  std::vector<int> mIndices;
+};
+
+/// Row and column of a cell in the topological map of the clusterizer
+std::tuple<int, int> getTopologicalRowColumn(const Geometry& geo, int tower)
+{
+  auto [supermodule, module, phiInModule, etaInModule] = geo.GetCellIndex(tower);
+  auto [row, column] = geo.GetCellPhiEtaIndexInSModule(supermodule, module, phiInModule, etaInModule);
+  row += supermodule / 2 * (24 + 1);
+  column += supermodule % 2 * (geo.IsDCALSM(supermodule) ? 48 + 1 : 48);
+  return {row, column};
+}
+
+/// \class RecursiveClusterizer
+/// \brief Reference: dense maps reset for every event and recursive neighbour search,
+/// as in the former implementation of the Clusterizer
+class RecursiveClusterizer
+{
+ public:
+  explicit RecursiveClusterizer(const Geometry& geo) : mGeometry(geo) {}
+
+  std::vector<RefCluster> findClusters(gsl::span<const Cell> cells)
+  {
+    mCells = cells;
+    mInputMap.assign(NROWS * NCOLS, -1);
+    mCellMask.assign(NROWS * NCOLS, false);
+    std::vector<std::tuple<float, int, int>> seeds; // energy, row, column
+    for (int icell = 0; icell < int(cells.size()); icell++) {
+      const auto& cell = cells[icell];
+      if (cell.getEnergy() < CELLTHRESHOLD || cell.getTimeStamp() > TIMEMAX || cell.getTimeStamp() < TIMEMIN) {
+        continue;
+      }
+      auto [row, column] = getTopologicalRowColumn(mGeometry, cell.getTower());
+      mInputMap[row * NCOLS + column] = icell;
+      seeds.emplace_back(cell.getEnergy(), row, column);
+    }
+    std::sort(seeds.begin(), seeds.end(), [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+
+    std::vector<RefCluster> clusters;
+    for (const auto& [energy, row, column] : seeds) {
+      if (mCellMask[row * NCOLS + column] || energy <= SEEDTHRESHOLD) {
+        continue;
+      }
+      const int seed = mInputMap[row * NCOLS + column];
+      RefCluster cluster{cells[seed].getTimeStamp(), {seed}};
+      addNeighbours(cluster.mIndices, row, column);
+      clusters.push_back(cluster);
+    }
+    return clusters;
+  }
+
+ private:
+  void addNeighbours(std::vector<int>& indices, int row, int column)
+  {
+    constexpr int rowDiffs[4] = {-1, 0, 0, 1};
+    constexpr int colDiffs[4] = {0, -1, 1, 0};
+    mCellMask[row * NCOLS + column] = true;
+    const auto& current = mCells[mInputMap[row * NCOLS + column]];
+    for (int dir = 0; dir < 4; dir++) {
+      const int nextRow = row + rowDiffs[dir], nextColumn = column + colDiffs[dir];
+      if (nextRow < 0 || nextRow >= int(NROWS) || nextColumn < 0 || nextColumn >= int(NCOLS)) {
+        continue;
+      }
+      const int next = mInputMap[nextRow * NCOLS + nextColumn];
+      if (next < 0 || mCellMask[nextRow * NCOLS + nextColumn]) {
+        continue;
+      }
+      if (mCells[next].getEnergy() > current.getEnergy() + GRADIENTCUT || std::abs(mCells[next].getTimeStamp() - current.getTimeStamp()) > TIMECUT) {
+        continue;
+      }
+      addNeighbours(indices, nextRow, nextColumn);
+      indices.push_back(next);
+    }
+  }
+
+  const Geometry& mGeometry;
+  gsl::span<const Cell> mCells;
+  std::vector<int> mInputMap;
+  std::vector<bool> mCellMask;
+};
+
+/// Clusterizer with the settings of the test
+ClusterizerCells createClusterizer(Geometry* geo)
+{
+  ClusterizerCells clusterizer(TIMECUT, TIMEMIN, TIMEMAX, GRADIENTCUT, true, SEEDTHRESHOLD, CELLTHRESHOLD);
+  clusterizer.setGeometry(geo);
+  return clusterizer;
+}
+
+/// \class EventGenerator
+/// \brief Events with showers of a few cells around random positions and noise cells in random order.
+/// The towers and the energies of the possible seeds are unique in an event, such that the order of the seeds is defined
+class EventGenerator
+{
+ public:
+  explicit EventGenerator(const Geometry& geo) : mTowerMap(NROWS * NCOLS, -1)
+  {
+    for (int tower = 0; tower < geo.GetNCells(); tower++) {
+      auto [row, column] = getTopologicalRowColumn(geo, tower);
+      mTowerMap[row * NCOLS + column] = tower;
+    }
+  }
+
+  /// \param nShowers number of showers
+  /// \param nNoise number of noise cells, below the seed threshold
+  std::vector<Cell> createEvent(int nShowers, int nNoise)
+  {
+    std::uniform_real_distribution<double> flat(0., 1.);
+    std::normal_distribution<double> gaus(0., 1.);
+    mTowers.clear();
+    mSeedEnergies.clear();
+    std::vector<Cell> cells;
+    for (int ishower = 0; ishower < nShowers; ishower++) {
+      const int row = mRandom() % NROWS, column = mRandom() % NCOLS;
+      const double energy = 0.5 + 20. * flat(mRandom), time = 100. * flat(mRandom);
+      for (int drow = -2; drow <= 2; drow++) {
+        for (int dcolumn = -2; dcolumn <= 2; dcolumn++) {
+          const double cellEnergy = energy * std::exp(-1.5 * (std::abs(drow) + std::abs(dcolumn))) * (0.5 + flat(mRandom));
+          // some cells out of the time window of the shower or of the event
+          double cellTime = time + 10. * gaus(mRandom);
+          if (flat(mRandom) < 0.05) {
+            cellTime += flat(mRandom) < 0.5 ? 200. : 500.;
+          }
+          addCell(cells, row + drow, column + dcolumn, cellEnergy, cellTime);
+        }
+      }
+    }
+    for (int inoise = 0; inoise < nNoise; inoise++) {
+      addCell(cells, mRandom() % NROWS, mRandom() % NCOLS, 0.05 + 0.4 * flat(mRandom), 100. * flat(mRandom));
+    }
+    std::shuffle(cells.begin(), cells.end(), mRandom);
+    return cells;
+  }
+
+ private:
+  void addCell(std::vector<Cell>& cells, int row, int column, double energy, double time)
+  {
+    if (row < 0 || row >= int(NROWS) || column < 0 || column >= int(NCOLS) || mTowerMap[row * NCOLS + column] < 0) {
+      return;
+    }
+    const int tower = mTowerMap[row * NCOLS + column];
+    Cell cell(tower, energy, time);
+    if (mTowers.count(tower) || (cell.getEnergy() > SEEDTHRESHOLD && mSeedEnergies.count(cell.getEnergy()))) {
+      return;
+    }
+    mTowers.insert(tower);
+    mSeedEnergies.insert(cell.getEnergy());
+    cells.push_back(cell);
+  }
+
+  std::mt19937 mRandom{1234};
+  std::vector<int> mTowerMap; ///< tower of each position in the topological map, -1 for the gaps
+  std::set<int> mTowers;
+  std::set<float> mSeedEnergies;
+};
+
+/// Compares the clusters of one event with the reference
+void checkClusters(gsl::span<const Cluster> clusters, gsl::span<const ClusterIndex> indices, const std::vector<RefCluster>& reference)
+{
+  BOOST_REQUIRE_EQUAL(clusters.size(), reference.size());
+  int nIndices = 0;
+  for (size_t icl = 0; icl < clusters.size(); icl++) {
+    const auto& cluster = clusters[icl];
+    const auto& ref = reference[icl];
+    BOOST_CHECK_EQUAL(cluster.getTimeStamp(), Cluster(ref.mTime, 0, 0).getTimeStamp());
+    BOOST_CHECK_EQUAL(cluster.getCellIndexFirst(), nIndices);
+    BOOST_REQUIRE_EQUAL(cluster.getNCells(), int(ref.mIndices.size()));
+    BOOST_REQUIRE_LE(cluster.getCellIndexFirst() + cluster.getNCells(), int(indices.size()));
+    auto clusterIndices = indices.subspan(cluster.getCellIndexFirst(), cluster.getNCells());
+    BOOST_CHECK_EQUAL_COLLECTIONS(clusterIndices.begin(), clusterIndices.end(), ref.mIndices.begin(), ref.mIndices.end());
+    nIndices += cluster.getNCells();
+  }
+  BOOST_CHECK_EQUAL(nIndices, int(indices.size()));
+}
+
+/// \macro Test of the clusterizer on a hand-built event
+///
+/// Test coverage:
+/// - order of the cells in the cluster
+/// - cells below the seed threshold do not form clusters
+/// - cells below the cell threshold and out of the time window are not clustered
+BOOST_AUTO_TEST_CASE(Clusterizer_handBuilt_test)
+{
+  auto geo = Geometry::GetInstanceFromRunNumber(300000);
+  auto clusterizer = createClusterizer(geo);
+  auto cell = [geo](int iphi, int ieta, float energy, float time = 20.) { return Cell(geo->GetAbsCellIdFromCellIndexes(0, iphi, ieta), energy, time); };
+
+  // supermodule 0: row = iphi, column = ieta
+  std::vector<Cell> cells{
+    cell(11, 10, 0.3),              // 0: neighbour of 2
+    cell(10, 11, 1.),               // 1: neighbour of the seed
+    cell(11, 11, 0.5),              // 2: neighbour of 1
+    cell(10, 10, 2.),               // 3: seed
+    cell(9, 10, 0.05),              // 4: below the cell threshold
+    cell(10, 9, 1.5, 200.),         // 5: out of the time window of the seed, own cluster
+    cell(20, 30, 0.4),              // 6: below the seed threshold
+    cell(21, 30, 0.3),              // 7: below the seed threshold
+    cell(5, 40, 3., TIMEMAX + 10)}; // 8: out of the time window of the event
+
+  clusterizer.findClusters(cells);
+  const auto& clusters = *clusterizer.getFoundClusters();
+  const auto& indices = *clusterizer.getFoundClustersInputIndices();
+  BOOST_REQUIRE_EQUAL(clusters.size(), 2);
+  // the seed first, then the neighbours in the order of the end of their search
+  const std::vector<ClusterIndex> expected{3, 0, 2, 1, 5};
+  BOOST_CHECK_EQUAL_COLLECTIONS(indices.begin(), indices.end(), expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL(clusters[0].getCellIndexFirst(), 0);
+  BOOST_CHECK_EQUAL(clusters[0].getNCells(), 4);
+  BOOST_CHECK_EQUAL(clusters[1].getCellIndexFirst(), 4);
+  BOOST_CHECK_EQUAL(clusters[1].getNCells(), 1);
+
+  // only cells below the seed threshold
+  std::vector<Cell> noSeeds{cells[6], cells[7], cells[4]};
+  clusterizer.findClusters(noSeeds);
+  BOOST_CHECK(clusterizer.getFoundClusters()->empty());
+  BOOST_CHECK(clusterizer.getFoundClustersInputIndices()->empty());
+
+  // the cells of the previous events are reset
+  clusterizer.findClusters(gsl::span<const Cell>(cells.data() + 3, 1));
+  BOOST_REQUIRE_EQUAL(clusterizer.getFoundClusters()->size(), 1);
+  BOOST_CHECK_EQUAL(clusterizer.getFoundClusters()->front().getNCells(), 1);
+}
+
+/// \macro Test of the clusterizer against the recursive reference, event by event and in one batch
+///
+/// Test coverage:
+/// - events of different occupancy with the same clusterizer (reset of the maps)
+/// - empty events and events with only cells below the seed threshold
+/// - several triggers in findClustersBatch, with empty triggers
+BOOST_AUTO_TEST_CASE(Clusterizer_reference_test)
+{
+  auto geo = Geometry::GetInstanceFromRunNumber(300000);
+  RecursiveClusterizer reference(*geo);
+  EventGenerator generator(*geo);
+
+  std::vector<std::vector<Cell>> events;
+  const std::vector<std::array<int, 2>> occupancies{{5, 50}, {0, 0}, {200, 2000}, {0, 300}, {1, 0}, {50, 500}, {0, 0}, {0, 0}, {20, 20}, {400, 0}};
+  for (const auto& [nShowers, nNoise] : occupancies) {
+    events.push_back(generator.createEvent(nShowers, nNoise));
+  }
+
+  auto clusterizer = createClusterizer(geo);
+  std::vector<Cell> allCells;
+  std::vector<TriggerRecord> triggers;
+  std::vector<std::vector<RefCluster>> refClusters;
+  size_t nClusters = 0;
+  for (size_t iev = 0; iev < events.size(); iev++) {
+    BOOST_TEST_CONTEXT("event " << iev)
+    {
+      refClusters.push_back(reference.findClusters(events[iev]));
+      clusterizer.findClusters(events[iev]);
+      checkClusters(*clusterizer.getFoundClusters(), *clusterizer.getFoundClustersInputIndices(), refClusters.back());
+      nClusters += refClusters.back().size();
+    }
+    triggers.emplace_back(o2::InteractionRecord(iev * 100, iev), allCells.size(), events[iev].size());
+    allCells.insert(allCells.end(), events[iev].begin(), events[iev].end());
+  }
+  BOOST_CHECK(nClusters > 0);
+
+  std::vector<Cluster> clusters;
+  std::vector<ClusterIndex> indices;
+  std::vector<TriggerRecord> clusterTriggers, indexTriggers;
+  clusterizer.findClustersBatch(allCells, triggers, clusters, indices, clusterTriggers, indexTriggers);
+  BOOST_REQUIRE_EQUAL(clusterTriggers.size(), triggers.size());
+  BOOST_REQUIRE_EQUAL(indexTriggers.size(), triggers.size());
+  int firstCluster = 0, firstIndex = 0;
+  for (size_t iev = 0; iev < events.size(); iev++) {
+    BOOST_TEST_CONTEXT("trigger " << iev)
+    {
+      BOOST_CHECK(clusterTriggers[iev].getBCData() == triggers[iev].getBCData());
+      BOOST_CHECK(indexTriggers[iev].getBCData() == triggers[iev].getBCData());
+      BOOST_CHECK_EQUAL(clusterTriggers[iev].getFirstEntry(), firstCluster);
+      BOOST_CHECK_EQUAL(indexTriggers[iev].getFirstEntry(), firstIndex);
+      auto eventClusters = gsl::span<const Cluster>(clusters).subspan(clusterTriggers[iev].getFirstEntry(), clusterTriggers[iev].getNumberOfObjects());
+      auto eventIndices = gsl::span<const ClusterIndex>(indices).subspan(indexTriggers[iev].getFirstEntry(), indexTriggers[iev].getNumberOfObjects());
+      checkClusters(eventClusters, eventIndices, refClusters[iev]);
+      firstCluster += clusterTriggers[iev].getNumberOfObjects();
+      firstIndex += indexTriggers[iev].getNumberOfObjects();
+    }
+  }
+  BOOST_CHECK_EQUAL(firstCluster, int(clusters.size()));
+  BOOST_CHECK_EQUAL(firstIndex, int(indices.size()));
+}
+
+} // namespace emcal
+} // namespace o2
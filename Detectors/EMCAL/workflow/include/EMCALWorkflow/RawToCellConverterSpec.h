@@ -18,6 +18,7 @@
 #include "EMCALBase/Geometry.h"
 #include "EMCALBase/Mapper.h"
 #include "EMCALReconstruction/CaloRawFitter.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2Batch.h"
 
 namespace o2
 {
@@ -73,6 +74,7 @@ class RawToCellConverterSpec : public framework::Task
   o2::emcal::Geometry* mGeometry = nullptr;                     ///!<! Geometry pointer
   std::unique_ptr<o2::emcal::MappingHandler> mMapper = nullptr; ///!<! Mapper
   std::unique_ptr<o2::emcal::CaloRawFitter> mRawFitter;         ///!<! Raw fitter
+  o2::emcal::CaloRawFitterGamma2Batch* mBatchFitter = nullptr;  ///!<! Raw fitter if it fits all channels of a page at once
   std::vector<o2::emcal::Cell> mOutputCells;                    ///< Container with output cells
   std::vector<o2::emcal::TriggerRecord> mOutputTriggerRecords;  ///< Container with output cells
   std::vector<ErrorTypeFEE> mOutputDecoderErrors;               ///< Container with decoder errors
@@ -76,30 +76,10 @@ void ClusterizerSpec<InputType>::run(framework::ProcessingContext& ctx)
   mOutputTriggerRecord->clear();
   mOutputTriggerRecordIndices->clear();
 
-  int currentStartClusters = mOutputClusters->size();
-  int currentStartIndices = mOutputCellDigitIndices->size();
-  for (auto iTrgRcrd : InputTriggerRecord) {
-    if (Inputs.size() && iTrgRcrd.getNumberOfObjects()) {
-      mClusterizer.findClusters(gsl::span<const InputType>(&Inputs[iTrgRcrd.getFirstEntry()], iTrgRcrd.getNumberOfObjects())); // Find clusters on cells/digits (pass by ref)
-    } else {
-      mClusterizer.clear();
-    }
-    // Get found clusters + cell/digit indices for output
-    // * A cluster contains a range that correspond to the vector of cell/digit indices
-    // * The cell/digit index vector contains the indices of the clusterized cells/digits wrt to the original cell/digit array
-
-    auto outputClustersTemp = mClusterizer.getFoundClusters();
-    auto outputCellDigitIndicesTemp = mClusterizer.getFoundClustersInputIndices();
-
-    std::copy(outputClustersTemp->begin(), outputClustersTemp->end(), std::back_inserter(*mOutputClusters));
-    std::copy(outputCellDigitIndicesTemp->begin(), outputCellDigitIndicesTemp->end(), std::back_inserter(*mOutputCellDigitIndices));
-
-    mOutputTriggerRecord->emplace_back(iTrgRcrd.getBCData(), currentStartClusters, outputClustersTemp->size());
-    mOutputTriggerRecordIndices->emplace_back(iTrgRcrd.getBCData(), currentStartIndices, outputCellDigitIndicesTemp->size());
-
-    currentStartClusters = mOutputClusters->size();
-    currentStartIndices = mOutputCellDigitIndices->size();
-  }
+  // Find clusters on cells/digits for all trigger records in one go
+  // * A cluster contains a range that correspond to the vector of cell/digit indices
+  // * The cell/digit index vector contains the indices of the clusterized cells/digits wrt to the first cell/digit of the trigger
+  mClusterizer.findClustersBatch(Inputs, InputTriggerRecord, *mOutputClusters, *mOutputCellDigitIndices, *mOutputTriggerRecord, *mOutputTriggerRecordIndices);
   LOG(DEBUG) << "[EMCALClusterizer - run] Writing " << mOutputClusters->size() << " clusters ...";
   ctx.outputs().snapshot(o2::framework::Output{o2::header::gDataOriginEMC, "CLUSTERS", 0, o2::framework::Lifetime::Timeframe}, *mOutputClusters);
   ctx.outputs().snapshot(o2::framework::Output{o2::header::gDataOriginEMC, "INDICES", 0, o2::framework::Lifetime::Timeframe}, *mOutputCellDigitIndices);
@@ -9,6 +9,8 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "FairLogger.h"
 
@@ -27,6 +29,7 @@
 #include "EMCALReconstruction/Bunch.h"
 #include "EMCALReconstruction/CaloRawFitterStandard.h"
 #include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2Batch.h"
 #include "EMCALReconstruction/AltroDecoder.h"
 #include "EMCALWorkflow/RawToCellConverterSpec.h"
 #include "SimulationDataFormat/MCCompLabel.h"
@@ -64,6 +67,10 @@ void RawToCellConverterSpec::init(framework::InitContext& ctx)
     mRawFitter = std::unique_ptr<CaloRawFitter>(new o2::emcal::CaloRawFitterStandard);
   } else if (fitmethod == "gamma2") {
     mRawFitter = std::unique_ptr<CaloRawFitter>(new o2::emcal::CaloRawFitterGamma2);
+  } else if (fitmethod == "gamma2batch") {
+    LOG(INFO) << "Using gamma2 raw fitter on all channels of a page at once";
+    mBatchFitter = new o2::emcal::CaloRawFitterGamma2Batch;
+    mRawFitter = std::unique_ptr<CaloRawFitter>(mBatchFitter);
   }
 
   mMaxErrorMessages = ctx.options().get<int>("maxmessage");
@@ -186,6 +193,7 @@ void RawToCellConverterSpec::run(framework::ProcessingContext& ctx)
       int iSM = feeID / 2;
 
       // Loop over all the channels
+      std::vector<std::tuple<int, ChannelType_t, const Channel*>> channels;
       for (auto& chan : decoder.getChannels()) {
 
         int iRow, iCol;
@@ -201,11 +209,24 @@ void RawToCellConverterSpec::run(framework::ProcessingContext& ctx)
 
         auto [phishift, etashift] = mGeometry->ShiftOnlineToOfflineCellIndexes(iSM, iRow, iCol);
         int CellID = mGeometry->GetAbsCellIdFromCellIndexes(iSM, phishift, etashift);
+        channels.emplace_back(CellID, chantype, &chan);
+      }
+
+      // with the batch fitter all channels of the page are fitted together
+      if (mBatchFitter) {
+        mBatchFitter->clear();
+        for (auto& [CellID, chantype, chan] : channels) {
+          mBatchFitter->addChannel(chan->getBunches(), 0, 0);
+        }
+        mBatchFitter->fitBatch();
+      }
 
+      for (size_t ichan = 0; ichan < channels.size(); ichan++) {
+        auto [CellID, chantype, chan] = channels[ichan];
         // define the conatiner for the fit results, and perform the raw fitting using the stadnard raw fitter
         CaloFitResults fitResults;
         try {
-          fitResults = mRawFitter->evaluate(chan.getBunches(), 0, 0);
+          fitResults = mBatchFitter ? mBatchFitter->getResult(ichan) : mRawFitter->evaluate(chan->getBunches(), 0, 0);
           // Prevent negative entries - we should no longer get here as the raw fit usually will end in an error state
           if (fitResults.getAmp() < 0) {
             fitResults.setAmp(0.);
@@ -264,6 +285,6 @@ o2::framework::DataProcessorSpec o2::emcal::reco_workflow::getRawToCellConverter
                                           outputs,
                                           o2::framework::adaptFromTask<o2::emcal::reco_workflow::RawToCellConverterSpec>(),
                                           o2::framework::Options{
-                                            {"fitmethod", o2::framework::VariantType::String, "gamma2", {"Fit method (standard or gamma2)"}},
+                                            {"fitmethod", o2::framework::VariantType::String, "gamma2", {"Fit method (standard, gamma2 or gamma2batch)"}},
                                             {"maxmessage", o2::framework::VariantType::Int, 100, {"Max. amout of error messages to be displayed"}}}};
 }
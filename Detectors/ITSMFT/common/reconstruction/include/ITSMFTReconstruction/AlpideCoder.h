@@ -205,71 +205,84 @@ class AlpideCoder
       // hit info ?
       if ((expectInp & ExpectData)) {
         if (isData(dataC)) { // region header was seen, expect data
-                             // note that here we are checking on the byte rather than the short, need complete to ushort
-          dataS = dataC << 8;
-          if (!buffer.next(dataC)) {
+          // The DATA SHORT/LONG records of the region are decoded in a tight loop working directly on the
+          // buffer, until a byte which is not a data word is met
+          uint8_t* ptr = buffer.getPtr();
+          const uint8_t* end = buffer.getEnd();
+          const uint16_t colDReg = region * NDColInReg;
+          while (true) {
+            // note that here we are checking on the byte rather than the short, need complete to ushort
+            if (ptr == end) {
+              buffer.setPtr(ptr);
 #ifdef ALPIDE_DECODING_STAT
-            chipData.setError(ChipStat::TruncatedRegion);
+              chipData.setError(ChipStat::TruncatedRegion);
 #endif
-            return unexpectedEOF("CHIPDATA");
-          }
-          dataS |= dataC;
-          // we are decoding the pixel addres, if this is a DATALONG, we will fetch the mask later
-          uint16_t dColID = (dataS & MaskEncoder) >> 10;
-          uint16_t pixID = dataS & MaskPixID;
-
-          // convert data to usual row/pixel format
-          uint16_t row = pixID >> 1;
-          // abs id of left column in double column
-          uint16_t colD = (region * NDColInReg + dColID) << 1; // TODO consider <<4 instead of *NDColInReg?
-
-          // if we start new double column, transfer the hits accumulated in the right column buffer of prev. double column
-          if (colD != colDPrev) {
-            colDPrev++;
-            for (int ihr = 0; ihr < nRightCHits; ihr++) {
-              addHit(chipData, rightColHits[ihr], colDPrev);
+              return unexpectedEOF("CHIPDATA");
+            }
+            dataS = (uint16_t(dataC) << 8) | *ptr++;
+            // we are decoding the pixel addres, if this is a DATALONG, we will fetch the mask later
+            uint16_t dColID = (dataS & MaskEncoder) >> 10;
+            uint16_t pixID = dataS & MaskPixID;
+
+            // convert data to usual row/pixel format
+            uint16_t row = pixID >> 1;
+            // abs id of left column in double column
+            uint16_t colD = (colDReg + dColID) << 1;
+
+            // if we start new double column, transfer the hits accumulated in the right column buffer of prev. double column
+            if (colD != colDPrev) {
+              colDPrev++;
+              for (int ihr = 0; ihr < nRightCHits; ihr++) {
+                addHit(chipData, rightColHits[ihr], colDPrev);
+              }
+              colDPrev = colD;
+              nRightCHits = 0; // reset the buffer
             }
-            colDPrev = colD;
-            nRightCHits = 0; // reset the buffer
-          }
-
-          bool rightC = (row & 0x1) ? !(pixID & 0x1) : (pixID & 0x1); // true for right column / lalse for left
 
-          // we want to have hits sorted in column/row, so the hits in right column of given double column
-          // are first collected in the temporary buffer
-          // real columnt id is col = colD + 1;
-          if (rightC) {
-            rightColHits[nRightCHits++] = row; // col = colD+1
-          } else {
-            addHit(chipData, row, colD); // col = colD, left column hits are added directly to the container
-          }
+            // we want to have hits sorted in column/row, so the hits in right column of given double column
+            // are first collected in the temporary buffer, left column hits are added directly to the container
+            // real columnt id is col = colD + 1 for right, colD for left column
+            uint32_t rightC = (row ^ pixID) & 0x1; // right column: odd row with even pixID or even row with odd pixID
+            if (rightC) {
+              rightColHits[nRightCHits++] = row;
+            } else {
+              addHit(chipData, row, colD);
+            }
 
-          if ((dataS & (~MaskDColID)) == DATALONG) { // multiple hits ?
-            uint8_t hitsPattern = 0;
-            if (!buffer.next(hitsPattern)) {
+            if ((dataS & (~MaskDColID)) == DATALONG) { // multiple hits ?
+              if (ptr == end) {
+                buffer.setPtr(ptr);
 #ifdef ALPIDE_DECODING_STAT
-              chipData.setError(ChipStat::TruncatedLondData);
+                chipData.setError(ChipStat::TruncatedLondData);
 #endif
-              return unexpectedEOF("CHIP_DATA_LONG:Pattern");
-            }
+                return unexpectedEOF("CHIP_DATA_LONG:Pattern");
+              }
+              uint8_t hitsPattern = *ptr++;
 #ifdef ALPIDE_DECODING_STAT
-            if (hitsPattern & (~MaskHitMap)) {
-              chipData.setError(ChipStat::WrongDataLongPattern);
-            }
+              if (hitsPattern & (~MaskHitMap)) {
+                chipData.setError(ChipStat::WrongDataLongPattern);
+              }
 #endif
-            for (int ip = 0; ip < HitMapSize; ip++) {
-              if (hitsPattern & (0x1 << ip)) {
-                uint16_t addr = pixID + ip + 1, rowE = addr >> 1;
-                rightC = ((rowE & 0x1) ? !(addr & 0x1) : (addr & 0x1)); // true for right column / lalse for left
-                // the real columnt is int colE = colD + rightC;
-                if (rightC) { // same as above
-                  rightColHits[nRightCHits++] = rowE;
-                } else {
-                  addHit(chipData, rowE, colD + rightC); // left column hits are added directly to the container
+              // bit ip of the pattern corresponds to the address pixID + ip + 1
+              uint16_t addr = pixID + 1;
+              for (uint32_t hits = hitsPattern & MaskHitMap; hits; hits >>= 1, addr++) {
+                if (hits & 0x1) {
+                  uint16_t rowE = addr >> 1;
+                  if ((rowE ^ addr) & 0x1) {
+                    rightColHits[nRightCHits++] = rowE;
+                  } else {
+                    addHit(chipData, rowE, colD);
+                  }
                 }
               }
             }
+            // continue with the next record if it is data
+            if (ptr == end || !isData(*ptr)) {
+              break;
+            }
+            dataC = *ptr++;
           }
+          buffer.setPtr(ptr);
         } else {
 #ifdef ALPIDE_DECODING_STAT
           chipData.setError(ChipStat::NoDataFound);
@@ -79,6 +79,8 @@ class Clusterer
     uint32_t firstPatt = 0;
     uint32_t nClus = 0;
     uint32_t nPatt = 0;
+    uint32_t destClus = 0; // position of the clusters in the final output
+    uint32_t destPatt = 0; // position of the patterns in the final output
     ThreadStat() = default;
   };
 
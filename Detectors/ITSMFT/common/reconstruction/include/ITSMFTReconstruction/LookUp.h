@@ -19,10 +19,18 @@
 /// This class is for the association of the cluster topology with the corresponding
 /// entry in the dictionary
 ///
+/// The hashes of the common big topologies are looked up in a perfect hash table
+/// (hash and displace: each bucket of hashes stores the seed which maps its members
+/// to free slots), built when the dictionary is loaded, such that any topology is
+/// found with one probe. The table is not modified by the look-up, so a single
+/// instance can be shared by the clusterer threads.
+///
 
 #ifndef ALICEO2_ITSMFT_LOOKUP_H
 #define ALICEO2_ITSMFT_LOOKUP_H
 #include <array>
+#include <cstdint>
+#include <vector>
 #include "DataFormatsITSMFT/ClusterTopology.h"
 #include "DataFormatsITSMFT/TopologyDictionary.h"
 
@@ -36,17 +44,32 @@ class LookUp
   LookUp();
   LookUp(std::string fileName);
   static int groupFinder(int nRow, int nCol);
-  int findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]);
+  int findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]) const;
   int getTopologiesOverThreshold() { return mTopologiesOverThreshold; }
   void loadDictionary(std::string fileName);
   bool isGroup(int id) const;
   int size() const { return mDictionary.getSize(); }
 
  private:
+  void buildTables();
+  int findCommonID(unsigned long hash) const;
+  static uint32_t mixHash(unsigned long hash, uint32_t seed)
+  {
+    uint64_t h = (hash ^ (seed * 0x9e3779b97f4a7c15UL)) * 0xbf58476d1ce4e5b9UL;
+    h ^= h >> 31;
+    h *= 0x94d049bb133111ebUL;
+    return uint32_t(h >> 32);
+  }
+  static uint32_t reduce(uint32_t h, uint32_t n) { return (uint64_t(h) * n) >> 32; } // h -> [0, n)
+
   TopologyDictionary mDictionary;
   int mTopologiesOverThreshold;
+  std::vector<uint32_t> mBucketSeeds;  //! seed of the slot hash for each bucket of the perfect hash
+  std::vector<unsigned long> mSlotKeys; //! hash of the topology in each slot
+  std::vector<int> mSlotIDs;            //! dictionary ID of the topology in each slot, -1 if empty
+  std::vector<int> mGroupIDs;           //! dictionary ID for each group index returned by groupFinder
 
-  ClassDefNV(LookUp, 3);
+  ClassDefNV(LookUp, 4);
 };
 } // namespace itsmft
 } // namespace o2
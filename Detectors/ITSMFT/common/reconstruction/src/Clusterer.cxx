@@ -102,39 +102,48 @@ void Clusterer::process(int nThreads, PixelReader& reader, CompClusCont* compClu
 #ifdef _PERFORM_TIMING_
       mTimerMerge.Start(false);
 #endif
-      size_t nClTot = 0, nPattTot = 0;
+      // assign to the blocks of each thread their place in the output, in the order of the chips
+      size_t nClTot = compClus->size(), nPattTot = patterns ? patterns->size() : 0;
       int chid = 0, thrStatIdx[nThreads];
       for (int ith = 0; ith < nThreads; ith++) {
         thrStatIdx[ith] = 0;
-        nClTot += mThreads[ith]->compClusters.size();
-        nPattTot += mThreads[ith]->patterns.size();
-      }
-      compClus->reserve(nClTot);
-      if (patterns) {
-        patterns->reserve(nPattTot);
       }
       while (chid < nFired) {
         for (int ith = 0; ith < nThreads; ith++) {
           if (thrStatIdx[ith] >= mThreads[ith]->stats.size()) {
             continue;
           }
-          const auto& stat = mThreads[ith]->stats[thrStatIdx[ith]];
+          auto& stat = mThreads[ith]->stats[thrStatIdx[ith]];
           if (stat.firstChip == chid) {
             thrStatIdx[ith]++;
             chid += stat.nChips; // next chip to look
-            const auto clbeg = mThreads[ith]->compClusters.begin() + stat.firstClus;
-            auto szold = compClus->size();
-            compClus->insert(compClus->end(), clbeg, clbeg + stat.nClus);
-            if (patterns) {
-              const auto ptbeg = mThreads[ith]->patterns.begin() + stat.firstPatt;
-              patterns->insert(patterns->end(), ptbeg, ptbeg + stat.nPatt);
-            }
+            stat.destClus = nClTot;
+            stat.destPatt = nPattTot;
+            nClTot += stat.nClus;
+            nPattTot += stat.nPatt;
             if (labelsCl) {
               labelsCl->mergeAtBack(mThreads[ith]->labels, stat.firstClus, stat.nClus);
             }
           }
         }
       }
+      // size the output once and let each thread copy its blocks to their place
+      compClus->resize(nClTot);
+      if (patterns) {
+        patterns->resize(nPattTot);
+      }
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+      for (int ith = 0; ith < nThreads; ith++) {
+        const auto& thr = *mThreads[ith];
+        for (const auto& stat : thr.stats) {
+          std::copy_n(thr.compClusters.begin() + stat.firstClus, stat.nClus, compClus->begin() + stat.destClus);
+          if (patterns) {
+            std::copy_n(thr.patterns.begin() + stat.firstPatt, stat.nPatt, patterns->begin() + stat.destPatt);
+          }
+        }
+      }
       for (int ith = 0; ith < nThreads; ith++) {
         mThreads[ith]->patterns.clear();
         mThreads[ith]->compClusters.clear();
@@ -14,6 +14,8 @@
 ///
 /// \author Luca Barioglio, University and INFN of Torino
 
+#include <algorithm>
+#include <numeric>
 #include "ITSMFTReconstruction/LookUp.h"
 
 ClassImp(o2::itsmft::LookUp);
@@ -36,6 +38,83 @@ void LookUp::loadDictionary(std::string fileName)
 {
   mDictionary.readBinaryFile(fileName);
   mTopologiesOverThreshold = mDictionary.mCommonMap.size();
+  buildTables();
+}
+
+void LookUp::buildTables()
+{
+  // flat table of the group IDs, covering all indices returned by groupFinder
+  mGroupIDs.assign((TopologyDictionary::MaxNumberOfRowClasses + 1) * TopologyDictionary::MaxNumberOfColClasses + 1, 0);
+  for (const auto& [index, id] : mDictionary.mGroupMap) {
+    if (index >= 0 && index < int(mGroupIDs.size())) {
+      mGroupIDs[index] = id;
+    }
+  }
+
+  // perfect hash of the common topologies: the hashes are distributed in buckets of ~4 entries,
+  // then, starting from the largest bucket, a seed is searched for each bucket which maps all of
+  // its hashes to free slots
+  std::vector<std::pair<unsigned long, int>> entries(mDictionary.mCommonMap.begin(), mDictionary.mCommonMap.end());
+  uint32_t nEntries = entries.size();
+  uint32_t nBuckets = nEntries / 4 + 1;
+  uint32_t nSlots = nEntries + nEntries / 4 + 1;
+  std::vector<std::vector<int>> buckets(nBuckets);
+  for (uint32_t i = 0; i < nEntries; i++) {
+    buckets[reduce(mixHash(entries[i].first, 0), nBuckets)].push_back(i);
+  }
+  std::vector<int> order(nBuckets);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&buckets](int a, int b) { return buckets[a].size() > buckets[b].size(); });
+
+  bool done = false;
+  while (!done) {
+    mBucketSeeds.assign(nBuckets, 0);
+    mSlotKeys.assign(nSlots, 0);
+    mSlotIDs.assign(nSlots, -1);
+    done = true;
+    std::vector<uint32_t> slots;
+    for (auto ib : order) {
+      const auto& bucket = buckets[ib];
+      if (bucket.empty()) {
+        break;
+      }
+      bool found = false;
+      for (uint32_t seed = 1; seed < (1u << 20) && !found; seed++) {
+        slots.clear();
+        found = true;
+        for (auto i : bucket) {
+          auto slot = reduce(mixHash(entries[i].first, seed), nSlots);
+          if (mSlotIDs[slot] >= 0 || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+            found = false;
+            break;
+          }
+          slots.push_back(slot);
+        }
+        if (found) {
+          mBucketSeeds[ib] = seed;
+          for (size_t j = 0; j < bucket.size(); j++) {
+            mSlotKeys[slots[j]] = entries[bucket[j]].first;
+            mSlotIDs[slots[j]] = entries[bucket[j]].second;
+          }
+        }
+      }
+      if (!found) { // should not happen, retry with more slots
+        nSlots += nSlots / 4 + 1;
+        done = false;
+        break;
+      }
+    }
+  }
+}
+
+int LookUp::findCommonID(unsigned long hash) const
+{
+  if (mSlotIDs.empty()) {
+    return -1;
+  }
+  auto seed = mBucketSeeds[reduce(mixHash(hash, 0), mBucketSeeds.size())];
+  auto slot = reduce(mixHash(hash, seed), mSlotIDs.size());
+  return mSlotKeys[slot] == hash ? mSlotIDs[slot] : -1;
 }
 
 int LookUp::groupFinder(int nRow, int nCol)
@@ -57,7 +136,7 @@ int LookUp::groupFinder(int nRow, int nCol)
   return grNum;
 }
 
-int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes])
+int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]) const
 {
   int nBits = nRow * nCol;
   // Small topology
@@ -66,18 +145,16 @@ int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPatt
     if (ID >= 0) {
       return ID;
     } else { //small rare topology (inside groups)
-      int index = groupFinder(nRow, nCol);
-      return mDictionary.mGroupMap[index];
+      return mGroupIDs[groupFinder(nRow, nCol)];
     }
   }
   // Big topology
   unsigned long hash = ClusterTopology::getCompleteHash(nRow, nCol, patt);
-  auto ret = mDictionary.mCommonMap.find(hash);
-  if (ret != mDictionary.mCommonMap.end()) {
-    return ret->second;
+  int ID = findCommonID(hash);
+  if (ID >= 0) {
+    return ID;
   } else { // Big rare topology (inside groups)
-    int index = groupFinder(nRow, nCol);
-    return mDictionary.mGroupMap[index];
+    return mGroupIDs[groupFinder(nRow, nCol)];
   }
 }
 
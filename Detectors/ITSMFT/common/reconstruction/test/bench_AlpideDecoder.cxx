@@ -0,0 +1,82 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file   bench_AlpideDecoder.cxx
+/// \brief  Benchmark of the ALPIDE chip data decoder
+
+#include "benchmark/benchmark.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include "ITSMFTReconstruction/AlpideCoder.h"
+#include "ITSMFTReconstruction/PayLoadCont.h"
+#include "ITSMFTReconstruction/PixelData.h"
+
+using namespace o2::itsmft;
+
+// Encode nChips chips with nClusters random clusters of up to 6 pixels each
+PayLoadCont generateTestData(int nChips, int nClusters)
+{
+  std::mt19937 rng(1234);
+  AlpideCoder coder;
+  PayLoadCont buffer;
+  ChipPixelData chipData;
+  std::vector<std::pair<int, int>> pixels; // row, column
+  for (int ichip = 0; ichip < nChips; ichip++) {
+    pixels.clear();
+    for (int icl = 0; icl < nClusters; icl++) {
+      int row = rng() % (AlpideCoder::NRows - 2), col = rng() % (AlpideCoder::NCols - 2), size = 1 + rng() % 6;
+      for (int ip = 0; ip < size; ip++) {
+        pixels.emplace_back(row + rng() % 3, col + rng() % 3);
+      }
+    }
+    std::sort(pixels.begin(), pixels.end());
+    pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+    chipData.clear();
+    for (const auto& pix : pixels) {
+      chipData.getData().emplace_back(pix.first, pix.second);
+    }
+    buffer.ensureFreeCapacity(40 * (2 + pixels.size()));
+    coder.encodeChip(buffer, chipData, ichip % 9, rng() % 3564);
+  }
+  return buffer;
+}
+
+static void BM_DecodeChip(benchmark::State& state)
+{
+  auto buffer = generateTestData(state.range(0), state.range(1));
+  ChipPixelData chipData;
+  size_t nPixels = 0;
+
+  for (auto _ : state) {
+    buffer.rewind();
+    while (!buffer.isEmpty()) {
+      AlpideCoder::decodeChip(chipData, buffer, [](uint16_t chipInModule) { return chipInModule; });
+      nPixels += chipData.getData().size();
+    }
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * buffer.getSize());
+  state.counters["pixels"] = benchmark::Counter(nPixels, benchmark::Counter::kIsRate);
+}
+
+static void CustomArguments(benchmark::internal::Benchmark* bench)
+{
+  // number of chips, number of clusters per chip
+  bench->Args({10000, 1});
+  bench->Args({10000, 20});
+  bench->Args({1000, 500});
+}
+
+BENCHMARK(BM_DecodeChip)->Apply(CustomArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,231 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testAlpideCoder.cxx
+/// \brief this task tests the decoding of the ALPIDE chip data encoded by the AlpideCoder
+
+#define BOOST_TEST_MODULE Test ITSMFT AlpideCoder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ITSMFTReconstruction/AlpideCoder.h"
+#include "ITSMFTReconstruction/DecodingStat.h"
+#include "ITSMFTReconstruction/PayLoadCont.h"
+#include "ITSMFTReconstruction/PixelData.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+namespace itsmft
+{
+
+using Pixels = std::vector<std::pair<int, int>>; // column, row, i.e. in the order of the decoded pixels
+
+static auto chipIDGetter = [](uint16_t chipInModule) { return chipInModule; };
+
+/// chip with nClusters random clusters of up to 6 pixels each, as in bench_AlpideDecoder
+ChipPixelData generateChip(std::mt19937& rng, int nClusters)
+{
+  std::vector<std::pair<int, int>> pixels; // row, column
+  for (int icl = 0; icl < nClusters; icl++) {
+    int row = rng() % (AlpideCoder::NRows - 2), col = rng() % (AlpideCoder::NCols - 2), size = 1 + rng() % 6;
+    for (int ip = 0; ip < size; ip++) {
+      pixels.emplace_back(row + rng() % 3, col + rng() % 3);
+    }
+  }
+  std::sort(pixels.begin(), pixels.end());
+  pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+  ChipPixelData chipData;
+  for (const auto& pix : pixels) {
+    chipData.getData().emplace_back(pix.first, pix.second);
+  }
+  return chipData;
+}
+
+/// pixels of the chip in the order of the container
+Pixels decodedPixels(const ChipPixelData& chipData)
+{
+  Pixels pixels;
+  for (const auto& pix : chipData.getData()) {
+    pixels.emplace_back(pix.getCol(), pix.getRow());
+  }
+  return pixels;
+}
+
+/// pixels of the chip sorted in column/row, as provided by the decoder
+Pixels sortedPixels(const ChipPixelData& chipData)
+{
+  auto pixels = decodedPixels(chipData);
+  std::sort(pixels.begin(), pixels.end());
+  return pixels;
+}
+
+/// encode the chip alone in the buffer
+PayLoadCont encode(const ChipPixelData& chipData, uint16_t chipInModule, uint16_t bc)
+{
+  AlpideCoder coder;
+  PayLoadCont buffer;
+  buffer.ensureFreeCapacity(40 * (2 + chipData.getData().size()));
+  coder.encodeChip(buffer, chipData, chipInModule, bc);
+  return buffer;
+}
+
+/// offsets of the records (chip header/empty, region, DATA SHORT/LONG, chip trailer) of the encoded buffer,
+/// the last entry being the size of the buffer
+std::vector<size_t> recordBoundaries(PayLoadCont& buffer, int& nDataLong)
+{
+  std::vector<size_t> boundaries;
+  size_t pos = 0;
+  nDataLong = 0;
+  while (pos < buffer.getSize()) {
+    boundaries.push_back(pos);
+    uint8_t b = buffer[pos];
+    if ((b & 0xf0) == AlpideCoder::CHIPHEADER || (b & 0xf0) == AlpideCoder::CHIPEMPTY) {
+      pos += 2;
+    } else if ((b & 0xf0) == AlpideCoder::CHIPTRAILER || (b & AlpideCoder::REGION) == AlpideCoder::REGION) {
+      pos += 1;
+    } else if ((b << 8) & AlpideCoder::DATASHORT) {
+      pos += 2;
+    } else { // DATA LONG: address and hit map
+      pos += 3;
+      nDataLong++;
+    }
+  }
+  boundaries.push_back(pos);
+  return boundaries;
+}
+
+/// encoding and decoding of a chip with pixels in both columns of neighbouring double columns, on rows with
+/// left to right (even) and right to left (odd) numbering, in DATA SHORT and DATA LONG records
+BOOST_AUTO_TEST_CASE(AlpideCoder_columns_test)
+{
+  // row, column, sorted in row/column as required by the encoder
+  const std::vector<std::pair<int, int>> pixels{{0, 1}, {0, 2}, {1, 0}, {1, 1}, {2, 0}, {3, 3}, {5, 1}, {9, 0}, {9, 1}, {20, 63}, {20, 64}, {511, 1023}};
+  ChipPixelData chipData;
+  for (const auto& pix : pixels) {
+    chipData.getData().emplace_back(pix.first, pix.second);
+  }
+  auto buffer = encode(chipData, 5, 1234);
+  int nDataLong = 0;
+  recordBoundaries(buffer, nDataLong);
+  BOOST_CHECK(nDataLong > 0);
+
+  ChipPixelData decoded;
+  BOOST_CHECK_EQUAL(AlpideCoder::decodeChip(decoded, buffer, chipIDGetter), int(pixels.size()));
+  BOOST_CHECK_EQUAL(decoded.getChipID(), 5);
+  BOOST_CHECK(!decoded.isErrorSet());
+  // left column of each double column first, then the right one, each of them sorted in row
+  const Pixels expected{{0, 1}, {0, 2}, {0, 9}, {1, 0}, {1, 1}, {1, 5}, {1, 9}, {2, 0}, {3, 3}, {63, 20}, {64, 20}, {1023, 511}};
+  BOOST_CHECK(decodedPixels(decoded) == expected);
+  BOOST_CHECK(buffer.isEmpty());
+  BOOST_CHECK_EQUAL(AlpideCoder::decodeChip(decoded, buffer, chipIDGetter), 0);
+}
+
+/// round trip of random chips, mixed with empty ones, in a single buffer
+BOOST_AUTO_TEST_CASE(AlpideCoder_roundtrip_test)
+{
+  std::mt19937 rng(1234);
+  AlpideCoder coder;
+  PayLoadCont buffer;
+  std::vector<ChipPixelData> chips;
+  std::vector<uint16_t> chipIDs;
+  int nDataLong = 0;
+  for (int ichip = 0; ichip < 500; ichip++) {
+    if (ichip % 7 == 0) {
+      buffer.ensureFreeCapacity(2);
+      coder.addEmptyChip(buffer, ichip % 9, rng() % 3564);
+      continue;
+    }
+    // from a single pixel to dense chips with several pixels in the same double column
+    chips.push_back(generateChip(rng, 1 + rng() % (ichip % 3 ? 20 : 500)));
+    chipIDs.push_back(ichip % 9);
+    auto chipBuffer = encode(chips.back(), ichip % 9, rng() % 3564);
+    int nDataLongChip = 0;
+    recordBoundaries(chipBuffer, nDataLongChip);
+    nDataLong += nDataLongChip;
+    buffer.add(chipBuffer.data(), chipBuffer.getSize());
+  }
+  BOOST_CHECK(nDataLong > 0);
+
+  ChipPixelData decoded;
+  for (size_t ichip = 0; ichip < chips.size(); ichip++) {
+    BOOST_TEST_CONTEXT("chip " << ichip)
+    {
+      BOOST_CHECK_EQUAL(AlpideCoder::decodeChip(decoded, buffer, chipIDGetter), int(chips[ichip].getData().size()));
+      BOOST_CHECK_EQUAL(decoded.getChipID(), chipIDs[ichip]);
+      BOOST_CHECK(!decoded.isErrorSet());
+      BOOST_CHECK(decodedPixels(decoded) == sortedPixels(chips[ichip]));
+    }
+  }
+  BOOST_CHECK(buffer.isEmpty());
+  BOOST_CHECK_EQUAL(AlpideCoder::decodeChip(decoded, buffer, chipIDGetter), 0);
+}
+
+/// decoding of chips truncated at every byte: a cut within a record is an error, a cut between records
+/// gives a subset of the pixels, and no byte after the cut is read
+BOOST_AUTO_TEST_CASE(AlpideCoder_truncation_test)
+{
+  std::mt19937 rng(4321);
+  for (int ichip = 0; ichip < 50; ichip++) {
+    auto chipData = generateChip(rng, ichip ? 1 + rng() % 20 : 0);
+    auto buffer = encode(chipData, ichip % 9, rng() % 3564);
+    const auto pixels = sortedPixels(chipData);
+    const std::set<std::pair<int, int>> pixelSet(pixels.begin(), pixels.end());
+    int nDataLong = 0;
+    const auto boundaries = recordBoundaries(buffer, nDataLong);
+    BOOST_REQUIRE_EQUAL(boundaries.back(), buffer.getSize());
+
+    // the bytes after the cut are kept in the buffer, such that reading beyond the end gives data
+    const size_t size = buffer.getSize();
+    for (size_t cut = 0; cut <= size; cut++) {
+      BOOST_TEST_CONTEXT("chip " << ichip << " cut at byte " << cut << " of " << size)
+      {
+        buffer.rewind();
+        uint8_t* start = buffer.getPtr();
+        buffer.setEnd(start + cut);
+        ChipPixelData decoded;
+        int ret = AlpideCoder::decodeChip(decoded, buffer, chipIDGetter);
+        BOOST_CHECK(buffer.getPtr() <= start + cut);
+
+        auto rec = std::upper_bound(boundaries.begin(), boundaries.end(), cut) - 1;
+        if (*rec != cut) { // within a record
+          BOOST_CHECK_EQUAL(ret, AlpideCoder::Error);
+          BOOST_CHECK(decoded.isErrorSet());
+          uint8_t b = buffer[*rec];
+          if (cut == 1) {
+            BOOST_CHECK(decoded.isErrorSet(pixels.empty() ? ChipStat::TruncatedChipEmpty : ChipStat::TruncatedChipHeader));
+          } else if (cut - *rec == 2 && !((b << 8) & AlpideCoder::DATASHORT)) {
+            BOOST_CHECK(decoded.isErrorSet(ChipStat::TruncatedLondData));
+          } else {
+            BOOST_CHECK(decoded.isErrorSet(ChipStat::TruncatedRegion));
+          }
+        } else if (cut == size) {
+          BOOST_CHECK_EQUAL(ret, int(pixels.size()));
+          BOOST_CHECK(!decoded.isErrorSet());
+          BOOST_CHECK(decodedPixels(decoded) == pixels);
+        } else { // between records: the pixels read before the cut
+          BOOST_CHECK_EQUAL(ret, int(decoded.getData().size()));
+          BOOST_CHECK(!decoded.isErrorSet());
+          for (const auto& pix : decodedPixels(decoded)) {
+            BOOST_CHECK(pixelSet.count(pix));
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace itsmft
+} // namespace o2
@@ -0,0 +1,164 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testLookUp.cxx
+/// \brief this task tests the look-up of the cluster topologies in the dictionary
+
+#define BOOST_TEST_MODULE Test ITSMFT LookUp
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ITSMFTReconstruction/BuildTopologyDictionary.h"
+#include "ITSMFTReconstruction/LookUp.h"
+#include "DataFormatsITSMFT/ClusterTopology.h"
+#include "DataFormatsITSMFT/TopologyDictionary.h"
+#include <array>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace itsmft
+{
+
+using Pattern = std::array<unsigned char, ClusterPattern::MaxPatternBytes>;
+
+static constexpr int NTOPOLOGIES = 3000;
+static const std::string DictionaryFile = "testLookUpDictionary.bin";
+
+void setPixel(Pattern& patt, int nCol, int row, int col)
+{
+  int nbits = row * nCol + col;
+  patt[nbits >> 3] |= (0x1 << (7 - (nbits % 8)));
+}
+
+/// random pattern with the given row and column span
+Pattern createPattern(std::mt19937& rng, int nRow, int nCol)
+{
+  Pattern patt{};
+  // pixels on the edges of the bounding box
+  setPixel(patt, nCol, 0, rng() % nCol);
+  setPixel(patt, nCol, nRow - 1, rng() % nCol);
+  setPixel(patt, nCol, rng() % nRow, 0);
+  setPixel(patt, nCol, rng() % nRow, nCol - 1);
+  for (int i = rng() % (nRow * nCol); i--;) {
+    setPixel(patt, nCol, rng() % nRow, rng() % nCol);
+  }
+  return patt;
+}
+
+/// dictionary of random topologies with a falling frequency, the rare ones being grouped
+void createDictionary()
+{
+  std::mt19937 rng(1234);
+  BuildTopologyDictionary builder;
+  std::set<unsigned long> hashes;
+  for (int itopo = 0; itopo < NTOPOLOGIES; itopo++) {
+    // mostly small topologies, some of them with a single byte, and a few large ones
+    int nRow = 1 + rng() % 6, nCol = 1 + rng() % 6;
+    if (itopo % 10 == 0) {
+      nRow = 1 + rng() % 40;
+      nCol = 1 + rng() % 40;
+    }
+    auto patt = createPattern(rng, nRow, nCol);
+    ClusterTopology topology(nRow, nCol, patt.data());
+    if (!hashes.insert(topology.getHash()).second) {
+      continue;
+    }
+    for (int i = 0; i < 1 + 2000 / (itopo + 1); i++) {
+      builder.accountTopology(topology);
+    }
+  }
+  builder.setThreshold(1.e-4);
+  builder.groupRareTopologies();
+  builder.printDictionaryBinary(DictionaryFile);
+}
+
+/// every common topology of the dictionary is found with its ID, whatever the size of its pattern
+BOOST_AUTO_TEST_CASE(LookUp_common_test)
+{
+  createDictionary();
+  LookUp lookUp(DictionaryFile);
+  TopologyDictionary dictionary;
+  dictionary.readBinaryFile(DictionaryFile);
+  BOOST_REQUIRE_EQUAL(lookUp.size(), dictionary.getSize());
+
+  int nCommon = 0, nSmall = 0;
+  for (int id = 0; id < dictionary.getSize(); id++) {
+    if (dictionary.isGroup(id)) {
+      continue;
+    }
+    auto pattern = dictionary.getPattern(id);
+    auto bitmap = pattern.getPattern();
+    const unsigned char* patt = bitmap.data() + 2; // skip the row and column span
+    BOOST_CHECK_EQUAL(dictionary.getHash(id), ClusterTopology::getCompleteHash(pattern.getRowSpan(), pattern.getColumnSpan(), patt));
+    BOOST_CHECK_EQUAL(lookUp.findGroupID(pattern.getRowSpan(), pattern.getColumnSpan(), patt), id);
+    nSmall += pattern.getRowSpan() * pattern.getColumnSpan() < 9;
+    nCommon++;
+  }
+  BOOST_CHECK_EQUAL(nCommon, lookUp.getTopologiesOverThreshold());
+  BOOST_CHECK(nSmall > 0);
+  BOOST_CHECK(nCommon - nSmall > 100); // enough entries for collisions in the buckets of the perfect hash
+}
+
+/// topologies which are not in the dictionary are found as the group of their row and column span,
+/// for all groups of the dictionary
+BOOST_AUTO_TEST_CASE(LookUp_groups_test)
+{
+  createDictionary();
+  LookUp lookUp(DictionaryFile);
+  TopologyDictionary dictionary;
+  dictionary.readBinaryFile(DictionaryFile);
+
+  std::set<unsigned long> commonHashes;
+  std::map<int, int> groupIDs; // group index -> ID
+  for (int id = 0; id < dictionary.getSize(); id++) {
+    if (dictionary.isGroup(id)) {
+      groupIDs[dictionary.getHash(id) >> 32] = id;
+      BOOST_CHECK(lookUp.isGroup(id));
+    } else {
+      commonHashes.insert(dictionary.getHash(id));
+    }
+  }
+  BOOST_CHECK_EQUAL(groupIDs.size(), size_t(TopologyDictionary::NumberOfRareGroups));
+
+  std::mt19937 rng(4321);
+  std::set<int> groupsFound;
+  int nForeign = 0;
+  for (int nRow = 1; nRow <= ClusterPattern::MaxRowSpan; nRow++) {
+    for (int nCol = 1; nCol <= ClusterPattern::MaxColSpan; nCol++) {
+      // the small spans have most of the common topologies, more patterns are tried
+      const int nPatterns = (nRow <= 8 && nCol <= 8) ? 20 : 1;
+      for (int i = 0; i < nPatterns; i++) {
+        auto patt = createPattern(rng, nRow, nCol);
+        if (commonHashes.count(ClusterTopology::getCompleteHash(nRow, nCol, patt.data()))) {
+          continue;
+        }
+        int group = LookUp::groupFinder(nRow, nCol);
+        BOOST_TEST_CONTEXT("row span " << nRow << " column span " << nCol)
+        {
+          BOOST_REQUIRE(groupIDs.count(group));
+          BOOST_CHECK_EQUAL(lookUp.findGroupID(nRow, nCol, patt.data()), groupIDs[group]);
+        }
+        groupsFound.insert(group);
+        nForeign++;
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL(groupsFound.size(), groupIDs.size());
+  BOOST_CHECK(nForeign > 0);
+}
+
+} // namespace itsmft
+} // namespace o2
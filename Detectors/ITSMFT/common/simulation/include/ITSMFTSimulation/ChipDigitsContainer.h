@@ -20,7 +20,8 @@
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "ITSMFTBase/SegmentationAlpide.h"
 #include "ITSMFTSimulation/PreDigit.h"
-#include <map>
+#include <algorithm>
+#include <deque>
 #include <vector>
 
 namespace o2
@@ -31,6 +32,10 @@ class DigiParams;
 
 /// @class ChipDigitsContainer
 /// @brief Container for similated points connected to a given chip
+///
+/// The fired pixels are stored per readout frame in flat vectors with an open-addressing index on the pixel,
+/// instead of a node based map. The pre-digits of a frame are sorted in column/row order only once, when
+/// the frame is read out. The buffers of the frames which were read out are kept for reuse.
 
 class ChipDigitsContainer
 {
@@ -41,8 +46,8 @@ class ChipDigitsContainer
   /// Destructor
   ~ChipDigitsContainer() = default;
 
-  std::map<ULong64_t, o2::itsmft::PreDigit>& getPreDigits() { return mDigits; }
-  bool isEmpty() const { return mDigits.empty(); }
+  bool isEmpty() const { return mNDigits == 0; }
+  size_t getNDigits() const { return mNDigits; }
 
   void setChipIndex(UShort_t ind) { mChipIndex = ind; }
   UShort_t getChipIndex() const { return mChipIndex; }
@@ -51,6 +56,13 @@ class ChipDigitsContainer
   void addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl);
   void addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmft::DigiParams* params, int maxRows = o2::itsmft::SegmentationAlpide::NRows, int maxCols = o2::itsmft::SegmentationAlpide::NCols);
 
+  /// Get the pre-digits of all frames up to given one, sorted in frame/column/row order.
+  /// They stay valid until the call to releaseROFrames
+  const std::vector<o2::itsmft::PreDigit>& getSortedPreDigits(UInt_t roframe);
+
+  /// Discard the pre-digits of all frames up to given one, keeping their buffers for reuse
+  void releaseROFrames(UInt_t roframe);
+
   /// Get global ordering key made of readout frame, column and row
   static ULong64_t getOrderingKey(UInt_t roframe, UShort_t row, UShort_t col)
   {
@@ -64,25 +76,83 @@ class ChipDigitsContainer
   }
 
  protected:
-  UShort_t mChipIndex = 0;                           ///< chip index
-  std::map<ULong64_t, o2::itsmft::PreDigit> mDigits; ///< Map of fired pixels, possibly in multiple frames
-
-  ClassDefNV(ChipDigitsContainer, 1);
+  /// pre-digits of a single readout frame
+  struct ROFrameDigits {
+    static constexpr int MinIndexSize = 64;
+    std::vector<o2::itsmft::PreDigit> digits; ///< pre-digits in the order of creation
+    std::vector<int> index;                   ///< open-addressing index on the pixel, position in digits + 1 (0 = empty)
+
+    /// pixel part of the ordering key, ordered by column then row
+    static UInt_t pixelKey(UShort_t row, UShort_t col) { return (UInt_t(col) << (8 * sizeof(Short_t))) + row; }
+    size_t hashSlot(UInt_t pixKey) const { return (pixKey * 2654435761u) & (index.size() - 1); }
+    o2::itsmft::PreDigit* find(UInt_t pixKey);
+    void add(const o2::itsmft::PreDigit& digit);
+    void rehash(size_t size);
+    void clear();
+  };
+
+  /// get the buffer of a frame, creating it if needed
+  ROFrameDigits& getROFrameDigits(UInt_t roframe);
+
+  UShort_t mChipIndex = 0;                     ///< chip index
+  UInt_t mFirstROFrame = 0;                    ///< frame of the 1st entry in mROFrames
+  size_t mNDigits = 0;                         ///< total number of pre-digits stored
+  std::deque<ROFrameDigits> mROFrames;         //! per-frame pre-digits, starting from mFirstROFrame
+  std::vector<ROFrameDigits> mROFramesPool;    //! buffers of already read out frames
+  std::vector<o2::itsmft::PreDigit> mSorted;   //! workspace for the sorted readout
+
+  ClassDefNV(ChipDigitsContainer, 2);
 };
 
+//_______________________________________________________________________
+inline o2::itsmft::PreDigit* ChipDigitsContainer::ROFrameDigits::find(UInt_t pixKey)
+{
+  if (digits.empty()) {
+    return nullptr;
+  }
+  const size_t mask = index.size() - 1;
+  for (size_t slot = hashSlot(pixKey); index[slot]; slot = (slot + 1) & mask) {
+    auto& dig = digits[index[slot] - 1];
+    if (pixelKey(dig.row, dig.col) == pixKey) {
+      return &dig;
+    }
+  }
+  return nullptr;
+}
+
+//_______________________________________________________________________
+inline void ChipDigitsContainer::ROFrameDigits::add(const o2::itsmft::PreDigit& digit)
+{
+  digits.push_back(digit);
+  if (2 * digits.size() > index.size()) { // keep the load factor below 1/2
+    rehash(std::max(size_t(MinIndexSize), 2 * index.size()));
+    return;
+  }
+  const size_t mask = index.size() - 1;
+  size_t slot = hashSlot(pixelKey(digit.row, digit.col));
+  while (index[slot]) {
+    slot = (slot + 1) & mask;
+  }
+  index[slot] = digits.size();
+}
+
 //_______________________________________________________________________
 inline o2::itsmft::PreDigit* ChipDigitsContainer::findDigit(ULong64_t key)
 {
   // finds the digit corresponding to global key
-  auto digitentry = mDigits.find(key);
-  return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  const auto roframe = key2ROFrame(key);
+  if (roframe < mFirstROFrame || roframe >= mFirstROFrame + mROFrames.size()) {
+    return nullptr;
+  }
+  return mROFrames[roframe - mFirstROFrame].find(static_cast<UInt_t>(key));
 }
 
 //_______________________________________________________________________
 inline void ChipDigitsContainer::addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col,
                                           int charge, o2::MCCompLabel lbl)
 {
-  mDigits.emplace(std::make_pair(key, o2::itsmft::PreDigit(roframe, row, col, charge, lbl)));
+  getROFrameDigits(roframe).add(o2::itsmft::PreDigit(roframe, row, col, charge, lbl));
+  mNDigits++;
 }
 } // namespace itsmft
 } // namespace o2
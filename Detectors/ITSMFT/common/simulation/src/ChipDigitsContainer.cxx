@@ -47,3 +47,75 @@ void ChipDigitsContainer::addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmf
     }
   }
 }
+
+//______________________________________________________________________
+ChipDigitsContainer::ROFrameDigits& ChipDigitsContainer::getROFrameDigits(UInt_t roframe)
+{
+  // get the buffer of the frame, extending the list of frames if needed
+  auto getBuffer = [this]() {
+    if (mROFramesPool.empty()) {
+      return ROFrameDigits();
+    }
+    auto buff = std::move(mROFramesPool.back());
+    mROFramesPool.pop_back();
+    return buff;
+  };
+  if (mROFrames.empty()) {
+    mFirstROFrame = roframe;
+  }
+  while (roframe < mFirstROFrame) {
+    mROFrames.emplace_front(getBuffer());
+    mFirstROFrame--;
+  }
+  while (roframe >= mFirstROFrame + mROFrames.size()) {
+    mROFrames.emplace_back(getBuffer());
+  }
+  return mROFrames[roframe - mFirstROFrame];
+}
+
+//______________________________________________________________________
+const std::vector<PreDigit>& ChipDigitsContainer::getSortedPreDigits(UInt_t roframe)
+{
+  mSorted.clear();
+  for (size_t i = 0; i < mROFrames.size() && mFirstROFrame + i <= roframe; i++) {
+    auto& digits = mROFrames[i].digits;
+    auto first = mSorted.insert(mSorted.end(), digits.begin(), digits.end());
+    std::sort(first, mSorted.end(), [](const PreDigit& a, const PreDigit& b) {
+      return ROFrameDigits::pixelKey(a.row, a.col) < ROFrameDigits::pixelKey(b.row, b.col);
+    });
+  }
+  return mSorted;
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::releaseROFrames(UInt_t roframe)
+{
+  while (!mROFrames.empty() && mFirstROFrame <= roframe) {
+    mNDigits -= mROFrames.front().digits.size();
+    mROFrames.front().clear();
+    mROFramesPool.emplace_back(std::move(mROFrames.front()));
+    mROFrames.pop_front();
+    mFirstROFrame++;
+  }
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::ROFrameDigits::rehash(size_t size)
+{
+  index.assign(size, 0);
+  const size_t mask = size - 1;
+  for (size_t i = 0; i < digits.size(); i++) {
+    size_t slot = hashSlot(pixelKey(digits[i].row, digits[i].col));
+    while (index[slot]) {
+      slot = (slot + 1) & mask;
+    }
+    index[slot] = i + 1;
+  }
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::ROFrameDigits::clear()
+{
+  digits.clear();
+  std::fill(index.begin(), index.end(), 0);
+}
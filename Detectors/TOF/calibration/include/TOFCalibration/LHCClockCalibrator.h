@@ -68,6 +68,8 @@ class LHCClockCalibrator final : public o2::calibration::TimeSlotCalibration<o2:
   bool hasEnoughData(const Slot& slot) const final { return slot.getContainer()->entries >= mMinEntries; }
   void initOutput() final;
   void finalizeSlot(Slot& slot) final;
+  // the fit runs in the worker, only the storage of the result is left to the publishing
+  o2::calibration::SlotFinalizationPool::Task prepareSlotFinalization(std::shared_ptr<Slot> slot) final;
   Slot& emplaceNewSlot(bool front, TFType tstart, TFType tend) final;
 
   const LHCphaseVector& getLHCphaseVector() const { return mLHCphaseVector; }
@@ -75,6 +77,10 @@ class LHCClockCalibrator final : public o2::calibration::TimeSlotCalibration<o2:
   CcdbObjectInfoVector& getLHCphaseInfoVector() { return mInfoVector; }
 
  private:
+  // fit the LHC phase of the slot, reading only the slot
+  static float fitLHCphase(Slot& slot);
+  void addLHCphase(TFType tfStart, float phase);
+
   int mMinEntries = 0;
   int mNBins = 0;
   float mRange = 0.;
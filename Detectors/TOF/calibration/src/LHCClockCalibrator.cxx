@@ -15,6 +15,7 @@
 #include "CommonUtils/MemFileHelper.h"
 #include "CCDB/CcdbApi.h"
 #include "DetectorsCalibration/Utils.h"
+#include <mutex>
 
 namespace o2
 {
@@ -77,30 +78,56 @@ void LHCClockCalibrator::initOutput()
 void LHCClockCalibrator::finalizeSlot(Slot& slot)
 {
   // Extract results for the single slot
+  addLHCphase(slot.getTFStart(), fitLHCphase(slot));
+  slot.print();
+}
+
+//_____________________________________________
+o2::calibration::SlotFinalizationPool::Task LHCClockCalibrator::prepareSlotFinalization(std::shared_ptr<Slot> slot)
+{
+  // the task uses only the slot, the calibrator is accessed by the publisher in the calling thread
+  return [this, slot]() -> o2::calibration::SlotFinalizationPool::Publisher {
+    float phase = fitLHCphase(*slot);
+    return [this, tfStart = slot->getTFStart(), phase]() { addLHCphase(tfStart, phase); };
+  };
+}
+
+//_____________________________________________
+float LHCClockCalibrator::fitLHCphase(Slot& slot)
+{
   o2::tof::LHCClockDataHisto* c = slot.getContainer();
   LOG(INFO) << "Finalize slot " << slot.getTFStart() << " <= TF <= " << slot.getTFEnd() << " with "
             << c->getEntries() << " entries";
   std::vector<float> fitValues;
   float* array = &c->histo[0];
-  double fitres = fitGaus(c->nbins, array, -(c->range), c->range, fitValues);
+  double fitres;
+  {
+    // fitGaus uses a static fitter, the fits of the slots finalized in parallel must not overlap
+    static std::mutex fitMutex;
+    std::lock_guard<std::mutex> lock(fitMutex);
+    fitres = fitGaus(c->nbins, array, -(c->range), c->range, fitValues);
+  }
   if (fitres >= 0) {
     LOG(INFO) << "Fit result " << fitres << " Mean = " << fitValues[1] << " Sigma = " << fitValues[2];
   } else {
     LOG(ERROR) << "Fit failed with result = " << fitres;
   }
+  return fitValues[1];
+}
 
+//_____________________________________________
+void LHCClockCalibrator::addLHCphase(TFType tfStart, float phase)
+{
   // TODO: the timestamp is now given with the TF index, but it will have
   // to become an absolute time. This is true both for the lhc phase object itself
   // and the CCDB entry
   std::map<std::string, std::string> md;
   LHCphase l;
-  l.addLHCphase(slot.getTFStart(), fitValues[1]);
+  l.addLHCphase(tfStart, phase);
   auto clName = o2::utils::MemFileHelper::getClassName(l);
   auto flName = o2::ccdb::CcdbApi::generateFileName(clName);
-  mInfoVector.emplace_back("TOF/LHCphase", clName, flName, md, slot.getTFStart(), 99999999999999);
+  mInfoVector.emplace_back("TOF/LHCphase", clName, flName, md, tfStart, 99999999999999);
   mLHCphaseVector.emplace_back(l);
-
-  slot.print();
 }
 
 //_____________________________________________
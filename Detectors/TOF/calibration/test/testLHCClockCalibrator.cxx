@@ -0,0 +1,124 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test LHCClockCalibrator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TOFCalibration/LHCClockCalibrator.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace o2::tof;
+using CalibInfoTOF = o2::dataformats::CalibInfoTOF;
+
+constexpr int NTFs = 40;
+constexpr int TFsPerSlot = 5;
+constexpr uint64_t INFINITE_TF = 0xffffffffffffffff;
+
+// data of one TF, the LHC phase is 50 ps times the slot number
+std::vector<CalibInfoTOF> generateTF(int tf)
+{
+  std::mt19937 rng(tf);
+  std::normal_distribution<float> deltaTime(50.f * (tf / TFsPerSlot), 200.f);
+  std::vector<CalibInfoTOF> data;
+  for (int i = 0; i < 2000; i++) {
+    data.emplace_back(i, tf, deltaTime(rng), 10.f);
+  }
+  return data;
+}
+
+std::unique_ptr<LHCClockCalibrator> makeCalibrator(int nFinalizationThreads, int nFillThreads = 1)
+{
+  auto calibrator = std::make_unique<LHCClockCalibrator>();
+  calibrator->setSlotLength(TFsPerSlot);
+  calibrator->setMaxSlotsDelay(1);
+  calibrator->setNFillThreads(nFillThreads, 100);
+  calibrator->setNAsyncFinalizationThreads(nFinalizationThreads);
+  return calibrator;
+}
+
+// the asynchronous finalization gives the same results, in the same order, as the synchronous one
+BOOST_AUTO_TEST_CASE(LHCClockCalibrator_async)
+{
+  auto sync = makeCalibrator(0);
+  auto async = makeCalibrator(3);
+  for (int tf = 0; tf < NTFs; tf++) {
+    auto data = generateTF(tf);
+    sync->process(tf, data);
+    async->process(tf, data);
+  }
+  // end of run: everything must be published when checkSlotsToFinalize returns
+  sync->checkSlotsToFinalize(INFINITE_TF);
+  async->checkSlotsToFinalize(INFINITE_TF);
+  BOOST_CHECK_EQUAL(async->getNPendingFinalizations(), 0);
+
+  const auto& syncPhases = sync->getLHCphaseVector();
+  const auto& asyncPhases = async->getLHCphaseVector();
+  const auto& syncInfos = sync->getLHCphaseInfoVector();
+  const auto& asyncInfos = async->getLHCphaseInfoVector();
+  BOOST_REQUIRE_EQUAL(syncPhases.size(), NTFs / TFsPerSlot);
+  BOOST_REQUIRE_EQUAL(asyncPhases.size(), syncPhases.size());
+  BOOST_REQUIRE_EQUAL(asyncInfos.size(), syncInfos.size());
+  for (size_t i = 0; i < syncPhases.size(); i++) {
+    const int tfStart = i * TFsPerSlot;
+    BOOST_CHECK_EQUAL(syncInfos[i].getStartValidityTimestamp(), tfStart);
+    BOOST_CHECK_EQUAL(asyncInfos[i].getStartValidityTimestamp(), tfStart);
+    BOOST_CHECK_EQUAL(asyncPhases[i].getLHCphase(tfStart), syncPhases[i].getLHCphase(tfStart));
+    BOOST_CHECK_SMALL(syncPhases[i].getLHCphase(tfStart) - 50.f * i, 25.f);
+  }
+}
+
+// a calibrator can be destroyed while slots are being finalized in the background
+BOOST_AUTO_TEST_CASE(LHCClockCalibrator_destruction)
+{
+  auto calibrator = makeCalibrator(2);
+  for (int tf = 0; tf < NTFs; tf++) {
+    calibrator->process(tf, generateTF(tf));
+  }
+  calibrator.reset();
+  BOOST_CHECK(!calibrator);
+}
+
+// filling the TFs in several threads gives the same histograms and results as the serial filling
+BOOST_AUTO_TEST_CASE(LHCClockCalibrator_parallelFill)
+{
+  auto serial = makeCalibrator(0);
+  auto parallel = makeCalibrator(0, 3);
+  for (int tf = 0; tf < NTFs; tf++) {
+    auto data = generateTF(tf);
+    serial->process(tf, data);
+    parallel->process(tf, data);
+  }
+  // the slots still open hold unmerged shards: a copy of the slot must keep them
+  BOOST_REQUIRE_EQUAL(parallel->getNSlots(), serial->getNSlots());
+  BOOST_REQUIRE(parallel->getNSlots() > 0);
+  for (int i = 0; i < serial->getNSlots(); i++) {
+    auto copy = parallel->getSlot(i);
+    BOOST_CHECK_EQUAL(copy.getNShards(), 3);
+    copy.mergeShards();
+    const auto* ref = serial->getSlot(i).getContainer();
+    BOOST_CHECK_EQUAL(copy.getContainer()->entries, ref->entries);
+    BOOST_CHECK(copy.getContainer()->histo == ref->histo);
+  }
+
+  serial->checkSlotsToFinalize(INFINITE_TF);
+  parallel->checkSlotsToFinalize(INFINITE_TF);
+  const auto& serialPhases = serial->getLHCphaseVector();
+  const auto& parallelPhases = parallel->getLHCphaseVector();
+  BOOST_REQUIRE_EQUAL(serialPhases.size(), NTFs / TFsPerSlot);
+  BOOST_REQUIRE_EQUAL(parallelPhases.size(), serialPhases.size());
+  for (size_t i = 0; i < serialPhases.size(); i++) {
+    const int tfStart = i * TFsPerSlot;
+    BOOST_CHECK_EQUAL(parallelPhases[i].getLHCphase(tfStart), serialPhases[i].getLHCphase(tfStart));
+  }
+}
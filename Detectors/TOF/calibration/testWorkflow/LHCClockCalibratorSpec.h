@@ -45,6 +45,8 @@ class LHCClockCalibDevice : public o2::framework::Task
     mCalibrator = std::make_unique<o2::tof::LHCClockCalibrator>(minEnt, nb);
     mCalibrator->setSlotLength(slotL);
     mCalibrator->setMaxSlotsDelay(delay);
+    mCalibrator->setNFillThreads(ic.options().get<int>("fill-threads"));
+    mCalibrator->setNAsyncFinalizationThreads(ic.options().get<int>("finalize-threads"));
   }
 
   void run(o2::framework::ProcessingContext& pc) final
@@ -115,7 +117,9 @@ DataProcessorSpec getLHCClockCalibDeviceSpec()
       {"tf-per-slot", VariantType::Int, 5, {"number of TFs per calibration time slot"}},
       {"max-delay", VariantType::Int, 3, {"number of slots in past to consider"}},
       {"min-entries", VariantType::Int, 500, {"minimum number of entries to fit single time slot"}},
-      {"nbins", VariantType::Int, 1000, {"number of bins for "}}}};
+      {"nbins", VariantType::Int, 1000, {"number of bins for "}},
+      {"fill-threads", VariantType::Int, 1, {"number of threads to fill the histogram of a TF with many entries"}},
+      {"finalize-threads", VariantType::Int, 0, {"number of threads to fit the closed slots in the background (0 = fit in the processing thread)"}}}};
 }
 
 } // namespace framework
@@ -26,6 +26,7 @@
 #include <bitset>
 #include <string>
 #include <Rtypes.h>
+#include <gsl/span>
 
 #include "DataFormatsTPC/Defs.h"
 #include "SpacePoints/SpacePointsCalibParam.h"
@@ -172,10 +173,32 @@ class TrackResiduals
   /// Loads residual data from track interpolation and fills voxel data structures local residuals
   void convertToLocalResiduals();
 
+  /// Fills the local residuals of each sector directly from the output of the track interpolation (e.g. the content of
+  /// one DPL message). Can be called several times, the residuals are accumulated in memory until processResiduals()
+  /// is called and no intermediate trees are written.
+  /// \param trackData Track information from the track interpolation
+  /// \param clRes TPC cluster residuals referenced by trackData
+  void fillLocalResiduals(gsl::span<const TrackData> trackData, gsl::span<const TPCClusterResiduals> clRes);
+
+  /// Adds a single local residual to the in-memory input of the given sector
+  /// \param iSec Sector of the residual
+  /// \param res Local residual
+  void addLocalResidual(int iSec, const LocalResid& res);
+
+  /// Clears the in-memory local residuals of all sectors
+  void clearLocalResiduals();
+
+  /// \return Number of local residuals stored in memory for the given sector
+  /// \param iSec Sector
+  size_t getNLocalResiduals(int iSec) const { return mLocalResiduals[iSec].size(); }
+
   /// Steers the processing of the residuals for all sectors.
+  /// The sectors are processed in parallel by getNThreads() threads, their results are then dumped in the order of the sectors.
   void processResiduals();
 
-  /// Processes residuals for given sector.
+  /// Processes residuals for given sector and dumps the results.
+  /// The residuals which were filled in memory are used if available, otherwise they are read from the local residuals tree
+  /// of the sector. The voxels of the sector are processed in parallel.
   /// \param iSec Sector to process
   void processSectorResiduals(Int_t iSec);
 
@@ -202,6 +225,12 @@ class TrackResiduals
   /// \param iSec Sector to process
   void smooth(int iSec);
 
+  /// Reads the local residuals for given sector from the tree created by fillLocalResidualsTrees() or convertToLocalResiduals()
+  /// \param iSec Sector to read
+  /// \param data Vector which is filled with the local residuals
+  /// \return false if the file or tree could not be accessed
+  bool readLocalResiduals(int iSec, std::vector<LocalResid>& data) const;
+
   // -------------------------------------- statistics --------------------------------------------------
 
   /// Performs a robust linear fit y(x) = a + b * x for given x and y.
@@ -437,6 +466,11 @@ class TrackResiduals
   // -------------------------------------- settings --------------------------------------------------
 
   void setPathToResFileRun2(std::string fPath) { mPathToResidualFiles = fPath; }
+  /// Sets the number of threads used for the processing of the sectors and voxels
+  /// \param nThreads Number of threads
+  static void setNThreads(const int nThreads) { sNThreads = nThreads; }
+  /// Sets if the local residuals filled by convertToLocalResiduals() are also written to trees (one file per sector)
+  void setWriteLocalResidualTrees(bool write) { mWriteLocalResidualTrees = write; }
   void setLocalResFileName(std::string fName) { mLocalResFileName = fName; }
   void setLocalResTreeName(std::string tName) { mLocalResTreeName = tName; }
   void setLocalResBranchName(std::string bName) { mLocalResBranchName = bName; }
@@ -455,6 +489,9 @@ class TrackResiduals
   void setMaxSigZ(float sigZ) { mMaxSigZ = sigZ; }
   void setMaxGaussStdDev(float sigmas) { mMaxGaussStdDev = sigmas; }
 
+  /// \return Number of threads used for the processing of the sectors and voxels
+  static int getNThreads() { return sNThreads; }
+  bool getWriteLocalResidualTrees() const { return mWriteLocalResidualTrees; }
   std::string getLocalResFileName() const { return mLocalResFileName; }
   std::string getLocalResTreeName() const { return mLocalResTreeName; }
   std::string getLocalResBranchName() const { return mLocalResBranchName; }
@@ -510,6 +547,12 @@ class TrackResiduals
   void closeOutputFile();
 
  private:
+  /// Extracts, validates and smooths the voxel results of the given sector, without dumping them.
+  /// When called from the parallel loop over the sectors in processResiduals() the voxels are processed by a single thread.
+  /// \param iSec Sector to process
+  /// \return true if the results of the sector were extracted
+  bool extractSectorResults(int iSec);
+
   // names of input files / trees
   std::string mInputFileNameResiduals{"residuals_tpc.root"}; ///< name of file with track residuals
   // some constants
@@ -518,6 +561,7 @@ class TrackResiduals
   static constexpr float sMaxZ2X{1.f};      ///< max value for Z2X
   static constexpr int sSmtLinDim{4};       ///< max matrix size for smoothing (pol1)
   static constexpr int sMaxSmtDim{7};       ///< max matrix size for smoothing (pol2)
+  inline static int sNThreads{1};           ///< number of threads used for the processing of the residuals
 
   // input data
   std::unique_ptr<TFile> mFileIn{};                     ///< input file with residuals data
@@ -554,10 +598,12 @@ class TrackResiduals
   float mMaxZ2X{1.f};                      ///< max z/x value
   std::array<bool, VoxDim> mUniformBins{true, true, true}; ///< if binning is uniform for each dimension
   // local residual data, extracted from track interpolation
-  std::array<std::unique_ptr<TFile>, SECTORSPERSIDE * SIDES> mTmpFile{}; ///< I/O file
-  std::array<std::unique_ptr<TTree>, SECTORSPERSIDE * SIDES> mTmpTree{}; ///< I/O tree per sector
-  LocalResid mLocalResid{};                                              ///< data exchange structure for filling mTmpTree
-  LocalResid* mLocalResidPtr{&mLocalResid};                              ///< pointer to mLocalResid
+  std::array<std::unique_ptr<TFile>, SECTORSPERSIDE * SIDES> mTmpFile{};         ///< I/O file
+  std::array<std::unique_ptr<TTree>, SECTORSPERSIDE * SIDES> mTmpTree{};         ///< I/O tree per sector
+  LocalResid mLocalResid{};                                                      ///< data exchange structure for filling mTmpTree
+  LocalResid* mLocalResidPtr{&mLocalResid};                                      ///< pointer to mLocalResid
+  std::array<std::vector<LocalResid>, SECTORSPERSIDE * SIDES> mLocalResiduals{}; ///< local residuals per sector kept in memory
+  bool mWriteLocalResidualTrees{false};                                          ///< write trees with local residuals in convertToLocalResiduals()
   // settings
   std::string mLocalResFileName{"deltasSect"};   ///< filename for local residuals input
   std::string mLocalResTreeName{"treeSec"};      ///< name for tree with local residuals
@@ -584,7 +630,6 @@ class TrackResiduals
   std::array<int, VoxDim> mStepKern{};                             ///< N bins to consider with given kernel settings
   std::array<float, VoxDim> mKernelScaleEdge{};                    ///< optional scaling factors for kernel width on the edge
   std::array<float, VoxDim> mKernelWInv{};                         ///< inverse kernel width in bins
-  std::array<double, ResDim * sMaxSmtDim> mLastSmoothingRes{};     ///< results of last smoothing operation
   // (intermediate) results
   std::array<std::bitset<param::NPadRows>, SECTORSPERSIDE * SIDES> mXBinsIgnore{};          ///< flags which X bins to ignore
   std::array<std::array<float, param::NPadRows>, SECTORSPERSIDE * SIDES> mValidFracXBins{}; ///< for each sector for each X-bin the fraction of validated voxels
@@ -39,6 +39,10 @@
 
 #include <fairlogger/Logger.h>
 
+#if (defined(WITH_OPENMP) || defined(_OPENMP)) && !defined(__CLING__)
+#include <omp.h>
+#endif
+
 //#define TPC_RUN2 // if defined, use run 2 geometry for TPC
 
 #define LOCAL_RESIDUAL_FORMAT_OLD // if defined, data in compact trees is stored as Double32_t, otherwise as short
@@ -745,31 +749,108 @@ void TrackResiduals::convertToLocalResiduals()
   mTreeInClRes->SetBranchAddress("residuals", &mClResPtr);
   mTreeInClRes->GetEntry(0);
 
-  prepareLocalResidualTrees();
+  fillLocalResiduals(mTrackData, mClRes);
 
-  // loop over tracks
-  for (const auto& trk : mTrackData) {
+  if (mWriteLocalResidualTrees) {
+    // write to file for debugging
+    prepareLocalResidualTrees();
+    for (int iSec = 0; iSec < SECTORSPERSIDE * SIDES; ++iSec) {
+      for (const auto& res : mLocalResiduals[iSec]) {
+        mLocalResid = res;
+        mTmpTree[iSec]->Fill();
+      }
+    }
+    writeLocalResidualTreesToFile();
+  }
+}
+
+void TrackResiduals::fillLocalResiduals(gsl::span<const TrackData> trackData, gsl::span<const TPCClusterResiduals> clRes)
+{
+  if (!mIsInitialized) {
+    init();
+  }
+  LocalResid res;
+  for (const auto& trk : trackData) {
     int iRow = 0;
     for (int iCl = 0; iCl < trk.clIdx.getEntries(); ++iCl) {
-      int clIdx = trk.clIdx.getFirstEntry() + iCl;
-      int sec = mClRes[clIdx].z < 0 ? mClRes[clIdx].sec : mClRes[clIdx].sec + SECTORSPERSIDE; // sector numbering 0..35 a.k.a. A0..C17
-      std::array<unsigned char, VoxDim> bvox;
-      iRow += mClRes[clIdx].dRow;
+      const auto& cl = clRes[trk.clIdx.getFirstEntry() + iCl];
+      int sec = cl.z < 0 ? cl.sec : cl.sec + SECTORSPERSIDE; // sector numbering 0..35 a.k.a. A0..C17
+      iRow += cl.dRow;
       float xPos = param::RowX[iRow];
-      if (!findVoxelBin(sec, xPos, mClRes[clIdx].y * param::MaxY / 0x7fff, mClRes[clIdx].z * param::MaxZ / 0x7fff, bvox)) {
+      if (!findVoxelBin(sec, xPos, cl.y * param::MaxY / 0x7fff, cl.z * param::MaxZ / 0x7fff, res.bvox)) {
         continue;
       }
-      mLocalResid.dy = mClRes[clIdx].dy;
-      mLocalResid.dz = mClRes[clIdx].dz;
-      mLocalResid.tgSlp = mClRes[clIdx].phi;
-      mLocalResid.bvox = bvox;
-      mTmpTree[sec]->Fill();
+      res.dy = cl.dy;
+      res.dz = cl.dz;
+      res.tgSlp = cl.phi;
+      addLocalResidual(sec, res);
       // TODO calculate mean position of clusters in each voxel (can be updated each time a new measurement is found inside voxel)
     }
   }
+}
 
-  // write to file for debugging
-  writeLocalResidualTreesToFile();
+void TrackResiduals::addLocalResidual(int iSec, const LocalResid& res)
+{
+  auto& data = mLocalResiduals[iSec];
+  if (data.size() < static_cast<size_t>(mMaxPointsPerSector)) {
+    data.push_back(res);
+  }
+}
+
+void TrackResiduals::clearLocalResiduals()
+{
+  for (auto& data : mLocalResiduals) {
+    std::vector<LocalResid>().swap(data);
+  }
+}
+
+bool TrackResiduals::readLocalResiduals(int iSec, std::vector<LocalResid>& data) const
+{
+  // open file and retrieve data tree (only local files are supported at the moment)
+  std::string filename = mLocalResFileName + std::to_string(iSec) + ".root";
+  std::unique_ptr<TFile> flin = std::make_unique<TFile>(filename.c_str());
+  if (!flin || flin->IsZombie()) {
+    LOG(error) << "failed to open " << filename.c_str();
+    return false;
+  }
+  std::string treename = mLocalResTreeName + std::to_string(iSec);
+  std::unique_ptr<TTree> tree((TTree*)flin->Get(treename.c_str()));
+  if (!tree) {
+    LOG(error) << "did not find the data tree " << treename.c_str();
+    return false;
+  }
+  // read compact delte trees created with AliRoot or o2
+  LocResStruct trkRes;
+  auto* pTrkRes = &trkRes;
+  tree->SetBranchAddress(mLocalResBranchName.c_str(), &pTrkRes);
+  auto nPoints = tree->GetEntries();
+  if (nPoints > mMaxPointsPerSector) {
+    nPoints = mMaxPointsPerSector;
+  }
+  data.clear();
+  data.reserve(nPoints);
+  LocalResid res;
+  for (int i = 0; i < nPoints; ++i) {
+    tree->GetEntry(i);
+#ifdef LOCAL_RESIDUAL_FORMAT_OLD
+    if (fabs(trkRes.tgSlp) >= param::MaxTgSlp) {
+      continue;
+    }
+    // convert to short to be compatible with AliRoot version
+    res.dy = short(float(trkRes.dy) * 0x7fff / param::MaxResid);
+    res.dz = short(float(trkRes.dz) * 0x7fff / param::MaxResid);
+    res.tgSlp = short(float(trkRes.tgSlp) * 0x7fff / param::MaxTgSlp);
+    for (int iDim = 0; iDim < VoxDim; ++iDim) {
+      res.bvox[iDim] = trkRes.bvox[iDim];
+    }
+    data.push_back(res);
+#else
+    data.push_back(trkRes);
+#endif
+  }
+  tree.release();
+  flin->Close();
+  return true;
 }
 
 //______________________________________________________________________________
@@ -778,8 +859,17 @@ void TrackResiduals::processResiduals()
   if (!mIsInitialized) {
     init();
   }
+  // the sectors are independent, the voxels of each sector are then processed by a single thread
+  std::array<bool, SECTORSPERSIDE * SIDES> sectorDone{};
+#pragma omp parallel for num_threads(sNThreads) schedule(dynamic)
   for (int iSec = 0; iSec < SECTORSPERSIDE * SIDES; ++iSec) {
-    processSectorResiduals(iSec);
+    sectorDone[iSec] = extractSectorResults(iSec);
+  }
+  // the results are dumped in the order of the sectors, independently of the order in which they were processed
+  for (int iSec = 0; iSec < SECTORSPERSIDE * SIDES; ++iSec) {
+    if (sectorDone[iSec]) {
+      dumpResults(iSec);
+    }
   }
 }
 
@@ -790,35 +880,35 @@ void TrackResiduals::processSectorResiduals(int iSec)
     LOG(error) << "wrong sector: " << iSec;
     return;
   }
+  if (extractSectorResults(iSec)) {
+    dumpResults(iSec);
+  }
+}
+
+//______________________________________________________________________________
+bool TrackResiduals::extractSectorResults(int iSec)
+{
   LOG(info) << "processing sector residuals for sector " << iSec;
   if (!mIsInitialized) {
     init();
   }
-  // open file and retrieve data tree (only local files are supported at the moment)
-  std::string filename = mLocalResFileName + std::to_string(iSec) + ".root";
-  std::unique_ptr<TFile> flin = std::make_unique<TFile>(filename.c_str());
-  if (!flin || flin->IsZombie()) {
-    LOG(error) << "failed to open " << filename.c_str();
-    return;
-  }
-  std::string treename = mLocalResTreeName + std::to_string(iSec);
-  std::unique_ptr<TTree> tree((TTree*)flin->Get(treename.c_str()));
-  if (!tree) {
-    LOG(error) << "did not find the data tree " << treename.c_str();
-    return;
+  // take the residuals filled in memory or read them from the local residuals tree
+  std::vector<LocalResid> localResiduals;
+  if (!mLocalResiduals[iSec].empty()) {
+    localResiduals.swap(mLocalResiduals[iSec]);
+  } else {
+    bool readOK = false;
+    // ROOT I/O is serialized
+#pragma omp critical(TrackResiduals_io)
+    readOK = readLocalResiduals(iSec, localResiduals);
+    if (!readOK) {
+      return false;
+    }
   }
-  // read compact delte trees created with AliRoot or o2
-  LocResStruct trkRes;
-  auto* pTrkRes = &trkRes;
-  tree->SetBranchAddress(mLocalResBranchName.c_str(), &pTrkRes);
-  auto nPoints = tree->GetEntries();
+  auto nPoints = localResiduals.size();
   if (!nPoints) {
     LOG(warning) << "no entries found for sector " << iSec;
-    flin->Close();
-    return;
-  }
-  if (nPoints > mMaxPointsPerSector) {
-    nPoints = mMaxPointsPerSector;
+    return false;
   }
   // initialize container holding results
   initResultsContainer(iSec);
@@ -838,30 +928,18 @@ void TrackResiduals::processSectorResiduals(int iSec)
     printMem();
   }
 
-  // read input data into internal vectors
-  for (int i = 0; i < nPoints; ++i) {
-    tree->GetEntry(i);
-#ifdef LOCAL_RESIDUAL_FORMAT_OLD
-    if (fabs(trkRes.tgSlp) >= param::MaxTgSlp) {
-      continue;
-    }
-    dyData[nAccepted] = trkRes.dy;
-    dzData[nAccepted] = trkRes.dz;
-    tgSlpData[nAccepted] = trkRes.tgSlp;
-#else
+  // convert input data into internal vectors
+  for (const auto& trkRes : localResiduals) {
     if (fabs(trkRes.tgSlp * param::MaxTgSlp / 0x7fff) >= param::MaxTgSlp) {
       continue;
     }
     dyData[nAccepted] = trkRes.dy * param::MaxResid / 0x7fff;
     dzData[nAccepted] = trkRes.dz * param::MaxResid / 0x7fff;
     tgSlpData[nAccepted] = trkRes.tgSlp * param::MaxTgSlp / 0x7fff;
-#endif
     binData[nAccepted] = getGlbVoxBin(trkRes.bvox[VoxX], trkRes.bvox[VoxF], trkRes.bvox[VoxZ]);
     nAccepted++;
   }
-
-  tree.release();
-  flin->Close();
+  std::vector<LocalResid>().swap(localResiduals);
 
   if (mPrintMem) {
     printMem();
@@ -876,63 +954,45 @@ void TrackResiduals::processSectorResiduals(int iSec)
   tgSlpData.resize(nAccepted);
   binData.resize(nAccepted);
 
-#ifdef LOCAL_RESIDUAL_FORMAT_OLD
-  // convert to short and back to float to be compatible with AliRoot version
-  std::vector<short> dyDataShort(nAccepted);
-  std::vector<short> dzDataShort(nAccepted);
-  std::vector<short> tgSlpDataShort(nAccepted);
-  for (unsigned int i = 0; i < nAccepted; ++i) {
-    dyDataShort[i] = short(dyData[i] * 0x7fff / param::MaxResid);
-    dzDataShort[i] = short(dzData[i] * 0x7fff / param::MaxResid);
-    tgSlpDataShort[i] = short(tgSlpData[i] * 0x7fff / param::MaxTgSlp);
-
-    dyData[i] = dyDataShort[i] * param::MaxResid / 0x7fff;
-    dzData[i] = dzDataShort[i] * param::MaxResid / 0x7fff;
-    tgSlpData[i] = tgSlpDataShort[i] * param::MaxTgSlp / 0x7fff;
-  }
-#endif
-
   // sort in voxel increasing order
   o2::math_utils::SortData(binData, binIndices);
   if (mPrintMem) {
     printMem();
   }
 
-  // vectors holding the data for one voxel at a time
-  std::vector<float> dyVec;
-  std::vector<float> dzVec;
-  std::vector<float> tgVec;
-  // assuming we will always have around 1000 entries per voxel
-  dyVec.reserve(1e3);
-  dzVec.reserve(1e3);
-  tgVec.reserve(1e3);
-  int currVoxBin = -1;
-  unsigned int nPointsInVox = 0;
-  unsigned int nProcessed = 0;
-  while (nProcessed < nAccepted) {
-    // read all points, voxel by voxel
-    int idx = binIndices[nProcessed];
-    if (currVoxBin != binData[idx]) {
-      if (nPointsInVox) {
-        VoxRes& resVox = secData[currVoxBin];
-        processVoxelResiduals(dyVec, dzVec, tgVec, resVox);
-      }
-      currVoxBin = binData[idx];
-      nPointsInVox = 0;
+  // first point of each voxel with data in the sorted input
+  std::vector<unsigned int> voxFirstPoint;
+  for (unsigned int i = 0; i < nAccepted; ++i) {
+    if (!i || binData[binIndices[i]] != binData[binIndices[i - 1]]) {
+      voxFirstPoint.push_back(i);
+    }
+  }
+  const int nVoxWithData = voxFirstPoint.size();
+  voxFirstPoint.push_back(nAccepted);
+
+#pragma omp parallel num_threads(sNThreads)
+  {
+    // vectors holding the data for one voxel at a time, assuming we will always have around 1000 entries per voxel
+    std::vector<float> dyVec;
+    std::vector<float> dzVec;
+    std::vector<float> tgVec;
+    dyVec.reserve(1e3);
+    dzVec.reserve(1e3);
+    tgVec.reserve(1e3);
+#pragma omp for schedule(dynamic)
+    for (int iVox = 0; iVox < nVoxWithData; ++iVox) {
       dyVec.clear();
       dzVec.clear();
       tgVec.clear();
+      for (unsigned int i = voxFirstPoint[iVox]; i < voxFirstPoint[iVox + 1]; ++i) {
+        int idx = binIndices[i];
+        dyVec.push_back(dyData[idx]);
+        dzVec.push_back(dzData[idx]);
+        tgVec.push_back(tgSlpData[idx]);
+      }
+      VoxRes& resVox = secData[binData[binIndices[voxFirstPoint[iVox]]]];
+      processVoxelResiduals(dyVec, dzVec, tgVec, resVox);
     }
-    dyVec.push_back(dyData[idx]);
-    dzVec.push_back(dzData[idx]);
-    tgVec.push_back(tgSlpData[idx]);
-    ++nPointsInVox;
-    ++nProcessed;
-  }
-  if (nPointsInVox) {
-    // process last voxel
-    VoxRes& resVox = secData[currVoxBin];
-    processVoxelResiduals(dyVec, dzVec, tgVec, resVox);
   }
   LOG(info) << "extracted residuals for sector " << iSec;
 
@@ -940,7 +1000,7 @@ void TrackResiduals::processSectorResiduals(int iSec)
   LOG(info) << "number of validated X rows: " << nRowsOK;
   if (!nRowsOK) {
     LOG(warning) << "sector " << iSec << ": all X-bins disabled, abandon smoothing";
-    return;
+    return false;
   } else {
     smooth(iSec);
   }
@@ -948,38 +1008,30 @@ void TrackResiduals::processSectorResiduals(int iSec)
   //return;
 
   // process dispersions
-  dyVec.clear();
-  tgVec.clear();
-  currVoxBin = -1;
-  nProcessed = 0;
-  nPointsInVox = 0;
-  while (nProcessed < nAccepted) {
-    int idx = binIndices[nProcessed];
-    if (currVoxBin != binData[idx]) {
-      if (nPointsInVox) {
-        VoxRes& resVox = secData[currVoxBin];
-        if (!getXBinIgnored(iSec, resVox.bvox[VoxX])) {
-          processVoxelDispersions(tgVec, dyVec, resVox);
-        }
+#pragma omp parallel num_threads(sNThreads)
+  {
+    std::vector<float> dyVec;
+    std::vector<float> tgVec;
+    dyVec.reserve(1e3);
+    tgVec.reserve(1e3);
+#pragma omp for schedule(dynamic)
+    for (int iVox = 0; iVox < nVoxWithData; ++iVox) {
+      VoxRes& resVox = secData[binData[binIndices[voxFirstPoint[iVox]]]];
+      if (getXBinIgnored(iSec, resVox.bvox[VoxX])) {
+        continue;
       }
-      currVoxBin = binData[idx];
-      nPointsInVox = 0;
       dyVec.clear();
       tgVec.clear();
-    }
-    dyVec.push_back(dyData[idx]);
-    tgVec.push_back(tgSlpData[idx]);
-    ++nPointsInVox;
-    ++nProcessed;
-  }
-  if (nPointsInVox) {
-    // process last voxel
-    VoxRes& resVox = secData[currVoxBin];
-    if (!getXBinIgnored(iSec, resVox.bvox[VoxX])) {
+      for (unsigned int i = voxFirstPoint[iVox]; i < voxFirstPoint[iVox + 1]; ++i) {
+        int idx = binIndices[i];
+        dyVec.push_back(dyData[idx]);
+        tgVec.push_back(tgSlpData[idx]);
+      }
       processVoxelDispersions(tgVec, dyVec, resVox);
     }
   }
   // smooth dispersions
+#pragma omp parallel for num_threads(sNThreads) schedule(dynamic)
   for (int ix = 0; ix < mNXBins; ++ix) {
     if (getXBinIgnored(iSec, ix)) {
       continue;
@@ -993,7 +1045,7 @@ void TrackResiduals::processSectorResiduals(int iSec)
     }
   }
   LOG(info) << "Done processing residuals for sector " << iSec;
-  dumpResults(iSec);
+  return true;
 }
 
 //______________________________________________________________________________
@@ -1185,6 +1237,21 @@ int TrackResiduals::validateVoxels(int iSec)
 void TrackResiduals::smooth(int iSec)
 {
   std::vector<VoxRes>& secData = mVoxelResults[iSec];
+  // the flags of the neighbouring voxels are read during the smoothing, so they are only updated afterwards
+  std::vector<char> smoothOK(secData.size(), 0);
+#pragma omp parallel for num_threads(sNThreads) schedule(dynamic)
+  for (int ix = 0; ix < mNXBins; ++ix) {
+    if (getXBinIgnored(iSec, ix)) {
+      continue;
+    }
+    for (int ip = 0; ip < mNY2XBins; ++ip) {
+      for (int iz = 0; iz < mNZ2XBins; ++iz) {
+        int voxBin = getGlbVoxBin(ix, ip, iz);
+        VoxRes& resVox = secData[voxBin];
+        smoothOK[voxBin] = getSmoothEstimate(resVox.bsec, resVox.stat[VoxX], resVox.stat[VoxF], resVox.stat[VoxZ], resVox.DS, (0x1 << VoxX | 0x1 << VoxF | 0x1 << VoxZ));
+      }
+    }
+  }
   for (int ix = 0; ix < mNXBins; ++ix) {
     if (getXBinIgnored(iSec, ix)) {
       continue;
@@ -1194,8 +1261,7 @@ void TrackResiduals::smooth(int iSec)
         int voxBin = getGlbVoxBin(ix, ip, iz);
         VoxRes& resVox = secData[voxBin];
         resVox.flags &= ~SmoothDone;
-        bool res = getSmoothEstimate(resVox.bsec, resVox.stat[VoxX], resVox.stat[VoxF], resVox.stat[VoxZ], resVox.DS, (0x1 << VoxX | 0x1 << VoxF | 0x1 << VoxZ));
-        if (!res) {
+        if (!smoothOK[voxBin]) {
           mNSmoothingFailedBins[iSec]++;
         } else {
           resVox.flags |= SmoothDone;
@@ -1256,6 +1322,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
   // cache
   // \todo maybe a 1-D cache would be more efficient?
   std::array<std::array<double, sMaxSmtDim*(sMaxSmtDim + 1) / 2>, ResDim> cmat;
+  std::array<double, ResDim * sMaxSmtDim> rhs; // right hand side and results of the smoothing
   int maxNeighb = 10 * 10 * 10;
   std::vector<VoxRes*> currVox;
   currVox.reserve(maxNeighb);
@@ -1270,7 +1337,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
   std::array<int, VoxDim> trial{0};
 
   while (true) {
-    std::fill(mLastSmoothingRes.begin(), mLastSmoothingRes.end(), 0);
+    rhs.fill(0);
     memset(&cmat[0][0], 0, sizeof(cmat));
 
     int nbOK = 0; // accounted neighbours
@@ -1456,7 +1523,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
           wi /= (voxNb->E[iDim] * voxNb->E[iDim]);
         }
         std::array<double, sMaxSmtDim*(sMaxSmtDim + 1) / 2>& cmatD = cmat[iDim];
-        double* rhsD = &mLastSmoothingRes[iDim * sMaxSmtDim];
+        double* rhsD = &rhs[iDim * sMaxSmtDim];
         unsigned short iMat = 0;
         unsigned short iRhs = 0;
         // linear part
@@ -1522,7 +1589,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
       }
       matrix.Zero(); // reset matrix
       std::array<double, sMaxSmtDim*(sMaxSmtDim + 1) / 2>& cmatD = cmat[iDim];
-      double* rhsD = &mLastSmoothingRes[iDim * sMaxSmtDim];
+      double* rhsD = &rhs[iDim * sMaxSmtDim];
       short iMat = -1;
       short iRhs = -1;
       short row = -1;
@@ -2198,7 +2265,7 @@ void TrackResiduals::createOutputFile()
 {
   mFileOut = std::make_unique<TFile>("debugOutliers.root", "recreate");
   mTreeOut = std::make_unique<TTree>("debugTree", "outliers");
-  //mTreeOut->Branch("voxRes", &mVoxelResultsOutPtr);
+  mTreeOut->Branch("voxRes", &mVoxelResultsOutPtr);
   mTreeOut->Branch("debug", &mOutVectorPtr);
 }
 
@@ -2232,17 +2299,20 @@ void TrackResiduals::dumpResults(int iSec)
 
 void TrackResiduals::printMem() const
 {
-  static float mres = 0, mvir = 0, mres0 = 0, mvir0 = 0;
-  static ProcInfo_t procInfo;
-  static TStopwatch sw;
-  const Long_t kMB = 1024;
-  gSystem->GetProcInfo(&procInfo);
-  mres = float(procInfo.fMemResident) / kMB;
-  mvir = float(procInfo.fMemVirtual) / kMB;
-  sw.Stop();
-  printf("RSS: %.3f(%.3f) VMEM: %.3f(%.3f) MB | CpuTime:%.3f RealTime:%.3f s\n",
-         mres, mres - mres0, mvir, mvir - mvir0, sw.CpuTime(), sw.RealTime());
-  mres0 = mres;
-  mvir0 = mvir;
-  sw.Start();
+#pragma omp critical(TrackResiduals_printMem)
+  {
+    static float mres = 0, mvir = 0, mres0 = 0, mvir0 = 0;
+    static ProcInfo_t procInfo;
+    static TStopwatch sw;
+    const Long_t kMB = 1024;
+    gSystem->GetProcInfo(&procInfo);
+    mres = float(procInfo.fMemResident) / kMB;
+    mvir = float(procInfo.fMemVirtual) / kMB;
+    sw.Stop();
+    printf("RSS: %.3f(%.3f) VMEM: %.3f(%.3f) MB | CpuTime:%.3f RealTime:%.3f s\n",
+           mres, mres - mres0, mvir, mvir - mvir0, sw.CpuTime(), sw.RealTime());
+    mres0 = mres;
+    mvir0 = mvir;
+    sw.Start();
+  }
 }
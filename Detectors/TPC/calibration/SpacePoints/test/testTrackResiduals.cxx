@@ -0,0 +1,128 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file  testTrackResiduals.cxx
+/// \brief this task tests that the results of the parallel processing of the sectors are dumped in the order of the sectors
+
+#define BOOST_TEST_MODULE Test TPC TrackResiduals class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "SpacePoints/TrackResiduals.h"
+#include "TRandom.h"
+#include <memory>
+#include <vector>
+
+namespace o2::tpc
+{
+
+using VoxRes = TrackResiduals::VoxRes;
+using LocalResid = TrackResiduals::LocalResid;
+
+static constexpr int NXBINS = 20;
+static constexpr int NY2XBINS = 3;
+static constexpr int NZ2XBINS = 2;
+static constexpr int NPOINTSPERVOXEL = 40;
+static constexpr int NSECTORS = SECTORSPERSIDE * SIDES;
+
+/// sectors without input are not processed and must not appear in the output
+bool hasInput(int iSec) { return iSec % 7 != 3; }
+
+short toShort(float val, float maxVal) { return static_cast<short>(val / maxVal * 0x7fff); }
+
+/// processes the same residuals with the given number of threads and returns the content of the debug tree
+std::vector<VoxRes> processResiduals(int nThreads)
+{
+  TrackResiduals::setNThreads(nThreads);
+  TrackResiduals residuals;
+  residuals.setNXBins(NXBINS);
+  residuals.setNY2XBins(NY2XBINS);
+  residuals.setNZ2XBins(NZ2XBINS);
+  residuals.init();
+
+  gRandom->SetSeed(1234);
+  for (int iSec = 0; iSec < NSECTORS; ++iSec) {
+    if (!hasInput(iSec)) {
+      continue;
+    }
+    // the sectors get different amounts of data to change the order in which the threads finish them
+    const int nPoints = NPOINTSPERVOXEL * (1 + iSec % 4);
+    for (int ix = 0; ix < NXBINS; ++ix) {
+      for (int ip = 0; ip < NY2XBINS; ++ip) {
+        for (int iz = 0; iz < NZ2XBINS; ++iz) {
+          for (int i = 0; i < nPoints; ++i) {
+            const float tgSlp = gRandom->Uniform(-0.5, 0.5);
+            LocalResid res;
+            res.dy = toShort(0.1f * iSec / NSECTORS + 0.05f * tgSlp + gRandom->Gaus(0, 0.1), param::MaxResid);
+            res.dz = toShort(-0.05f + gRandom->Gaus(0, 0.1), param::MaxResid);
+            res.tgSlp = toShort(tgSlp, param::MaxTgSlp);
+            res.bvox[TrackResiduals::VoxZ] = iz;
+            res.bvox[TrackResiduals::VoxF] = ip;
+            res.bvox[TrackResiduals::VoxX] = ix;
+            residuals.addLocalResidual(iSec, res);
+          }
+        }
+      }
+    }
+  }
+
+  residuals.createOutputFile();
+  residuals.processResiduals();
+  residuals.closeOutputFile();
+
+  std::vector<VoxRes> results;
+  std::unique_ptr<TFile> file(TFile::Open("debugOutliers.root"));
+  BOOST_REQUIRE(file && !file->IsZombie());
+  auto tree = file->Get<TTree>("debugTree");
+  BOOST_REQUIRE(tree);
+  VoxRes* voxRes = nullptr;
+  tree->SetBranchAddress("voxRes", &voxRes);
+  for (Long64_t i = 0; i < tree->GetEntries(); ++i) {
+    tree->GetEntry(i);
+    results.push_back(*voxRes);
+  }
+  return results;
+}
+
+BOOST_AUTO_TEST_CASE(TrackResiduals_dumpOrder_test)
+{
+  const int nVoxPerSector = NXBINS * NY2XBINS * NZ2XBINS;
+  const auto serial = processResiduals(1);
+  const auto parallel = processResiduals(4);
+
+  // the sectors with input are dumped one after the other in increasing order
+  std::vector<int> expectedSectors;
+  for (int iSec = 0; iSec < NSECTORS; ++iSec) {
+    if (hasInput(iSec)) {
+      for (int i = 0; i < nVoxPerSector; ++i) {
+        expectedSectors.push_back(iSec);
+      }
+    }
+  }
+  for (const auto* results : {&serial, &parallel}) {
+    std::vector<int> sectors;
+    for (const auto& voxRes : *results) {
+      sectors.push_back(voxRes.bsec);
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(sectors.begin(), sectors.end(), expectedSectors.begin(), expectedSectors.end());
+  }
+
+  // the results do not depend on the number of threads
+  BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+  for (size_t i = 0; i < serial.size(); ++i) {
+    BOOST_CHECK_EQUAL(parallel[i].flags, serial[i].flags);
+    BOOST_CHECK(parallel[i].bvox == serial[i].bvox);
+    BOOST_CHECK(parallel[i].D == serial[i].D);
+    BOOST_CHECK(parallel[i].DS == serial[i].DS);
+  }
+}
+
+} // namespace o2::tpc
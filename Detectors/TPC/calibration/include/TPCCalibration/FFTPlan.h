@@ -0,0 +1,213 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FFTPlan.h
+/// \brief header-only mixed-radix fast fourier transform with cached plans
+
+#ifndef ALICEO2_TPC_FFTPLAN_H_
+#define ALICEO2_TPC_FFTPLAN_H_
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::tpc
+{
+
+/// Plan for the discrete fourier transform of a fixed length N, evaluated as a recursive
+/// mixed-radix Cooley-Tukey decomposition (radix 4 and 2 butterflies are specialized, other
+/// prime factors use a generic butterfly, i.e. the complexity is O(N * sum of the factors)).
+///
+/// The plan is immutable after its creation and can be used concurrently by several threads,
+/// each of them having its own Workspace:
+/// 1. auto plan = o2::tpc::FFTPlan::get(200);   // created once and cached for all users
+/// 2. auto work = plan->makeWorkspace();          // one per thread
+/// 3. plan->forward(values, work);                // coefficients in work.out
+class FFTPlan
+{
+ public:
+  using complex_t = std::complex<float>;
+
+  /// per thread buffers used during the transform
+  struct Workspace {
+    std::vector<complex_t> out;     ///< result of the last transform
+    std::vector<complex_t> scratch; ///< buffer for the generic butterfly
+  };
+
+  /// constructor
+  /// \param n length of the transform
+  explicit FFTPlan(const unsigned int n) : mN{n}
+  {
+    mTwiddles.reserve(mN);
+    for (unsigned int i = 0; i < mN; ++i) {
+      const double phase = -2 * M_PI * i / mN;
+      mTwiddles.emplace_back(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+    }
+    // factorize, preferring radix 4 butterflies
+    unsigned int rest = mN;
+    unsigned int p = 4;
+    while (rest > 1) {
+      while (rest % p) {
+        p = (p == 4) ? 2 : ((p == 2) ? 3 : p + 2);
+        if (p * p > rest) {
+          p = rest; // no more factors
+        }
+      }
+      rest /= p;
+      mFactors.emplace_back(p);
+      mFactors.emplace_back(rest);
+      mMaxFactor = std::max(mMaxFactor, p);
+    }
+    if (mN == 1) {
+      mFactors = {1, 1};
+    }
+  }
+
+  /// \return returns the plan for transforms of length n, which is created on the first request and then shared. Thread safe.
+  /// \param n length of the transform
+  static std::shared_ptr<const FFTPlan> get(const unsigned int n)
+  {
+    static std::mutex mutex;
+    static std::unordered_map<unsigned int, std::shared_ptr<const FFTPlan>> plans;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& plan = plans[n];
+    if (!plan) {
+      plan = std::make_shared<const FFTPlan>(n);
+    }
+    return plan;
+  }
+
+  /// \return returns the length of the transform
+  unsigned int size() const { return mN; }
+
+  /// \return returns exp(-2 pi i index / N)
+  /// \param index index of the twiddle factor (modulo N)
+  complex_t getTwiddle(const unsigned int index) const { return mTwiddles[index % mN]; }
+
+  /// \return returns buffers for the transforms with this plan
+  Workspace makeWorkspace() const { return Workspace{std::vector<complex_t>(mN), std::vector<complex_t>(mMaxFactor)}; }
+
+  /// forward transform out[k] = sum_n in[n] * exp(-2 pi i k n / N) of N real or complex values
+  /// \param in input values
+  /// \param work workspace created by this plan, the coefficients are stored in work.out
+  template <typename DataT>
+  void forward(const DataT* in, Workspace& work) const
+  {
+    if (mN) {
+      transform(work.out.data(), in, 1, mFactors.data(), work.scratch.data());
+    }
+  }
+
+  /// inverse transform out[n] = sum_k in[k] * exp(2 pi i k n / N) of N complex values, without normalization
+  /// \param in input coefficients
+  /// \param work workspace created by this plan, the values are stored in work.out
+  void inverse(const complex_t* in, Workspace& work) const
+  {
+    // obtained from the forward transform of the complex conjugates
+    std::vector<complex_t> conjIn(in, in + mN);
+    for (auto& val : conjIn) {
+      val = std::conj(val);
+    }
+    forward(conjIn.data(), work);
+    for (auto& val : work.out) {
+      val = std::conj(val);
+    }
+  }
+
+ private:
+  unsigned int mN{};                    ///< length of the transform
+  unsigned int mMaxFactor{1};           ///< largest factor of the length
+  std::vector<unsigned int> mFactors{}; ///< pairs of radix and remaining length of each stage
+  std::vector<complex_t> mTwiddles{};   ///< exp(-2 pi i k / N)
+
+  template <typename DataT>
+  void transform(complex_t* out, const DataT* in, const unsigned int fstride, const unsigned int* factors, complex_t* scratch) const
+  {
+    const unsigned int p = factors[0]; // radix of this stage
+    const unsigned int m = factors[1]; // length of the sub-transforms
+    if (m == 1) {
+      for (unsigned int q = 0; q < p; ++q) {
+        out[q] = complex_t(in[q * fstride]);
+      }
+    } else {
+      // decimation in time: transforms of the p interleaved sub-sequences
+      for (unsigned int q = 0; q < p; ++q) {
+        transform(out + q * m, in + q * fstride, fstride * p, factors + 2, scratch);
+      }
+    }
+
+    switch (p) {
+      case 2:
+        butterfly2(out, fstride, m);
+        break;
+      case 4:
+        butterfly4(out, fstride, m);
+        break;
+      default:
+        butterflyGeneric(out, fstride, p, m, scratch);
+        break;
+    }
+  }
+
+  void butterfly2(complex_t* out, const unsigned int fstride, const unsigned int m) const
+  {
+    for (unsigned int k = 0; k < m; ++k) {
+      const complex_t t = out[k + m] * mTwiddles[k * fstride];
+      out[k + m] = out[k] - t;
+      out[k] += t;
+    }
+  }
+
+  void butterfly4(complex_t* out, const unsigned int fstride, const unsigned int m) const
+  {
+    for (unsigned int k = 0; k < m; ++k) {
+      const complex_t s0 = out[k + m] * mTwiddles[k * fstride];
+      const complex_t s1 = out[k + 2 * m] * mTwiddles[2 * k * fstride];
+      const complex_t s2 = out[k + 3 * m] * mTwiddles[3 * k * fstride];
+      const complex_t s5 = out[k] - s1;
+      const complex_t s3 = s0 + s2;
+      const complex_t s4 = s0 - s2;
+      out[k] += s1;
+      out[k + 2 * m] = out[k] - s3;
+      out[k] += s3;
+      out[k + m] = complex_t(s5.real() + s4.imag(), s5.imag() - s4.real());     // s5 - i * s4
+      out[k + 3 * m] = complex_t(s5.real() - s4.imag(), s5.imag() + s4.real()); // s5 + i * s4
+    }
+  }
+
+  void butterflyGeneric(complex_t* out, const unsigned int fstride, const unsigned int p, const unsigned int m, complex_t* scratch) const
+  {
+    for (unsigned int u = 0; u < m; ++u) {
+      for (unsigned int q = 0; q < p; ++q) {
+        scratch[q] = out[u + q * m];
+      }
+      for (unsigned int q1 = 0; q1 < p; ++q1) {
+        const unsigned int k = u + q1 * m;
+        complex_t sum = scratch[0];
+        unsigned int twIdx = 0;
+        for (unsigned int q = 1; q < p; ++q) {
+          twIdx += fstride * k;
+          twIdx %= mN;
+          sum += scratch[q] * mTwiddles[twIdx];
+        }
+        out[k] = sum;
+      }
+    }
+  }
+};
+
+} // namespace o2::tpc
+
+#endif
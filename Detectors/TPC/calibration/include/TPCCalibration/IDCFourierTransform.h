@@ -47,19 +47,28 @@ class IDCFourierTransform
   /// \param integrationIntervalsPerTF vector containg for each TF the number of IDCs
   void setIDCs(const OneDIDC& oneDIDCs, const std::vector<unsigned int>& integrationIntervalsPerTF);
 
-  /// set fast fourier transform using FFTW3
-  /// \param fft use FFTW3 or not (naive approach)
-  static void setFFT(const bool fft) { sFftw = fft; }
+  /// set fast fourier transform
+  /// \param fft use fast fourier transform or not (naive approach)
+  static void setFFT(const bool fft) { sFft = fft; }
+
+  /// set the sliding window mode of the fast fourier transform: the coefficients of an interval are obtained by updating the ones of the previous interval with the shifted in and out 1D-IDCs
+  /// \param sliding use sliding window mode
+  /// \param nIntervalsResync number of consecutive intervals after which the coefficients are recalculated from scratch to avoid the accumulation of rounding errors
+  static void setSlidingWindow(const bool sliding, const unsigned int nIntervalsResync = 100)
+  {
+    sSlidingWindow = sliding;
+    sNIntervalsResync = nIntervalsResync;
+  }
 
   /// \param nThreads set the number of threads used for calculation of the fourier coefficients
   static void setNThreads(const int nThreads) { sNThreads = nThreads; }
 
   /// calculate fourier coefficients
-  void calcFourierCoefficients() { sFftw ? calcFourierCoefficientsFFTW3() : calcFourierCoefficientsNaive(); }
+  void calcFourierCoefficients() { sFft ? calcFourierCoefficientsFFT() : calcFourierCoefficientsNaive(); }
 
   /// get IDC0 values from the inverse fourier transform. Can be used for debugging. std::vector<std::vector<float>>: first vector interval second vector IDC0 values
   /// \param side TPC side
-  std::vector<std::vector<float>> inverseFourierTransform(const o2::tpc::Side side) const { return sFftw ? inverseFourierTransformFFTW3(side) : inverseFourierTransformNaive(side); }
+  std::vector<std::vector<float>> inverseFourierTransform(const o2::tpc::Side side) const { return sFft ? inverseFourierTransformFFT(side) : inverseFourierTransformNaive(side); }
 
   /// \return returns number of IDCs for each interval which will be used to calculate the fourier coefficients
   unsigned int getrangeIDC() const { return mRangeIDC; }
@@ -86,7 +95,13 @@ class IDCFourierTransform
   std::vector<float> getExpandedIDCOne(const o2::tpc::Side side) const;
 
   /// get type of used fourier transform
-  static bool getFFT() { return sFftw; }
+  static bool getFFT() { return sFft; }
+
+  /// get whether the sliding window mode of the fast fourier transform is used
+  static bool getSlidingWindow() { return sSlidingWindow; }
+
+  /// get the number of intervals after which the coefficients are recalculated in the sliding window mode
+  static unsigned int getNIntervalsResync() { return sNIntervalsResync; }
 
   /// get the number of threads used for calculation of the fourier coefficients
   static int getNThreads() { return sNThreads; }
@@ -107,8 +122,10 @@ class IDCFourierTransform
   std::array<OneDIDC, 2> mOneDIDC{OneDIDC(mRangeIDC), OneDIDC(mRangeIDC)}; ///< all 1D-IDCs which are used to calculate the fourier coefficients. A buffer for the last aggregation interval is used to calculate the fourier coefficients for the first TFs
   std::array<std::vector<unsigned int>, 2> mIntegrationIntervalsPerTF{};   ///< number of integration intervals per TF used to set the correct range of IDCs. A buffer is needed for the last aggregation interval.
   bool mBufferIndex{true};                                                 ///< index for the buffer
-  inline static int sFftw{1};                                              ///< using fftw or naive approach for calculation of fourier coefficients
+  inline static int sFft{1};                                               ///< using fast fourier transform or naive approach for calculation of fourier coefficients
   inline static int sNThreads{1};                                          ///< number of threads which are used during the calculation of the fourier coefficients
+  inline static bool sSlidingWindow{false};                                ///< update the coefficients of consecutive intervals instead of recalculating them
+  inline static unsigned int sNIntervalsResync{100};                       ///< number of intervals after which the coefficients are recalculated in the sliding window mode
 
   /// calculate fourier coefficients
   void calcFourierCoefficientsNaive();
@@ -118,27 +135,21 @@ class IDCFourierTransform
   /// \param offsetIndex for accessing index obtained from getLastIntervals()
   void calcFourierCoefficientsNaive(const o2::tpc::Side side, const std::vector<unsigned int>& offsetIndex);
 
-  /// calculate fourier coefficients
-  void calcFourierCoefficientsFFTW3();
+  /// calculate fourier coefficients using the fast fourier transform
+  void calcFourierCoefficientsFFT();
 
-  /// calculate fourier coefficients using FFTW3 package
-  /// get IDC0 values from the inverse fourier transform. Can be used for debugging. std::vector<std::vector<float>>: first vector interval second vector IDC0 values
+  /// calculate fourier coefficients using the fast fourier transform
   /// \param side TPC side
   /// \param offsetIndex for accessing index obtained from getLastIntervals()
-  void calcFourierCoefficientsFFTW3(const o2::tpc::Side side, const std::vector<unsigned int>& offsetIndex);
+  void calcFourierCoefficientsFFT(const o2::tpc::Side side, const std::vector<unsigned int>& offsetIndex);
 
   /// get IDC0 values from the inverse fourier transform. Can be used for debugging. std::vector<std::vector<float>>: first vector interval second vector IDC0 values
   /// \param side TPC side
   std::vector<std::vector<float>> inverseFourierTransformNaive(const o2::tpc::Side side) const;
 
-  /// get IDC0 values from the inverse fourier transform using FFTW3. Can be used for debugging. std::vector<std::vector<float>>: first vector interval second vector IDC0 values
-  /// \param side TPC side
-  std::vector<std::vector<float>> inverseFourierTransformFFTW3(const o2::tpc::Side side) const;
-
-  /// copy over IDCs from buffer to current IDCOne vector for easier access using fftwf_alloc_real for possibly/forcing SIMD (?) http://www.fftw.org/fftw3_doc/SIMD-alignment-and-fftw_005fmalloc.html
+  /// get IDC0 values from the inverse fast fourier transform. Can be used for debugging. std::vector<std::vector<float>>: first vector interval second vector IDC0 values
   /// \param side TPC side
-  /// \param val1DIDCs 1D-IDCs which are allocated using fftwf_alloc_real
-  float* getExpandedIDCOneFFTW(const o2::tpc::Side side) const;
+  std::vector<std::vector<float>> inverseFourierTransformFFT(const o2::tpc::Side side) const;
 
   /// divide coefficients by number of IDCs used
   void normalizeCoefficients(const o2::tpc::Side side)
@@ -10,12 +10,13 @@
 // or submit itself to any jurisdiction.
 
 #include "TPCCalibration/IDCFourierTransform.h"
+#include "TPCCalibration/FFTPlan.h"
 #include "CommonUtils/TreeStreamRedirector.h"
 #include "CommonConstants/MathConstants.h"
 #include "Framework/Logger.h"
 #include "TFile.h"
 #include <cmath>
-// #include <fftw3.h>
+#include <complex>
 
 #if (defined(WITH_OPENMP) || defined(_OPENMP)) && !defined(__CLING__)
 #include <omp.h>
@@ -38,20 +39,18 @@ void o2::tpc::IDCFourierTransform::setIDCs(const OneDIDC& oneDIDCs, const std::v
 void o2::tpc::IDCFourierTransform::calcFourierCoefficientsNaive()
 {
   if (mFourierCoefficients.getNCoefficientsPerTF() % 2) {
-    LOGP(warning, "number of specified fourier coefficients is {}, but should be an even number! you can use FFTW3 method instead!", mFourierCoefficients.getNCoefficientsPerTF());
+    LOGP(warning, "number of specified fourier coefficients is {}, but should be an even number! you can use the fast fourier transform instead!", mFourierCoefficients.getNCoefficientsPerTF());
   }
   const std::vector<unsigned int> offsetIndex = getLastIntervals();
   calcFourierCoefficientsNaive(o2::tpc::Side::A, offsetIndex);
   calcFourierCoefficientsNaive(o2::tpc::Side::C, offsetIndex);
 }
 
-void o2::tpc::IDCFourierTransform::calcFourierCoefficientsFFTW3()
+void o2::tpc::IDCFourierTransform::calcFourierCoefficientsFFT()
 {
-  LOGP(warning, "FFTW3 method not available yet. Using naive approach...");
-  calcFourierCoefficientsNaive();
-  // const std::vector<unsigned int> offsetIndex = getLastIntervals();
-  // calcFourierCoefficientsFFTW3(o2::tpc::Side::A, offsetIndex);
-  // calcFourierCoefficientsFFTW3(o2::tpc::Side::C, offsetIndex);
+  const std::vector<unsigned int> offsetIndex = getLastIntervals();
+  calcFourierCoefficientsFFT(o2::tpc::Side::A, offsetIndex);
+  calcFourierCoefficientsFFT(o2::tpc::Side::C, offsetIndex);
 }
 
 void o2::tpc::IDCFourierTransform::calcFourierCoefficientsNaive(const o2::tpc::Side side, const std::vector<unsigned int>& offsetIndex)
@@ -76,29 +75,57 @@ void o2::tpc::IDCFourierTransform::calcFourierCoefficientsNaive(const o2::tpc::S
   normalizeCoefficients(side);
 }
 
-void o2::tpc::IDCFourierTransform::calcFourierCoefficientsFFTW3(const o2::tpc::Side side, const std::vector<unsigned int>& offsetIndex)
+void o2::tpc::IDCFourierTransform::calcFourierCoefficientsFFT(const o2::tpc::Side side, const std::vector<unsigned int>& offsetIndex)
 {
-  //   // for FFTW and OMP see: https://stackoverflow.com/questions/15012054/fftw-plan-creation-using-openmp
-  // #pragma omp parallel num_threads(sNThreads)
-  //   {
-  //     fftwf_plan fftwPlan = nullptr;
-  //     float* val1DIDCs = getExpandedIDCOneFFTW(side);
-  //     fftwf_complex* coefficients = fftwf_alloc_complex(getNMaxCoefficients());
-  //
-  // #pragma omp critical(make_plan)
-  //     fftwPlan = fftwf_plan_dft_r2c_1d(mRangeIDC, val1DIDCs, coefficients, FFTW_ESTIMATE);
-  //
-  // #pragma omp for
-  //     for (unsigned int interval = 0; interval < getNIntervals(); ++interval) {
-  //       fftwf_execute_dft_r2c(fftwPlan, &(val1DIDCs[offsetIndex[interval]]), coefficients);
-  //       std::memcpy(&(*(mFourierCoefficients.mFourierCoefficients[side].begin() + mFourierCoefficients.getIndex(interval, 0))), coefficients, mFourierCoefficients.getNCoefficientsPerTF() * sizeof(float));
-  //     }
-  //     // free memory
-  //     fftwf_free(coefficients);
-  //     fftwf_free(val1DIDCs);
-  //     fftwf_destroy_plan(fftwPlan);
-  //   }
-  //   normalizeCoefficients(side);
+  const auto plan = FFTPlan::get(mRangeIDC); // the plans are cached: only created for the first call
+  const auto idcOneExpanded = getExpandedIDCOne(side);
+  const unsigned int nCoeffStore = mFourierCoefficients.getNCoefficientsPerTF();
+  const unsigned int nCoeff = std::min((nCoeffStore + 1) / 2, mRangeIDC); // number of complex coefficients which have to be calculated
+  const float norm = 1.f / mRangeIDC;
+
+#pragma omp parallel num_threads(sNThreads)
+  {
+    auto work = plan->makeWorkspace();
+
+    // coefficients which are updated in the sliding window mode and the phase factors for shifting the window by one 1D-IDC
+    std::vector<std::complex<double>> coeffs(nCoeff);
+    std::vector<std::complex<double>> shift(nCoeff);
+    for (unsigned int coeff = 0; coeff < nCoeff; ++coeff) {
+      shift[coeff] = std::conj(std::complex<double>(plan->getTwiddle(coeff)));
+    }
+    long lastInterval = -1;
+    unsigned int nSlides = 0;
+
+    // static scheduling: each thread gets a contiguous set of intervals which can be used for the sliding window mode
+#pragma omp for schedule(static)
+    for (unsigned int interval = 0; interval < getNIntervals(); ++interval) {
+      const unsigned int firstIDC = offsetIndex[interval];
+      const bool slide = sSlidingWindow && (lastInterval >= 0) && (lastInterval + 1 == interval) && (nSlides < sNIntervalsResync) && (firstIDC - offsetIndex[lastInterval] < mRangeIDC);
+      if (slide) {
+        // X_k(m + 1) = (X_k(m) - x[m] + x[m + N]) * exp(2 pi i k / N)
+        for (unsigned int index = offsetIndex[lastInterval]; index < firstIDC; ++index) {
+          const double delta = idcOneExpanded[index + mRangeIDC] - idcOneExpanded[index];
+          for (unsigned int coeff = 0; coeff < nCoeff; ++coeff) {
+            coeffs[coeff] = (coeffs[coeff] + delta) * shift[coeff];
+          }
+        }
+        ++nSlides;
+      } else {
+        plan->forward(&idcOneExpanded[firstIDC], work);
+        std::copy(work.out.begin(), work.out.begin() + nCoeff, coeffs.begin());
+        nSlides = 0;
+      }
+      lastInterval = interval;
+
+      // store normalized real and imaginary parts
+      const unsigned int indexData = mFourierCoefficients.getIndex(interval, 0);
+      for (unsigned int i = 0; i < nCoeffStore; ++i) {
+        const unsigned int coeff = i / 2;
+        const double val = (coeff >= nCoeff) ? 0 : ((i % 2) ? coeffs[coeff].imag() : coeffs[coeff].real());
+        mFourierCoefficients(side, indexData + i) = val * norm;
+      }
+    }
+  }
 }
 
 std::vector<std::vector<float>> o2::tpc::IDCFourierTransform::inverseFourierTransformNaive(const o2::tpc::Side side) const
@@ -131,29 +158,31 @@ std::vector<std::vector<float>> o2::tpc::IDCFourierTransform::inverseFourierTran
   return inverse;
 }
 
-std::vector<std::vector<float>> o2::tpc::IDCFourierTransform::inverseFourierTransformFFTW3(const o2::tpc::Side side) const
+std::vector<std::vector<float>> o2::tpc::IDCFourierTransform::inverseFourierTransformFFT(const o2::tpc::Side side) const
 {
-  LOGP(warning, "FFTW3 method not available yet. Using naive approach...");
-  return inverseFourierTransformNaive(side);
-  // // vector containing for each intervall the inverse fourier IDCs
-  // std::vector<std::vector<float>> inverse(getNIntervals());
-  //
-  // // loop over all the intervals. For each interval the coefficients are calculated
-  // // this loop and execution of FFTW is not optimized as it is used only for debugging
-  // for (unsigned int interval = 0; interval < getNIntervals(); ++interval) {
-  //   inverse[interval].resize(mRangeIDC);
-  //   std::vector<std::array<float, 2>> val1DIDCs;
-  //   val1DIDCs.reserve(mRangeIDC);
-  //   for (unsigned int index = 0; index < getNMaxCoefficients(); ++index) {
-  //     const unsigned int indexDataReal = mFourierCoefficients.getIndex(interval, 2 * index); // index for storing real fourier coefficient
-  //     const unsigned int indexDataImag = indexDataReal + 1;                                  // index for storing complex fourier coefficient
-  //     val1DIDCs.emplace_back(std::array<float, 2>{mFourierCoefficients(side, indexDataReal), mFourierCoefficients(side, indexDataImag)});
-  //   }
-  //   const fftwf_plan fftwPlan = fftwf_plan_dft_c2r_1d(mRangeIDC, reinterpret_cast<fftwf_complex*>(val1DIDCs.data()), inverse[interval].data(), FFTW_ESTIMATE);
-  //   fftwf_execute(fftwPlan);
-  //   fftwf_destroy_plan(fftwPlan);
-  // }
-  // return inverse;
+  // vector containing for each intervall the inverse fourier IDCs
+  std::vector<std::vector<float>> inverse(getNIntervals());
+  const auto plan = FFTPlan::get(mRangeIDC);
+  auto work = plan->makeWorkspace();
+  const unsigned int nCoeffStore = mFourierCoefficients.getNCoefficientsPerTF();
+  std::vector<FFTPlan::complex_t> coeffs(mRangeIDC);
+
+  // loop over all the intervals. For each interval the coefficients are calculated
+  // this loop is not optimized as it is used only for debugging
+  for (unsigned int interval = 0; interval < getNIntervals(); ++interval) {
+    // coefficients of a real input are hermitian: c[N - k] = conj(c[k]). Coefficients which are not stored are set to 0
+    const unsigned int indexData = mFourierCoefficients.getIndex(interval, 0);
+    for (unsigned int coeff = 0; coeff < mRangeIDC; ++coeff) {
+      const unsigned int coeffStored = (coeff <= mRangeIDC / 2) ? coeff : mRangeIDC - coeff;
+      const float real = (2 * coeffStored < nCoeffStore) ? mFourierCoefficients(side, indexData + 2 * coeffStored) : 0;
+      const float imag = (2 * coeffStored + 1 < nCoeffStore) ? mFourierCoefficients(side, indexData + 2 * coeffStored + 1) : 0;
+      coeffs[coeff] = (coeff == coeffStored) ? FFTPlan::complex_t(real, imag) : FFTPlan::complex_t(real, -imag);
+    }
+    plan->inverse(coeffs.data(), work);
+    inverse[interval].resize(mRangeIDC);
+    std::transform(work.out.begin(), work.out.end(), inverse[interval].begin(), [](const auto& val) { return val.real(); });
+  }
+  return inverse;
 }
 
 void o2::tpc::IDCFourierTransform::dumpToFile(const char* outFileName, const char* outName) const
@@ -172,11 +201,11 @@ void o2::tpc::IDCFourierTransform::dumpToTree(const char* outFileName) const
     const o2::tpc::Side side = iSide == 0 ? Side::A : Side::C;
     const auto idcOneExpanded = getExpandedIDCOne(side);
     const auto inverseFourier = inverseFourierTransformNaive(side);
-    const auto inverseFourierFFTW3 = inverseFourierTransformFFTW3(side);
+    const auto inverseFourierFFT = inverseFourierTransformFFT(side);
 
     for (unsigned int interval = 0; interval < getNIntervals(); ++interval) {
       std::vector<float> oneDIDCInverse = inverseFourier[interval];
-      std::vector<float> oneDIDCInverseFFTW3 = inverseFourierFFTW3[interval];
+      std::vector<float> oneDIDCInverseFFT = inverseFourierFFT[interval];
 
       // get 1D-IDC values used for calculation of the fourier coefficients
       std::vector<float> oneDIDC;
@@ -195,7 +224,7 @@ void o2::tpc::IDCFourierTransform::dumpToTree(const char* outFileName) const
                  << "coefficient=" << coefficient // value for ith coefficient
                  << "1DIDC.=" << oneDIDC
                  << "1DIDCiDFT.=" << oneDIDCInverse
-                 << "1DIDiDFTFFTW3.=" << oneDIDCInverseFFTW3
+                 << "1DIDCiFFT.=" << oneDIDCInverseFFT
                  << "\n";
       }
     }
@@ -221,15 +250,3 @@ std::vector<float> o2::tpc::IDCFourierTransform::getExpandedIDCOne(const o2::tpc
   }
   return val1DIDCs;
 }
-
-// float* o2::tpc::IDCFourierTransform::getExpandedIDCOneFFTW(const o2::tpc::Side side) const
-// {
-// const unsigned int nElementsLastBuffer = useLastBuffer() ? mRangeIDC - mIntegrationIntervalsPerTF[!mBufferIndex][0] : 0;
-// const unsigned int nElementsAll = mOneDIDC[!mBufferIndex].getNIDCs(side) + nElementsLastBuffer;
-// float* val1DIDCs = fftwf_alloc_real(nElementsAll);
-// if (useLastBuffer()) {
-// std::memcpy(val1DIDCs, &(*(mOneDIDC[mBufferIndex].mOneDIDC[side].end() - nElementsLastBuffer)), nElementsLastBuffer * sizeof(float)); // copy IDCs from old buffer
-// }
-// std::memcpy(&val1DIDCs[nElementsLastBuffer], mOneDIDC[!mBufferIndex].mOneDIDC[side].data(), mOneDIDC[!mBufferIndex].getNIDCs(side) * sizeof(float)); // copy all IDCs from current buffer
-// return val1DIDCs;
-// }
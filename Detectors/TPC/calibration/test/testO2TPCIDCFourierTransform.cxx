@@ -90,4 +90,40 @@ BOOST_AUTO_TEST_CASE(IDCFourierTransform_test)
   }
 }
 
+BOOST_AUTO_TEST_CASE(IDCFourierTransformFFT_test)
+{
+  const unsigned int integrationIntervals = 10; // number of integration intervals for first TF
+  const unsigned int tfs = 200;                 // number of aggregated TFs
+  const unsigned int rangeIDC = 200;            // number of IDCs used to calculate the fourier coefficients
+  const unsigned int nFourierCoeff = 40;        // number of fourier coefficients (real+imag) which will be calculated/stored
+  const float tolerance = 1e-4f;                // absolute difference between the coefficients of the different methods
+  gRandom->SetSeed(0);
+
+  const auto intervalsPerTF = getIntegrationIntervalsPerTF(integrationIntervals, tfs);
+  const auto idcsLast = get1DIDCs(intervalsPerTF);
+  const auto idcs = get1DIDCs(intervalsPerTF);
+
+  // naive DFT, FFT and FFT in sliding window mode
+  std::array<o2::tpc::FourierCoeff, 3> coefficients{};
+  for (int iType = 0; iType < 3; ++iType) {
+    o2::tpc::IDCFourierTransform::setFFT(iType > 0);
+    o2::tpc::IDCFourierTransform::setSlidingWindow(iType == 2, 50);
+    o2::tpc::IDCFourierTransform idcFourierTransform{rangeIDC, tfs, nFourierCoeff};
+    idcFourierTransform.setIDCs(idcsLast, intervalsPerTF);
+    idcFourierTransform.setIDCs(idcs, intervalsPerTF);
+    idcFourierTransform.calcFourierCoefficients();
+    coefficients[iType].mFourierCoefficients = idcFourierTransform.getFourierCoefficients().mFourierCoefficients;
+  }
+  o2::tpc::IDCFourierTransform::setSlidingWindow(false);
+
+  for (unsigned int iSide = 0; iSide < o2::tpc::SIDES; ++iSide) {
+    const o2::tpc::Side side = iSide == 0 ? Side::A : Side::C;
+    BOOST_REQUIRE_EQUAL(coefficients[0].getNCoefficients(side), tfs * nFourierCoeff);
+    for (unsigned int i = 0; i < coefficients[0].getNCoefficients(side); ++i) {
+      BOOST_CHECK_SMALL(coefficients[1](side, i) - coefficients[0](side, i), tolerance);
+      BOOST_CHECK_SMALL(coefficients[2](side, i) - coefficients[1](side, i), tolerance);
+    }
+  }
+}
+
 } // namespace o2::tpc
@@ -17,6 +17,7 @@
 #define ALICEO2_TPC_DigitContainer_H_
 
 #include <deque>
+#include <vector>
 #include "TPCBase/CRU.h"
 #include "DataFormatsTPC/Defs.h"
 #include "TPCSimulation/DigitTime.h"
@@ -59,6 +60,7 @@ class DigitContainer
   void setStartTime(TimeBin time) { mFirstTimeBin = time; }
 
   /// Add digit to the container
+  /// Digits of different time bins can be added concurrently
   /// \param eventID MC Event ID
   /// \param trackID MC Track ID
   /// \param cru CRU of the digit
@@ -81,11 +83,15 @@ class DigitContainer
   size_t size() const { return mTimeBins.size(); }
 
  private:
-  TimeBin mFirstTimeBin = 0;       ///< First time bin to consider
-  TimeBin mEffectiveTimeBin = 0;   ///< Effective time bin of that digit
-  TimeBin mTmaxTriggered = 0;      ///< Maximum time bin in case of triggered mode (hard cut at average drift speed with additional margin)
-  TimeBin mOffset;                 ///< Size of the container for one event
-  std::deque<DigitTime> mTimeBins; ///< Time bin Container for the ADC value
+  /// Append empty time bins to the container, reusing buffers from the pool when available
+  /// \param nTimeBins Number of time bins to append
+  void appendTimeBins(size_t nTimeBins);
+
+  TimeBin mFirstTimeBin = 0;            ///< First time bin to consider
+  TimeBin mTmaxTriggered = 0;           ///< Maximum time bin in case of triggered mode (hard cut at average drift speed with additional margin)
+  TimeBin mOffset;                      ///< Size of the container for one event
+  std::deque<DigitTime> mTimeBins;      ///< Time bin Container for the ADC value
+  std::vector<DigitTime> mTimeBinsPool; ///< Already written out time bins, kept for reuse of their memory
 };
 
 inline DigitContainer::DigitContainer()
@@ -103,7 +109,6 @@ inline DigitContainer::DigitContainer()
 inline void DigitContainer::reset()
 {
   mFirstTimeBin = 0;
-  mEffectiveTimeBin = 0;
   for (auto& time : mTimeBins) {
     time.reset();
   }
@@ -111,16 +116,26 @@ inline void DigitContainer::reset()
 
 inline void DigitContainer::reserve(TimeBin eventTimeBin)
 {
-  if (mTimeBins.size() < mOffset + eventTimeBin - mFirstTimeBin) {
-    mTimeBins.resize(mOffset + eventTimeBin - mFirstTimeBin);
+  const size_t nTimeBins = mOffset + eventTimeBin - mFirstTimeBin;
+  if (mTimeBins.size() < nTimeBins) {
+    appendTimeBins(nTimeBins - mTimeBins.size());
   }
 }
 
+inline void DigitContainer::appendTimeBins(size_t nTimeBins)
+{
+  while (nTimeBins && !mTimeBinsPool.empty()) {
+    mTimeBins.emplace_back(std::move(mTimeBinsPool.back()));
+    mTimeBinsPool.pop_back();
+    --nTimeBins;
+  }
+  mTimeBins.resize(mTimeBins.size() + nTimeBins);
+}
+
 inline void DigitContainer::addDigit(const MCCompLabel& label, const CRU& cru, TimeBin timeBin, GlobalPadNumber globalPad,
                                      float signal)
 {
-  mEffectiveTimeBin = timeBin - mFirstTimeBin;
-  mTimeBins[mEffectiveTimeBin].addDigit(label, cru, globalPad, signal);
+  mTimeBins[timeBin - mFirstTimeBin].addDigit(label, cru, globalPad, signal);
 }
 
 } // namespace tpc
@@ -16,6 +16,9 @@
 #ifndef ALICEO2_TPC_DigitTime_H_
 #define ALICEO2_TPC_DigitTime_H_
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
 #include "TPCBase/Mapper.h"
 #include "TPCSimulation/DigitGlobalPad.h"
 #include "SimulationDataFormat/LabelContainer.h"
@@ -34,6 +37,9 @@ class DigitMCMetaData;
 /// sorted into after amplification
 /// The structure assures proper sorting of the Digits when later on written out for further processing.
 /// This class holds the individual Pad Row containers and is contained within the CRU Container.
+/// Only pads which received a signal are stored: they are kept in a compact vector together with a small
+/// open-addressing index (global pad -> slot), so that memory and output cost scale with the number of
+/// fired pads and not with the number of pads in the sector.
 
 class DigitTime
 {
@@ -45,6 +51,7 @@ class DigitTime
   ~DigitTime() = default;
 
   /// Resets the container
+  /// The allocated memory is kept, so that the object can be reused for another time bin
   void reset();
 
   /// Get common mode for a given GEM stack
@@ -65,6 +72,9 @@ class DigitTime
   /// \param signal Charge of the digit in ADC counts
   void addDigit(const MCCompLabel& label, const CRU& cru, GlobalPadNumber globalPad, float signal);
 
+  /// Get the number of pads with a signal in this time bin
+  size_t getNumberOfOccupiedPads() const { return mOccupiedPads.size(); }
+
   /// Fill output vector
   /// \param output Output container
   /// \param mcTruth MC Truth container
@@ -77,37 +87,85 @@ class DigitTime
                            std::vector<CommonMode>& commonModeOutput, const Sector& sector, TimeBin timeBin, float commonMode = 0.f);
 
  private:
-  std::array<float, GEMSTACKSPERSECTOR> mCommonMode;                 ///< Common mode container - 4 GEM ROCs per sector
-  std::array<DigitGlobalPad, Mapper::getPadsInSector()> mGlobalPads; ///< Pad Container for the ADC value
-  int mDigitCounter = 0;                                             ///< counts the number of digits in this timebin
+  static constexpr unsigned int InitialIndexBits = 8; ///< initial size of the pad index (2^8 slots)
+
+  /// Get the pad container of a given pad, registering the pad if it did not receive a signal yet
+  /// \param globalPad Global pad number
+  /// \return Pad container
+  DigitGlobalPad& getPad(GlobalPadNumber globalPad);
+
+  /// Double the size of the pad index and rehash all occupied pads
+  void growIndex();
+
+  /// Slot of a pad in the index
+  size_t hashPad(GlobalPadNumber globalPad) const { return (static_cast<uint32_t>(globalPad) * 2654435761u) >> mIndexShift; }
+
+  std::array<float, GEMSTACKSPERSECTOR> mCommonMode; ///< Common mode container - 4 GEM ROCs per sector
+  std::vector<DigitGlobalPad> mGlobalPads;           ///< Pad Container for the ADC value, one entry per occupied pad
+  std::vector<GlobalPadNumber> mOccupiedPads;        ///< Global pad number of each entry in mGlobalPads
+  std::vector<int> mPadIndex;                        ///< Open-addressing index global pad -> position in mGlobalPads + 1 (0 = empty)
+  unsigned int mIndexShift = 32 - InitialIndexBits;  ///< Shift applied to the multiplicative hash, 32 - log2(mPadIndex.size())
+  std::vector<int> mSortedSlots;                     //!< Workspace to write out the pads in ascending pad order
 
   o2::dataformats::LabelContainer<std::pair<MCCompLabel, int>, false> mLabels;
-  // std::deque<int> mOccupiedPads; // iterable container of occupied pads
 };
 
-inline DigitTime::DigitTime() : mCommonMode(), mGlobalPads()
+inline DigitTime::DigitTime() : mCommonMode(), mPadIndex(1u << InitialIndexBits, 0)
 {
   mCommonMode.fill(0.f);
-  mLabels.reserve(Mapper::getPadsInSector() / 3);
 }
 
-inline void DigitTime::addDigit(const MCCompLabel& label, const CRU& cru, GlobalPadNumber globalPad, float signal)
+inline DigitGlobalPad& DigitTime::getPad(GlobalPadNumber globalPad)
+{
+  const size_t mask = mPadIndex.size() - 1;
+  size_t slot = hashPad(globalPad);
+  while (mPadIndex[slot]) {
+    const int id = mPadIndex[slot] - 1;
+    if (mOccupiedPads[id] == globalPad) {
+      return mGlobalPads[id];
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  // this means we have a new digit, keep the load factor of the index below 1/2
+  const int id = static_cast<int>(mGlobalPads.size());
+  mOccupiedPads.emplace_back(globalPad);
+  auto& paddigit = mGlobalPads.emplace_back();
+  paddigit.setID(id);
+  if (2 * mGlobalPads.size() > mPadIndex.size()) {
+    growIndex();
+  } else {
+    mPadIndex[slot] = id + 1;
+  }
+  return paddigit;
+}
+
+inline void DigitTime::growIndex()
 {
-  auto& paddigit = mGlobalPads[globalPad];
-  if (paddigit.getID() == -1) {
-    // this means we have a new digit
-    paddigit.setID(mDigitCounter++);
-    // could also register this pad in a vector of digits
+  mPadIndex.assign(2 * mPadIndex.size(), 0);
+  --mIndexShift;
+  const size_t mask = mPadIndex.size() - 1;
+  for (size_t id = 0; id < mOccupiedPads.size(); ++id) {
+    size_t slot = hashPad(mOccupiedPads[id]);
+    while (mPadIndex[slot]) {
+      slot = (slot + 1) & mask;
+    }
+    mPadIndex[slot] = id + 1;
   }
-  paddigit.addDigit(label, signal, mLabels);
+}
+
+inline void DigitTime::addDigit(const MCCompLabel& label, const CRU& cru, GlobalPadNumber globalPad, float signal)
+{
+  getPad(globalPad).addDigit(label, signal, mLabels);
   mCommonMode[cru.gemStack()] += signal;
 }
 
 inline void DigitTime::reset()
 {
-  for (auto& pad : mGlobalPads) {
-    pad.reset();
-  }
+  mGlobalPads.clear();
+  mOccupiedPads.clear();
+  std::fill(mPadIndex.begin(), mPadIndex.end(), 0);
+  mLabels.clear();
   mCommonMode.fill(0.f);
 }
 
@@ -125,19 +183,24 @@ inline void DigitTime::fillOutputContainer(std::vector<Digit>& output, dataforma
                                            float commonMode)
 {
   static Mapper& mapper = Mapper::instance();
-  GlobalPadNumber globalPad = 0;
   for (size_t i = 0; i < mCommonMode.size(); ++i) {
     const float cm = getCommonMode(GEMstack(i));
     if (cm > 0.) {
       commonModeOutput.push_back({cm, timeBin, static_cast<unsigned char>(i)});
     }
   }
-  for (auto& pad : mGlobalPads) {
+
+  /// the digits are written out in ascending pad order, as for a dense scan over the sector
+  mSortedSlots.resize(mOccupiedPads.size());
+  std::iota(mSortedSlots.begin(), mSortedSlots.end(), 0);
+  std::sort(mSortedSlots.begin(), mSortedSlots.end(), [this](int a, int b) { return mOccupiedPads[a] < mOccupiedPads[b]; });
+  for (const auto id : mSortedSlots) {
+    auto& pad = mGlobalPads[id];
     if (pad.getChargePad() > 0.) {
+      const GlobalPadNumber globalPad = mOccupiedPads[id];
       const CRU cru = mapper.getCRU(sector, globalPad);
       pad.fillOutputContainer<MODE>(output, mcTruth, cru, timeBin, globalPad, mLabels, getCommonMode(cru));
     }
-    ++globalPad;
   }
 }
 } // namespace tpc
@@ -125,16 +125,38 @@ class Digitizer
   /// \param TFile file containing distortions and corrections
   void setUseSCDistortions(TFile& finp);
 
+  /// Use a fine-grained lookup table of the global distortions, created during init(), to distort the electrons instead of the tricubic interpolation
+  /// \param useLUT use the distortion lookup table
+  void setUseSCDistortionLUT(bool useLUT) { mUseSCDistortionLUT = useLUT; }
+
+  /// Set the number of threads used to process the hits
+  /// The random numbers are drawn in the same order as with a single thread, hence the digits do not depend on the number of threads
+  /// \param nThreads number of threads
+  static void setNThreads(const int nThreads) { sNThreads = nThreads; }
+
+  /// \return returns the number of threads used to process the hits
+  static int getNThreads() { return sNThreads; }
+
  private:
+  /// Process the hits with several threads
+  /// The steps drawing random numbers are executed sequentially, in the same order as in process(), the other ones are distributed over the threads
+  /// \param hits Container with TPC hit groups
+  /// \param eventID ID of the event to be processed
+  /// \param sourceID ID of the source to be processed
+  /// \param maxEleTime maximum drift time + hit time which can be processed
+  void processParallel(const std::vector<o2::tpc::HitGroup>& hits, const int eventID, const int sourceID, const float maxEleTime);
+
   DigitContainer mDigitContainer;    ///< Container for the Digits
   std::unique_ptr<SC> mSpaceCharge;  ///< Handler of space-charge distortions
   Sector mSector = -1;               ///< ID of the currently processed sector
   double mEventTime = 0.f;           ///< Time of the currently processed event
   double mOutputDigitTimeOffset = 0; ///< Time of the first IR sampled in the digitizer
   // FIXME: whats the reason for hving this static?
-  static bool mIsContinuous;      ///< Switch for continuous readout
-  bool mUseSCDistortions = false; ///< Flag to switch on the use of space-charge distortions
-  ClassDefNV(Digitizer, 1);
+  static bool mIsContinuous;        ///< Switch for continuous readout
+  bool mUseSCDistortions = false;   ///< Flag to switch on the use of space-charge distortions
+  bool mUseSCDistortionLUT = false; ///< Flag to switch on the use of the distortion lookup table
+  inline static int sNThreads{1};   ///< number of threads used to process the hits
+  ClassDefNV(Digitizer, 2);
 };
 } // namespace tpc
 } // namespace o2
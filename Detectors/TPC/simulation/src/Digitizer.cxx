@@ -31,6 +31,10 @@
 
 #include "FairLogger.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 ClassImp(o2::tpc::Digitizer);
 
 using namespace o2::tpc;
@@ -42,6 +46,9 @@ void Digitizer::init()
   // Calculate distortion lookup tables if initial space-charge density is provided
   if (mUseSCDistortions) {
     mSpaceCharge->init();
+    if (mUseSCDistortionLUT && !mSpaceCharge->hasDistortionLUT()) {
+      mSpaceCharge->initDistortionLUT();
+    }
   }
 }
 
@@ -64,6 +71,9 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
   const auto amplificationMode = gemParam.AmplMode;
   static std::vector<float> signalArray;
   signalArray.resize(nShapedPoints);
+  static std::vector<float> posEleX;
+  static std::vector<float> posEleY;
+  static std::vector<float> posEleZ;
 
   /// Reserve space in the digit container for the current event
   mDigitContainer.reserve(sampaProcessing.getTimeBinFromTime(mEventTime - mOutputDigitTimeOffset));
@@ -71,17 +81,33 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
   /// obtain max drift_time + hitTime which can be processed
   float maxEleTime = (int(mDigitContainer.size()) - nShapedPoints) * eleParam.ZbinWidth;
 
+  if (sNThreads > 1) {
+    processParallel(hits, eventID, sourceID, maxEleTime);
+    return;
+  }
+
   for (auto& hitGroup : hits) {
     const int MCTrackID = hitGroup.GetTrackID();
-    for (size_t hitindex = 0; hitindex < hitGroup.getSize(); ++hitindex) {
+    const size_t nHits = hitGroup.getSize();
+    posEleX.resize(nHits);
+    posEleY.resize(nHits);
+    posEleZ.resize(nHits);
+    for (size_t hitindex = 0; hitindex < nHits; ++hitindex) {
       const auto& eh = hitGroup.getHit(hitindex);
+      posEleX[hitindex] = eh.GetX();
+      posEleY[hitindex] = eh.GetY();
+      posEleZ[hitindex] = eh.GetZ();
+    }
 
-      GlobalPosition3D posEle(eh.GetX(), eh.GetY(), eh.GetZ());
+    // Distort the electron positions of all hits in case space-charge distortions are used
+    if (mUseSCDistortions) {
+      mSpaceCharge->distortElectrons(posEleX.data(), posEleY.data(), posEleZ.data(), nHits);
+    }
 
-      // Distort the electron position in case space-charge distortions are used
-      if (mUseSCDistortions) {
-        mSpaceCharge->distortElectron(posEle);
-      }
+    for (size_t hitindex = 0; hitindex < nHits; ++hitindex) {
+      const auto& eh = hitGroup.getHit(hitindex);
+
+      const GlobalPosition3D posEle(posEleX[hitindex], posEleY[hitindex], posEleZ[hitindex]);
 
       /// Remove electrons that end up more than three sigma of the hit's average diffusion away from the current sector
       /// boundary
@@ -156,6 +182,217 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
   }
 }
 
+void Digitizer::processParallel(const std::vector<o2::tpc::HitGroup>& hits, const int eventID, const int sourceID, const float maxEleTime)
+{
+  const static Mapper& mapper = Mapper::instance();
+  auto& detParam = ParameterDetector::Instance();
+  auto& eleParam = ParameterElectronics::Instance();
+  auto& gemParam = ParameterGEM::Instance();
+  static GEMAmplification& gemAmplification = GEMAmplification::instance();
+  static ElectronTransport& electronTransport = ElectronTransport::instance();
+  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
+
+  const int nShapedPoints = eleParam.NShapedPoints;
+  const auto amplificationMode = gemParam.AmplMode;
+
+  /// the tricubic interpolation of the distortions caches its coefficients per thread, it can only be used by as many threads as it was created for
+  const int nThreadsDistortion = (mUseSCDistortions && !mSpaceCharge->hasDistortionLUT()) ? std::min(sNThreads, SC::getNThreads()) : sNThreads;
+
+  /// the hit groups are processed in batches with about this number of primary electrons, to limit the memory of the intermediate electrons
+  constexpr size_t MaxElectronsBatch = 1 << 18;
+
+  /// the shaped signal of an electron spans at most nShapedPoints + 1 time bins, hence it only reaches the time bins of the chunk
+  /// in which it starts and of the next one
+  const TimeBin chunkSize = nShapedPoints + 2;
+
+  /// electron after drift, diffusion and attachment
+  struct Electron {
+    GlobalPosition3D pos;  ///< position after drift and diffusion
+    float time;            ///< absolute time
+    size_t hitGroup;       ///< index of the hit group
+    bool isInSector;       ///< the electron reaches a valid pad of the current sector
+    DigitPos digiPadPos;   ///< position of the pad
+    int nElectronsGEM;     ///< number of electrons after the amplification
+    TimeBin timeBin;       ///< first time bin of the shaped signal
+  };
+
+  static std::vector<float> posEleX;
+  static std::vector<float> posEleY;
+  static std::vector<float> posEleZ;
+  static std::vector<size_t> hitOffset;      // index of the first hit of each hit group in the batch
+  static std::vector<char> hitOutOfSector;   // hits which are completely out of the sector
+  static std::vector<Electron> electrons;    // electrons of the batch, in the order of processing
+  static std::vector<size_t> ampElectrons;   // index of the electrons with a signal
+  static std::vector<float> signals;         // shaped signals of the electrons with a signal
+  static std::vector<size_t> chunkOffset;    // index of the first electron of each chunk in chunkElectrons
+  static std::vector<size_t> chunkElectrons; // electrons with a signal sorted by the chunk of their first time bin
+  static std::vector<size_t> chunkFill;      // next free position of each chunk in chunkElectrons
+
+  size_t firstGroup = 0;
+  while (firstGroup < hits.size()) {
+    size_t lastGroup = firstGroup;
+    size_t nElectronsBatch = 0;
+    hitOffset.assign(1, 0);
+    while (lastGroup < hits.size() && (lastGroup == firstGroup || nElectronsBatch < MaxElectronsBatch)) {
+      const auto& hitGroup = hits[lastGroup++];
+      for (size_t hitindex = 0; hitindex < hitGroup.getSize(); ++hitindex) {
+        nElectronsBatch += std::max(0, static_cast<int>(hitGroup.getHit(hitindex).GetEnergyLoss()));
+      }
+      hitOffset.emplace_back(hitOffset.back() + hitGroup.getSize());
+    }
+
+    /// Distortion of the hit positions and removal of hits far from the sector, see process()
+    const size_t nHits = hitOffset.back();
+    posEleX.resize(nHits);
+    posEleY.resize(nHits);
+    posEleZ.resize(nHits);
+    hitOutOfSector.resize(nHits);
+#pragma omp parallel for num_threads(nThreadsDistortion) schedule(dynamic)
+    for (size_t igroup = firstGroup; igroup < lastGroup; ++igroup) {
+      const auto& hitGroup = hits[igroup];
+      const size_t offset = hitOffset[igroup - firstGroup];
+      for (size_t hitindex = 0; hitindex < hitGroup.getSize(); ++hitindex) {
+        const auto& eh = hitGroup.getHit(hitindex);
+        posEleX[offset + hitindex] = eh.GetX();
+        posEleY[offset + hitindex] = eh.GetY();
+        posEleZ[offset + hitindex] = eh.GetZ();
+      }
+      if (mUseSCDistortions) {
+        mSpaceCharge->distortElectrons(posEleX.data() + offset, posEleY.data() + offset, posEleZ.data() + offset, hitGroup.getSize());
+      }
+      for (size_t ihit = offset; ihit < offset + hitGroup.getSize(); ++ihit) {
+        const GlobalPosition3D posEle(posEleX[ihit], posEleY[ihit], posEleZ[ihit]);
+        hitOutOfSector[ihit] = electronTransport.isCompletelyOutOfSectorCoarseElectronDrift(posEle, mSector);
+      }
+    }
+
+    /// Drift, diffusion and attachment draw random numbers, they are done sequentially
+    electrons.clear();
+    for (size_t igroup = firstGroup; igroup < lastGroup; ++igroup) {
+      const auto& hitGroup = hits[igroup];
+      const size_t offset = hitOffset[igroup - firstGroup];
+      for (size_t hitindex = 0; hitindex < hitGroup.getSize(); ++hitindex) {
+        if (hitOutOfSector[offset + hitindex]) {
+          continue;
+        }
+        const auto& eh = hitGroup.getHit(hitindex);
+        const GlobalPosition3D posEle(posEleX[offset + hitindex], posEleY[offset + hitindex], posEleZ[offset + hitindex]);
+        const int nPrimaryElectrons = static_cast<int>(eh.GetEnergyLoss());
+        const float hitTime = eh.GetTime() * 0.001; /// in us
+        float driftTime = 0.f;
+        for (int iEle = 0; iEle < nPrimaryElectrons; ++iEle) {
+          const GlobalPosition3D posEleDiff = electronTransport.getElectronDrift(posEle, driftTime);
+          const float eleTime = driftTime + hitTime; /// in us
+          if (eleTime > maxEleTime) {
+            LOG(WARNING) << "Skipping electron with driftTime " << driftTime << " from hit at time " << hitTime;
+            continue;
+          }
+          const float absoluteTime = eleTime + (mEventTime - mOutputDigitTimeOffset); /// in us
+          if (electronTransport.isElectronAttachment(driftTime)) {
+            continue;
+          }
+          auto& electron = electrons.emplace_back();
+          electron.pos = posEleDiff;
+          electron.time = absoluteTime;
+          electron.hitGroup = igroup;
+        }
+      }
+    }
+
+    /// Position of the electrons on the pad plane
+#pragma omp parallel for num_threads(sNThreads)
+    for (size_t iele = 0; iele < electrons.size(); ++iele) {
+      auto& electron = electrons[iele];
+      electron.isInSector = false;
+      if (std::abs(electron.pos.Z()) > detParam.TPClength) {
+        continue;
+      }
+      if (mapper.isOutOfSector(electron.pos, mSector)) {
+        continue;
+      }
+      electron.digiPadPos = mapper.findDigitPosFromGlobalPosition(electron.pos, mSector);
+      electron.isInSector = electron.digiPadPos.isValid() && (electron.digiPadPos.getCRU().sector() == mSector);
+    }
+
+    /// Amplification draws random numbers, it is done sequentially
+    ampElectrons.clear();
+    TimeBin minTimeBin = std::numeric_limits<TimeBin>::max();
+    TimeBin maxTimeBin = 0;
+    for (size_t iele = 0; iele < electrons.size(); ++iele) {
+      auto& electron = electrons[iele];
+      if (!electron.isInSector) {
+        continue;
+      }
+      electron.nElectronsGEM = gemAmplification.getStackAmplification(electron.digiPadPos.getCRU(), electron.digiPadPos.getPadPos(), amplificationMode);
+      if (electron.nElectronsGEM == 0) {
+        continue;
+      }
+      electron.timeBin = sampaProcessing.getTimeBinFromTime(electron.time);
+      minTimeBin = std::min(minTimeBin, electron.timeBin);
+      maxTimeBin = std::max(maxTimeBin, electron.timeBin);
+      ampElectrons.emplace_back(iele);
+    }
+    firstGroup = lastGroup;
+    if (ampElectrons.empty()) {
+      continue;
+    }
+
+    /// Shaping of the signals
+    signals.resize(ampElectrons.size() * nShapedPoints);
+#pragma omp parallel num_threads(sNThreads)
+    {
+      std::vector<float> signalArray(nShapedPoints);
+#pragma omp for
+      for (size_t iamp = 0; iamp < ampElectrons.size(); ++iamp) {
+        const auto& electron = electrons[ampElectrons[iamp]];
+        const float ADCsignal = sampaProcessing.getADCvalue(static_cast<float>(electron.nElectronsGEM));
+        sampaProcessing.getShapedSignal(ADCsignal, electron.time, signalArray);
+        std::copy(signalArray.begin(), signalArray.begin() + nShapedPoints, signals.begin() + iamp * nShapedPoints);
+      }
+    }
+
+    /// The signals are added to the time bins in chunks of time bins, each time bin receives the signals in the order of the electrons
+    const size_t nChunks = (maxTimeBin - minTimeBin) / chunkSize + 1;
+    chunkOffset.assign(nChunks + 1, 0);
+    for (const auto iele : ampElectrons) {
+      ++chunkOffset[(electrons[iele].timeBin - minTimeBin) / chunkSize + 1];
+    }
+    std::partial_sum(chunkOffset.begin(), chunkOffset.end(), chunkOffset.begin());
+    chunkFill.assign(chunkOffset.begin(), chunkOffset.end() - 1);
+    chunkElectrons.resize(ampElectrons.size());
+    for (size_t iamp = 0; iamp < ampElectrons.size(); ++iamp) {
+      const size_t ichunk = (electrons[ampElectrons[iamp]].timeBin - minTimeBin) / chunkSize;
+      chunkElectrons[chunkFill[ichunk]++] = iamp;
+    }
+
+#pragma omp parallel for num_threads(sNThreads) schedule(dynamic)
+    for (size_t ichunk = 0; ichunk <= nChunks; ++ichunk) {
+      const TimeBin firstTimeBin = minTimeBin + ichunk * chunkSize;
+      const TimeBin lastTimeBin = firstTimeBin + chunkSize;
+      // electrons starting in the previous chunk and in this chunk, merged in the order of the electrons
+      size_t iPrev = (ichunk > 0) ? chunkOffset[ichunk - 1] : 0;
+      const size_t endPrev = (ichunk > 0) ? chunkOffset[ichunk] : 0;
+      size_t iCurr = (ichunk < nChunks) ? chunkOffset[ichunk] : 0;
+      const size_t endCurr = (ichunk < nChunks) ? chunkOffset[ichunk + 1] : 0;
+      while (iPrev < endPrev || iCurr < endCurr) {
+        const bool takePrev = (iCurr == endCurr) || ((iPrev < endPrev) && (chunkElectrons[iPrev] < chunkElectrons[iCurr]));
+        const size_t iamp = takePrev ? chunkElectrons[iPrev++] : chunkElectrons[iCurr++];
+        const auto& electron = electrons[ampElectrons[iamp]];
+        const GlobalPadNumber globalPad = mapper.globalPadNumber(electron.digiPadPos.getGlobalPadPos());
+        const MCCompLabel label(hits[electron.hitGroup].GetTrackID(), eventID, sourceID, false);
+        for (float i = 0; i < nShapedPoints; ++i) {
+          const float time = electron.time + i * eleParam.ZbinWidth;
+          const TimeBin timeBin = sampaProcessing.getTimeBinFromTime(time);
+          if (timeBin < firstTimeBin || timeBin >= lastTimeBin) {
+            continue;
+          }
+          mDigitContainer.addDigit(label, electron.digiPadPos.getCRU(), timeBin, globalPad, signals[iamp * nShapedPoints + static_cast<size_t>(i)]);
+        }
+      }
+    }
+  }
+}
+
 void Digitizer::flush(std::vector<o2::tpc::Digit>& digits,
                       o2::dataformats::MCTruthContainer<o2::MCCompLabel>& labels,
                       std::vector<o2::tpc::CommonMode>& commonModeOutput,
@@ -167,5 +167,42 @@ BOOST_AUTO_TEST_CASE(DigitContainer_test2)
     BOOST_CHECK_CLOSE(commonMode[i].getCommonMode(), chargeSum[i] / nPads, 1E-6);
   }
 }
+
+/// \brief Test of the DigitContainer
+/// Many pads are filled in random order into the same time bin, such that the sparse pad index needs to grow, and
+/// the container is reused after a flush. We check that the digits come out in ascending pad order
+BOOST_AUTO_TEST_CASE(DigitContainer_test3)
+{
+  auto& cdb = CDBInterface::instance();
+  cdb.setUseDefaults();
+  o2::conf::ConfigurableParam::updateFromString("TPCEleParam.DigiMode=3");
+  const Mapper& mapper = Mapper::instance();
+  DigitContainer digitContainer;
+
+  const int nPads = 2000;
+  const TimeBin timeBin = 10;
+  for (int iter = 0; iter < 2; ++iter) {
+    dataformats::MCTruthContainer<MCCompLabel> mcTruth;
+    std::vector<Digit> digits;
+    std::vector<o2::tpc::CommonMode> commonMode;
+    digitContainer.reset();
+    digitContainer.reserve(timeBin);
+    for (int i = 0; i < nPads; ++i) {
+      const GlobalPadNumber globalPad = (i * 7919) % Mapper::getPadsInSector();
+      const CRU cru = mapper.getCRU(Sector(0), globalPad);
+      digitContainer.addDigit(MCCompLabel(i, iter, 0, false), cru, timeBin, globalPad, 10.f);
+    }
+    digitContainer.fillOutputContainer(digits, mcTruth, commonMode, 0, 0, true, true);
+
+    BOOST_CHECK(digits.size() == nPads);
+    for (size_t i = 1; i < digits.size(); ++i) {
+      const auto padPrev = mapper.globalPadNumber(PadPos(digits[i - 1].getRow(), digits[i - 1].getPad()));
+      const auto pad = mapper.globalPadNumber(PadPos(digits[i].getRow(), digits[i].getPad()));
+      BOOST_CHECK(padPrev < pad);
+      BOOST_CHECK(mcTruth.getLabels(i).size() == 1);
+      BOOST_CHECK(mcTruth.getLabels(i)[0].getEventID() == iter);
+    }
+  }
+}
 } // namespace tpc
 } // namespace o2
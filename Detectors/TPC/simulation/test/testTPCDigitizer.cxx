@@ -0,0 +1,192 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCDigitizer.cxx
+/// \brief This task tests the digitization with several threads against the one with a single thread
+
+#define BOOST_TEST_MODULE Test TPC Digitizer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "TRandom.h"
+#include "DataFormatsTPC/Digit.h"
+#include "TPCSimulation/CommonMode.h"
+#include "TPCSimulation/Digitizer.h"
+#include "TPCSimulation/ElectronTransport.h"
+#include "TPCSimulation/GEMAmplification.h"
+#include "TPCSimulation/SAMPAProcessing.h"
+#include "TPCSimulation/Point.h"
+#include "TPCBase/CDBInterface.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+
+namespace o2
+{
+namespace tpc
+{
+
+using SC = Digitizer::SC;
+using Hits = std::array<std::vector<std::vector<HitGroup>>, Sector::MAXSECTOR>;
+
+constexpr int NEvents = 2;
+const std::vector<int> Sectors = {0, 1};
+
+/// Output of the digitization of all sectors
+struct DigitizerOutput {
+  std::vector<Digit> digits;
+  dataformats::MCTruthContainer<MCCompLabel> labels;
+  std::vector<CommonMode> commonMode;
+};
+
+/// Hits of straight tracks in the sectors 0 to 2, the hits of a sector are given in the branch of the sector
+/// Each sector receives more primary electrons per event than the digitizer processes in one batch with several threads
+Hits createHits()
+{
+  Hits hits;
+  gRandom->SetSeed(1234);
+  for (int sector = 0; sector < 3; ++sector) {
+    hits[sector].resize(NEvents);
+    for (int event = 0; event < NEvents; ++event) {
+      for (int track = 0; track < 40; ++track) {
+        HitGroup group(track);
+        const float phi = (sector + gRandom->Uniform(0.05, 0.95)) * M_PI / 9.;
+        const float z = gRandom->Uniform(20., 200.);
+        for (float r = 90.f; r < 240.f; r += 2.f) {
+          group.addHit(r * std::cos(phi), r * std::sin(phi), z, gRandom->Uniform(0., 100.), 90);
+        }
+        hits[sector][event].emplace_back(group);
+      }
+    }
+  }
+  return hits;
+}
+
+/// Space-charge object with smooth global distortions of up to ~1 cm, which are evaluated with the tricubic interpolation
+SC* createSpaceCharge()
+{
+  auto spaceCharge = new SC;
+  for (const auto side : {Side::A, Side::C}) {
+    SC::DataContainer distdZ{};
+    SC::DataContainer distdR{};
+    SC::DataContainer distdRPhi{};
+    const double rMin = spaceCharge->getRMin(side);
+    for (size_t iPhi = 0; iPhi < 180; ++iPhi) {
+      const double phi = spaceCharge->getPhiVertex(iPhi, side);
+      for (size_t iR = 0; iR < 129; ++iR) {
+        const double radius = spaceCharge->getRVertex(iR, side);
+        for (size_t iZ = 0; iZ < 129; ++iZ) {
+          const double drift = std::abs(spaceCharge->getZVertex(iZ, side)) / 250;
+          distdZ(iZ, iR, iPhi) = 0.3 * drift * std::cos(phi);
+          distdR(iZ, iR, iPhi) = drift * (0.5 + 0.5 * std::sin(2 * phi)) * std::exp(-(radius - rMin) / 50);
+          distdRPhi(iZ, iR, iPhi) = 0.5 * drift * std::sin(3 * phi) * rMin / radius;
+        }
+      }
+    }
+    spaceCharge->setDistortionLookupTables(distdZ, distdR, distdRPhi, side);
+  }
+  return spaceCharge;
+}
+
+/// Digitize the events of all sectors with a given number of threads in the order of the TPC digitizer workflow
+/// The random number generators are reset to the same state before
+DigitizerOutput digitize(int nThreads, const Hits& hits, bool useDistortions)
+{
+  static const GEMAmplification gemAmplification = GEMAmplification::instance();
+  static const ElectronTransport electronTransport = ElectronTransport::instance();
+  static const SAMPAProcessing sampaProcessing = SAMPAProcessing::instance();
+  GEMAmplification::instance() = gemAmplification;
+  ElectronTransport::instance() = electronTransport;
+  SAMPAProcessing::instance() = sampaProcessing;
+
+  DigitizerOutput output;
+  Digitizer digitizer;
+  Digitizer::setNThreads(nThreads);
+  if (useDistortions) {
+    digitizer.setUseSCDistortions(createSpaceCharge());
+  }
+
+  auto flush = [&](bool finalFlush) {
+    DigitizerOutput flushed;
+    digitizer.flush(flushed.digits, flushed.labels, flushed.commonMode, finalFlush);
+    output.digits.insert(output.digits.end(), flushed.digits.begin(), flushed.digits.end());
+    output.labels.mergeAtBack(flushed.labels);
+    output.commonMode.insert(output.commonMode.end(), flushed.commonMode.begin(), flushed.commonMode.end());
+  };
+
+  for (auto sector : Sectors) {
+    digitizer.setSector(sector);
+    digitizer.setStartTime(0.);
+    for (int event = 0; event < NEvents; ++event) {
+      digitizer.setEventTime(event * 5.);
+      digitizer.process(hits[Sector::getLeft(Sector(sector))][event], event, 0);
+      digitizer.process(hits[sector][event], event, 0);
+      flush(false);
+    }
+    flush(true);
+  }
+  Digitizer::setNThreads(1);
+  return output;
+}
+
+/// The digits, labels and common mode with several threads must be identical to the ones with a single thread
+void checkThreads(bool useDistortions)
+{
+  auto& cdb = CDBInterface::instance();
+  cdb.setUseDefaults();
+  const auto hits = createHits();
+
+  const auto ref = digitize(1, hits, useDistortions);
+  BOOST_CHECK(ref.digits.size() > 0);
+  for (int nThreads : {2, 4}) {
+    BOOST_TEST_CONTEXT("threads " << nThreads << " distortions " << useDistortions)
+    {
+      const auto res = digitize(nThreads, hits, useDistortions);
+      BOOST_REQUIRE_EQUAL(ref.digits.size(), res.digits.size());
+      BOOST_REQUIRE_EQUAL(ref.labels.getIndexedSize(), res.labels.getIndexedSize());
+      BOOST_REQUIRE_EQUAL(ref.commonMode.size(), res.commonMode.size());
+      for (size_t i = 0; i < ref.digits.size(); ++i) {
+        BOOST_CHECK_EQUAL(ref.digits[i].getCRU(), res.digits[i].getCRU());
+        BOOST_CHECK_EQUAL(ref.digits[i].getRow(), res.digits[i].getRow());
+        BOOST_CHECK_EQUAL(ref.digits[i].getPad(), res.digits[i].getPad());
+        BOOST_CHECK_EQUAL(ref.digits[i].getTimeStamp(), res.digits[i].getTimeStamp());
+        BOOST_CHECK_EQUAL(ref.digits[i].getChargeFloat(), res.digits[i].getChargeFloat());
+        const auto refLabels = ref.labels.getLabels(i);
+        const auto resLabels = res.labels.getLabels(i);
+        BOOST_REQUIRE_EQUAL(refLabels.size(), resLabels.size());
+        for (size_t j = 0; j < refLabels.size(); ++j) {
+          BOOST_CHECK(refLabels[j] == resLabels[j]);
+        }
+      }
+      for (size_t i = 0; i < ref.commonMode.size(); ++i) {
+        BOOST_CHECK_EQUAL(ref.commonMode[i].getCommonMode(), res.commonMode[i].getCommonMode());
+        BOOST_CHECK_EQUAL(ref.commonMode[i].getTimeBin(), res.commonMode[i].getTimeBin());
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Digitizer_threads_test)
+{
+  checkThreads(false);
+}
+
+/// The tricubic interpolation of the distortions is used concurrently by the threads, as many threads as used
+/// by the digitizer must be allowed
+BOOST_AUTO_TEST_CASE(Digitizer_threads_distortions_test)
+{
+  SC::setNThreads(4);
+  checkThreads(true);
+}
+
+} // namespace tpc
+} // namespace o2
@@ -86,17 +86,17 @@ class PoissonSolver
 
   static DataT getConvergenceError() { return sConvergenceError; }
 
-  /// get the number of threads used for some of the calculations
+  /// get the number of threads used for the calculations
   static int getNThreads() { return sNThreads; }
 
-  /// set the number of threads used for some of the calculations
+  /// set the number of threads used for the calculations
   static void setNThreads(int nThreads) { sNThreads = nThreads; }
 
  private:
   const RegularGrid& mGrid3D{};                                      ///< grid properties
   inline static DataT sConvergenceError{1e-6};                       ///< Error tolerated
   static constexpr DataT INVTWOPI = 1. / o2::constants::math::TwoPI; ///< inverse of 2*pi
-  inline static int sNThreads{4};                                    ///< number of threads which are used during some of the calculations (increasing this number has no big impact)
+  inline static int sNThreads{4};                                    ///< number of threads which are used during the calculations
 
   /// Relative error calculation: comparison with exact solution
   ///
@@ -234,6 +234,25 @@ class PoissonSolver
   void relax3D(Vector& matricesCurrentV, const Vector& matricesCurrentCharge, const int tnRRow, const int tnZColumn, const int iPhi, const int symmetry, const DataT h2, const DataT tempRatioZ,
                const std::array<DataT, Nr>& coefficient1, const std::array<DataT, Nr>& coefficient2, const std::array<DataT, Nr>& coefficient3, const std::array<DataT, Nr>& coefficient4) const;
 
+  /// Gauss-Seidel relaxation of the points of one colour in one phi slice
+  ///
+  /// \param matricesCurrentV potential in 3D
+  /// \param matricesCurrentCharge charge in 3D
+  /// \param tnRRow number of vertices in r direction
+  /// \param tnZColumn number of vertices in z direction
+  /// \param iPhi number of phi slices
+  /// \param m index of the phi slice which is relaxed
+  /// \param msw colour of the pass (1 or 2)
+  /// \param symmetry is the cylinder has symmetry
+  /// \param h2 \f$  h_{r}^{2} \f$
+  /// \param tempRatioZ ration between grid size in z-direction and r-direction
+  /// \param coefficient1 coefficients for \f$  V_{x+1,y,z} \f$
+  /// \param coefficient2 coefficients for \f$  V_{x-1,y,z} \f$
+  /// \param coefficient3 coefficients for z
+  /// \param coefficient4 coefficients for f(r,\phi,z)
+  void relaxSliceGaussSeidel3D(Vector& matricesCurrentV, const Vector& matricesCurrentCharge, const int tnRRow, const int tnZColumn, const int iPhi, const int m, const int msw, const int symmetry, const DataT h2,
+                               const DataT tempRatioZ, const std::array<DataT, Nr>& coefficient1, const std::array<DataT, Nr>& coefficient2, const std::array<DataT, Nr>& coefficient3, const std::array<DataT, Nr>& coefficient4) const;
+
   /// Relax2D
   ///
   ///    Relaxation operation for multiGrid
@@ -282,6 +282,28 @@ class SpaceCharge
   /// \param point 3D coordinates of the electron
   void distortElectron(GlobalPosition3D& point) const;
 
+  /// Distort the positions of several electrons, given in SoA form, in place. If the distortion LUT was created with initDistortionLUT()
+  /// the distortions are obtained from it, otherwise with the same interpolation as in distortElectron()
+  /// With the LUT the function only reads and can be called concurrently from any thread. Without the LUT the tricubic interpolators cache
+  /// their coefficients per OpenMP thread number: concurrent calls are only allowed from OpenMP threads with a thread number smaller than
+  /// getNThreads(), other threads (e.g. std::thread) all have the thread number 0 and would share the cache
+  /// \param posX x coordinates of the electrons
+  /// \param posY y coordinates of the electrons
+  /// \param posZ z coordinates of the electrons
+  /// \param nElectrons number of electrons
+  void distortElectrons(float* posX, float* posY, float* posZ, const size_t nElectrons) const;
+
+  /// create a lookup table of the global distortions on a grid which is finer than the one used for the calculations.
+  /// For each vertex of the LUT the distortions dZ, dR and dRPhi are stored next to each other in single precision and are evaluated with trilinear interpolation.
+  /// The LUT has to be recreated if the global distortions change.
+  /// \param refineZ number of LUT bins per grid bin in z direction
+  /// \param refineR number of LUT bins per grid bin in r direction
+  /// \param refinePhi number of LUT bins per grid bin in phi direction
+  void initDistortionLUT(const int refineZ = 2, const int refineR = 2, const int refinePhi = 1);
+
+  /// \return returns whether the distortion LUT was created
+  bool hasDistortionLUT() const { return !mDistortionLUT[Side::A].mValues.empty(); }
+
   /// set the distortions directly from a look up table
   /// \param distdZ distortions in z direction
   /// \param distdR distortions in r direction
@@ -559,8 +581,24 @@ class SpaceCharge
   {
     sNThreads = nThreads;
     o2::tpc::TriCubicInterpolator<DataT, Nz, Nr, Nphi>::setNThreads(nThreads);
+    ASolv::setNThreads(nThreads);
   }
 
+  /// set the directory in which the results of calculateDistortionsCorrections() are cached. The results are stored in one file per side, identified by
+  /// a hash of the charge density, the boundary potential and the settings of the calculation (see getCalculationHash()), and are read instead of being
+  /// recalculated if the same calculation is requested again. The cache is disabled if the directory is empty (default).
+  /// \param dir directory of the cache
+  static void setCacheDirectory(const std::string& dir) { sCacheDirectory = dir; }
+
+  /// \return returns the directory in which the results of calculateDistortionsCorrections() are cached
+  static const std::string& getCacheDirectory() { return sCacheDirectory; }
+
+  /// \return returns the hash which identifies the results of calculateDistortionsCorrections() for the current charge density, potential, settings
+  /// and TPC parameters (e.g. the cathode and GEM 1 top voltages)
+  /// \param side side of the TPC
+  /// \param calcVectors set if the local distortion and local correction vectors are calculated
+  uint64_t getCalculationHash(const Side side, const bool calcVectors) const;
+
   /// set which kind of numerical integration is used for calcution of the integrals int Er/Ez dz, int Ephi/Ez dz, int Ez dz
   /// \param strategy numerical integration strategy. see enum IntegrationStrategy for the different types
   static void setNumericalIntegrationStrategy(const IntegrationStrategy strategy) { sNumericalIntegrationStrategy = strategy; }
@@ -700,6 +738,16 @@ class SpaceCharge
  private:
   using ASolv = o2::tpc::PoissonSolver<DataT, Nz, Nr, Nphi>;
 
+  /// \return returns the name of the file in the cache directory for the current calculation
+  std::string getCacheFileName(const Side side, const bool calcVectors) const;
+
+  /// set the potential, electric fields, local and global distortions and corrections from a file in the cache directory
+  /// \return returns false, without changing any of the objects, if the file does not exist or one of the objects is missing or has the wrong size
+  bool readFromCache(const std::string& file, const Side side, const bool calcVectors);
+
+  /// store the potential, electric fields, local and global distortions and corrections in a file in the cache directory
+  void writeToCache(const std::string& file, const Side side) const;
+
   inline static int sNThreads{omp_get_max_threads()}; ///< number of threads which are used during the calculations
 
   inline static IntegrationStrategy sNumericalIntegrationStrategy{IntegrationStrategy::SimpsonIterative}; ///< numerical integration strategy of integration of the E-Field: 0: trapezoidal, 1: Simpson, 2: Root (only for analytical formula case)
@@ -708,6 +756,7 @@ class SpaceCharge
   inline static GlobalDistType sGlobalDistType{GlobalDistType::Fast};                                     ///< setting for global distortions: 0: standard method,      1: interpolation of global corrections
   inline static GlobalDistCorrMethod sGlobalDistCorrCalcMethod{GlobalDistCorrMethod::LocalDistCorr};      ///< setting for  global distortions/corrections: 0: using electric field, 1: using local dis/corr interpolator
   inline static SCDistortionType sSCDistortionType{SCDistortionType::SCDistortionsConstant};              ///< Type of space-charge distortions
+  inline static std::string sCacheDirectory{};                                                            ///< directory in which the results of calculateDistortionsCorrections() are cached
 
   DataT mC0 = 0; ///< coefficient C0 (compare Jim Thomas's notes for definitions)
   DataT mC1 = 0; ///< coefficient C1 (compare Jim Thomas's notes for definitions)
@@ -784,6 +833,21 @@ class SpaceCharge
     {mLocalVecDistdR[Side::A], mLocalVecDistdZ[Side::A], mLocalVecDistdRPhi[Side::A], mGrid3D[Side::A], Side::A},
     {mLocalVecDistdR[Side::C], mLocalVecDistdZ[Side::C], mLocalVecDistdRPhi[Side::C], mGrid3D[Side::C], Side::C}}; ///< interpolator for the local distortion vectors
 
+  /// lookup table of the global distortions used for the distortion of electrons. The vertices are ordered with z running fastest and phi slowest
+  struct DistortionLUT {
+    std::vector<float> mValues{}; ///< dZ, dR and dRPhi for each vertex
+    int mNZ{};                    ///< number of vertices in z direction
+    int mNR{};                    ///< number of vertices in r direction
+    int mNPhi{};                  ///< number of vertices in phi direction (the first vertex follows the last one)
+    float mInvSpacingZ{};         ///< inverse spacing in |z| direction
+    float mInvSpacingR{};         ///< inverse spacing in r direction
+    float mInvSpacingPhi{};       ///< inverse spacing in phi direction
+
+    /// \return returns the index of the first value of the vertex
+    size_t getIndex(const int iz, const int ir, const int iphi) const { return 3 * (iz + mNZ * (ir + static_cast<size_t>(mNR) * iphi)); }
+  };
+  DistortionLUT mDistortionLUT[FNSIDES]{}; //! fine-grained lookup table of the global distortions
+
   NumericalFields<DataT, Nz, Nr, Nphi> mInterpolatorEField[FNSIDES]{
     {mElectricFieldEr[Side::A], mElectricFieldEz[Side::A], mElectricFieldEphi[Side::A], mGrid3D[Side::A], Side::A},
     {mElectricFieldEr[Side::C], mElectricFieldEz[Side::C], mElectricFieldEphi[Side::C], mGrid3D[Side::C], Side::C}}; ///< interpolator for the electric fields
@@ -255,6 +255,7 @@ void PoissonSolver<DataT, Nz, Nr, Nphi>::poissonMultiGrid3D2D(DataContainer& mat
     tvCharge[count - 1].resize(tnRRow, tnZColumn, Nphi);
 
     if (count == 1) {
+#pragma omp parallel for num_threads(sNThreads)
       for (int iphi = 0; iphi < Nphi; ++iphi) {
         for (int ir = 0; ir < Nr; ++ir) {
           for (int iz = 0; iz < Nz; ++iz) {
@@ -329,6 +330,7 @@ void PoissonSolver<DataT, Nz, Nr, Nphi>::poissonMultiGrid3D2D(DataContainer& mat
   }
 
   // fill output
+#pragma omp parallel for num_threads(sNThreads)
   for (int iphi = 0; iphi < Nphi; ++iphi) {
     for (int ir = 0; ir < Nr; ++ir) {
       for (int iz = 0; iz < Nz; ++iz) {
@@ -981,6 +983,7 @@ void PoissonSolver<DataT, Nz, Nr, Nphi>::interp3D(Vector& matricesCurrentV, cons
 {
   // Do restrict 2 D for each slice
   if (newPhiSlice == 2 * oldPhiSlice) {
+#pragma omp parallel for num_threads(sNThreads) // each iteration writes only to the slices m and m + 1
     for (int m = 0; m < newPhiSlice; m += 2) {
       // assuming no symmetry
       int mm = m * 0.5;
@@ -1087,6 +1090,7 @@ void PoissonSolver<DataT, Nz, Nr, Nphi>::addInterp3D(Vector& matricesCurrentV, c
 {
   // Do restrict 2 D for each slice
   if (newPhiSlice == 2 * oldPhiSlice) {
+#pragma omp parallel for num_threads(sNThreads) // each iteration writes only to the slices m and m + 1
     for (int m = 0; m < newPhiSlice; m += 2) {
       // assuming no symmetry
       int mm = m * 0.5;
@@ -1192,52 +1196,21 @@ template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
 void PoissonSolver<DataT, Nz, Nr, Nphi>::relax3D(Vector& matricesCurrentV, const Vector& matricesCurrentCharge, const int tnRRow, const int tnZColumn, const int iPhi, const int symmetry, const DataT h2,
                                                  const DataT tempRatioZ, const std::array<DataT, Nr>& coefficient1, const std::array<DataT, Nr>& coefficient2, const std::array<DataT, Nr>& coefficient3, const std::array<DataT, Nr>& coefficient4) const
 {
-  // Gauss-Seidel (Read Black}
+  // Gauss-Seidel (Red Black)
   if (MGParameters::relaxType == RelaxType::GaussSeidel) {
-    // for each slice
+    // the points of one colour only depend on points of the other colour, except for the first and the last phi slice in case of
+    // periodic boundaries and an odd number of slices: the last slice is relaxed after all other slices as in a sequential sweep
+    const int nParallelSlices = (symmetry == 0 && (iPhi % 2)) ? iPhi - 1 : iPhi;
     for (int iPass = 1; iPass <= 2; ++iPass) {
       const int msw = (iPass % 2) ? 1 : 2;
-      for (int m = 0; m < iPhi; ++m) {
-        const int jsw = ((msw + m) % 2) ? 1 : 2;
-        int mp1 = m + 1;
-        int signPlus = 1;
-        int mm1 = m - 1;
-        int signMinus = 1;
-        // Reflection symmetry in phi (e.g. symmetry at sector boundaries, or half sectors, etc.)
-        if (symmetry == 1) {
-          if (mp1 > iPhi - 1) {
-            mp1 = iPhi - 2;
-          }
-          if (mm1 < 0) {
-            mm1 = 1;
-          }
-        }
-        // Anti-symmetry in phi
-        else if (symmetry == -1) {
-          if (mp1 > iPhi - 1) {
-            mp1 = iPhi - 2;
-            signPlus = -1;
-          }
-          if (mm1 < 0) {
-            mm1 = 1;
-            signMinus = -1;
-          }
-        } else { // No Symmetries in phi, no boundaries, the calculation is continuous across all phi
-          if (mp1 > iPhi - 1) {
-            mp1 = m + 1 - iPhi;
-          }
-          if (mm1 < 0) {
-            mm1 = m - 1 + iPhi;
-          }
-        }
-        int isw = jsw;
-        for (int j = 1; j < tnZColumn - 1; ++j, isw = 3 - isw) {
-          for (int i = isw; i < tnRRow - 1; i += 2) {
-            (matricesCurrentV)(i, j, m) = (coefficient2[i] * (matricesCurrentV)(i - 1, j, m) + tempRatioZ * ((matricesCurrentV)(i, j - 1, m) + (matricesCurrentV)(i, j + 1, m)) + coefficient1[i] * (matricesCurrentV)(i + 1, j, m) + coefficient3[i] * (signPlus * (matricesCurrentV)(i, j, mp1) + signMinus * (matricesCurrentV)(i, j, mm1)) + (h2 * (matricesCurrentCharge)(i, j, m))) * coefficient4[i];
-          } // end cols
-        }   // end Nr
-      }     // end phi
-    }       // end sweep
+#pragma omp parallel for num_threads(sNThreads)
+      for (int m = 0; m < nParallelSlices; ++m) {
+        relaxSliceGaussSeidel3D(matricesCurrentV, matricesCurrentCharge, tnRRow, tnZColumn, iPhi, m, msw, symmetry, h2, tempRatioZ, coefficient1, coefficient2, coefficient3, coefficient4);
+      }
+      for (int m = nParallelSlices; m < iPhi; ++m) {
+        relaxSliceGaussSeidel3D(matricesCurrentV, matricesCurrentCharge, tnRRow, tnZColumn, iPhi, m, msw, symmetry, h2, tempRatioZ, coefficient1, coefficient2, coefficient3, coefficient4);
+      }
+    } // end sweep
   } else if (MGParameters::relaxType == RelaxType::Jacobi) {
     // for each slice
     for (int m = 0; m < iPhi; ++m) {
@@ -1286,6 +1259,50 @@ void PoissonSolver<DataT, Nz, Nr, Nphi>::relax3D(Vector& matricesCurrentV, const
   }
 }
 
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+void PoissonSolver<DataT, Nz, Nr, Nphi>::relaxSliceGaussSeidel3D(Vector& matricesCurrentV, const Vector& matricesCurrentCharge, const int tnRRow, const int tnZColumn, const int iPhi, const int m, const int msw, const int symmetry, const DataT h2,
+                                                                 const DataT tempRatioZ, const std::array<DataT, Nr>& coefficient1, const std::array<DataT, Nr>& coefficient2, const std::array<DataT, Nr>& coefficient3, const std::array<DataT, Nr>& coefficient4) const
+{
+  const int jsw = ((msw + m) % 2) ? 1 : 2;
+  int mp1 = m + 1;
+  int signPlus = 1;
+  int mm1 = m - 1;
+  int signMinus = 1;
+  // Reflection symmetry in phi (e.g. symmetry at sector boundaries, or half sectors, etc.)
+  if (symmetry == 1) {
+    if (mp1 > iPhi - 1) {
+      mp1 = iPhi - 2;
+    }
+    if (mm1 < 0) {
+      mm1 = 1;
+    }
+  }
+  // Anti-symmetry in phi
+  else if (symmetry == -1) {
+    if (mp1 > iPhi - 1) {
+      mp1 = iPhi - 2;
+      signPlus = -1;
+    }
+    if (mm1 < 0) {
+      mm1 = 1;
+      signMinus = -1;
+    }
+  } else { // No Symmetries in phi, no boundaries, the calculation is continuous across all phi
+    if (mp1 > iPhi - 1) {
+      mp1 = m + 1 - iPhi;
+    }
+    if (mm1 < 0) {
+      mm1 = m - 1 + iPhi;
+    }
+  }
+  int isw = jsw;
+  for (int j = 1; j < tnZColumn - 1; ++j, isw = 3 - isw) {
+    for (int i = isw; i < tnRRow - 1; i += 2) {
+      (matricesCurrentV)(i, j, m) = (coefficient2[i] * (matricesCurrentV)(i - 1, j, m) + tempRatioZ * ((matricesCurrentV)(i, j - 1, m) + (matricesCurrentV)(i, j + 1, m)) + coefficient1[i] * (matricesCurrentV)(i + 1, j, m) + coefficient3[i] * (signPlus * (matricesCurrentV)(i, j, mp1) + signMinus * (matricesCurrentV)(i, j, mm1)) + (h2 * (matricesCurrentCharge)(i, j, m))) * coefficient4[i];
+    } // end cols
+  }   // end Nr
+}
+
 template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
 void PoissonSolver<DataT, Nz, Nr, Nphi>::relax2D(Vector& matricesCurrentV, const Vector& matricesCurrentCharge, const int tnRRow, const int tnZColumn, const DataT h2, const DataT tempFourth, const DataT tempRatio,
                                                  std::vector<DataT>& coefficient1, std::vector<DataT>& coefficient2)
@@ -1361,8 +1378,9 @@ template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
 void PoissonSolver<DataT, Nz, Nr, Nphi>::restrict3D(Vector& matricesCurrentCharge, const Vector& residue, const int tnRRow, const int tnZColumn, const int newPhiSlice, const int oldPhiSlice) const
 {
   if (2 * newPhiSlice == oldPhiSlice) {
-    int mm = 0;
-    for (int m = 0; m < newPhiSlice; m++, mm += 2) {
+#pragma omp parallel for num_threads(sNThreads)
+    for (int m = 0; m < newPhiSlice; ++m) {
+      const int mm = 2 * m;
       // assuming no symmetry
       int mp1 = mm + 1;
       int mm1 = mm - 1;
@@ -1409,6 +1427,7 @@ void PoissonSolver<DataT, Nz, Nr, Nphi>::restrict3D(Vector& matricesCurrentCharg
     } // end phis
 
   } else {
+#pragma omp parallel for num_threads(sNThreads)
     for (int m = 0; m < newPhiSlice; ++m) {
       restrict2D(matricesCurrentCharge, residue, tnRRow, tnZColumn, m);
     }
@@ -18,7 +18,11 @@
 #include "TPCSpaceCharge/SpaceCharge.h"
 #include "fmt/core.h"
 #include "Framework/Logger.h"
+#include <Vc/Vc>
 #include <chrono>
+#include <filesystem>
+#include <memory>
+#include <unistd.h>
 
 #ifdef WITH_OPENMP
 #include <omp.h>
@@ -28,6 +32,25 @@ templateClassImp(o2::tpc::SpaceCharge);
 
 using namespace o2::tpc;
 
+namespace
+{
+/// FNV-1a hash of a block of memory
+uint64_t hashBytes(const void* data, const size_t size, uint64_t hash)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+template <typename T>
+uint64_t hashValue(const T value, const uint64_t hash)
+{
+  return hashBytes(&value, sizeof(T), hash);
+}
+} // namespace
+
 template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
 void SpaceCharge<DataT, Nz, Nr, Nphi>::calculateDistortionsCorrections(const o2::tpc::Side side, const bool calcVectors)
 {
@@ -58,6 +81,15 @@ void SpaceCharge<DataT, Nz, Nr, Nphi>::calculateDistortionsCorrections(const o2:
     LOGP(info, "skipping calculation of global distortions");
   }
 
+  std::string cacheFile;
+  if (!sCacheDirectory.empty()) {
+    cacheFile = getCacheFileName(side, calcVectors);
+    if (readFromCache(cacheFile, side, calcVectors)) {
+      LOGP(info, "distortions and corrections for Side {} are taken from the cache: {}", sideName[side], cacheFile);
+      return;
+    }
+  }
+
   auto startTotal = timer::now();
 
   auto start = timer::now();
@@ -122,6 +154,144 @@ void SpaceCharge<DataT, Nz, Nr, Nphi>::calculateDistortionsCorrections(const o2:
   stop = timer::now();
   time = stop - startTotal;
   LOGP(info, "everything is done. Total Time: {}", time.count());
+
+  if (!cacheFile.empty()) {
+    writeToCache(cacheFile, side);
+  }
+}
+
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+uint64_t SpaceCharge<DataT, Nz, Nr, Nphi>::getCalculationHash(const Side side, const bool calcVectors) const
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (const auto val : {Nz, Nr, Nphi, sizeof(DataT), static_cast<size_t>(side), static_cast<size_t>(calcVectors)}) {
+    hash = hashValue(val, hash);
+  }
+
+  // input of the calculation: charge density and the (boundary) potential used as starting point of the poisson solver
+  hash = hashBytes(mDensity[side].getData().data(), mDensity[side].getData().size() * sizeof(DataT), hash);
+  hash = hashBytes(mPotential[side].getData().data(), mPotential[side].getData().size() * sizeof(DataT), hash);
+
+  // settings of the calculation
+  using TPCParam = TPCParameters<DataT>;
+  for (const auto val : {mC0, mC1, TPCParam::cathodev, TPCParam::vg1t, TPCParam::TPCZ0, TPCParam::IFCRADIUS, TPCParam::OFCRADIUS, TPCParam::ZOFFSET, TPCParam::DVDE,
+                         TPCParam::EM, TPCParam::E0, ASolv::getConvergenceError()}) {
+    hash = hashValue(val, hash);
+  }
+  for (const auto val : {static_cast<int>(sNumericalIntegrationStrategy), sSimpsonNIteratives, sSteps, static_cast<int>(sGlobalDistType), static_cast<int>(sGlobalDistCorrCalcMethod),
+                         static_cast<int>(MGParameters::isFull3D), static_cast<int>(MGParameters::cycleType), static_cast<int>(MGParameters::gtType), static_cast<int>(MGParameters::relaxType),
+                         MGParameters::nPre, MGParameters::nPost, MGParameters::nMGCycle, MGParameters::maxLoop, MGParameters::gamma}) {
+    hash = hashValue(val, hash);
+  }
+  return hash;
+}
+
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+std::string SpaceCharge<DataT, Nz, Nr, Nphi>::getCacheFileName(const Side side, const bool calcVectors) const
+{
+  return fmt::format("{}/spaceCharge_{}_{}_{}_side{}_{:016x}.root", sCacheDirectory, Nz, Nr, Nphi, getSideName(side), getCalculationHash(side, calcVectors));
+}
+
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+bool SpaceCharge<DataT, Nz, Nr, Nphi>::readFromCache(const std::string& file, const Side side, const bool calcVectors)
+{
+  if (!std::filesystem::exists(file)) {
+    return false;
+  }
+  TFile fInp(file.data(), "READ");
+  if (fInp.IsZombie()) {
+    LOGP(warning, "cache file {} can not be read, the distortions and corrections are recalculated", file);
+    return false;
+  }
+
+  // objects which are stored by writeToCache() for the requested calculation
+  const std::string sideName = getSideName(side);
+  std::vector<std::pair<DataContainer*, std::string>> objects{
+    {&mPotential[side], fmt::format("potential_side{}", sideName)},
+    {&mElectricFieldEr[side], fmt::format("fieldEr_side{}", sideName)},
+    {&mElectricFieldEz[side], fmt::format("fieldEz_side{}", sideName)},
+    {&mElectricFieldEphi[side], fmt::format("fieldEphi_side{}", sideName)},
+    {&mLocalCorrdR[side], fmt::format("lcorrR_side{}", sideName)},
+    {&mLocalCorrdZ[side], fmt::format("lcorrZ_side{}", sideName)},
+    {&mLocalCorrdRPhi[side], fmt::format("lcorrRPhi_side{}", sideName)},
+    {&mGlobalCorrdR[side], fmt::format("corrR_side{}", sideName)},
+    {&mGlobalCorrdZ[side], fmt::format("corrZ_side{}", sideName)},
+    {&mGlobalCorrdRPhi[side], fmt::format("corrRPhi_side{}", sideName)}};
+  if (getGlobalDistType() == GlobalDistType::Standard) {
+    objects.insert(objects.end(), {{&mLocalDistdR[side], fmt::format("ldistR_side{}", sideName)},
+                                   {&mLocalDistdZ[side], fmt::format("ldistZ_side{}", sideName)},
+                                   {&mLocalDistdRPhi[side], fmt::format("ldistRPhi_side{}", sideName)}});
+  }
+  if (calcVectors) {
+    objects.insert(objects.end(), {{&mLocalVecDistdR[side], fmt::format("lvecdistR_side{}", sideName)},
+                                   {&mLocalVecDistdZ[side], fmt::format("lvecdistZ_side{}", sideName)},
+                                   {&mLocalVecDistdRPhi[side], fmt::format("lvecdistRPhi_side{}", sideName)}});
+  }
+  if (getGlobalDistType() != GlobalDistType::None) {
+    objects.insert(objects.end(), {{&mGlobalDistdR[side], fmt::format("distR_side{}", sideName)},
+                                   {&mGlobalDistdZ[side], fmt::format("distZ_side{}", sideName)},
+                                   {&mGlobalDistdRPhi[side], fmt::format("distRphi_side{}", sideName)}});
+  }
+
+  // all objects are read and checked before any of them is set, such that an incomplete or corrupted file (e.g. written by a different version)
+  // leaves the object unchanged and the calculation is performed
+  std::vector<std::unique_ptr<DataContainer>> loaded;
+  for (const auto& object : objects) {
+    loaded.emplace_back(fInp.Get<DataContainer>(object.second.data()));
+    if (!loaded.back() || loaded.back()->getData().size() != DataContainer::getNDataPoints()) {
+      LOGP(warning, "object {} is missing or has the wrong size in the cache file {}, the distortions and corrections are recalculated", object.second, file);
+      return false;
+    }
+  }
+  for (size_t i = 0; i < objects.size(); ++i) {
+    objects[i].first->getData() = std::move(loaded[i]->getData());
+  }
+
+  mIsEfieldSet[side] = true;
+  mIsLocalCorrSet[side] = true;
+  mIsGlobalCorrSet[side] = true;
+  if (getGlobalDistType() == GlobalDistType::Standard) {
+    mIsLocalDistSet[side] = true;
+  }
+  if (calcVectors) {
+    mIsLocalVecDistSet[side] = true;
+  }
+  if (getGlobalDistType() != GlobalDistType::None) {
+    mIsGlobalDistSet[side] = true;
+  }
+  return true;
+}
+
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+void SpaceCharge<DataT, Nz, Nr, Nphi>::writeToCache(const std::string& file, const Side side) const
+{
+  // write to a temporary file first, to not expose incomplete files to concurrent jobs using the same cache
+  std::filesystem::create_directories(sCacheDirectory);
+  const std::string tmpFile = fmt::format("{}.{}.tmp", file, getpid());
+  {
+    TFile fOut(tmpFile.data(), "RECREATE");
+    dumpPotential(fOut, side);
+    dumpElectricFields(fOut, side);
+    dumpLocalCorrections(fOut, side);
+    if (mIsLocalDistSet[side]) {
+      dumpLocalDistortions(fOut, side);
+    }
+    if (mIsLocalVecDistSet[side]) {
+      dumpLocalDistCorrVectors(fOut, side);
+    }
+    dumpGlobalCorrections(fOut, side);
+    if (mIsGlobalDistSet[side]) {
+      dumpGlobalDistortions(fOut, side);
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpFile, file, ec);
+  if (ec) {
+    LOGP(warning, "could not store the distortions and corrections in the cache {}: {}", file, ec.message());
+    std::filesystem::remove(tmpFile, ec);
+  } else {
+    LOGP(info, "distortions and corrections for Side {} are stored in the cache: {}", getSideName(side), file);
+  }
 }
 
 template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
@@ -1218,6 +1388,161 @@ void SpaceCharge<DataT, Nz, Nr, Nphi>::distortElectron(GlobalPosition3D& point)
   point.SetXYZ(point.X() + distX, point.Y() + distY, point.Z() + distZ);
 }
 
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+void SpaceCharge<DataT, Nz, Nr, Nphi>::distortElectrons(float* posX, float* posY, float* posZ, const size_t nElectrons) const
+{
+  if (!hasDistortionLUT()) {
+    if (omp_get_thread_num() >= sNThreads) {
+      LOGP(fatal, "distortElectrons without LUT called from thread {}, the interpolators are set up for {} threads", omp_get_thread_num(), sNThreads);
+    }
+    for (size_t i = 0; i < nElectrons; ++i) {
+      DataT distX{};
+      DataT distY{};
+      DataT distZ{};
+      getDistortions(posX[i], posY[i], posZ[i], getSide(posZ[i]), distX, distY, distZ);
+      posX[i] += distX;
+      posY[i] += distY;
+      posZ[i] += distZ;
+    }
+    return;
+  }
+
+  // the binning of the LUT is the same for both sides
+  using float_v = Vc::float_v;
+  constexpr size_t nLanes = float_v::size();
+  const auto& lutA = mDistortionLUT[Side::A];
+  const float_v invSpacingZ = lutA.mInvSpacingZ;
+  const float_v invSpacingR = lutA.mInvSpacingR;
+  const float_v invSpacingPhi = lutA.mInvSpacingPhi;
+  const float_v zMax = static_cast<float>(lutA.mNZ - 2);
+  const float_v rMax = static_cast<float>(lutA.mNR - 2);
+  const float_v rMin = static_cast<float>(getRMin(Side::A));
+  const float_v zero = 0.f;
+  const float_v one = 1.f;
+  const float_v twoPi = static_cast<float>(2 * M_PI);
+
+  for (size_t i = 0; i < nElectrons; i += nLanes) {
+    // the unused lanes of the last chunk are filled with the first electron of the chunk
+    const size_t nLanesUsed = std::min(nLanes, nElectrons - i);
+    float_v x;
+    float_v y;
+    float_v z;
+    for (size_t lane = 0; lane < nLanes; ++lane) {
+      const size_t idx = i + ((lane < nLanesUsed) ? lane : 0);
+      x[lane] = posX[idx];
+      y[lane] = posY[idx];
+      z[lane] = posZ[idx];
+    }
+
+    // convert cartesian to polar and to the relative positions in the LUT
+    const float_v radius = Vc::sqrt(x * x + y * y);
+    float_v phi = Vc::atan2(y, x);
+    phi(phi < zero) += twoPi;
+
+    const float_v relZ = Vc::abs(z) * invSpacingZ;
+    const float_v relR = (radius - rMin) * invSpacingR;
+    const float_v relPhi = phi * invSpacingPhi;
+    const float_v binZ = Vc::max(Vc::min(Vc::floor(relZ), zMax), zero);
+    const float_v binR = Vc::max(Vc::min(Vc::floor(relR), rMax), zero);
+    const float_v binPhi = Vc::floor(relPhi);
+    const float_v fracZ = Vc::max(Vc::min(relZ - binZ, one), zero);
+    const float_v fracR = Vc::max(Vc::min(relR - binR, one), zero);
+    const float_v fracPhi = Vc::max(Vc::min(relPhi - binPhi, one), zero);
+
+    // trilinear interpolation of the distortions
+    float_v distZ;
+    float_v distR;
+    float_v distRPhi;
+    for (size_t lane = 0; lane < nLanes; ++lane) {
+      const auto& lut = mDistortionLUT[getSide(z[lane])];
+      const int iz = static_cast<int>(binZ[lane]);
+      const int ir = static_cast<int>(binR[lane]);
+      const int iphi0 = static_cast<int>(binPhi[lane]) % lut.mNPhi;
+      const int iphi1 = (iphi0 + 1) % lut.mNPhi;
+      const float fz = fracZ[lane];
+      const float fr = fracR[lane];
+      const float fphi = fracPhi[lane];
+      float dist[3]{};
+      for (int iPhi = 0; iPhi < 2; ++iPhi) {
+        const float wPhi = iPhi ? fphi : 1 - fphi;
+        for (int iR = 0; iR < 2; ++iR) {
+          const float wR = wPhi * (iR ? fr : 1 - fr);
+          const float* vertex = &lut.mValues[lut.getIndex(iz, ir + iR, iPhi ? iphi1 : iphi0)];
+          const float wZ0 = wR * (1 - fz);
+          const float wZ1 = wR * fz;
+          for (int iDist = 0; iDist < 3; ++iDist) {
+            dist[iDist] += wZ0 * vertex[iDist] + wZ1 * vertex[iDist + 3];
+          }
+        }
+      }
+      distZ[lane] = dist[0];
+      distR[lane] = dist[1];
+      distRPhi[lane] = dist[2];
+    }
+
+    // calculate distorted position
+    const float_v radiusDist = radius + distR;
+    const float_v phiDist = phi + distRPhi / radius;
+    float_v sinPhi;
+    float_v cosPhi;
+    Vc::sincos(phiDist, &sinPhi, &cosPhi);
+    const float_v xDist = radiusDist * cosPhi;
+    const float_v yDist = radiusDist * sinPhi;
+    const float_v zDist = z + distZ;
+    for (size_t lane = 0; lane < nLanesUsed; ++lane) {
+      posX[i + lane] = xDist[lane];
+      posY[i + lane] = yDist[lane];
+      posZ[i + lane] = zDist[lane];
+    }
+  }
+}
+
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+void SpaceCharge<DataT, Nz, Nr, Nphi>::initDistortionLUT(const int refineZ, const int refineR, const int refinePhi)
+{
+  using timer = std::chrono::high_resolution_clock;
+  auto start = timer::now();
+  for (int iside = 0; iside < FNSIDES; ++iside) {
+    const Side side = (iside == 0) ? Side::A : Side::C;
+    if (!mIsGlobalDistSet[side]) {
+      LOGP(warning, "global distortions for side {} are not set, the distortion LUT will contain zeros", getSideName(side));
+    }
+    auto& lut = mDistortionLUT[side];
+    lut.mNZ = (Nz - 1) * refineZ + 1;
+    lut.mNR = (Nr - 1) * refineR + 1;
+    lut.mNPhi = Nphi * refinePhi;
+    lut.mInvSpacingZ = refineZ / std::abs(getGridSpacingZ(side));
+    lut.mInvSpacingR = refineR / getGridSpacingR(side);
+    lut.mInvSpacingPhi = refinePhi / getGridSpacingPhi(side);
+    lut.mValues.resize(3 * static_cast<size_t>(lut.mNZ) * lut.mNR * lut.mNPhi);
+
+    const DataT spacingZ = getGridSpacingZ(side) / refineZ;
+    const DataT spacingR = getGridSpacingR(side) / refineR;
+    const DataT spacingPhi = getGridSpacingPhi(side) / refinePhi;
+#pragma omp parallel for num_threads(sNThreads)
+    for (int iphi = 0; iphi < lut.mNPhi; ++iphi) {
+      const DataT phi = getPhiMin(side) + iphi * spacingPhi;
+      for (int ir = 0; ir < lut.mNR; ++ir) {
+        const DataT radius = getRMin(side) + ir * spacingR;
+        for (int iz = 0; iz < lut.mNZ; ++iz) {
+          const DataT z = getZMin(side) + iz * spacingZ;
+          DataT distZ{};
+          DataT distR{};
+          DataT distRPhi{};
+          getDistortionsCyl(z, radius, phi, side, distZ, distR, distRPhi);
+          float* vertex = &lut.mValues[lut.getIndex(iz, ir, iphi)];
+          vertex[0] = distZ;
+          vertex[1] = distR;
+          vertex[2] = distRPhi;
+        }
+      }
+    }
+  }
+  auto stop = timer::now();
+  std::chrono::duration<float> time = stop - start;
+  LOGP(info, "creation of the distortion LUT with {} MB took {}s", 2 * sizeof(float) * mDistortionLUT[Side::A].mValues.size() / (1024 * 1024), time.count());
+}
+
 template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
 DataT SpaceCharge<DataT, Nz, Nr, Nphi>::getChargeCyl(const DataT z, const DataT r, const DataT phi, const Side side) const
 {
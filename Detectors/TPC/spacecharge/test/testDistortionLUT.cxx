@@ -0,0 +1,196 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file  testDistortionLUT.cxx
+/// \brief this task tests the distortion of electrons with the distortion LUT against the tricubic interpolation
+
+#define BOOST_TEST_MODULE Test TPC SpaceCharge distortion LUT
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCSpaceCharge/SpaceCharge.h"
+#include <TRandom.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+namespace tpc
+{
+
+using DataT = double;
+static constexpr size_t NZ = 33;
+static constexpr size_t NR = 33;
+static constexpr size_t NPHI = 180;
+using SC = SpaceCharge<DataT, NZ, NR, NPHI>;
+
+static constexpr int NELECTRONS = 10001;     // not a multiple of the number of SIMD lanes
+static constexpr float TOLERANCE = 0.005f;   // cm, maximum difference between the LUT and the tricubic interpolation
+static constexpr float MINDISTORTION = 0.5f; // cm, the maximum distortion of the electrons must be larger
+
+/// smooth distortion map with variations in z, r and phi of up to ~1 cm
+void setDistortions(SC& sc, const Side side)
+{
+  using DataContainer = SC::DataContainer;
+  DataContainer distdZ{};
+  DataContainer distdR{};
+  DataContainer distdRPhi{};
+  const DataT rMin = sc.getRMin(side);
+  const DataT sign = (side == Side::A) ? 1 : -1;
+  for (size_t iPhi = 0; iPhi < NPHI; ++iPhi) {
+    const DataT phi = sc.getPhiVertex(iPhi, side);
+    for (size_t iR = 0; iR < NR; ++iR) {
+      const DataT radius = sc.getRVertex(iR, side);
+      for (size_t iZ = 0; iZ < NZ; ++iZ) {
+        const DataT drift = std::abs(sc.getZVertex(iZ, side)) / 250;
+        distdZ(iZ, iR, iPhi) = sign * 0.3 * drift * std::cos(phi);
+        distdR(iZ, iR, iPhi) = drift * (0.5 + 0.5 * std::sin(2 * phi)) * std::exp(-(radius - rMin) / 50);
+        distdRPhi(iZ, iR, iPhi) = 0.5 * drift * std::sin(3 * phi) * rMin / radius;
+      }
+    }
+  }
+  sc.setDistortionLookupTables(distdZ, distdR, distdRPhi, side);
+}
+
+/// random electron positions inside the grid of both sides
+void createElectrons(const SC& sc, std::vector<float>& posX, std::vector<float>& posY, std::vector<float>& posZ)
+{
+  gRandom->SetSeed(1234);
+  const DataT rMin = sc.getRMin(Side::A) + 0.5;
+  const DataT rMax = sc.getRMax(Side::A) - 0.5;
+  const DataT zMax = std::abs(sc.getZMax(Side::A)) - 0.5;
+  for (int i = 0; i < NELECTRONS; ++i) {
+    const DataT radius = gRandom->Uniform(rMin, rMax);
+    const DataT phi = gRandom->Uniform(-M_PI, M_PI);
+    const DataT z = gRandom->Uniform(0.5, zMax) * ((i % 2) ? 1 : -1);
+    posX.push_back(radius * std::cos(phi));
+    posY.push_back(radius * std::sin(phi));
+    posZ.push_back(z);
+  }
+}
+
+/// distortElectrons without LUT must give the same positions as distortElectron
+BOOST_AUTO_TEST_CASE(DistortElectrons_noLUT_test)
+{
+  SC sc;
+  setDistortions(sc, Side::A);
+  setDistortions(sc, Side::C);
+  BOOST_REQUIRE(!sc.hasDistortionLUT());
+  std::vector<float> posX, posY, posZ;
+  createElectrons(sc, posX, posY, posZ);
+  const auto origX = posX, origY = posY, origZ = posZ;
+  sc.distortElectrons(posX.data(), posY.data(), posZ.data(), posX.size());
+  for (size_t i = 0; i < posX.size(); ++i) {
+    GlobalPosition3D pos(origX[i], origY[i], origZ[i]);
+    sc.distortElectron(pos);
+    BOOST_CHECK_SMALL(posX[i] - pos.X(), 1e-3f);
+    BOOST_CHECK_SMALL(posY[i] - pos.Y(), 1e-3f);
+    BOOST_CHECK_SMALL(posZ[i] - pos.Z(), 1e-3f);
+  }
+}
+
+/// distortElectrons with the LUT must agree with the tricubic interpolation within the tolerance, for different refinements of the LUT
+BOOST_AUTO_TEST_CASE(DistortElectrons_LUT_test)
+{
+  const std::vector<std::array<int, 3>> refinements{{1, 1, 1}, {2, 2, 1}, {4, 4, 2}};
+  for (const auto& refine : refinements) {
+    BOOST_TEST_CONTEXT("refinement z " << refine[0] << " r " << refine[1] << " phi " << refine[2])
+    {
+      SC sc;
+      setDistortions(sc, Side::A);
+      setDistortions(sc, Side::C);
+      std::vector<float> refX, refY, refZ;
+      createElectrons(sc, refX, refY, refZ);
+      const auto origX = refX, origY = refY, origZ = refZ;
+      sc.distortElectrons(refX.data(), refY.data(), refZ.data(), refX.size());
+
+      sc.initDistortionLUT(refine[0], refine[1], refine[2]);
+      BOOST_REQUIRE(sc.hasDistortionLUT());
+      auto lutX = origX, lutY = origY, lutZ = origZ;
+      sc.distortElectrons(lutX.data(), lutY.data(), lutZ.data(), lutX.size());
+
+      float maxDist = 0;
+      float maxDiff = 0;
+      for (size_t i = 0; i < origX.size(); ++i) {
+        maxDist = std::max({maxDist, std::abs(refX[i] - origX[i]), std::abs(refY[i] - origY[i]), std::abs(refZ[i] - origZ[i])});
+        maxDiff = std::max({maxDiff, std::abs(lutX[i] - refX[i]), std::abs(lutY[i] - refY[i]), std::abs(lutZ[i] - refZ[i])});
+        BOOST_CHECK_SMALL(lutX[i] - refX[i], TOLERANCE);
+        BOOST_CHECK_SMALL(lutY[i] - refY[i], TOLERANCE);
+        BOOST_CHECK_SMALL(lutZ[i] - refZ[i], TOLERANCE);
+      }
+      BOOST_TEST_MESSAGE("maximum distortion " << maxDist << " cm, maximum difference to the tricubic interpolation " << maxDiff << " cm");
+      BOOST_CHECK(maxDist > MINDISTORTION);
+    }
+  }
+}
+
+/// concurrent calls of distortElectrons must give the same positions as a single thread: the LUT is only read and is used from
+/// std::threads, the tricubic interpolation caches its coefficients per OpenMP thread and is used from OpenMP threads
+BOOST_AUTO_TEST_CASE(DistortElectrons_concurrent_test)
+{
+  constexpr int NTHREADS = 4;
+  constexpr int CHUNKSIZE = 16; // small chunks, such that the threads often switch between cells of the interpolation
+  constexpr int NCHUNKS = (NELECTRONS + CHUNKSIZE - 1) / CHUNKSIZE;
+  SC::setNThreads(NTHREADS); // the interpolators are set up for the number of threads when they are created
+  SC sc;
+  setDistortions(sc, Side::A);
+  setDistortions(sc, Side::C);
+  std::vector<float> origX, origY, origZ;
+  createElectrons(sc, origX, origY, origZ);
+
+  for (const bool useLUT : {false, true}) {
+    BOOST_TEST_CONTEXT("LUT " << useLUT)
+    {
+      if (useLUT) {
+        sc.initDistortionLUT();
+      }
+      auto refX = origX, refY = origY, refZ = origZ;
+      sc.distortElectrons(refX.data(), refY.data(), refZ.data(), refX.size());
+
+      auto posX = origX, posY = origY, posZ = origZ;
+      auto distortChunk = [&](const int chunk) {
+        const size_t first = chunk * CHUNKSIZE;
+        const size_t n = std::min(static_cast<size_t>(CHUNKSIZE), posX.size() - first);
+        sc.distortElectrons(posX.data() + first, posY.data() + first, posZ.data() + first, n);
+      };
+      if (useLUT) {
+        std::vector<std::thread> threads;
+        for (int ithread = 0; ithread < NTHREADS; ++ithread) {
+          threads.emplace_back([&distortChunk, ithread]() {
+            for (int chunk = ithread; chunk < NCHUNKS; chunk += NTHREADS) {
+              distortChunk(chunk);
+            }
+          });
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+      } else {
+#pragma omp parallel for num_threads(NTHREADS) schedule(dynamic)
+        for (int chunk = 0; chunk < NCHUNKS; ++chunk) {
+          distortChunk(chunk);
+        }
+      }
+
+      int nDifferent = 0;
+      for (size_t i = 0; i < posX.size(); ++i) {
+        nDifferent += (posX[i] != refX[i]) || (posY[i] != refY[i]) || (posZ[i] != refZ[i]);
+      }
+      BOOST_CHECK_EQUAL(nDifferent, 0);
+    }
+  }
+}
+
+} // namespace tpc
+} // namespace o2
@@ -194,6 +194,37 @@ void poissonSolver3D()
   testAlmostEqualArray<DataT, Nz, Nr, Nphi>(potentialAnalytical, potentialNumerical);
 }
 
+template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
+void poissonSolver3DThreads()
+{
+  using GridProp = GridProperties<DataT, Nr, Nz, Nphi>;
+  const o2::tpc::RegularGrid3D<DataT, Nz, Nr, Nphi> grid3D{GridProp::ZMIN, GridProp::RMIN, GridProp::PHIMIN, GridProp::GRIDSPACINGZ, GridProp::GRIDSPACINGR, GridProp::GRIDSPACINGPHI};
+
+  using DataContainer = o2::tpc::DataContainer3D<DataT, Nz, Nr, Nphi>;
+  DataContainer charge{};
+  DataContainer potentialBoundary{};
+  const o2::tpc::AnalyticalFields<DataT> analyticalFields;
+  setChargeDensityFromFormula<DataT, Nz, Nr, Nphi>(analyticalFields, grid3D, charge);
+  setPotentialBoundaryFromFormula<DataT, Nz, Nr, Nphi>(analyticalFields, grid3D, potentialBoundary);
+
+  // the red-black relaxation is performed in parallel, the result has to be independent of the number of threads
+  using PoissonSolverT = PoissonSolver<DataT, Nz, Nr, Nphi>;
+  const int nThreadsDefault = PoissonSolverT::getNThreads();
+  const int symmetry = 0;
+  DataContainer potentialSerial = potentialBoundary;
+  PoissonSolverT::setNThreads(1);
+  PoissonSolverT(grid3D).poissonSolver3D(potentialSerial, charge, symmetry);
+
+  DataContainer potentialParallel = potentialBoundary;
+  PoissonSolverT::setNThreads(4);
+  PoissonSolverT(grid3D).poissonSolver3D(potentialParallel, charge, symmetry);
+  PoissonSolverT::setNThreads(nThreadsDefault);
+
+  for (size_t i = 0; i < DataContainer::getNDataPoints(); ++i) {
+    BOOST_REQUIRE_EQUAL(potentialSerial[i], potentialParallel[i]);
+  }
+}
+
 template <typename DataT, size_t Nz, size_t Nr, size_t Nphi>
 void poissonSolver2D()
 {
@@ -233,6 +264,12 @@ BOOST_AUTO_TEST_CASE(PoissonSolver3D2D_test)
   poissonSolver3D<DataT, NZ, NR, NPHI>();
 }
 
+BOOST_AUTO_TEST_CASE(PoissonSolver3D_threads_test)
+{
+  o2::tpc::MGParameters::isFull3D = true; //3D
+  poissonSolver3DThreads<DataT, NZ, NR, NPHI>();
+}
+
 BOOST_AUTO_TEST_CASE(PoissonSolver2D_test)
 {
   const int Nphi = 1;
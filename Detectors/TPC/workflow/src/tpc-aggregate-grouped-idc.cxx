@@ -45,7 +45,8 @@ void customize(std::vector<ConfigParamSpec>& workflowOptions)
     {"nthreads-IDC-factorization", VariantType::Int, 1, {"Number of threads which will be used during the factorization of the IDCs."}},
     {"nthreads-IDC-fourier-transform", VariantType::Int, 1, {"Number of threads which will be used during the calculation of the fourier coefficients."}},
     {"debug", VariantType::Bool, false, {"create debug files"}},
-    {"use-naive-fft", VariantType::Bool, false, {"using naive fourier transform (true) or FFTW (false)"}},
+    {"use-naive-fft", VariantType::Bool, false, {"using naive fourier transform (true) or FFT (false)"}},
+    {"fft-sliding-window", VariantType::Bool, false, {"update the fourier coefficients of consecutive intervals instead of recalculating them (FFT only)"}},
     {"crus", VariantType::String, cruDefault.c_str(), {"List of CRUs, comma separated ranges, e.g. 0-3,7,9-15"}},
     {"compression", VariantType::Int, 1, {"compression of DeltaIDC: 0 -> No, 1 -> Medium (data compression ratio 2), 2 -> High (data compression ratio ~6)"}},
     {"configKeyValues", VariantType::String, "", {"Semicolon separated key=value strings (e.g. for pp 50kHz: 'TPCIDCCompressionParam.MaxIDCDeltaValue=15;')"}}};
@@ -77,6 +78,7 @@ WorkflowSpec defineDataProcessing(ConfigContext const& config)
   IDCFactorization::setNThreads(nthreadsFactorization);
   IDCFourierTransform::setNThreads(nthreadsFourier);
   IDCFourierTransform::setFFT(!fft);
+  IDCFourierTransform::setSlidingWindow(config.options().get<bool>("fft-sliding-window"));
 
   const int compressionTmp = config.options().get<int>("compression");
   IDCDeltaCompression compression;
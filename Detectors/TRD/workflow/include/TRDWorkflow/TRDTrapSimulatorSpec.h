@@ -43,6 +43,17 @@ class TRDDPLTrapSimulatorTask : public o2::framework::Task
 
 
  private:
+  /// digits of one half chamber in one collision and the TRAP simulation output for them
+  struct HalfChamberSegment {
+    int iTrig{0};                        // index of the trigger record
+    int firstDigit{0};                   // first entry in the sorted digit index array
+    int lastDigit{0};                    // one past the last entry in the sorted digit index array
+    int nTracklets{0};                   // number of tracklets found
+    std::vector<Tracklet64> tracklets;   // tracklets found
+    std::vector<short> digitCounts;      // number of digits contributing to each tracklet (MC only)
+    std::vector<int> digitIndices;       // indices of the digits contributing to the tracklets (MC only)
+  };
+
   TrapConfig* mTrapConfig = nullptr;
   unsigned long mRunNumber = 297595; //run number to anchor simulation to.
   bool mEnableOnlineGainCorrection{false};
@@ -235,83 +235,88 @@ void TRDDPLTrapSimulatorTask::run(o2::framework::ProcessingContext& pc)
   }
   auto sortTime = std::chrono::high_resolution_clock::now() - sortStart;
 
-  // prepare data structures for accumulating results per collision
-  std::vector<int> nTracklets(triggerRecords.size());
-  std::vector<std::vector<Tracklet64>> trackletsAccum;
-  trackletsAccum.resize(triggerRecords.size());
-  std::vector<std::vector<short>> digitCountsAccum; // holds the number of digits included in each tracklet (therefore has the same number of elements as trackletsAccum)
-  // digitIndicesAccum holds the global indices of the digits which comprise the tracklets
-  // with the help of digitCountsAccum one can loop through this vector and find the corresponding digit indices for each tracklet
-  std::vector<std::vector<int>> digitIndicesAccum;
-  digitCountsAccum.resize(triggerRecords.size());
-  digitIndicesAccum.resize(triggerRecords.size());
+  // split the digits of each collision into half chamber segments, which are processed independently
+  std::vector<HalfChamberSegment> segments;
+  for (int iTrig = 0; iTrig < triggerRecords.size(); ++iTrig) {
+    int firstDigit = triggerRecords[iTrig].getFirstDigit();
+    int lastDigit = firstDigit + triggerRecords[iTrig].getNumberOfDigits();
+    for (int iDigit = firstDigit; iDigit < lastDigit; ++iDigit) {
+      if (iDigit == firstDigit || digits[digitIdxArray[iDigit]].getHCId() != digits[digitIdxArray[iDigit - 1]].getHCId()) {
+        auto& segment = segments.emplace_back();
+        segment.iTrig = iTrig;
+        segment.firstDigit = iDigit;
+      }
+      segments.back().lastDigit = iDigit + 1;
+    }
+  }
 
   auto timeParallelStart = std::chrono::high_resolution_clock::now();
 
 #ifdef WITH_OPENMP
-#pragma omp parallel for schedule(dynamic) num_threads(mNumThreads)
+#pragma omp parallel num_threads(mNumThreads)
 #endif
-  for (int iTrig = 0; iTrig < triggerRecords.size(); ++iTrig) {
-    int currHCId = -1;
-    std::array<TrapSimulator, NMCMHCMAX> trapSimulators{}; //the up to 64 trap simulators for a single half chamber
-    for (int iDigit = triggerRecords[iTrig].getFirstDigit(); iDigit < (triggerRecords[iTrig].getFirstDigit() + triggerRecords[iTrig].getNumberOfDigits()); ++iDigit) {
-      const auto& digit = &digits[digitIdxArray[iDigit]];
-      if (currHCId < 0) {
-        currHCId = digit->getHCId();
-      }
-      if (currHCId != digit->getHCId()) {
-        // we switch to a new half chamber, process all TRAPs of the previous half chamber which contain data
-        processTRAPchips(nTracklets[iTrig], trackletsAccum[iTrig], trapSimulators, digitCountsAccum[iTrig], digitIndicesAccum[iTrig]);
-        currHCId = digit->getHCId();
-      }
-      // fill the digit data into the corresponding TRAP chip
-      int trapIdx = (digit->getROB() / 2) * NMCMROB + digit->getMCM();
-      if (!trapSimulators[trapIdx].isDataSet()) {
-        trapSimulators[trapIdx].init(mTrapConfig, digit->getDetector(), digit->getROB(), digit->getMCM());
+  {
+    std::array<TrapSimulator, NMCMHCMAX> trapSimulators{}; //the up to 64 trap simulators for a single half chamber, one set per thread
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int iSegment = 0; iSegment < segments.size(); ++iSegment) {
+      auto& segment = segments[iSegment];
+      for (int iDigit = segment.firstDigit; iDigit < segment.lastDigit; ++iDigit) {
+        const auto& digit = &digits[digitIdxArray[iDigit]];
+        // fill the digit data into the corresponding TRAP chip
+        int trapIdx = (digit->getROB() / 2) * NMCMROB + digit->getMCM();
+        if (!trapSimulators[trapIdx].isDataSet()) {
+          trapSimulators[trapIdx].init(mTrapConfig, digit->getDetector(), digit->getROB(), digit->getMCM());
+        }
+        trapSimulators[trapIdx].setData(digit->getChannel(), digit->getADC(), digitIdxArray[iDigit]);
       }
-      trapSimulators[trapIdx].setData(digit->getChannel(), digit->getADC(), digitIdxArray[iDigit]);
+      // process all TRAPs of this half chamber which contain data, the results go into the output segment
+      processTRAPchips(segment.nTracklets, segment.tracklets, trapSimulators, segment.digitCounts, segment.digitIndices);
     }
-    // take care of the TRAPs for the last half chamber
-    processTRAPchips(nTracklets[iTrig], trackletsAccum[iTrig], trapSimulators, digitCountsAccum[iTrig], digitIndicesAccum[iTrig]);
   } // done with parallel processing
   auto parallelTime = std::chrono::high_resolution_clock::now() - timeParallelStart;
 
-  // accumulate results and add MC labels
+  // concatenate the output segments in their original order and add MC labels
+  auto segment = segments.begin();
   for (int iTrig = 0; iTrig < triggerRecords.size(); ++iTrig) {
-    if (mUseMC) {
-      int currDigitIndex = 0; // counter for all digits which are associated to tracklets
-      int trkltIdxStart = tracklets.size();
-      for (int iTrklt = 0; iTrklt < nTracklets[iTrig]; ++iTrklt) {
-        int tmp = currDigitIndex;
-        for (int iDigitIndex = tmp; iDigitIndex < tmp + digitCountsAccum[iTrig][iTrklt]; ++iDigitIndex) {
-          if (iDigitIndex == tmp) {
-            // for the first digit composing the tracklet we don't need to check for duplicate labels
-            lblTracklets.addElements(trkltIdxStart + iTrklt, lblDigitsPtr->getLabels(digitIndicesAccum[iTrig][iDigitIndex]));
-          } else {
-            // in case more than one digit composes the tracklet we add only the labels
-            // from the additional digit(s) which are not already contained in the previous
-            // digit(s)
-            auto currentLabels = lblTracklets.getLabels(trkltIdxStart + iTrklt);
-            auto newLabels = lblDigitsPtr->getLabels(digitIndicesAccum[iTrig][iDigitIndex]);
-            for (const auto& newLabel : newLabels) {
-              bool alreadyIn = false;
-              for (const auto& currLabel : currentLabels) {
-                if (currLabel.compare(newLabel)) {
-                  alreadyIn = true;
-                  break;
+    int trkltIdxTrig = tracklets.size();
+    for (; segment != segments.end() && segment->iTrig == iTrig; ++segment) {
+      if (mUseMC) {
+        int currDigitIndex = 0; // counter for all digits which are associated to tracklets
+        int trkltIdxStart = tracklets.size();
+        for (int iTrklt = 0; iTrklt < segment->nTracklets; ++iTrklt) {
+          int tmp = currDigitIndex;
+          for (int iDigitIndex = tmp; iDigitIndex < tmp + segment->digitCounts[iTrklt]; ++iDigitIndex) {
+            if (iDigitIndex == tmp) {
+              // for the first digit composing the tracklet we don't need to check for duplicate labels
+              lblTracklets.addElements(trkltIdxStart + iTrklt, lblDigitsPtr->getLabels(segment->digitIndices[iDigitIndex]));
+            } else {
+              // in case more than one digit composes the tracklet we add only the labels
+              // from the additional digit(s) which are not already contained in the previous
+              // digit(s)
+              auto currentLabels = lblTracklets.getLabels(trkltIdxStart + iTrklt);
+              auto newLabels = lblDigitsPtr->getLabels(segment->digitIndices[iDigitIndex]);
+              for (const auto& newLabel : newLabels) {
+                bool alreadyIn = false;
+                for (const auto& currLabel : currentLabels) {
+                  if (currLabel.compare(newLabel)) {
+                    alreadyIn = true;
+                    break;
+                  }
+                }
+                if (!alreadyIn) {
+                  lblTracklets.addElement(trkltIdxStart + iTrklt, newLabel);
                 }
-              }
-              if (!alreadyIn) {
-                lblTracklets.addElement(trkltIdxStart + iTrklt, newLabel);
               }
             }
+            ++currDigitIndex;
           }
-          ++currDigitIndex;
         }
       }
+      tracklets.insert(tracklets.end(), segment->tracklets.begin(), segment->tracklets.end());
     }
-    tracklets.insert(tracklets.end(), trackletsAccum[iTrig].begin(), trackletsAccum[iTrig].end());
-    triggerRecords[iTrig].setTrackletRange(tracklets.size() - nTracklets[iTrig], nTracklets[iTrig]);
+    triggerRecords[iTrig].setTrackletRange(trkltIdxTrig, tracklets.size() - trkltIdxTrig);
   }
 
   auto processingTime = std::chrono::high_resolution_clock::now() - timeProcessingStart;
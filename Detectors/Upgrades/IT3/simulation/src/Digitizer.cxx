@@ -147,30 +147,23 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
       } else {
         chip.addNoise(mROFrameMin, mROFrameMin, &mParams);
       }
-      auto& buffer = chip.getPreDigits();
-      if (buffer.empty()) {
+      if (chip.isEmpty()) {
         continue;
       }
-      auto itBeg = buffer.begin();
-      auto iter = itBeg;
-      ULong64_t maxKey = chip.getOrderingKey(mROFrameMin + 1, 0, 0) - 1; // fetch digits with key below that
-      for (; iter != buffer.end(); ++iter) {
-        if (iter->first > maxKey) {
-          break; // is the digit ROFrame from the key > the max requested frame
-        }
-        auto& preDig = iter->second; // preDigit
+      // fetch digits of the frames up to the current one, in column/row order
+      for (auto& preDig : chip.getSortedPreDigits(mROFrameMin)) {
         if (preDig.charge >= mParams.getChargeThreshold()) {
           int digID = mDigits->size();
           mDigits->emplace_back(chip.getChipIndex(), preDig.row, preDig.col, preDig.charge);
           mMCLabels->addElement(digID, preDig.labelRef.label);
-          auto& nextRef = preDig.labelRef; // extra contributors are in extra array
+          auto nextRef = preDig.labelRef; // extra contributors are in extra array
           while (nextRef.next >= 0) {
             nextRef = extra[nextRef.next];
             mMCLabels->addElement(digID, nextRef.label);
           }
         }
       }
-      buffer.erase(itBeg, iter);
+      chip.releaseROFrames(mROFrameMin);
     }
     // finalize ROF record
     rcROF.setNEntries(mDigits->size() - rcROF.getFirstEntry()); // number of digits
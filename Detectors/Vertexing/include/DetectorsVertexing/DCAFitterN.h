@@ -68,6 +68,9 @@ struct TrackDeriv {
   }
 };
 
+template <int N, typename... Args>
+class DCAFitterNBatch;
+
 template <int N, typename... Args>
 class DCAFitterN
 {
@@ -205,6 +208,12 @@ class DCAFitterN
   bool correctTracks(const VecND& corrX);
   bool minimizeChi2();
   bool minimizeChi2NoErr();
+  bool initMinimization();
+  bool initMinimizationNoErr();
+  bool initCrossings();
+  bool initSeed(int ic);
+  bool acceptSeed();
+  void orderCandidates();
   bool roughDZCut() const;
   bool closerToAlternative() const;
   static double getAbsMax(const VecND& v);
@@ -300,6 +309,8 @@ class DCAFitterN
   float mMaxChi2 = 100;             // abs cut on chi2 or abs distance
   float mMaxDist2ToMergeSeeds = 1.; // merge 2 seeds to their average if their distance^2 is below the threshold
 
+  friend class DCAFitterNBatch<N, Args...>;
+
   ClassDefNV(DCAFitterN, 1);
 };
 
@@ -311,12 +322,30 @@ int DCAFitterN<N, Args...>::process(const Tr&... args)
   // This is a main entry point: fit PCA of N tracks
   static_assert(sizeof...(args) == N, "incorrect number of input tracks");
   assign(0, args...);
+  if (!initCrossings()) {
+    return 0; // no crossing
+  }
+  // check all crossings
+  for (int ic = 0; ic < mCrossings.nDCA; ic++) {
+    if (initSeed(ic) && (mUseAbsDCA ? minimizeChi2NoErr() : minimizeChi2())) {
+      acceptSeed();
+    }
+  }
+  orderCandidates();
+  return mCurHyp;
+}
+
+//__________________________________________________________________________
+template <int N, typename... Args>
+bool DCAFitterN<N, Args...>::initCrossings()
+{
+  // prepare the seeds for the PCA search of the assigned tracks, return false if there is none
   clear();
   for (int i = 0; i < N; i++) {
     mTrAux[i].set(*mOrigTrPtr[i], mBz);
   }
   if (!mCrossings.set(mTrAux[0], *mOrigTrPtr[0], mTrAux[1], *mOrigTrPtr[1], mMaxDXYIni)) { // even for N>2 it should be enough to test just 1 loop
-    return 0;                                                                  // no crossing
+    return false;                                                              // no crossing
   }
   if (mUseAbsDCA) {
     calcRMatrices(); // needed for fast residuals derivatives calculation in case of abs. distance minimization
@@ -330,29 +359,44 @@ int DCAFitterN<N, Args...>::process(const Tr&... args)
       mCrossings.yDCA[0] = 0.5 * (mCrossings.yDCA[0] + mCrossings.yDCA[1]);
     }
   }
-  // check all crossings
-  for (int ic = 0; ic < mCrossings.nDCA; ic++) {
-    // check if radius is acceptable
-    if (mCrossings.xDCA[ic] * mCrossings.xDCA[ic] + mCrossings.yDCA[ic] * mCrossings.yDCA[ic] > mMaxR2) {
-      continue;
-    }
-    mCrossIDCur = ic;
-    mCrossIDAlt = (mCrossings.nDCA == 2 && mAllowAltPreference) ? 1 - ic : -1; // works for max 2 crossings
-    mNIters[mCurHyp] = 0;
-    mTrPropDone[mCurHyp] = false;
-    mChi2[mCurHyp] = -1.;
-    mPCA[mCurHyp][0] = mCrossings.xDCA[ic];
-    mPCA[mCurHyp][1] = mCrossings.yDCA[ic];
-
-    if (mUseAbsDCA ? minimizeChi2NoErr() : minimizeChi2()) {
-      mOrder[mCurHyp] = mCurHyp;
-      if (mPropagateToPCA && !propagateTracksToVertex(mCurHyp)) {
-        continue; // discard candidate if failed to propagate to it
-      }
-      mCurHyp++;
-    }
+  return true;
+}
+
+//__________________________________________________________________________
+template <int N, typename... Args>
+bool DCAFitterN<N, Args...>::initSeed(int ic)
+{
+  // set the crossing ic as the starting point of the current hypothesis, return false if it is not acceptable
+  if (mCrossings.xDCA[ic] * mCrossings.xDCA[ic] + mCrossings.yDCA[ic] * mCrossings.yDCA[ic] > mMaxR2) {
+    return false;
   }
+  mCrossIDCur = ic;
+  mCrossIDAlt = (mCrossings.nDCA == 2 && mAllowAltPreference) ? 1 - ic : -1; // works for max 2 crossings
+  mNIters[mCurHyp] = 0;
+  mTrPropDone[mCurHyp] = false;
+  mChi2[mCurHyp] = -1.;
+  mPCA[mCurHyp][0] = mCrossings.xDCA[ic];
+  mPCA[mCurHyp][1] = mCrossings.yDCA[ic];
+  return true;
+}
 
+//__________________________________________________________________________
+template <int N, typename... Args>
+bool DCAFitterN<N, Args...>::acceptSeed()
+{
+  // register the converged current hypothesis as a candidate
+  mOrder[mCurHyp] = mCurHyp;
+  if (mPropagateToPCA && !propagateTracksToVertex(mCurHyp)) {
+    return false; // discard candidate if failed to propagate to it
+  }
+  mCurHyp++;
+  return true;
+}
+
+//__________________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterN<N, Args...>::orderCandidates()
+{
   for (int i = mCurHyp; i--;) { // order in quality
     for (int j = i; j--;) {
       if (mChi2[mOrder[i]] < mChi2[mOrder[j]]) {
@@ -360,7 +404,6 @@ int DCAFitterN<N, Args...>::process(const Tr&... args)
       }
     }
   }
-  return mCurHyp;
 }
 
 //__________________________________________________________________________
@@ -761,9 +804,9 @@ inline double DCAFitterN<N, Args...>::getAbsMax(const VecND& v)
 
 //___________________________________________________________________
 template <int N, typename... Args>
-bool DCAFitterN<N, Args...>::minimizeChi2()
+bool DCAFitterN<N, Args...>::initMinimization()
 {
-  // find best chi2 (weighted DCA) of N tracks in the vicinity of the seed PCA
+  // bring the tracks to the seed PCA and prepare the starting point of the weighted DCA minimization
   for (int i = N; i--;) {
     mCandTr[mCurHyp][i] = *mOrigTrPtr[i];
     auto x = mTrAux[i].c * mPCA[mCurHyp][0] + mTrAux[i].s * mPCA[mCurHyp][1]; // X of PCA in the track frame
@@ -783,6 +826,39 @@ bool DCAFitterN<N, Args...>::minimizeChi2()
   }
   calcPCA();            // current PCA
   calcTrackResiduals(); // current track residuals
+  return true;
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+bool DCAFitterN<N, Args...>::initMinimizationNoErr()
+{
+  // bring the tracks to the seed PCA and prepare the starting point of the absolute DCA minimization
+  for (int i = N; i--;) {
+    mCandTr[mCurHyp][i] = *mOrigTrPtr[i];
+    auto x = mTrAux[i].c * mPCA[mCurHyp][0] + mTrAux[i].s * mPCA[mCurHyp][1]; // X of PCA in the track frame
+    if (!mCandTr[mCurHyp][i].propagateParamTo(x, mBz)) {
+      return false;
+    }
+    setTrackPos(mTrPos[mCurHyp][i], mCandTr[mCurHyp][i]); // prepare positions
+  }
+  if (mMaxDZIni > 0 && !roughDZCut()) { // apply rough cut on tracks Z difference
+    return false;
+  }
+
+  calcPCANoErr();       // current PCA
+  calcTrackResiduals(); // current track residuals
+  return true;
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+bool DCAFitterN<N, Args...>::minimizeChi2()
+{
+  // find best chi2 (weighted DCA) of N tracks in the vicinity of the seed PCA
+  if (!initMinimization()) {
+    return false;
+  }
   float chi2Upd, chi2 = calcChi2();
   do {
     calcTrackDerivatives(); // current track derivatives (1st and 2nd)
@@ -821,21 +897,9 @@ template <int N, typename... Args>
 bool DCAFitterN<N, Args...>::minimizeChi2NoErr()
 {
   // find best chi2 (absolute DCA) of N tracks in the vicinity of the PCA seed
-
-  for (int i = N; i--;) {
-    mCandTr[mCurHyp][i] = *mOrigTrPtr[i];
-    auto x = mTrAux[i].c * mPCA[mCurHyp][0] + mTrAux[i].s * mPCA[mCurHyp][1]; // X of PCA in the track frame
-    if (!mCandTr[mCurHyp][i].propagateParamTo(x, mBz)) {
-      return false;
-    }
-    setTrackPos(mTrPos[mCurHyp][i], mCandTr[mCurHyp][i]); // prepare positions
-  }
-  if (mMaxDZIni > 0 && !roughDZCut()) { // apply rough cut on tracks Z difference
+  if (!initMinimizationNoErr()) {
     return false;
   }
-
-  calcPCANoErr();       // current PCA
-  calcTrackResiduals(); // current track residuals
   float chi2Upd, chi2 = calcChi2NoErr();
   do {
     calcTrackDerivatives();      // current track derivatives (1st and 2nd)
@@ -0,0 +1,476 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DCAFitterNBatch.h
+/// \brief N-prongs secondary vertex fit of many candidates at once
+/// \author ruben.shahoyan@cern.ch
+
+#ifndef _ALICEO2_DCA_FITTERN_BATCH_
+#define _ALICEO2_DCA_FITTERN_BATCH_
+
+#include "DetectorsVertexing/DCAFitterN.h"
+#include "gsl/span"
+#include <vector>
+
+namespace o2
+{
+namespace vertexing
+{
+
+///__________________________________________________________________________________
+///< Fits many N-prong candidates in one go.
+/// Every candidate gets a copy of the fitter passed as prototype, which prepares its seeds and
+/// propagates its tracks to the found PCA exactly as DCAFitterN::process does. The Newton iterations
+/// of all the seeds being minimized are instead done together, on arrays holding one entry (lane)
+/// per seed, so that the compiler can vectorize them over the candidates. Each lane is retired as
+/// soon as it converges or fails, with the same stopping conditions as the scalar fitter, so that
+/// the results agree with those of DCAFitterN::process up to the rounding of the summations.
+/// The results are accessed via the per-candidate fitters, e.g. getFitter(i).getPCACandidate().
+template <int N, typename... Args>
+class DCAFitterNBatch
+{
+ public:
+  using Fitter = DCAFitterN<N, Args...>;
+  using Track = o2::track::TrackParCov;
+  using Candidate = std::array<const Track*, N>;
+
+  DCAFitterNBatch() = default;
+  DCAFitterNBatch(const Fitter& proto) : mProto(proto) {}
+
+  ///< settings to be used for all the candidates
+  void setFitter(const Fitter& proto) { mProto = proto; }
+  Fitter& getFitter() { return mProto; }
+
+  ///< fit all the candidates, return the total number of found PCA candidates
+  int process(gsl::span<const Candidate> cands);
+
+  int getNCombinations() const { return mFitters.size(); }
+  int getNCandidates(int i) const { return mFitters[i].getNCandidates(); }
+  Fitter& getFitter(int i) { return mFitters[i]; }
+  const Fitter& getFitter(int i) const { return mFitters[i]; }
+
+ private:
+  static constexpr int NDR = N * N * 3;
+
+  void loadLanes();
+  void minimizeLanes();
+  void calcChi2DerivativesLanes();
+  void calcChi2DerivativesNoErrLanes();
+  void calcPCALanes();
+  void calcResidualsAndChi2Lanes();
+  void finishLane(int l, bool converged);
+
+  // index of component comp (out of the ones of a given quantity) of lane l
+  int id(int comp, int l) const { return comp * mNLanes + l; }
+
+  Fitter mProto;
+  std::vector<Fitter> mFitters;
+  std::vector<int> mLaneFitter; // fitter of each lane
+
+  // SoA storage of the quantities of the seeds being minimized
+  int mNLanes = 0;
+  int mNActive = 0;
+  std::vector<double> mC, mS;             // track frame cos and sin [N]
+  std::vector<double> mCovI;              // inverse cov.matrix elements sxx, syy, syz, szz [4N]
+  std::vector<double> mDer;               // track derivatives dydx, dzdx, d2ydx2, d2zdx2 [4N]
+  std::vector<double> mCoefT;             // PCA coefficient matrices [9N]
+  std::vector<double> mDR1, mDR2;         // 1st and 2nd derivatives of residual i over X of track j [N*N*3]
+  std::vector<double> mCIDR;              // temporary covI_j * dres_j/dx_i [N*N*3]
+  std::vector<double> mPos, mRes;         // track positions and residuals [3N]
+  std::vector<double> mPCA;               // current PCA [3]
+  std::vector<double> mD1, mD2;           // chi2 1st [N] and 2nd [N*N] derivatives
+  std::vector<double> mDX, mAbsMaxDX;     // Newton-Raphson corrections [N] and their max. abs value
+  std::vector<double> mSeedCur, mSeedAlt; // XY of the current and alternative seeds [2]
+  std::vector<float> mChi2, mChi2Upd;
+  std::vector<int> mNIters;
+  std::vector<char> mHasAlt, mActive;
+};
+
+//___________________________________________________________________
+template <int N, typename... Args>
+int DCAFitterNBatch<N, Args...>::process(gsl::span<const Candidate> cands)
+{
+  mFitters.assign(cands.size(), mProto);
+  std::vector<char> seeded(cands.size());
+  for (size_t i = 0; i < cands.size(); i++) {
+    auto& ft = mFitters[i];
+    for (int ip = 0; ip < N; ip++) {
+      ft.mOrigTrPtr[ip] = cands[i][ip];
+    }
+    seeded[i] = ft.initCrossings();
+  }
+  // the seeds of the same candidate are minimized in consecutive passes, since the
+  // outcome of the 1st one decides the preference for the 2nd one
+  for (int ic = 0; ic < Fitter::MAXHYP; ic++) {
+    mLaneFitter.clear();
+    for (size_t i = 0; i < cands.size(); i++) {
+      auto& ft = mFitters[i];
+      if (seeded[i] && ic < ft.mCrossings.nDCA && ft.initSeed(ic) &&
+          (mProto.mUseAbsDCA ? ft.initMinimizationNoErr() : ft.initMinimization())) {
+        mLaneFitter.push_back(i);
+      }
+    }
+    if (!mLaneFitter.empty()) {
+      loadLanes();
+      minimizeLanes();
+    }
+  }
+  int nCand = 0;
+  for (auto& ft : mFitters) {
+    ft.orderCandidates();
+    nCand += ft.getNCandidates();
+  }
+  return nCand;
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::loadLanes()
+{
+  // fill the lanes with the starting point of the seeds being minimized
+  const int nl = mNLanes = mNActive = mLaneFitter.size();
+  mC.resize(N * nl);
+  mS.resize(N * nl);
+  mCovI.resize(4 * N * nl);
+  mDer.resize(4 * N * nl);
+  mCoefT.resize(9 * N * nl);
+  mDR1.resize(NDR * nl);
+  mDR2.resize(NDR * nl);
+  mCIDR.resize(NDR * nl);
+  mPos.resize(3 * N * nl);
+  mRes.resize(3 * N * nl);
+  mPCA.resize(3 * nl);
+  mD1.resize(N * nl);
+  mD2.resize(N * N * nl);
+  mDX.resize(N * nl);
+  mAbsMaxDX.resize(nl);
+  mSeedCur.resize(2 * nl);
+  mSeedAlt.resize(2 * nl);
+  mChi2.resize(nl);
+  mChi2Upd.resize(nl);
+  mNIters.resize(nl);
+  mHasAlt.resize(nl);
+  mActive.resize(nl);
+
+  for (int l = 0; l < nl; l++) {
+    auto& ft = mFitters[mLaneFitter[l]];
+    const int h = ft.mCurHyp;
+    // track derivatives and hence the residuals derivatives do not change during the minimization
+    ft.calcTrackDerivatives();
+    if (mProto.mUseAbsDCA) {
+      ft.calcResidDerivativesNoErr();
+    } else {
+      ft.calcResidDerivatives();
+    }
+    for (int i = 0; i < N; i++) {
+      mC[id(i, l)] = ft.mTrAux[i].c;
+      mS[id(i, l)] = ft.mTrAux[i].s;
+      const auto& covI = ft.mTrcEInv[h][i];
+      mCovI[id(4 * i, l)] = covI.sxx;
+      mCovI[id(4 * i + 1, l)] = covI.syy;
+      mCovI[id(4 * i + 2, l)] = covI.syz;
+      mCovI[id(4 * i + 3, l)] = covI.szz;
+      const auto& der = ft.mTrDer[h][i];
+      mDer[id(4 * i, l)] = der.dydx;
+      mDer[id(4 * i + 1, l)] = der.dzdx;
+      mDer[id(4 * i + 2, l)] = der.d2ydx2;
+      mDer[id(4 * i + 3, l)] = der.d2zdx2;
+      for (int k = 0; k < 3; k++) {
+        for (int m = 0; m < 3; m++) {
+          mCoefT[id(9 * i + 3 * k + m, l)] = ft.mTrCFVT[h][i](k, m);
+        }
+        mPos[id(3 * i + k, l)] = ft.mTrPos[h][i][k];
+        mRes[id(3 * i + k, l)] = ft.mTrRes[h][i][k];
+        for (int j = 0; j < N; j++) {
+          mDR1[id((i * N + j) * 3 + k, l)] = ft.mDResidDx[i][j][k];
+          mDR2[id((i * N + j) * 3 + k, l)] = ft.mD2ResidDx2[i][j][k];
+        }
+      }
+    }
+    for (int k = 0; k < 3; k++) {
+      mPCA[id(k, l)] = ft.mPCA[h][k];
+    }
+    mSeedCur[id(0, l)] = ft.mCrossings.xDCA[ft.mCrossIDCur];
+    mSeedCur[id(1, l)] = ft.mCrossings.yDCA[ft.mCrossIDCur];
+    mHasAlt[l] = ft.mCrossIDAlt >= 0;
+    if (mHasAlt[l]) {
+      mSeedAlt[id(0, l)] = ft.mCrossings.xDCA[ft.mCrossIDAlt];
+      mSeedAlt[id(1, l)] = ft.mCrossings.yDCA[ft.mCrossIDAlt];
+    }
+    mChi2[l] = mProto.mUseAbsDCA ? ft.calcChi2NoErr() : ft.calcChi2();
+    mNIters[l] = 0;
+    mActive[l] = true;
+  }
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::minimizeLanes()
+{
+  // Newton-Raphson minimization of all the lanes, same steps as in DCAFitterN::minimizeChi2(NoErr)
+  const int nl = mNLanes;
+  while (mNActive) {
+    if (mProto.mUseAbsDCA) {
+      calcChi2DerivativesNoErrLanes();
+    } else {
+      calcChi2DerivativesLanes();
+    }
+    // corrections = - dchi2/d{x0..xN} * [ d^2chi2/d{x0..xN}^2 ]^-1, the inversion is done lane by lane
+    for (int l = 0; l < nl; l++) {
+      if (!mActive[l]) {
+        continue;
+      }
+      typename Fitter::MatSymND d2;
+      typename Fitter::VecND d1;
+      for (int i = 0; i < N; i++) {
+        d1[i] = mD1[id(i, l)];
+        for (int j = 0; j <= i; j++) {
+          d2[i][j] = mD2[id(i * N + j, l)];
+        }
+      }
+      if (!d2.Invert()) {
+        LOG(ERROR) << "InversionFailed";
+        finishLane(l, false);
+        continue;
+      }
+      typename Fitter::VecND dx = d2 * d1;
+      for (int i = 0; i < N; i++) {
+        mDX[id(i, l)] = dx[i];
+      }
+      mAbsMaxDX[l] = Fitter::getAbsMax(dx);
+    }
+    // propagate tracks to updated X
+    for (int i = 0; i < N; i++) {
+      const double* dx = &mDX[id(i, 0)];
+      const double *dydx = &mDer[id(4 * i, 0)], *dzdx = &mDer[id(4 * i + 1, 0)];
+      const double *d2ydx2 = &mDer[id(4 * i + 2, 0)], *d2zdx2 = &mDer[id(4 * i + 3, 0)];
+      double *x = &mPos[id(3 * i, 0)], *y = &mPos[id(3 * i + 1, 0)], *z = &mPos[id(3 * i + 2, 0)];
+      for (int l = 0; l < nl; l++) {
+        auto dx2h = 0.5 * dx[l] * dx[l];
+        x[l] -= dx[l];
+        y[l] -= dydx[l] * dx[l] - dx2h * d2ydx2[l];
+        z[l] -= dzdx[l] * dx[l] - dx2h * d2zdx2[l];
+      }
+    }
+    calcPCALanes();
+    for (int l = 0; l < nl; l++) {
+      if (mActive[l] && mHasAlt[l]) {
+        auto dxCur = mPCA[id(0, l)] - mSeedCur[id(0, l)], dyCur = mPCA[id(1, l)] - mSeedCur[id(1, l)];
+        auto dxAlt = mPCA[id(0, l)] - mSeedAlt[id(0, l)], dyAlt = mPCA[id(1, l)] - mSeedAlt[id(1, l)];
+        if (dxCur * dxCur + dyCur * dyCur > dxAlt * dxAlt + dyAlt * dyAlt) { // closer to alternative seed
+          mFitters[mLaneFitter[l]].mAllowAltPreference = false;
+          finishLane(l, false);
+        }
+      }
+    }
+    calcResidualsAndChi2Lanes();
+    for (int l = 0; l < nl; l++) {
+      if (!mActive[l]) {
+        continue;
+      }
+      bool converged = mAbsMaxDX[l] < mProto.mMinParamChange || mChi2Upd[l] > mChi2[l] * mProto.mMinRelChi2Change;
+      mChi2[l] = mChi2Upd[l];
+      if (converged || ++mNIters[l] >= mProto.mMaxIter) {
+        finishLane(l, true);
+      }
+    }
+  }
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::calcChi2DerivativesLanes()
+{
+  // same as DCAFitterN::calcChi2Derivatives, for all lanes
+  const int nl = mNLanes;
+  for (int i = N; i--;) {
+    double* dchi1 = &mD1[id(i, 0)];
+    for (int l = 0; l < nl; l++) {
+      dchi1[l] = 0;
+    }
+    for (int j = N; j--;) {
+      const double *sxx = &mCovI[id(4 * j, 0)], *syy = &mCovI[id(4 * j + 1, 0)], *syz = &mCovI[id(4 * j + 2, 0)], *szz = &mCovI[id(4 * j + 3, 0)];
+      const double *res0 = &mRes[id(3 * j, 0)], *res1 = &mRes[id(3 * j + 1, 0)], *res2 = &mRes[id(3 * j + 2, 0)];
+      const int idr = (j * N + i) * 3;
+      const double *dr0 = &mDR1[id(idr, 0)], *dr1 = &mDR1[id(idr + 1, 0)], *dr2 = &mDR1[id(idr + 2, 0)];
+      const int icidr = (i * N + j) * 3;
+      double *cidr0 = &mCIDR[id(icidr, 0)], *cidr1 = &mCIDR[id(icidr + 1, 0)], *cidr2 = &mCIDR[id(icidr + 2, 0)];
+      for (int l = 0; l < nl; l++) {
+        cidr0[l] = sxx[l] * dr0[l];
+        cidr1[l] = syy[l] * dr1[l] + syz[l] * dr2[l];
+        cidr2[l] = syz[l] * dr1[l] + szz[l] * dr2[l];
+        dchi1[l] += res0[l] * cidr0[l] + res1[l] * cidr1[l] + res2[l] * cidr2[l];
+      }
+    }
+  }
+  for (int i = N; i--;) {
+    for (int j = i + 1; j--;) {
+      double* dchi2 = &mD2[id(i * N + j, 0)];
+      for (int l = 0; l < nl; l++) {
+        dchi2[l] = 0;
+      }
+      for (int k = N; k--;) {
+        const int idr = (k * N + j) * 3, icidr = (i * N + k) * 3;
+        const double *dr0 = &mDR1[id(idr, 0)], *dr1 = &mDR1[id(idr + 1, 0)], *dr2 = &mDR1[id(idr + 2, 0)];
+        const double *cidr0 = &mCIDR[id(icidr, 0)], *cidr1 = &mCIDR[id(icidr + 1, 0)], *cidr2 = &mCIDR[id(icidr + 2, 0)];
+        for (int l = 0; l < nl; l++) {
+          dchi2[l] += dr0[l] * cidr0[l] + dr1[l] * cidr1[l] + dr2[l] * cidr2[l];
+        }
+        if (k == j) {
+          const double *sxx = &mCovI[id(4 * k, 0)], *syy = &mCovI[id(4 * k + 1, 0)], *syz = &mCovI[id(4 * k + 2, 0)], *szz = &mCovI[id(4 * k + 3, 0)];
+          const double *res0 = &mRes[id(3 * k, 0)], *res1 = &mRes[id(3 * k + 1, 0)], *res2 = &mRes[id(3 * k + 2, 0)];
+          const double *d2r0 = &mDR2[id(idr, 0)], *d2r1 = &mDR2[id(idr + 1, 0)], *d2r2 = &mDR2[id(idr + 2, 0)];
+          for (int l = 0; l < nl; l++) {
+            dchi2[l] += res0[l] * sxx[l] * d2r0[l] + res1[l] * (syy[l] * d2r1[l] + syz[l] * d2r2[l]) + res2[l] * (syz[l] * d2r1[l] + szz[l] * d2r2[l]);
+          }
+        }
+      }
+    }
+  }
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::calcChi2DerivativesNoErrLanes()
+{
+  // same as DCAFitterN::calcChi2DerivativesNoErr, for all lanes
+  const int nl = mNLanes;
+  auto dot = [this, nl](double* out, const std::vector<double>& a, int ia, const std::vector<double>& b, int ib) {
+    const double *a0 = &a[id(ia, 0)], *a1 = &a[id(ia + 1, 0)], *a2 = &a[id(ia + 2, 0)];
+    const double *b0 = &b[id(ib, 0)], *b1 = &b[id(ib + 1, 0)], *b2 = &b[id(ib + 2, 0)];
+    for (int l = 0; l < nl; l++) {
+      out[l] += a0[l] * b0[l] + a1[l] * b1[l] + a2[l] * b2[l];
+    }
+  };
+  for (int i = N; i--;) {
+    double* dchi1 = &mD1[id(i, 0)];
+    for (int l = 0; l < nl; l++) {
+      dchi1[l] = 0;
+    }
+    for (int j = N; j--;) {
+      dot(dchi1, mRes, 3 * j, mDR1, (j * N + i) * 3);
+      if (i >= j) {
+        double* dchi2 = &mD2[id(i * N + j, 0)];
+        for (int l = 0; l < nl; l++) {
+          dchi2[l] = 0;
+        }
+        dot(dchi2, mRes, 3 * i, mDR2, (i * N + j) * 3);
+        for (int k = N; k--;) {
+          dot(dchi2, mDR1, (k * N + i) * 3, mDR1, (k * N + j) * 3);
+        }
+      }
+    }
+  }
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::calcPCALanes()
+{
+  // same as DCAFitterN::calcPCA(NoErr), for all lanes
+  const int nl = mNLanes;
+  double *pca0 = &mPCA[id(0, 0)], *pca1 = &mPCA[id(1, 0)], *pca2 = &mPCA[id(2, 0)];
+  for (int l = 0; l < nl; l++) {
+    pca0[l] = pca1[l] = pca2[l] = 0;
+  }
+  for (int i = N; i--;) {
+    const double *x = &mPos[id(3 * i, 0)], *y = &mPos[id(3 * i + 1, 0)], *z = &mPos[id(3 * i + 2, 0)];
+    if (mProto.mUseAbsDCA) {
+      const double *c = &mC[id(i, 0)], *s = &mS[id(i, 0)];
+      for (int l = 0; l < nl; l++) {
+        pca0[l] += x[l] * c[l] - y[l] * s[l];
+        pca1[l] += x[l] * s[l] + y[l] * c[l];
+        pca2[l] += z[l];
+      }
+    } else {
+      const double* t = &mCoefT[id(9 * i, 0)];
+      const int stride = nl;
+      for (int l = 0; l < nl; l++) {
+        pca0[l] += t[l] * x[l] + t[stride + l] * y[l] + t[2 * stride + l] * z[l];
+        pca1[l] += t[3 * stride + l] * x[l] + t[4 * stride + l] * y[l] + t[5 * stride + l] * z[l];
+        pca2[l] += t[6 * stride + l] * x[l] + t[7 * stride + l] * y[l] + t[8 * stride + l] * z[l];
+      }
+    }
+  }
+  if (mProto.mUseAbsDCA) {
+    for (int l = 0; l < nl; l++) {
+      pca0[l] *= Fitter::NInv;
+      pca1[l] *= Fitter::NInv;
+      pca2[l] *= Fitter::NInv;
+    }
+  }
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::calcResidualsAndChi2Lanes()
+{
+  // same as DCAFitterN::calcTrackResiduals followed by calcChi2(NoErr), for all lanes
+  const int nl = mNLanes;
+  const double *pca0 = &mPCA[id(0, 0)], *pca1 = &mPCA[id(1, 0)], *pca2 = &mPCA[id(2, 0)];
+  std::vector<double> chi2(nl, 0.);
+  for (int i = N; i--;) {
+    const double *c = &mC[id(i, 0)], *s = &mS[id(i, 0)];
+    const double *x = &mPos[id(3 * i, 0)], *y = &mPos[id(3 * i + 1, 0)], *z = &mPos[id(3 * i + 2, 0)];
+    double *res0 = &mRes[id(3 * i, 0)], *res1 = &mRes[id(3 * i + 1, 0)], *res2 = &mRes[id(3 * i + 2, 0)];
+    const double *sxx = &mCovI[id(4 * i, 0)], *syy = &mCovI[id(4 * i + 1, 0)], *syz = &mCovI[id(4 * i + 2, 0)], *szz = &mCovI[id(4 * i + 3, 0)];
+    for (int l = 0; l < nl; l++) {
+      res0[l] = x[l] - (pca0[l] * c[l] + pca1[l] * s[l]); // PCA in the track frame
+      res1[l] = y[l] - (pca1[l] * c[l] - pca0[l] * s[l]);
+      res2[l] = z[l] - pca2[l];
+    }
+    if (mProto.mUseAbsDCA) {
+      for (int l = 0; l < nl; l++) {
+        chi2[l] += res0[l] * res0[l] + res1[l] * res1[l] + res2[l] * res2[l];
+      }
+    } else {
+      for (int l = 0; l < nl; l++) {
+        chi2[l] += res0[l] * res0[l] * sxx[l] + res1[l] * res1[l] * syy[l] + res2[l] * res2[l] * szz[l] + 2. * res1[l] * res2[l] * syz[l];
+      }
+    }
+  }
+  for (int l = 0; l < nl; l++) {
+    mChi2Upd[l] = chi2[l];
+  }
+}
+
+//___________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterNBatch<N, Args...>::finishLane(int l, bool converged)
+{
+  // retire the lane, storing the result of a completed minimization in its fitter
+  mActive[l] = false;
+  mNActive--;
+  if (!converged) {
+    return;
+  }
+  auto& ft = mFitters[mLaneFitter[l]];
+  const int h = ft.mCurHyp;
+  for (int k = 0; k < 3; k++) {
+    for (int i = 0; i < N; i++) {
+      ft.mTrPos[h][i][k] = mPos[id(3 * i + k, l)];
+      ft.mTrRes[h][i][k] = mRes[id(3 * i + k, l)];
+    }
+    ft.mPCA[h][k] = mPCA[id(k, l)];
+  }
+  ft.mNIters[h] = mNIters[l];
+  ft.mChi2[h] = mChi2[l] * Fitter::NInv;
+  if (ft.mChi2[h] < ft.mMaxChi2) {
+    ft.acceptSeed();
+  }
+}
+
+using DCAFitter2Batch = DCAFitterNBatch<2, o2::track::TrackParCov>;
+using DCAFitter3Batch = DCAFitterNBatch<3, o2::track::TrackParCov>;
+
+} // namespace vertexing
+} // namespace o2
+#endif // _ALICEO2_DCA_FITTERN_BATCH_
@@ -26,6 +26,7 @@
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "DetectorsVertexing/SVertexerParams.h"
 #include "DetectorsVertexing/SVertexHypothesis.h"
+#include "DetectorsVertexing/V0PairIndex.h"
 #include <numeric>
 #include <algorithm>
 
@@ -67,6 +68,19 @@ class SVertexer
     VBracket vBracket;
   };
 
+  // counters of the V0 pairing, to monitor the selectivity of the pairing index
+  struct PairingStats {
+    size_t nTimeCompatible = 0; ///< pairs compatible in time, i.e. sharing a primary vertex
+    size_t nConsidered = 0;     ///< pairs passing the phi/tgl cuts of the index and proposed to the DCAFitter
+    size_t nAccepted = 0;       ///< pairs accepted as V0
+    void add(const PairingStats& other)
+    {
+      nTimeCompatible += other.nTimeCompatible;
+      nConsidered += other.nConsidered;
+      nAccepted += other.nAccepted;
+    }
+  };
+
   SVertexer(bool enabCascades = true) : mEnableCascades(enabCascades) {}
 
   void setEnableCascades(bool v) { mEnableCascades = v; }
@@ -77,6 +91,7 @@ class SVertexer
   void setMeanVertex(const o2d::VertexBase& v) { mMeanVertex = v; }
   void setNThreads(int n);
   int getNThreads() const { return mNThreads; }
+  const PairingStats& getPairingStats() const { return mPairingStats; }
 
   template <typename V0CONT, typename V0REFCONT, typename CASCCONT, typename CASCREFCONT>
   void extractSecondaryVertices(V0CONT& v0s, V0REFCONT& vtx2V0Refs, CASCCONT& cascades, CASCREFCONT& vtx2CascRefs);
@@ -98,6 +113,9 @@ class SVertexer
   std::vector<std::vector<Cascade>> mCascadesTmp;
   std::array<std::vector<TrackCand>, 2> mTracksPool{}; // pools of positive and negative seeds sorted in min VtxID
   std::array<std::vector<int>, 2> mVtxFirstTrack{};    // 1st pos. and neg. track of the pools for each vertex
+  V0PairIndex mV0PairIndex;                            // index of negative seeds used to propose the V0 pairs
+  std::vector<PairingStats> mPairingStatsTmp; // per thread counters
+  PairingStats mPairingStats;
   o2d::VertexBase mMeanVertex{{0., 0., 0.}, {0.1 * 0.1, 0., 0.1 * 0.1, 0., 0., 6. * 6.}};
   const SVertexerParams* mSVParams = nullptr;
   std::array<SVertexHypothesis, NHypV0> mV0Hyps;
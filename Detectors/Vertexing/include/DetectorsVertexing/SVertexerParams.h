@@ -36,6 +36,9 @@ struct SVertexerParams : public o2::conf::ConfigurableParamHelper<SVertexerParam
   float maxRIni = 150;          ///< don't consider as a seed (circles intersection) if its R exceeds this
   bool useAbsDCA = true; ///< use abs dca minimization
   //
+  float maxDPhiV0Prongs = 0.; ///< propose to the fitter only V0 prongs with smaller phi difference, no cut if <= 0
+  float maxDTglV0Prongs = 0.; ///< propose to the fitter only V0 prongs with smaller tgl difference, no cut if <= 0
+  //
   float minRToMeanVertex = 0.5;           ///< min radial distance of V0 from beam line (mean vertex)
   float maxDCAXYToMeanVertex = 0.2;       ///< max DCA of V0 from beam line (mean vertex) for prompt V0 candidates
   float maxDCAXYToMeanVertexV0Casc = 0.5; ///< max DCA of V0 from beam line (mean vertex) for cascade V0 candidates
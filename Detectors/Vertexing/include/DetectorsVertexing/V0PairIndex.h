@@ -0,0 +1,154 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file V0PairIndex.h
+/// \brief Index of the negative V0 seeds in cells of vertex, phi and tgl, to propose the V0 pairs
+
+#ifndef O2_V0_PAIR_INDEX_H
+#define O2_V0_PAIR_INDEX_H
+
+#include "MathUtils/Primitive2D.h"
+#include "CommonConstants/MathConstants.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace o2
+{
+namespace vertexing
+{
+
+/// Negative seeds are distributed in cells of their lowest compatible primary vertex, momentum phi and tgl.
+/// The partners proposed for a positive seed are the negative seeds whose lowest compatible vertex is within
+/// the vertex bracket of the positive one (as in the scan of the negative seeds sorted in lowest vertex),
+/// and whose phi and tgl differ from the ones of the positive seed by less than the cuts. The phi and tgl bins
+/// are not narrower than the cuts, so that only the neighbouring bins need to be scanned.
+class V0PairIndex
+{
+ public:
+  using VBracket = o2::math_utils::Bracket<int>;
+  static constexpr float MaxTglIndex = 2.; ///< tgl beyond +-this value goes to the edge cells
+
+  /// set the max phi and tgl differences of the prongs, no cut if <= 0
+  void setCuts(float maxDPhi, float maxDTgl)
+  {
+    mCheckDTgl = maxDTgl > 0;
+    mMaxDPhi = maxDPhi > 0 ? maxDPhi : o2::constants::math::TwoPI;
+    mMaxDTgl = maxDTgl > 0 ? maxDTgl : 4 * MaxTglIndex;
+    mNPhiBins = mMaxDPhi < o2::constants::math::PI ? int(o2::constants::math::TwoPI / mMaxDPhi) : 1;
+    mNTglBins = mMaxDTgl < 2 * MaxTglIndex ? int(2 * MaxTglIndex / mMaxDTgl) : 1;
+    mPhiBinInv = mNPhiBins / o2::constants::math::TwoPI;
+    mTglBinInv = mNTglBins / (2 * MaxTglIndex);
+  }
+
+  /// distribute the negative seeds, which must be sorted in their lowest compatible vertex, in the cells
+  template <typename Track>
+  void build(const std::vector<Track>& negTracks, int nVertices);
+
+  /// number of negative seeds whose lowest compatible vertex is within the vertex bracket
+  int getNTimeCompatible(const VBracket& vBracket) const
+  {
+    return mCellFirst[getCellID(vBracket.getMax() + 1, 0, 0)] - mCellFirst[getCellID(vBracket.getMin(), 0, 0)];
+  }
+
+  /// call func(id) for each negative seed proposed as a partner of the positive seed, id being its entry in the
+  /// negative seeds given to build()
+  template <typename Track, typename F>
+  void forEachPartner(const Track& posTrack, F&& func) const;
+
+  int getNPhiBins() const { return mNPhiBins; }
+  int getNTglBins() const { return mNTglBins; }
+
+ private:
+  struct IndexedTrack {
+    int id = -1; // entry in the negative seeds
+    float phi = 0.;
+    float tgl = 0.;
+  };
+
+  int getPhiBin(float phi) const { return std::max(0, std::min(int(phi * mPhiBinInv), mNPhiBins - 1)); }
+  int getTglBin(float tgl) const { return std::max(0, std::min(int((tgl + MaxTglIndex) * mTglBinInv), mNTglBins - 1)); }
+  int getCellID(int iv, int iphi, int itgl) const { return (iv * mNPhiBins + iphi) * mNTglBins + itgl; }
+
+  std::vector<IndexedTrack> mEntries; // negative seeds ordered in cells
+  std::vector<int> mCellFirst;        // 1st entry of each cell in the mEntries, with extra entry at the end
+  int mNPhiBins = 1;
+  int mNTglBins = 1;
+  float mPhiBinInv = 1. / o2::constants::math::TwoPI;
+  float mTglBinInv = 1. / (2 * MaxTglIndex);
+  float mMaxDPhi = o2::constants::math::TwoPI;
+  float mMaxDTgl = 4 * MaxTglIndex;
+  bool mCheckDTgl = false;
+};
+
+//__________________________________________________________________
+template <typename Track>
+void V0PairIndex::build(const std::vector<Track>& negTracks, int nVertices)
+{
+  int ntr = negTracks.size(), ncells = nVertices * mNPhiBins * mNTglBins;
+  std::vector<IndexedTrack> entries(ntr);
+  std::vector<int> cellID(ntr);
+  mCellFirst.clear();
+  mCellFirst.resize(ncells + 1, 0);
+  for (int i = 0; i < ntr; i++) {
+    const auto& trc = negTracks[i];
+    entries[i] = IndexedTrack{i, trc.getPhi(), trc.getTgl()};
+    cellID[i] = getCellID(trc.vBracket.getMin(), getPhiBin(entries[i].phi), getTglBin(entries[i].tgl));
+    mCellFirst[cellID[i] + 1]++;
+  }
+  for (int ic = 0; ic < ncells; ic++) {
+    mCellFirst[ic + 1] += mCellFirst[ic];
+  }
+  // the seeds keep their original order within a cell
+  std::vector<int> cellFill(mCellFirst.begin(), mCellFirst.end() - 1);
+  mEntries.resize(ntr);
+  for (int i = 0; i < ntr; i++) {
+    mEntries[cellFill[cellID[i]]++] = entries[i];
+  }
+}
+
+//__________________________________________________________________
+template <typename Track, typename F>
+void V0PairIndex::forEachPartner(const Track& posTrack, F&& func) const
+{
+  int vMin = posTrack.vBracket.getMin(), vMax = posTrack.vBracket.getMax();
+  float phiP = posTrack.getPhi(), tglP = posTrack.getTgl();
+  int iphiP = getPhiBin(phiP), itglP = getTglBin(tglP);
+  int nPhiScan = std::min(3, mNPhiBins), itglMin = std::max(0, itglP - 1), itglMax = std::min(mNTglBins - 1, itglP + 1);
+  bool checkDPhi = mNPhiBins > 1;
+  for (int iv = vMin; iv <= vMax; iv++) {
+    for (int ip = 0; ip < nPhiScan; ip++) {
+      int iphi = nPhiScan < 3 ? ip : (iphiP + ip - 1 + mNPhiBins) % mNPhiBins; // with less than 3 bins scan all of them
+      int ient = mCellFirst[getCellID(iv, iphi, itglMin)], ientLim = mCellFirst[getCellID(iv, iphi, itglMax) + 1];
+      for (; ient < ientLim; ient++) {
+        const auto& negEntry = mEntries[ient];
+        if (checkDPhi) {
+          float dphi = std::abs(phiP - negEntry.phi);
+          if (dphi > o2::constants::math::PI) {
+            dphi = o2::constants::math::TwoPI - dphi;
+          }
+          if (dphi > mMaxDPhi) {
+            continue;
+          }
+        }
+        if (mCheckDTgl && std::abs(tglP - negEntry.tgl) > mMaxDTgl) {
+          continue;
+        }
+        func(negEntry.id);
+      }
+    }
+  }
+}
+
+} // namespace vertexing
+} // namespace o2
+
+#endif
@@ -14,6 +14,7 @@
 /// \author ruben.shahoyan@cern.ch
 
 #include "DetectorsVertexing/DCAFitterN.h"
+#include "DetectorsVertexing/DCAFitterNBatch.h"
 
 namespace o2
 {
@@ -27,6 +28,12 @@ void __dummy_instance__()
   o2::track::TrackParCov tr;
   ft2.process(tr, tr);
   ft3.process(tr, tr, tr);
+  DCAFitter2Batch bt2;
+  DCAFitter3Batch bt3;
+  std::vector<DCAFitter2Batch::Candidate> cand2{{&tr, &tr}};
+  std::vector<DCAFitter3Batch::Candidate> cand3{{&tr, &tr, &tr}};
+  bt2.process(cand2);
+  bt3.process(cand3);
 }
 
 } // namespace vertexing
@@ -36,9 +36,13 @@ void SVertexer::process(const o2::globaltracking::RecoContainer& recoData) // ac
   updateTimeDependentParams(); // TODO RS: strictly speaking, one should do this only in case of the CCDB objects update
   mPVertices = recoData.getPrimaryVertices();
   buildT2V(recoData); // build track->vertex refs from vertex->track (if other workflow will need this, consider producing a message in the VertexTrackMatcher)
-  int ntrP = mTracksPool[POS].size(), ntrN = mTracksPool[NEG].size(), iThread = 0;
+  mV0PairIndex.build(mTracksPool[NEG], mVtxFirstTrack[NEG].size());
+  int ntrP = mTracksPool[POS].size();
   mV0sTmp[0].clear();
   mCascadesTmp[0].clear();
+  for (auto& stats : mPairingStatsTmp) {
+    stats = PairingStats{};
+  }
 
 #ifdef WITH_OPENMP
   omp_set_num_threads(mNThreads);
@@ -47,16 +51,24 @@ void SVertexer::process(const o2::globaltracking::RecoContainer& recoData) // ac
 #endif
   for (int itp = 0; itp < ntrP; itp++) {
     auto& seedP = mTracksPool[POS][itp];
-    for (int itn = mVtxFirstTrack[NEG][seedP.vBracket.getMin()]; itn < ntrN; itn++) { // start from the 1st negative track of lowest-ID vertex of positive
-      auto& seedN = mTracksPool[NEG][itn];
-      if (seedN.vBracket > seedP.vBracket) { // all vertices compatible with seedN are in future wrt that of seedP
-        break;
-      }
+    int iThread = 0;
 #ifdef WITH_OPENMP
-      iThread = omp_get_thread_num();
+    iThread = omp_get_thread_num();
 #endif
-      checkV0(seedP, seedN, itp, itn, iThread);
-    }
+    auto& stats = mPairingStatsTmp[iThread];
+    // consider negative seeds whose lowest compatible vertex is within the vertex bracket of the positive one,
+    // with close enough phi and tgl
+    stats.nTimeCompatible += mV0PairIndex.getNTimeCompatible(seedP.vBracket);
+    mV0PairIndex.forEachPartner(seedP, [&](int itn) {
+      stats.nConsidered++;
+      if (checkV0(seedP, mTracksPool[NEG][itn], itp, itn, iThread)) {
+        stats.nAccepted++;
+      }
+    });
+  }
+  mPairingStats = PairingStats{};
+  for (const auto& stats : mPairingStatsTmp) {
+    mPairingStats.add(stats);
   }
 #ifdef WITH_OPENMP
   for (int i = 1; i < mNThreads; i++) { // merge results of all threads
@@ -70,6 +82,8 @@ void SVertexer::process(const o2::globaltracking::RecoContainer& recoData) // ac
   }
 #endif
   LOG(INFO) << "DONE : " << mV0sTmp[0].size() << " " << mCascadesTmp[0].size();
+  LOG(INFO) << "V0 pairs: " << mPairingStats.nTimeCompatible << " compatible in time, " << mPairingStats.nConsidered
+            << " considered, " << mPairingStats.nAccepted << " accepted";
 }
 
 //__________________________________________________________________
@@ -88,6 +102,7 @@ void SVertexer::updateTimeDependentParams()
   mMaxDCAXY2ToMeanVertex = mSVParams->maxDCAXYToMeanVertex * mSVParams->maxDCAXYToMeanVertex;
   mMaxDCAXY2ToMeanVertexV0Casc = mSVParams->maxDCAXYToMeanVertexV0Casc * mSVParams->maxDCAXYToMeanVertexV0Casc;
   mMinR2DiffV0Casc = mSVParams->minRDiffV0Casc * mSVParams->minRDiffV0Casc;
+  mV0PairIndex.setCuts(mSVParams->maxDPhiV0Prongs, mSVParams->maxDTglV0Prongs);
 
   auto bz = o2::base::Propagator::Instance()->getNominalBz();
 
@@ -119,6 +134,7 @@ void SVertexer::setupThreads()
   }
   mV0sTmp.resize(mNThreads);
   mCascadesTmp.resize(mNThreads);
+  mPairingStatsTmp.resize(mNThreads);
   mFitterV0.resize(mNThreads);
   auto bz = o2::base::Propagator::Instance()->getNominalBz();
   for (auto& fitter : mFitterV0) {
@@ -15,6 +15,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "DetectorsVertexing/DCAFitterN.h"
+#include "DetectorsVertexing/DCAFitterNBatch.h"
 #include "CommonUtils/TreeStreamRedirector.h"
 #include <TRandom.h>
 #include <TGenPhaseSpace.h>
@@ -387,5 +388,65 @@ BOOST_AUTO_TEST_CASE(DCAFitterNProngs)
   outStream.Close();
 }
 
+BOOST_AUTO_TEST_CASE(DCAFitterNBatchVsScalar)
+{
+  // the batched fit must reproduce the scalar one
+  constexpr int NTest = 2000;
+  TGenPhaseSpace genPHS;
+  constexpr double pion = 0.13957;
+  constexpr double k0 = 0.49761;
+  std::vector<double> k0dec = {pion, pion};
+  std::vector<int> forceQ{1, 1};
+  double bz = 5.0;
+  Vec3D vtxGen;
+  std::vector<o2::track::TrackParCov> vctracks, allTracks;
+  allTracks.reserve(2 * NTest);
+  for (int iev = 0; iev < NTest; iev++) {
+    generate(vtxGen, vctracks, bz, genPHS, k0, k0dec, forceQ);
+    allTracks.insert(allTracks.end(), vctracks.begin(), vctracks.end());
+  }
+  std::vector<DCAFitter2Batch::Candidate> cands;
+  for (int iev = 0; iev < NTest; iev++) {
+    cands.push_back({&allTracks[2 * iev], &allTracks[2 * iev + 1]});
+  }
+
+  DCAFitter2 ft;
+  ft.setBz(bz);
+  for (bool useAbsDCA : {true, false}) {
+    ft.setUseAbsDCA(useAbsDCA);
+    DCAFitter2Batch batch(ft);
+    TStopwatch swS, swB;
+    swB.Start();
+    int nB = batch.process(cands);
+    swB.Stop();
+    int nS = 0, nDiff = 0;
+    swS.Start();
+    for (int iev = 0; iev < NTest; iev++) {
+      nS += ft.process(*cands[iev][0], *cands[iev][1]);
+    }
+    swS.Stop();
+    for (int iev = 0; iev < NTest; iev++) {
+      int nc = ft.process(*cands[iev][0], *cands[iev][1]);
+      const auto& bft = batch.getFitter(iev);
+      if (nc != bft.getNCandidates()) {
+        nDiff++;
+        continue;
+      }
+      for (int ic = 0; ic < nc; ic++) {
+        auto d = ft.getPCACandidate(ic);
+        d -= bft.getPCACandidate(ic);
+        if (std::abs(d[0]) > 1e-6 || std::abs(d[1]) > 1e-6 || std::abs(d[2]) > 1e-6 ||
+            std::abs(ft.getChi2AtPCACandidate(ic) - bft.getChi2AtPCACandidate(ic)) > 1e-4 * (1. + ft.getChi2AtPCACandidate(ic))) {
+          nDiff++;
+        }
+      }
+    }
+    LOG(INFO) << "2-prongs with " << (useAbsDCA ? "abs." : "wgh.") << "dist minimization: " << nS << " candidates in scalar mode, CPU time: "
+              << swS.CpuTime() << ", " << nB << " in batch mode, CPU time: " << swB.CpuTime() << ", differing: " << nDiff;
+    BOOST_CHECK(nB == nS);
+    BOOST_CHECK(nDiff < 1e-3 * NTest); // allow for the rare flip of a convergence decision due to the rounding
+  }
+}
+
 } // namespace vertexing
 } // namespace o2
@@ -0,0 +1,123 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test V0PairIndex class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "DetectorsVertexing/SVertexer.h"
+#include "DetectorsVertexing/V0PairIndex.h"
+#include "CommonConstants/MathConstants.h"
+#include <TRandom.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace o2
+{
+namespace vertexing
+{
+
+using TrackCand = SVertexer::TrackCand;
+
+constexpr int NVertices = 30;
+
+// seeds sorted in their lowest compatible vertex, as in SVertexer::buildT2V, some vertices having no seeds
+std::vector<TrackCand> createSeeds(int charge)
+{
+  std::vector<TrackCand> seeds;
+  for (int iv = 0; iv < NVertices; iv++) {
+    int ntr = iv % 7 == 3 ? 0 : gRandom->Integer(10);
+    for (int i = 0; i < ntr; i++) {
+      std::array<float, 5> par{0., 0., float(gRandom->Uniform(-0.9, 0.9)), float(gRandom->Uniform(-2.5, 2.5)), charge / float(gRandom->Uniform(0.2, 5.))};
+      std::array<float, 15> cov{1e-4, 0., 1e-4, 0., 0., 1e-5, 0., 0., 0., 1e-5, 0., 0., 0., 0., 1e-3};
+      o2::track::TrackParCov trc(gRandom->Uniform(0., 50.), gRandom->Uniform(-M_PI, M_PI), par, cov);
+      int ivMax = std::min(NVertices - 1, iv + int(gRandom->Integer(3)));
+      seeds.emplace_back(TrackCand{trc, {}, {iv, ivMax}});
+    }
+  }
+  return seeds;
+}
+
+// partners of a positive seed in the brute-force scan of the negative seeds sorted in lowest compatible vertex,
+// which was used by the SVertexer before the index
+std::vector<int> bruteForcePartners(const TrackCand& seedP, const std::vector<TrackCand>& negSeeds, float maxDPhi, float maxDTgl)
+{
+  std::vector<int> partners;
+  int itn = 0, ntrN = negSeeds.size();
+  while (itn < ntrN && negSeeds[itn].vBracket.getMin() < seedP.vBracket.getMin()) { // 1st negative track of lowest-ID vertex of positive
+    itn++;
+  }
+  for (; itn < ntrN; itn++) {
+    const auto& seedN = negSeeds[itn];
+    if (seedN.vBracket > seedP.vBracket) { // all vertices compatible with seedN are in future wrt that of seedP
+      break;
+    }
+    float dphi = std::abs(seedP.getPhi() - seedN.getPhi());
+    if (dphi > o2::constants::math::PI) {
+      dphi = o2::constants::math::TwoPI - dphi;
+    }
+    if ((maxDPhi > 0 && dphi > maxDPhi) || (maxDTgl > 0 && std::abs(seedP.getTgl() - seedN.getTgl()) > maxDTgl)) {
+      continue;
+    }
+    partners.push_back(itn);
+  }
+  return partners;
+}
+
+void checkPairs(float maxDPhi, float maxDTgl)
+{
+  gRandom->SetSeed(1234);
+  const auto posSeeds = createSeeds(1);
+  const auto negSeeds = createSeeds(-1);
+  V0PairIndex index;
+  index.setCuts(maxDPhi, maxDTgl);
+  index.build(negSeeds, NVertices);
+  bool noCuts = maxDPhi <= 0 && maxDTgl <= 0;
+  if (noCuts) {
+    BOOST_CHECK_EQUAL(index.getNPhiBins(), 1);
+    BOOST_CHECK_EQUAL(index.getNTglBins(), 1);
+  }
+  size_t nPairs = 0;
+  for (const auto& seedP : posSeeds) {
+    auto expected = bruteForcePartners(seedP, negSeeds, maxDPhi, maxDTgl);
+    std::vector<int> proposed;
+    index.forEachPartner(seedP, [&proposed](int itn) { proposed.push_back(itn); });
+    if (!noCuts) { // only the order of the scan without cuts is the one of the brute-force scan
+      std::sort(proposed.begin(), proposed.end());
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(proposed.begin(), proposed.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(index.getNTimeCompatible(seedP.vBracket), int(bruteForcePartners(seedP, negSeeds, 0., 0.).size()));
+    nPairs += expected.size();
+  }
+  BOOST_CHECK(nPairs > 0);
+}
+
+BOOST_AUTO_TEST_CASE(V0PairIndex_noCuts)
+{
+  checkPairs(0., 0.);
+}
+
+BOOST_AUTO_TEST_CASE(V0PairIndex_cuts)
+{
+  const std::vector<std::array<float, 2>> cutsList{{1.5, 1.0}, {0.3, 0.2}, {0.5, 0.}, {0., 0.4}, {2., 3.}};
+  for (const auto& cuts : cutsList) {
+    BOOST_TEST_CONTEXT("maxDPhi " << cuts[0] << " maxDTgl " << cuts[1])
+    {
+      checkPairs(cuts[0], cuts[1]);
+    }
+  }
+}
+
+} // namespace vertexing
+} // namespace o2
@@ -18,6 +18,7 @@
 #include "Framework/OutputRef.h"
 #include "Framework/OutputRoute.h"
 #include "Framework/DataChunk.h"
+#include "Framework/DataRef.h"
 #include "Framework/FairMQDeviceProxy.h"
 #include "Framework/TimingInfo.h"
 #include "Framework/TMessageSerializer.h"
@@ -376,6 +377,16 @@ class DataAllocator
   void snapshot(const Output& spec, const char* payload, size_t payloadSize,
                 o2::header::SerializationMethod serializationMethod = o2::header::gSerializationMethodNone);
 
+  /// Send the payload of @a input, which must be one of the inputs currently
+  /// being processed, to the output specified by @a spec, with a new header.
+  /// When the input and the output use the same transport (e.g. shared memory)
+  /// the payload is shared with the input message rather than copied, otherwise
+  /// this is equivalent to snapshot().
+  /// If @a batched is true, the part is never dispatched on its own, but it
+  /// is sent together with all the other outputs at the end of the processing,
+  /// regardless of the dispatch policy.
+  void forwardPayload(const Output& spec, DataRef const& input, bool batched = false);
+
   /// make an object of type T and route to output specified by OutputRef
   /// The object is owned by the framework, returned reference can be used to fill the object.
   ///
@@ -473,7 +484,8 @@ class DataAllocator
   Output getOutputByBind(OutputRef&& ref);
   void addPartToContext(FairMQMessagePtr&& payload,
                         const Output& spec,
-                        o2::header::SerializationMethod serializationMethod);
+                        o2::header::SerializationMethod serializationMethod,
+                        bool batched = false);
 };
 
 } // namespace framework
@@ -20,6 +20,7 @@
 #include "Framework/DataProcessingStats.h"
 #include "Framework/ExpirationHandler.h"
 #include "Framework/ServiceRegistry.h"
+#include "Framework/InputRecord.h"
 #include "Framework/InputRoute.h"
 #include "Framework/ForwardRoute.h"
 #include "Framework/TimingInfo.h"
@@ -86,6 +87,7 @@ struct DataProcessorContext {
   AlgorithmSpec::ErrorCallback* error = nullptr;
 
   std::function<void(o2::framework::RuntimeErrorRef e, InputRecord& record)>* errorHandling = nullptr;
+  InputRecord::BindingIndex const* bindingIndex = nullptr;
 };
 
 struct TaskStreamRef {
@@ -150,6 +152,8 @@ class DataProcessingDevice : public FairMQDevice
   std::vector<ExpirationHandler> mExpirationHandlers;
   /// Completed actions
   std::vector<DataRelayer::RecordAction> mCompleted;
+  /// Binding lookup for the InputRecords of this device
+  InputRecord::BindingIndex mBindingIndex;
 
   uint64_t mLastSlowMetricSentTimestamp = 0;         /// The timestamp of the last time we sent slow metrics
   uint64_t mLastMetricFlushedTimestamp = 0;          /// The timestamp of the last time we actually flushed metrics
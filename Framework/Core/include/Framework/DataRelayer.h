@@ -21,6 +21,7 @@
 #include "Framework/Tracing.h"
 
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -34,6 +35,8 @@ class Monitoring;
 namespace o2::framework
 {
 
+class CompiledInputMatchers;
+
 /// Helper struct to hold statistics about the relaying process.
 struct DataRelayerStats {
   uint64_t malformedInputs = 0;         /// Malformed inputs which the user attempted to process
@@ -77,6 +80,7 @@ class DataRelayer
               std::vector<InputRoute> const& routes,
               monitoring::Monitoring&,
               TimesliceIndex&);
+  ~DataRelayer();
 
   /// This invokes the appropriate `InputRoute::danglingChecker` on every
   /// entry in the cache and if it returns true, it creates a new
@@ -155,6 +159,7 @@ class DataRelayer
   CompletionPolicy mCompletionPolicy;
   std::vector<size_t> mDistinctRoutesIndex;
   std::vector<data_matcher::DataDescriptorMatcher> mInputMatchers;
+  std::unique_ptr<CompiledInputMatchers> mCompiledMatchers;
   std::vector<data_matcher::VariableContext> mVariableContextes;
   std::vector<CacheEntryStatus> mCachedStateMetrics;
 
@@ -38,9 +38,17 @@ struct DeviceMetricsHelper {
   /// @matches is the regexp_matches from the metric identifying regex
   /// @info is the DeviceInfo associated to the device posting the metric
   /// @newMetricsCallback is a callback that will be invoked every time a new metric is added to the list.
+  /// @metricIndex if not null, is filled with the index of the metric in @info
   static bool processMetric(ParsedMetricMatch& results,
                             DeviceMetricsInfo& info,
-                            NewMetricCallback newMetricCallback = nullptr);
+                            NewMetricCallback newMetricCallback = nullptr,
+                            size_t* metricIndex = nullptr);
+
+  /// Stores the value of a parsed metric for the already known metric at @metricIndex,
+  /// skipping the lookup by name.
+  static bool storeMetric(ParsedMetricMatch const& results,
+                          DeviceMetricsInfo& info,
+                          size_t metricIndex);
   /// @return the index in metrics for the information of given metric
   static size_t metricIdxByName(const std::string& name,
                                 const DeviceMetricsInfo& info);
@@ -157,6 +157,8 @@ struct DriverInfo {
   DeviceMetricsInfo metrics;
   /// Skip shared memory cleanup if set
   bool noSHMCleanup;
+  /// Use a binary shared memory channel for the metrics of the devices
+  bool shmMetrics = false;
   /// Default value for the --driver-client-backend. Notice that if we start from
   /// the driver, the default backend will be the websocket one.  On the other hand,
   /// if the device is started standalone, the default becomes the old stdout:// so
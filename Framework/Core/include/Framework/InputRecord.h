@@ -26,6 +26,7 @@
 
 #include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstring>
 #include <cassert>
@@ -98,8 +99,27 @@ class InputRecord
  public:
   using DataHeader = o2::header::DataHeader;
 
+  /// Precomputed mapping from the bindings of an input schema to their
+  /// position, so that getPos() does not need to compare all the bindings.
+  /// It is meant to be built once per schema and shared by all the
+  /// InputRecords created for it.
+  class BindingIndex
+  {
+   public:
+    BindingIndex() = default;
+    BindingIndex(std::vector<InputRoute> const& inputs);
+
+    /// @return the position of @a binding, -1 if not found
+    int find(std::string_view binding) const;
+
+   private:
+    std::vector<std::pair<std::string, int>> mSlots; /// open addressing table, position -1 for unused slots
+    size_t mMask = 0;
+  };
+
   InputRecord(std::vector<InputRoute> const& inputs,
-              InputSpan& span);
+              InputSpan& span,
+              BindingIndex const* bindingIndex = nullptr);
 
   /// A deleter type to be used with unique_ptr, which can be marked that
   /// it does not own the underlying resource and thus should not delete it.
@@ -628,6 +648,7 @@ class InputRecord
  private:
   std::vector<InputRoute> const& mInputsSchema;
   InputSpan& mSpan;
+  BindingIndex const* mBindingIndex = nullptr;
 };
 
 } // namespace framework
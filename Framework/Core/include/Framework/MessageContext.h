@@ -37,6 +37,7 @@ namespace o2
 namespace framework
 {
 class Output;
+struct MessageSet;
 
 class MessageContext
 {
@@ -544,12 +545,24 @@ class MessageContext
   /// mMessages then in mScheduledMessages
   o2::header::DataHeader* findMessageHeader(const Output& spec);
 
+  /// Set the inputs currently being processed, so that their payloads can be
+  /// reused for the outputs. nullptr when no processing is ongoing.
+  void setInputs(std::vector<MessageSet> const* inputs)
+  {
+    mInputs = inputs;
+  }
+
+  /// return the message holding @a payload, if it belongs to one of the
+  /// inputs currently being processed, nullptr otherwise.
+  FairMQMessage const* findInputPayload(char const* payload) const;
+
  private:
   FairMQDeviceProxy mProxy;
   Messages mMessages;
   Messages mScheduledMessages;
   DispatchControl mDispatchControl;
   std::unordered_map<std::string, std::unique_ptr<std::string>> mChannelRefs;
+  std::vector<MessageSet> const* mInputs = nullptr;
 };
 } // namespace framework
 } // namespace o2
@@ -10,9 +10,11 @@
 // or submit itself to any jurisdiction.
 
 #include "DPLMonitoringBackend.h"
+#include "ShmMetricsChannel.h"
 #include "Framework/DriverClient.h"
 #include "Framework/ServiceRegistry.h"
 #include <fmt/format.h>
+#include <cstdlib>
 #include <sstream>
 
 namespace o2::framework
@@ -35,8 +37,13 @@ inline unsigned long DPLMonitoringBackend::convertTimestamp(const std::chrono::t
 DPLMonitoringBackend::DPLMonitoringBackend(ServiceRegistry& registry)
   : mRegistry{registry}
 {
+  if (char const* shmName = getenv(ShmMetricsChannel::ENV_VARIABLE)) {
+    mShmChannel = ShmMetricsChannel::attach(shmName);
+  }
 }
 
+DPLMonitoringBackend::~DPLMonitoringBackend() = default;
+
 void DPLMonitoringBackend::addGlobalTag(std::string_view name, std::string_view value)
 {
   // FIXME: tags are ignored by DPL in any case...
@@ -52,6 +59,9 @@ void DPLMonitoringBackend::send(std::vector<o2::monitoring::Metric>&& metrics)
 
 void DPLMonitoringBackend::send(o2::monitoring::Metric const& metric)
 {
+  if (mShmChannel && mShmChannel->send(metric)) {
+    return;
+  }
   std::ostringstream mStream;
   mStream << "[METRIC] " << metric.getName();
   for (auto& value : metric.getValues()) {
@@ -12,12 +12,14 @@
 #define O2_FRAMEWORK_DPLMONITORINGBACKEND_H_
 
 #include "Monitoring/Backend.h"
+#include <memory>
 #include <string>
 
 namespace o2::framework
 {
 
 struct ServiceRegistry;
+class ShmMetricsChannel;
 
 /// \brief Prints metrics to standard output via std::cout
 class DPLMonitoringBackend final : public o2::monitoring::Backend
@@ -27,7 +29,7 @@ class DPLMonitoringBackend final : public o2::monitoring::Backend
   DPLMonitoringBackend(ServiceRegistry& registry);
 
   /// Default destructor
-  ~DPLMonitoringBackend() override = default;
+  ~DPLMonitoringBackend() override;
 
   /// Prints metric
   /// \param metric           reference to metric object
@@ -51,6 +53,9 @@ class DPLMonitoringBackend final : public o2::monitoring::Backend
   std::string mTagString;    ///< Global tagset (common for each metric)
   const std::string mPrefix; ///< Metric prefix
   ServiceRegistry& mRegistry;
+  /// Binary channel to the driver, if one was provided. Metrics which
+  /// cannot go through it use the text protocol.
+  std::unique_ptr<ShmMetricsChannel> mShmChannel;
 };
 
 } // namespace o2::framework
@@ -111,7 +111,8 @@ FairMQMessagePtr DataAllocator::headerMessageFromOutput(Output const& spec,
 }
 
 void DataAllocator::addPartToContext(FairMQMessagePtr&& payloadMessage, const Output& spec,
-                                     o2::header::SerializationMethod serializationMethod)
+                                     o2::header::SerializationMethod serializationMethod,
+                                     bool batched)
 {
   std::string const& channel = matchDataHeader(spec, mTimingInfo->timeslice);
   auto headerMessage = headerMessageFromOutput(spec, channel, serializationMethod, 0);
@@ -122,6 +123,12 @@ void DataAllocator::addPartToContext(FairMQMessagePtr&& payloadMessage, const Ou
   DataHeader* dh = const_cast<DataHeader*>(cdh);
   dh->payloadSize = payloadMessage->GetSize();
   auto& context = mRegistry->get<MessageContext>();
+  if (batched) {
+    // add keeps the object in the context until the end of the processing, when
+    // all the messages for a given channel are sent together
+    context.add<MessageContext::TrivialObject>(std::move(headerMessage), std::move(payloadMessage), channel);
+    return;
+  }
   // make_scoped creates the context object inside of a scope handler, since it goes out of
   // scope immediately, the created object is scheduled and can be directly sent if the context
   // is configured with the dispatcher callback
@@ -256,6 +263,29 @@ void DataAllocator::snapshot(const Output& spec, const char* payload, size_t pay
   addPartToContext(std::move(payloadMessage), spec, serializationMethod);
 }
 
+void DataAllocator::forwardPayload(const Output& spec, DataRef const& input, bool batched)
+{
+  const auto* inputHeader = o2::header::get<DataHeader*>(input.header);
+  if (inputHeader == nullptr) {
+    throw runtime_error("Forwarded input does not have a DataHeader");
+  }
+  auto& context = mRegistry->get<MessageContext>();
+  std::string const& channel = matchDataHeader(spec, mTimingInfo->timeslice);
+  auto* transport = context.proxy().getTransport(channel, 0);
+  FairMQMessage const* inputPayload = context.findInputPayload(input.payload);
+
+  FairMQMessagePtr payloadMessage;
+  if (inputPayload != nullptr && inputPayload->GetType() == transport->GetType()) {
+    // Copy only adds a reference to the same buffer for shared memory.
+    payloadMessage = transport->CreateMessage();
+    payloadMessage->Copy(*inputPayload);
+  } else {
+    payloadMessage = transport->CreateMessage(inputHeader->payloadSize, fair::mq::Alignment{64});
+    memcpy(payloadMessage->GetData(), input.payload, inputHeader->payloadSize);
+  }
+  addPartToContext(std::move(payloadMessage), spec, inputHeader->payloadSerializationMethod, batched);
+}
+
 Output DataAllocator::getOutputByBind(OutputRef&& ref)
 {
   if (ref.label.empty()) {
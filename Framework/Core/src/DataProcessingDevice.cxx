@@ -515,6 +515,8 @@ void DataProcessingDevice::fillContext(DataProcessorContext& context, DeviceCont
   context.deviceContext = &deviceContext;
   /// Callback for the error handling
   context.errorHandling = &mErrorHandling;
+  mBindingIndex = InputRecord::BindingIndex{mSpec.inputs};
+  context.bindingIndex = &mBindingIndex;
 }
 
 void DataProcessingDevice::PreRun()
@@ -1046,8 +1048,11 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
 
   //
   auto getInputSpan = [&relayer = context.relayer,
+                       &messageContext = context.registry->get<MessageContext>(),
                        &currentSetOfInputs](TimesliceSlot slot) {
     currentSetOfInputs = std::move(relayer->getInputsForTimeslice(slot));
+    // Allows the outputs to share the payloads of the inputs.
+    messageContext.setInputs(&currentSetOfInputs);
     auto getter = [&currentSetOfInputs](size_t i, size_t partindex) -> DataRef {
       if (currentSetOfInputs[i].size() > partindex) {
         return DataRef{nullptr,
@@ -1242,7 +1247,7 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
 
     prepareAllocatorForCurrentTimeSlice(TimesliceSlot{action.slot});
     InputSpan span = getInputSpan(action.slot);
-    InputRecord record{context.deviceContext->spec->inputs, span};
+    InputRecord record{context.deviceContext->spec->inputs, span, context.bindingIndex};
     ProcessingContext processContext{record, *context.registry, *context.allocator};
     {
       ZoneScopedN("service pre processing");
@@ -1313,6 +1318,8 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
       cleanTimers(action.slot, record);
     }
   }
+  // The inputs go out of scope when we return.
+  context.registry->get<MessageContext>().setInputs(nullptr);
   // We now broadcast the end of stream if it was requested
   if (context.deviceContext->state->streaming == StreamingState::EndOfStreaming) {
     for (auto& channel : context.deviceContext->spec->outputChannels) {
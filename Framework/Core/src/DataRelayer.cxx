@@ -57,7 +57,8 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
     mMetrics{metrics},
     mCompletionPolicy{policy},
     mDistinctRoutesIndex{DataRelayerHelpers::createDistinctRouteIndex(routes)},
-    mInputMatchers{DataRelayerHelpers::createInputMatchers(routes)}
+    mInputMatchers{DataRelayerHelpers::createInputMatchers(routes)},
+    mCompiledMatchers{std::make_unique<CompiledInputMatchers>(mInputMatchers, mDistinctRoutesIndex)}
 {
   std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
 
@@ -78,6 +79,8 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
   }
 }
 
+DataRelayer::~DataRelayer() = default;
+
 TimesliceId DataRelayer::getTimesliceForSlot(TimesliceSlot slot)
 {
   std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
@@ -154,26 +157,6 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
   return activity;
 }
 
-/// This does the mapping between a route and a InputSpec. The
-/// reason why these might diffent is that when you have timepipelining
-/// you have one route per timeslice, even if the type is the same.
-size_t matchToContext(void* data,
-                      std::vector<DataDescriptorMatcher> const& matchers,
-                      std::vector<size_t> const& index,
-                      VariableContext& context)
-{
-  for (size_t ri = 0, re = index.size(); ri < re; ++ri) {
-    auto& matcher = matchers[index[ri]];
-
-    if (matcher.match(reinterpret_cast<char const*>(data), context)) {
-      context.commit();
-      return ri;
-    }
-    context.discard();
-  }
-  return INVALID_INPUT;
-}
-
 /// Send the contents of a context as metrics, so that we can examine them in
 /// the GUI.
 void sendVariableContextMetrics(VariableContext& context, TimesliceSlot slot,
@@ -224,14 +207,16 @@ DataRelayer::RelayChoice
   // This returns the identifier for the given input. We use a separate
   // function because while it's trivial now, the actual matchmaking will
   // become more complicated when we will start supporting ranges.
-  auto getInputTimeslice = [&matchers = mInputMatchers,
-                            &distinctRoutes = mDistinctRoutesIndex,
-                            &firstPart,
-                            &index](VariableContext& context)
+  // The headers are looked up only once, and then matched against
+  // the context of each slot.
+  auto messageInfo = mCompiledMatchers->prepare(reinterpret_cast<char const*>(firstPart->GetData()));
+  auto getInputTimeslice = [&matchers = *mCompiledMatchers,
+                            &messageInfo](VariableContext& context)
     -> std::tuple<int, TimesliceId> {
     /// FIXME: for the moment we only use the first context and reset
     /// between one invokation and the other.
-    auto input = matchToContext(firstPart->GetData(), matchers, distinctRoutes, context);
+    auto matched = matchers.match(messageInfo, context);
+    int input = matched == CompiledInputMatchers::INVALID ? INVALID_INPUT : (int)matched;
 
     if (input == INVALID_INPUT) {
       return {
@@ -11,6 +11,12 @@
 
 #include "DataRelayerHelpers.h"
 #include "Framework/DataDescriptorMatcher.h"
+#include "Framework/RuntimeError.h"
+#include "Framework/VariantHelpers.h"
+#include "Headers/DataHeaderHelpers.h"
+#include <array>
+#include <cstring>
+#include <optional>
 #include <stdexcept>
 
 using namespace o2::framework::data_matcher;
@@ -35,6 +41,46 @@ DataDescriptorMatcher fromConcreteMatcher(ConcreteDataMatcher const& matcher)
           DataDescriptorMatcher::Op::Just,
           SubSpecificationTypeValueMatcher{matcher.subSpec})))};
 }
+
+/// Collect the constant origin, description and subSpec which are required
+/// for the matcher to succeed, i.e. the ones reachable via And / Just nodes only.
+struct RequiredValues {
+  std::optional<std::string> origin;
+  std::optional<std::string> description;
+  std::optional<header::DataHeader::SubSpecificationType> subSpec;
+};
+
+void collectRequired(DataDescriptorMatcher const& matcher, RequiredValues& required)
+{
+  using SubSpecificationType = header::DataHeader::SubSpecificationType;
+  if (matcher.getOp() != DataDescriptorMatcher::Op::And && matcher.getOp() != DataDescriptorMatcher::Op::Just) {
+    return;
+  }
+  auto collect = [&required](Node const& node) {
+    std::visit(overloaded{
+                 [&required](OriginValueMatcher const& leaf) {
+                   leaf.visit(overloaded{[&required](std::string const& s) { required.origin = s; },
+                                         [](ContextRef) {}});
+                 },
+                 [&required](DescriptionValueMatcher const& leaf) {
+                   leaf.visit(overloaded{[&required](std::string const& s) { required.description = s; },
+                                         [](ContextRef) {}});
+                 },
+                 [&required](SubSpecificationTypeValueMatcher const& leaf) {
+                   leaf.visit(overloaded{[&required](SubSpecificationType v) { required.subSpec = v; },
+                                         [](ContextRef) {}});
+                 },
+                 [&required](std::unique_ptr<DataDescriptorMatcher> const& child) {
+                   collectRequired(*child, required);
+                 },
+                 [](auto const&) {}},
+               node);
+  };
+  collect(matcher.getLeft());
+  if (matcher.getOp() == DataDescriptorMatcher::Op::And) {
+    collect(matcher.getRight());
+  }
+}
 } // namespace
 
 std::vector<size_t>
@@ -69,4 +115,213 @@ std::vector<DataDescriptorMatcher>
   return result;
 }
 
+bool CompiledInputMatchers::Key::operator==(Key const& other) const
+{
+  return origin == other.origin && description[0] == other.description[0] &&
+         description[1] == other.description[1] && subSpec == other.subSpec;
+}
+
+size_t CompiledInputMatchers::KeyHash::operator()(Key const& key) const
+{
+  uint64_t h = key.description[0] ^ (key.description[1] * 0x9E3779B97F4A7C15ULL);
+  h ^= ((uint64_t(key.origin) << 32) | key.subSpec) * 0xC2B2AE3D27D4EB4FULL;
+  return std::hash<uint64_t>{}(h ^ (h >> 29));
+}
+
+/// Build the key the same way the matchers compare strings, i.e.
+/// up to the first null character and at most the size of the field.
+CompiledInputMatchers::Key CompiledInputMatchers::makeKey(char const* origin, char const* description, uint32_t subSpec)
+{
+  Key key{};
+  char buffer[16];
+  strncpy(buffer, origin, 4);
+  memcpy(&key.origin, buffer, 4);
+  strncpy(buffer, description, 16);
+  memcpy(key.description, buffer, 16);
+  key.subSpec = subSpec;
+  return key;
+}
+
+CompiledInputMatchers::CompiledInputMatchers(std::vector<DataDescriptorMatcher> const& matchers, std::vector<size_t> const& index)
+{
+  for (size_t ri = 0; ri < index.size(); ++ri) {
+    auto& matcher = matchers[index[ri]];
+    mProgramStart.push_back(mProgram.size());
+    compile(matcher);
+
+    RequiredValues required;
+    collectRequired(matcher, required);
+    bool keyed = required.origin && required.description && required.subSpec;
+    mKeyed.push_back(keyed);
+    if (keyed) {
+      mKeyedRoutes[makeKey(required.origin->c_str(), required.description->c_str(), *required.subSpec)].push_back(ri);
+    } else {
+      mUnkeyedRoutes.push_back(ri);
+    }
+  }
+  mProgramStart.push_back(mProgram.size());
+}
+
+void CompiledInputMatchers::compile(DataDescriptorMatcher const& matcher)
+{
+  using Code = Instruction::Code;
+  compile(matcher.getLeft());
+  switch (matcher.getOp()) {
+    case DataDescriptorMatcher::Op::Just:
+      break;
+    case DataDescriptorMatcher::Op::And:
+    case DataDescriptorMatcher::Op::Or: {
+      // Short circuit as the interpreted matcher: the right side is
+      // evaluated only if the left side does not decide the result.
+      auto jump = mProgram.size();
+      mProgram.push_back({matcher.getOp() == DataDescriptorMatcher::Op::And ? Code::JumpIfFalse : Code::JumpIfTrue, 0});
+      compile(matcher.getRight());
+      mProgram[jump].arg = mProgram.size();
+    } break;
+    case DataDescriptorMatcher::Op::Xor:
+      if (++mStackDepth > MAX_STACK_DEPTH) {
+        throw runtime_error("Matcher too deeply nested");
+      }
+      mProgram.push_back({Code::Push, 0});
+      compile(matcher.getRight());
+      mProgram.push_back({Code::Xor, 0});
+      --mStackDepth;
+      break;
+  }
+}
+
+void CompiledInputMatchers::compile(Node const& node)
+{
+  using Code = Instruction::Code;
+  std::visit(overloaded{
+               [this](OriginValueMatcher const& leaf) {
+                 mProgram.push_back({Code::Origin, (uint32_t)mOrigins.size()});
+                 mOrigins.push_back(leaf);
+               },
+               [this](DescriptionValueMatcher const& leaf) {
+                 mProgram.push_back({Code::Description, (uint32_t)mDescriptions.size()});
+                 mDescriptions.push_back(leaf);
+               },
+               [this](SubSpecificationTypeValueMatcher const& leaf) {
+                 mProgram.push_back({Code::SubSpec, (uint32_t)mSubSpecs.size()});
+                 mSubSpecs.push_back(leaf);
+               },
+               [this](StartTimeValueMatcher const& leaf) {
+                 mProgram.push_back({Code::StartTime, (uint32_t)mStartTimes.size()});
+                 mStartTimes.push_back(leaf);
+               },
+               [this](ConstantValueMatcher const& leaf) {
+                 mProgram.push_back({Code::Constant, leaf.match()});
+               },
+               [this](std::unique_ptr<DataDescriptorMatcher> const& child) {
+                 compile(*child);
+               }},
+             node);
+}
+
+CompiledInputMatchers::MessageInfo CompiledInputMatchers::prepare(char const* data) const
+{
+  MessageInfo info;
+  info.dh = o2::header::get<header::DataHeader*>(data);
+  info.dph = o2::header::get<DataProcessingHeader*>(data);
+  if (info.dh) {
+    auto key = makeKey(info.dh->dataOrigin.str, info.dh->dataDescription.str, info.dh->subSpecification);
+    auto it = mKeyedRoutes.find(key);
+    if (it != mKeyedRoutes.end()) {
+      info.keyedRoutes = &it->second;
+    }
+  }
+  return info;
+}
+
+bool CompiledInputMatchers::run(size_t ri, MessageInfo const& info, VariableContext& context) const
+{
+  using Code = Instruction::Code;
+  auto dataHeader = [&info]() -> header::DataHeader const& {
+    if (info.dh == nullptr) {
+      throw runtime_error("Cannot find DataHeader");
+    }
+    return *info.dh;
+  };
+  std::array<bool, MAX_STACK_DEPTH> stack;
+  int depth = 0;
+  bool value = false;
+  for (size_t pc = mProgramStart[ri], pe = mProgramStart[ri + 1]; pc < pe; ++pc) {
+    auto& instruction = mProgram[pc];
+    switch (instruction.code) {
+      case Code::Origin:
+        value = mOrigins[instruction.arg].match(dataHeader(), context);
+        break;
+      case Code::Description:
+        value = mDescriptions[instruction.arg].match(dataHeader(), context);
+        break;
+      case Code::SubSpec:
+        value = mSubSpecs[instruction.arg].match(dataHeader(), context);
+        break;
+      case Code::StartTime:
+        if (info.dph == nullptr) {
+          throw runtime_error("Cannot find DataProcessingHeader");
+        }
+        value = mStartTimes[instruction.arg].match(dataHeader(), *info.dph, context);
+        break;
+      case Code::Constant:
+        value = instruction.arg != 0;
+        break;
+      case Code::JumpIfFalse:
+        if (!value) {
+          pc = instruction.arg - 1;
+        }
+        break;
+      case Code::JumpIfTrue:
+        if (value) {
+          pc = instruction.arg - 1;
+        }
+        break;
+      case Code::Push:
+        stack[depth++] = value;
+        break;
+      case Code::Xor:
+        value = stack[--depth] ^ value;
+        break;
+    }
+  }
+  return value;
+}
+
+size_t CompiledInputMatchers::match(MessageInfo const& info, VariableContext& context) const
+{
+  // Without a DataHeader no hash lookup is possible: evaluate everything in
+  // order, which will report the malformed message.
+  if (info.dh == nullptr) {
+    for (size_t ri = 0, re = mKeyed.size(); ri < re; ++ri) {
+      if (run(ri, info, context)) {
+        context.commit();
+        return ri;
+      }
+      context.discard();
+    }
+    return INVALID;
+  }
+  // Merge the routes with a matching key with the ones which cannot be
+  // indexed, so that the first matching route wins as when walking all
+  // the routes.
+  static const std::vector<size_t> noRoutes;
+  auto const& keyed = info.keyedRoutes ? *info.keyedRoutes : noRoutes;
+  size_t ki = 0, ui = 0;
+  while (ki < keyed.size() || ui < mUnkeyedRoutes.size()) {
+    size_t ri;
+    if (ui == mUnkeyedRoutes.size() || (ki < keyed.size() && keyed[ki] < mUnkeyedRoutes[ui])) {
+      ri = keyed[ki++];
+    } else {
+      ri = mUnkeyedRoutes[ui++];
+    }
+    if (run(ri, info, context)) {
+      context.commit();
+      return ri;
+    }
+    context.discard();
+  }
+  return INVALID;
+}
+
 } // namespace o2::framework
@@ -12,6 +12,9 @@
 #define O2_FRAMEWORK_DATARELAYERHELPERS_H_
 
 #include "Framework/InputRoute.h"
+#include "Framework/DataDescriptorMatcher.h"
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace o2::framework
@@ -25,6 +28,85 @@ struct DataRelayerHelpers {
   static std::vector<data_matcher::DataDescriptorMatcher> createInputMatchers(std::vector<InputRoute> const&);
 };
 
+/// The input matchers of a DataRelayer, compiled once so that matching an
+/// incoming header does not walk every matcher tree. Each matcher is
+/// flattened into a short linear program. Routes which require a constant
+/// (origin, description, subSpec) are additionally indexed by a hash on it,
+/// so that only the routes which can possibly match are evaluated. The result
+/// is the same as evaluating the matchers one by one in route order.
+class CompiledInputMatchers
+{
+ public:
+  constexpr static size_t INVALID = -1;
+  /// Maximum nesting of Xor nodes in a matcher
+  constexpr static int MAX_STACK_DEPTH = 16;
+
+  /// Headers of an incoming message, extracted once and reused when matching
+  /// it against the variable context of each slot.
+  struct MessageInfo {
+    header::DataHeader const* dh = nullptr;
+    DataProcessingHeader const* dph = nullptr;
+    std::vector<size_t> const* keyedRoutes = nullptr; /// Routes requiring exactly the (origin, description, subSpec) of dh
+  };
+
+  /// @a matchers are the matchers of all the routes, @a index the distinct routes to consider
+  CompiledInputMatchers(std::vector<data_matcher::DataDescriptorMatcher> const& matchers, std::vector<size_t> const& index);
+
+  MessageInfo prepare(char const* data) const;
+
+  /// @return the position in the distinct routes index of the first route matching
+  /// the message, INVALID if there is none. The context is committed on success
+  /// and discarded otherwise.
+  size_t match(MessageInfo const& info, data_matcher::VariableContext& context) const;
+
+  /// @return true if the matcher of the distinct route @a ri is part of the hash index
+  bool isKeyed(size_t ri) const { return mKeyed[ri]; }
+
+ private:
+  struct Instruction {
+    enum struct Code : uint8_t {
+      Origin,      /// Evaluate origin matcher arg
+      Description, /// Evaluate description matcher arg
+      SubSpec,     /// Evaluate subspecification matcher arg
+      StartTime,   /// Evaluate start time matcher arg
+      Constant,    /// Load constant arg
+      JumpIfFalse, /// Jump to arg if the current value is false
+      JumpIfTrue,  /// Jump to arg if the current value is true
+      Push,        /// Save the current value on the stack
+      Xor          /// Xor the current value with the one on top of the stack
+    };
+    Code code;
+    uint32_t arg;
+  };
+
+  struct Key {
+    uint32_t origin;
+    uint64_t description[2];
+    uint32_t subSpec;
+    bool operator==(Key const& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(Key const& key) const;
+  };
+
+  void compile(data_matcher::DataDescriptorMatcher const& matcher);
+  void compile(data_matcher::Node const& node);
+  bool run(size_t ri, MessageInfo const& info, data_matcher::VariableContext& context) const;
+  static Key makeKey(char const* origin, char const* description, uint32_t subSpec);
+
+  std::vector<Instruction> mProgram;
+  std::vector<uint32_t> mProgramStart; /// Start of the program of each distinct route, with one extra entry for the end
+  std::vector<data_matcher::OriginValueMatcher> mOrigins;
+  std::vector<data_matcher::DescriptionValueMatcher> mDescriptions;
+  std::vector<data_matcher::SubSpecificationTypeValueMatcher> mSubSpecs;
+  std::vector<data_matcher::StartTimeValueMatcher> mStartTimes;
+  std::unordered_map<Key, std::vector<size_t>, KeyHash> mKeyedRoutes;
+  std::vector<size_t> mUnkeyedRoutes;
+  std::vector<bool> mKeyed;
+  int mStackDepth = 0; /// Stack depth while compiling
+};
+
 } // namespace o2::framework
 
 #endif // O2_FRAMEWORK_DATARELAYERHELPERS_H_
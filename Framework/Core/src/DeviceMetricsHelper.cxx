@@ -170,22 +170,18 @@ size_t DeviceMetricsHelper::bookMetricInfo(DeviceMetricsInfo& info, char const*
 
 bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
                                         DeviceMetricsInfo& info,
-                                        DeviceMetricsHelper::NewMetricCallback newMetricsCallback)
+                                        DeviceMetricsHelper::NewMetricCallback newMetricsCallback,
+                                        size_t* metricIndexOut)
 {
   // get the type
   size_t metricIndex = -1;
 
-  StringMetric stringValue;
   switch (match.type) {
     case MetricType::Float:
     case MetricType::Int:
     case MetricType::Uint64:
+    case MetricType::String:
       break;
-    case MetricType::String: {
-      auto lastChar = std::min(match.endStringValue - match.beginStringValue, StringMetric::MAX_SIZE - 1);
-      memcpy(stringValue.data, match.beginStringValue, lastChar);
-      stringValue.data[lastChar] = '\0';
-    } break;
     default:
       return false;
       break;
@@ -266,7 +262,17 @@ bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
     metricIndex = mi->index;
   }
   assert(metricIndex != -1);
+  if (metricIndexOut) {
+    *metricIndexOut = metricIndex;
+  }
   // We are now guaranteed our metric is present at metricIndex.
+  return storeMetric(match, info, metricIndex);
+}
+
+bool DeviceMetricsHelper::storeMetric(ParsedMetricMatch const& match,
+                                      DeviceMetricsInfo& info,
+                                      size_t metricIndex)
+{
   MetricInfo& metricInfo = info.metrics[metricIndex];
 
   //  auto mod = info.timestamps[metricIndex].size();
@@ -286,7 +292,10 @@ bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
       ++metricInfo.filledMetrics;
     } break;
     case MetricType::String: {
-      info.stringMetrics[metricInfo.storeIdx][metricInfo.pos] = stringValue;
+      auto& stringValue = info.stringMetrics[metricInfo.storeIdx][metricInfo.pos];
+      auto lastChar = std::min(match.endStringValue - match.beginStringValue, StringMetric::MAX_SIZE - 1);
+      memcpy(stringValue.data, match.beginStringValue, lastChar);
+      stringValue.data[lastChar] = '\0';
       // Save the timestamp for the current metric we do it here
       // so that we do not update timestamps for broken metrics
       info.timestamps[metricIndex][metricInfo.pos] = match.timestamp;
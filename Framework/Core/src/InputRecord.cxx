@@ -31,15 +31,63 @@
 namespace o2::framework
 {
 
+InputRecord::BindingIndex::BindingIndex(std::vector<InputRoute> const& inputs)
+{
+  size_t size = 4;
+  while (size < 2 * inputs.size()) {
+    size *= 2;
+  }
+  mSlots.resize(size, {std::string{}, -1});
+  mMask = size - 1;
+  // Same numbering as the linear lookup: only the first timeslice of each
+  // route counts, and the first occurence of a binding wins.
+  int inputIndex = 0;
+  for (auto& route : inputs) {
+    if (route.timeslice != 0) {
+      continue;
+    }
+    auto& binding = route.matcher.binding;
+    if (find(binding) < 0) {
+      size_t slot = std::hash<std::string_view>{}(binding) & mMask;
+      while (mSlots[slot].second >= 0) {
+        slot = (slot + 1) & mMask;
+      }
+      mSlots[slot] = {binding, inputIndex};
+    }
+    ++inputIndex;
+  }
+}
+
+int InputRecord::BindingIndex::find(std::string_view binding) const
+{
+  if (mSlots.empty()) {
+    return -1;
+  }
+  for (size_t slot = std::hash<std::string_view>{}(binding) & mMask;; slot = (slot + 1) & mMask) {
+    auto& entry = mSlots[slot];
+    if (entry.second < 0) {
+      return -1;
+    }
+    if (entry.first == binding) {
+      return entry.second;
+    }
+  }
+}
+
 InputRecord::InputRecord(std::vector<InputRoute> const& inputsSchema,
-                         InputSpan& span)
+                         InputSpan& span,
+                         BindingIndex const* bindingIndex)
   : mInputsSchema{inputsSchema},
-    mSpan{span}
+    mSpan{span},
+    mBindingIndex{bindingIndex}
 {
 }
 
 int InputRecord::getPos(const char* binding) const
 {
+  if (mBindingIndex) {
+    return mBindingIndex->find(binding);
+  }
   auto inputIndex = 0;
   for (size_t i = 0; i < mInputsSchema.size(); ++i) {
     auto& route = mInputsSchema[i];
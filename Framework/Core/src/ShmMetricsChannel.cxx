@@ -0,0 +1,220 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "ShmMetricsChannel.h"
+#include "Framework/DeviceMetricsInfo.h"
+#include "Framework/VariantHelpers.h"
+#include "Framework/Logger.h"
+
+#include <Monitoring/Metric.h>
+
+#include <chrono>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace o2::framework
+{
+
+ShmMetricsChannel::ShmMetricsChannel(std::string name, ShmMetricsSegment* segment, bool owner)
+  : mName{std::move(name)},
+    mSegment{segment},
+    mOwner{owner}
+{
+}
+
+ShmMetricsChannel::~ShmMetricsChannel()
+{
+  munmap(mSegment, sizeof(ShmMetricsSegment));
+  if (mOwner) {
+    shm_unlink(mName.c_str());
+  }
+}
+
+std::unique_ptr<ShmMetricsChannel> ShmMetricsChannel::create(std::string const& name)
+{
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOGP(error, "Unable to create shared memory metrics segment {}: {}", name, strerror(errno));
+    return nullptr;
+  }
+  // A freshly truncated segment is zero filled, so all the positions
+  // and counters start from 0.
+  if (ftruncate(fd, sizeof(ShmMetricsSegment)) != 0) {
+    LOGP(error, "Unable to resize shared memory metrics segment {}: {}", name, strerror(errno));
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  void* ptr = mmap(nullptr, sizeof(ShmMetricsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    LOGP(error, "Unable to map shared memory metrics segment {}: {}", name, strerror(errno));
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  auto* segment = reinterpret_cast<ShmMetricsSegment*>(ptr);
+  segment->magic.store(ShmMetricsSegment::MAGIC, std::memory_order_release);
+  return std::unique_ptr<ShmMetricsChannel>(new ShmMetricsChannel(name, segment, true));
+}
+
+std::unique_ptr<ShmMetricsChannel> ShmMetricsChannel::attach(std::string const& name)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    LOGP(warning, "Unable to open shared memory metrics segment {}: {}. Using text metrics.", name, strerror(errno));
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size != sizeof(ShmMetricsSegment)) {
+    LOGP(warning, "Shared memory metrics segment {} has unexpected size. Using text metrics.", name);
+    close(fd);
+    return nullptr;
+  }
+  void* ptr = mmap(nullptr, sizeof(ShmMetricsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    LOGP(warning, "Unable to map shared memory metrics segment {}: {}. Using text metrics.", name, strerror(errno));
+    return nullptr;
+  }
+  auto* segment = reinterpret_cast<ShmMetricsSegment*>(ptr);
+  if (segment->magic.load(std::memory_order_acquire) != ShmMetricsSegment::MAGIC) {
+    LOGP(warning, "Shared memory metrics segment {} is not valid. Using text metrics.", name);
+    munmap(ptr, sizeof(ShmMetricsSegment));
+    return nullptr;
+  }
+  return std::unique_ptr<ShmMetricsChannel>(new ShmMetricsChannel(name, segment, false));
+}
+
+bool ShmMetricsChannel::send(o2::monitoring::Metric const& metric)
+{
+  // Multi-value metrics are not understood by the driver in any case, so
+  // we leave them to the text protocol.
+  if (metric.getValuesSize() != 1) {
+    return false;
+  }
+  auto const& name = metric.getName();
+  if (name.size() >= ShmMetricsSegment::MAX_NAME_SIZE) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  uint64_t writePos = mSegment->writePos.load(std::memory_order_relaxed);
+  if (writePos - mSegment->readPos.load(std::memory_order_acquire) >= ShmMetricsSegment::RING_SIZE) {
+    return false;
+  }
+
+  ShmMetricRecord& record = mSegment->records[writePos % ShmMetricsSegment::RING_SIZE];
+  bool valid = std::visit(overloaded{
+                            [&record](int value) -> bool {
+                              record.type = (uint32_t)MetricType::Int;
+                              record.intValue = value;
+                              return true;
+                            },
+                            [&record](double value) -> bool {
+                              record.type = (uint32_t)MetricType::Float;
+                              record.floatValue = value;
+                              return true;
+                            },
+                            [&record](uint64_t value) -> bool {
+                              record.type = (uint32_t)MetricType::Uint64;
+                              record.uint64Value = value;
+                              return true;
+                            },
+                            [&record](std::string const& value) -> bool {
+                              if (value.size() >= ShmMetricRecord::MAX_STRING_SIZE) {
+                                return false;
+                              }
+                              record.type = (uint32_t)MetricType::String;
+                              memcpy(record.stringValue, value.data(), value.size());
+                              record.stringValue[value.size()] = '\0';
+                              return true;
+                            },
+                            [](auto) -> bool { return false; }},
+                          metric.getValues()[0].second);
+  if (valid == false) {
+    return false;
+  }
+
+  // Register the name the first time we see it. Names are published
+  // before the record which refers to them, so the driver will always find
+  // them.
+  auto idIt = mIds.find(name);
+  if (idIt == mIds.end()) {
+    uint32_t id = mSegment->registeredNames.load(std::memory_order_relaxed);
+    if (id >= ShmMetricsSegment::MAX_METRICS) {
+      return false;
+    }
+    memcpy(mSegment->names[id], name.data(), name.size());
+    mSegment->names[id][name.size()] = '\0';
+    mSegment->registeredNames.store(id + 1, std::memory_order_release);
+    idIt = mIds.emplace(name, id).first;
+  }
+  record.id = idIt->second;
+  record.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(metric.getTimestamp().time_since_epoch()).count();
+  mSegment->writePos.store(writePos + 1, std::memory_order_release);
+  return true;
+}
+
+size_t ShmMetricsChannel::process(DeviceMetricsInfo& info, DeviceMetricsHelper::NewMetricCallback newMetricCallback)
+{
+  uint64_t end = mSegment->writePos.load(std::memory_order_acquire);
+  uint64_t begin = mSegment->readPos.load(std::memory_order_relaxed);
+  if (begin == end) {
+    return 0;
+  }
+  uint32_t registeredNames = mSegment->registeredNames.load(std::memory_order_acquire);
+  if (mMetricIndices.size() < registeredNames) {
+    mMetricIndices.resize(registeredNames, -1);
+  }
+
+  ParsedMetricMatch match;
+  for (uint64_t pos = begin; pos != end; ++pos) {
+    ShmMetricRecord const& record = mSegment->records[pos % ShmMetricsSegment::RING_SIZE];
+    if (record.id >= registeredNames) {
+      continue;
+    }
+    match.timestamp = record.timestamp;
+    match.type = (MetricType)record.type;
+    switch (match.type) {
+      case MetricType::Int:
+        match.intValue = record.intValue;
+        break;
+      case MetricType::Float:
+        match.floatValue = record.floatValue;
+        break;
+      case MetricType::Uint64:
+        match.uint64Value = record.uint64Value;
+        break;
+      case MetricType::String:
+        match.beginStringValue = record.stringValue;
+        match.endStringValue = record.stringValue + strnlen(record.stringValue, ShmMetricRecord::MAX_STRING_SIZE);
+        break;
+      default:
+        continue;
+    }
+    size_t& metricIndex = mMetricIndices[record.id];
+    if (metricIndex != (size_t)-1) {
+      DeviceMetricsHelper::storeMetric(match, info, metricIndex);
+      continue;
+    }
+    char const* name = mSegment->names[record.id];
+    match.beginKey = name;
+    match.endKey = name + strnlen(name, ShmMetricsSegment::MAX_NAME_SIZE);
+    DeviceMetricsHelper::processMetric(match, info, newMetricCallback, &metricIndex);
+  }
+  mSegment->readPos.store(end, std::memory_order_release);
+  return end - begin;
+}
+
+} // namespace o2::framework
@@ -0,0 +1,120 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_SHMMETRICSCHANNEL_H_
+#define O2_FRAMEWORK_SHMMETRICSCHANNEL_H_
+
+#include "Framework/DeviceMetricsHelper.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::monitoring
+{
+class Metric;
+}
+
+namespace o2::framework
+{
+
+struct DeviceMetricsInfo;
+
+/// A single metric sample, as written by the device in the ring buffer.
+/// The name of the metric is not part of the record, but it is registered
+/// once in the segment name table and referred to by @a id.
+struct ShmMetricRecord {
+  static constexpr size_t MAX_STRING_SIZE = 48;
+  uint32_t id;
+  uint32_t type;
+  uint64_t timestamp;
+  union {
+    int intValue;
+    float floatValue;
+    uint64_t uint64Value;
+    char stringValue[MAX_STRING_SIZE];
+  };
+};
+static_assert(sizeof(ShmMetricRecord) == 64, "ShmMetricRecord must fit a cacheline");
+
+/// Layout of the shared memory segment used by one device. There is
+/// a single producer (the device) and a single consumer (the driver),
+/// so the read and the write positions are enough to synchronise the two.
+struct ShmMetricsSegment {
+  static constexpr uint64_t MAGIC = 0x44504c4d45545231; // DPLMETR1
+  static constexpr size_t MAX_METRICS = 2048;
+  static constexpr size_t MAX_NAME_SIZE = MetricLabel::MAX_METRIC_LABEL_SIZE + 1;
+  static constexpr size_t RING_SIZE = 1 << 14;
+
+  std::atomic<uint64_t> magic;
+  /// Number of entries in @a names which can be safely read
+  std::atomic<uint32_t> registeredNames;
+  alignas(64) std::atomic<uint64_t> writePos;
+  alignas(64) std::atomic<uint64_t> readPos;
+  alignas(64) char names[MAX_METRICS][MAX_NAME_SIZE];
+  ShmMetricRecord records[RING_SIZE];
+};
+
+/// Binary transport for metrics between a device and the driver. It
+/// uses a lock free single producer / single consumer ring buffer in a POSIX
+/// shared memory segment, created by the driver before forking the device
+/// and advertised to it via the DPL_SHM_METRICS environment variable.
+/// Metrics which do not fit the binary representation (e.g. multi-value
+/// metrics, long strings) or which arrive when the ring is full are
+/// not handled, and the caller is expected to use the text protocol
+/// instead.
+class ShmMetricsChannel
+{
+ public:
+  /// Name of the environment variable used to pass the segment to the device
+  static constexpr const char* ENV_VARIABLE = "DPL_SHM_METRICS";
+
+  /// Driver side: create (and own) a new segment called @a name.
+  /// @return nullptr if the segment could not be created.
+  static std::unique_ptr<ShmMetricsChannel> create(std::string const& name);
+  /// Device side: attach to the segment @a name created by the driver.
+  /// @return nullptr if the segment does not exist or it is not valid.
+  static std::unique_ptr<ShmMetricsChannel> attach(std::string const& name);
+
+  ~ShmMetricsChannel();
+
+  /// Device side: push @a metric to the ring buffer.
+  /// @return false if the metric could not be sent in binary form.
+  bool send(o2::monitoring::Metric const& metric);
+
+  /// Driver side: store all the pending records into @a info.
+  /// Metrics are looked up by name only the first time a given
+  /// id is seen.
+  /// @return the number of records processed
+  size_t process(DeviceMetricsInfo& info, DeviceMetricsHelper::NewMetricCallback newMetricCallback = nullptr);
+
+  std::string const& name() const { return mName; }
+
+ private:
+  ShmMetricsChannel(std::string name, ShmMetricsSegment* segment, bool owner);
+
+  std::string mName;
+  ShmMetricsSegment* mSegment = nullptr;
+  bool mOwner = false;
+  /// Device side: serialises the producers in the device and maps names to ids
+  std::mutex mMutex;
+  std::unordered_map<std::string, uint32_t> mIds;
+  /// Driver side: index in the DeviceMetricsInfo of a given id
+  std::vector<size_t> mMetricIndices;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_SHMMETRICSCHANNEL_H_
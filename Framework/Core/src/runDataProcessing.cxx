@@ -67,6 +67,7 @@
 #include <Monitoring/MonitoringFactory.h>
 #include <InfoLogger/InfoLogger.hxx>
 #include "ResourcesMonitoringHelper.h"
+#include "ShmMetricsChannel.h"
 
 #include "FairMQDevice.h"
 #include <fairmq/DeviceRunner.h>
@@ -151,6 +152,9 @@ using DataProcessorSpecs = std::vector<DataProcessorSpec>;
 template class std::vector<DeviceSpec>;
 
 std::vector<DeviceMetricsInfo> gDeviceMetricsInfos;
+/// Binary metrics channels, one per device. nullptr when the device
+/// only uses the text protocol.
+std::vector<std::unique_ptr<ShmMetricsChannel>> gDeviceMetricsChannels;
 
 // FIXME: probably find a better place
 // these are the device options added by the framework, but they can be
@@ -420,6 +424,7 @@ void spawnRemoteDevice(std::string const& forwardedStdin,
   deviceInfos.emplace_back(info);
   // Let's add also metrics information for the given device
   gDeviceMetricsInfos.emplace_back(DeviceMetricsInfo{});
+  gDeviceMetricsChannels.emplace_back(nullptr);
 }
 
 struct DeviceLogContext {
@@ -805,6 +810,12 @@ void spawnDevice(DeviceRef ref,
       service.preFork(serviceRegistry, varmap);
     }
   }
+  // The binary metrics channel needs to exist before the child starts,
+  // so that it can attach to it as soon as the monitoring is created.
+  std::unique_ptr<ShmMetricsChannel> metricsChannel;
+  if (driverInfo.shmMetrics) {
+    metricsChannel = ShmMetricsChannel::create(fmt::format("/dpl-metrics-{}-{}", getpid(), ref.index));
+  }
   // If we have a framework id, it means we have already been respawned
   // and that we are in a child. If not, we need to fork and re-exec, adding
   // the framework-id as one of the options.
@@ -841,6 +852,9 @@ void spawnDevice(DeviceRef ref,
 
     auto portS = std::to_string(driverInfo.tracyPort);
     setenv("TRACY_PORT", portS.c_str(), 1);
+    if (metricsChannel) {
+      setenv(ShmMetricsChannel::ENV_VARIABLE, metricsChannel->name().c_str(), 1);
+    }
     for (auto& service : spec.services) {
       if (service.postForkChild != nullptr) {
         service.postForkChild(serviceRegistry);
@@ -901,6 +915,7 @@ void spawnDevice(DeviceRef ref,
   deviceInfos.emplace_back(info);
   // Let's add also metrics information for the given device
   gDeviceMetricsInfos.emplace_back(DeviceMetricsInfo{});
+  gDeviceMetricsChannels.emplace_back(std::move(metricsChannel));
 }
 
 struct LogProcessingState {
@@ -915,7 +930,8 @@ LogProcessingState processChildrenOutput(DriverInfo& driverInfo,
                                          DeviceInfos& infos,
                                          DeviceSpecs const& specs,
                                          DeviceControls& controls,
-                                         std::vector<DeviceMetricsInfo>& metricsInfos)
+                                         std::vector<DeviceMetricsInfo>& metricsInfos,
+                                         std::vector<std::unique_ptr<ShmMetricsChannel>>& metricsChannels)
 {
   // Display part. All you need to display should actually be in
   // `infos`.
@@ -938,18 +954,12 @@ LogProcessingState processChildrenOutput(DriverInfo& driverInfo,
     DeviceMetricsInfo& metrics = metricsInfos[di];
     assert(specs.size() == infos.size());
     DeviceSpec const& spec = specs[di];
+    auto& metricsChannel = metricsChannels[di];
 
-    if (info.unprinted.empty()) {
+    if (info.unprinted.empty() && !metricsChannel) {
       continue;
     }
 
-    O2_SIGNPOST_START(DriverStatus::ID, DriverStatus::BYTES_PROCESSED, info.pid, 0, 0);
-
-    std::string_view s = info.unprinted;
-    size_t pos = 0;
-    info.history.resize(info.historySize);
-    info.historyLevel.resize(info.historySize);
-
     auto updateMetricsViews =
       Metric2DViewIndex::getUpdater({&info.dataRelayerViewIndex,
                                      &info.variablesViewIndex,
@@ -960,6 +970,22 @@ LogProcessingState processChildrenOutput(DriverInfo& driverInfo,
       hasNewMetric = true;
     };
 
+    // Metrics sent in binary form do not need any parsing.
+    if (metricsChannel && metricsChannel->process(metrics, newMetricCallback)) {
+      result.didProcessMetric = true;
+    }
+
+    if (info.unprinted.empty()) {
+      continue;
+    }
+
+    O2_SIGNPOST_START(DriverStatus::ID, DriverStatus::BYTES_PROCESSED, info.pid, 0, 0);
+
+    std::string_view s = info.unprinted;
+    size_t pos = 0;
+    info.history.resize(info.historySize);
+    info.historyLevel.resize(info.historySize);
+
     while ((pos = s.find(delimiter)) != std::string::npos) {
       std::string token{s.substr(0, pos)};
       auto logLevel = LogParsingHelpers::parseTokenLevel(token);
@@ -1370,6 +1396,15 @@ int runStateMachine(DataProcessorSpecs const& workflow,
   uv_timer_t metricDumpTimer;
   metricDumpTimer.data = &serverContext;
 
+  // Metrics sent via shared memory do not generate any I/O in the driver,
+  // so we need to wake up periodically to process them.
+  uv_timer_t shmMetricsTimer;
+  if (driverInfo.shmMetrics) {
+    uv_timer_init(loop, &shmMetricsTimer);
+    uv_timer_start(
+      &shmMetricsTimer, [](uv_timer_t*) {}, 0, 100);
+  }
+
   while (true) {
     // If control forced some transition on us, we push it to the queue.
     if (driverControl.forcedTransitions.empty() == false) {
@@ -1723,7 +1758,7 @@ int runStateMachine(DataProcessorSpecs const& workflow,
         {
           uint64_t inputProcessingStart = uv_hrtime();
           auto inputProcessingLatency = inputProcessingStart - inputProcessingLast;
-          auto outputProcessing = processChildrenOutput(driverInfo, infos, runningWorkflow.devices, controls, metricsInfos);
+          auto outputProcessing = processChildrenOutput(driverInfo, infos, runningWorkflow.devices, controls, metricsInfos, gDeviceMetricsChannels);
           if (outputProcessing.didProcessMetric) {
             size_t timestamp = current_time_with_ms();
             for (auto& callback : metricProcessingCallbacks) {
@@ -1771,7 +1806,7 @@ int runStateMachine(DataProcessorSpecs const& workflow,
         }
         sigchld_requested = false;
         driverInfo.sigchldRequested = false;
-        auto outputProcessing = processChildrenOutput(driverInfo, infos, runningWorkflow.devices, controls, metricsInfos);
+        auto outputProcessing = processChildrenOutput(driverInfo, infos, runningWorkflow.devices, controls, metricsInfos, gDeviceMetricsChannels);
         if (outputProcessing.didProcessMetric) {
           size_t timestamp = current_time_with_ms();
           for (auto& callback : metricProcessingCallbacks) {
@@ -2203,6 +2238,7 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     ("batch,b", bpo::value<bool>()->zero_tokens()->default_value(isatty(fileno(stdout)) == 0), "batch processing mode")                                   //                                                                                                               //
     ("no-batch", bpo::value<bool>()->zero_tokens()->default_value(false), "force gui processing mode")                                                    //                                                                                                            //
     ("no-cleanup", bpo::value<bool>()->zero_tokens()->default_value(false), "do not cleanup the shm segment")                                             //                                                                                                               //
+    ("shm-metrics", bpo::value<bool>()->zero_tokens()->default_value(false), "send metrics from the devices to the driver via shared memory")                //                                                                                                               //
     ("hostname", bpo::value<std::string>()->default_value("localhost"), "hostname to deploy")                                                             //                                                                                                                 //
     ("resources", bpo::value<std::string>()->default_value(""), "resources allocated for the workflow")                                                   //                                                                                                                   //
     ("start-port,p", bpo::value<unsigned short>()->default_value(22000), "start port to allocate")                                                        //                                                                                                                     //
@@ -2428,6 +2464,7 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
   driverInfo.argv = argv;
   driverInfo.batch = varmap["no-batch"].defaulted() ? varmap["batch"].as<bool>() : false;
   driverInfo.noSHMCleanup = varmap["no-cleanup"].as<bool>();
+  driverInfo.shmMetrics = varmap["shm-metrics"].as<bool>();
   driverInfo.terminationPolicy = varmap["completion-policy"].as<TerminationPolicy>();
   if (varmap["error-policy"].defaulted() && driverInfo.batch == false) {
     driverInfo.errorPolicy = TerminationPolicy::WAIT;
@@ -10,8 +10,11 @@
 // or submit itself to any jurisdiction.
 #include "Framework/DeviceMetricsInfo.h"
 #include "Framework/DeviceMetricsHelper.h"
+#include "../src/ShmMetricsChannel.h"
 
+#include <Monitoring/Metric.h>
 #include <benchmark/benchmark.h>
+#include <unistd.h>
 #include <regex>
 
 // This is the fastest we could ever get.
@@ -96,6 +99,27 @@ static void BM_ProcessIntMetric(benchmark::State& state)
 
 BENCHMARK(BM_ProcessIntMetric);
 
+// Same as above, but going through the binary shared memory channel
+static void BM_ProcessShmIntMetric(benchmark::State& state)
+{
+  using namespace o2::framework;
+  DeviceMetricsInfo info;
+
+  auto name = "/dpl-benchmark-metrics-" + std::to_string(getpid());
+  auto driver = ShmMetricsChannel::create(name);
+  auto device = ShmMetricsChannel::attach(name);
+  o2::monitoring::Metric metric{12, "bkey"};
+  for (auto _ : state) {
+    for (size_t i = 0; i < 1000; ++i) {
+      device->send(metric);
+    }
+    driver->process(info);
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+BENCHMARK(BM_ProcessShmIntMetric);
+
 static void BM_ParseFloatMetric(benchmark::State& state)
 {
   using namespace o2::framework;
@@ -102,4 +102,25 @@ static void BM_InputRecordGenericGetters(benchmark::State& state)
 
 BENCHMARK(BM_InputRecordGenericGetters);
 
+// Lookup of the last binding in a schema with many inputs,
+// with (range(1) == 1) or without the precomputed binding index.
+static void BM_InputRecordGetPos(benchmark::State& state)
+{
+  std::vector<InputRoute> schema;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    InputSpec spec{"input" + std::to_string(i), "TST", "A", static_cast<uint32_t>(i), Lifetime::Timeframe};
+    schema.emplace_back(InputRoute{spec, static_cast<size_t>(i), "source"});
+  }
+  InputRecord::BindingIndex bindingIndex{schema};
+  InputSpan span{[](size_t) { return DataRef{nullptr, nullptr, nullptr}; }, 0};
+  InputRecord record{schema, span, state.range(1) ? &bindingIndex : nullptr};
+  auto last = "input" + std::to_string(state.range(0) - 1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(record.getPos(last.c_str()));
+  }
+}
+
+BENCHMARK(BM_InputRecordGetPos)->Args({8, 0})->Args({8, 1})->Args({256, 0})->Args({256, 1});
+
 BENCHMARK_MAIN();
@@ -593,3 +593,63 @@ BOOST_AUTO_TEST_CASE(SplitParts)
   BOOST_CHECK_NE(header2.get(), nullptr);
   BOOST_CHECK_NE(payload2.get(), nullptr);
 }
+
+// The compiled matchers must give the same route as walking all the
+// matchers in order, including when a wildcard route hides a concrete one.
+BOOST_AUTO_TEST_CASE(TestCompiledMatchers)
+{
+  using namespace o2::framework::data_matcher;
+  std::vector<InputRoute> inputs = {
+    InputRoute{InputSpec{"a", "TPC", "CLUSTERS", 0}, 0, "Fake", 0},
+    InputRoute{InputSpec{"b", ConcreteDataTypeMatcher{"ITS", "CLUSTERS"}}, 1, "Fake", 0},
+    InputRoute{InputSpec{"c", "ITS", "CLUSTERS", 1}, 2, "Fake", 0},
+    InputRoute{InputSpec{"d", "TPC", "TRACKS", 2}, 3, "Fake", 0}};
+
+  auto index = DataRelayerHelpers::createDistinctRouteIndex(inputs);
+  auto matchers = DataRelayerHelpers::createInputMatchers(inputs);
+  CompiledInputMatchers compiled{matchers, index};
+  BOOST_CHECK(compiled.isKeyed(0));
+  BOOST_CHECK(compiled.isKeyed(1) == false);
+  BOOST_CHECK(compiled.isKeyed(2));
+
+  struct Query {
+    char const* origin;
+    char const* description;
+    uint32_t subSpec;
+    size_t expected;
+  };
+  std::vector<Query> queries = {
+    {"TPC", "CLUSTERS", 0, 0},
+    {"TPC", "CLUSTERS", 1, CompiledInputMatchers::INVALID},
+    {"ITS", "CLUSTERS", 1, 1},
+    {"ITS", "CLUSTERS", 5, 1},
+    {"TPC", "TRACKS", 2, 3},
+    {"TPC", "TRACKS", 3, CompiledInputMatchers::INVALID},
+    {"TOF", "CLUSTERS", 0, CompiledInputMatchers::INVALID}};
+
+  for (auto& query : queries) {
+    DataHeader dh;
+    dh.dataOrigin = query.origin;
+    dh.dataDescription = query.description;
+    dh.subSpecification = query.subSpec;
+    DataProcessingHeader dph{0, 1};
+    Stack stack{dh, dph};
+
+    size_t interpreted = CompiledInputMatchers::INVALID;
+    VariableContext interpretedContext;
+    for (size_t ri = 0; ri < index.size(); ++ri) {
+      if (matchers[index[ri]].match(reinterpret_cast<char const*>(stack.data()), interpretedContext)) {
+        interpretedContext.commit();
+        interpreted = ri;
+        break;
+      }
+      interpretedContext.discard();
+    }
+
+    VariableContext context;
+    auto info = compiled.prepare(reinterpret_cast<char const*>(stack.data()));
+    auto result = compiled.match(info, context);
+    BOOST_CHECK_EQUAL(result, query.expected);
+    BOOST_CHECK_EQUAL(result, interpreted);
+  }
+}
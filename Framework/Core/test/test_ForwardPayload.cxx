@@ -0,0 +1,124 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/WorkflowSpec.h"
+#include "Framework/DataProcessorSpec.h"
+#include "Framework/runDataProcessing.h"
+#include "Framework/DataAllocator.h"
+#include "Framework/DataRefUtils.h"
+#include "Framework/InputRecord.h"
+#include "Framework/InputRecordWalker.h"
+#include "Framework/ControlService.h"
+#include "Framework/Logger.h"
+#include "Headers/DataHeader.h"
+#include <vector>
+
+using namespace o2::framework;
+
+#define ASSERT_ERROR(condition)                                   \
+  if ((condition) == false) {                                     \
+    LOG(FATAL) << R"(Test condition ")" #condition R"(" failed)"; \
+  }
+
+// number of parts, each part i holds getPartSize(i) integers with value 1000 * i + k
+constexpr int NParts = 5;
+// order in which the forwarder sends the parts
+constexpr int ForwardOrder[NParts] = {3, 1, 4, 0, 2};
+
+size_t getPartSize(int part)
+{
+  // include a large part to make sure that the payload does not fit in a small buffer
+  return part == 2 ? 1000000 : 10 + part;
+}
+
+DataProcessorSpec getSourceSpec()
+{
+  auto processingFct = [](ProcessingContext& pc) {
+    for (int part = 0; part < NParts; ++part) {
+      auto values = pc.outputs().make<int>(Output{"TST", "PARTS", static_cast<o2::header::DataHeader::SubSpecificationType>(part), Lifetime::Timeframe}, getPartSize(part));
+      for (size_t k = 0; k < values.size(); ++k) {
+        values[k] = 1000 * part + static_cast<int>(k);
+      }
+    }
+    pc.outputs().make<int>(Output{"TST", "SINGLE", 0, Lifetime::Timeframe}) = 42;
+    pc.services().get<ControlService>().endOfStream();
+    pc.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+  };
+
+  return DataProcessorSpec{"source",
+                           {},
+                           {OutputSpec{{"parts"}, ConcreteDataTypeMatcher{"TST", "PARTS"}, Lifetime::Timeframe},
+                            OutputSpec{"TST", "SINGLE", 0, Lifetime::Timeframe}},
+                           AlgorithmSpec(processingFct)};
+}
+
+// forwards all parts batched, in a different order than received, and the single input not batched
+DataProcessorSpec getForwarderSpec()
+{
+  auto processingFct = [](ProcessingContext& pc) {
+    std::vector<DataRef> parts(NParts);
+    for (auto const& ref : InputRecordWalker(pc.inputs())) {
+      auto const* dh = DataRefUtils::getHeader<o2::header::DataHeader*>(ref);
+      if (dh->dataDescription == o2::header::DataDescription("PARTS")) {
+        ASSERT_ERROR(dh->subSpecification < static_cast<uint32_t>(NParts));
+        parts[dh->subSpecification] = ref;
+      }
+    }
+    for (int part : ForwardOrder) {
+      ASSERT_ERROR(parts[part].payload != nullptr);
+      pc.outputs().forwardPayload(Output{"TST", "FWD", static_cast<o2::header::DataHeader::SubSpecificationType>(part), Lifetime::Timeframe}, parts[part], true);
+    }
+    pc.outputs().forwardPayload(Output{"TST", "FWDSINGLE", 0, Lifetime::Timeframe}, pc.inputs().get("single"));
+  };
+
+  return DataProcessorSpec{"forwarder",
+                           {InputSpec{"parts", ConcreteDataTypeMatcher{"TST", "PARTS"}, Lifetime::Timeframe},
+                            InputSpec{"single", "TST", "SINGLE", 0, Lifetime::Timeframe}},
+                           {OutputSpec{{"fwd"}, ConcreteDataTypeMatcher{"TST", "FWD"}, Lifetime::Timeframe},
+                            OutputSpec{"TST", "FWDSINGLE", 0, Lifetime::Timeframe}},
+                           AlgorithmSpec(processingFct)};
+}
+
+// checks that the forwarded parts arrive in the order they were sent, with their full payload
+DataProcessorSpec getSinkSpec()
+{
+  auto processingFct = [](ProcessingContext& pc) {
+    int nPart = 0;
+    for (auto const& ref : InputRecordWalker(pc.inputs(), {InputSpec{"fwd", ConcreteDataTypeMatcher{"TST", "FWD"}}})) {
+      ASSERT_ERROR(nPart < NParts);
+      auto const* dh = DataRefUtils::getHeader<o2::header::DataHeader*>(ref);
+      const int part = ForwardOrder[nPart];
+      LOG(INFO) << "part " << nPart << ": subspec " << dh->subSpecification << ", payload size " << dh->payloadSize;
+      ASSERT_ERROR(dh->subSpecification == static_cast<uint32_t>(part));
+      ASSERT_ERROR(dh->payloadSerializationMethod == o2::header::gSerializationMethodNone);
+      auto values = DataRefUtils::as<int>(ref);
+      ASSERT_ERROR(values.size() == getPartSize(part));
+      for (size_t k = 0; k < values.size(); ++k) {
+        ASSERT_ERROR(values[k] == 1000 * part + static_cast<int>(k));
+      }
+      nPart++;
+    }
+    ASSERT_ERROR(nPart == NParts);
+    ASSERT_ERROR(pc.inputs().get<int>("single") == 42);
+    pc.services().get<ControlService>().readyToQuit(QuitRequest::All);
+  };
+
+  return DataProcessorSpec{"sink",
+                           {InputSpec{"fwd", ConcreteDataTypeMatcher{"TST", "FWD"}, Lifetime::Timeframe},
+                            InputSpec{"single", "TST", "FWDSINGLE", 0, Lifetime::Timeframe}},
+                           Outputs{},
+                           AlgorithmSpec(processingFct)};
+}
+
+WorkflowSpec defineDataProcessing(ConfigContext const&)
+{
+  return WorkflowSpec{getSourceSpec(), getForwarderSpec(), getSinkSpec()};
+}
@@ -104,6 +104,13 @@ BOOST_AUTO_TEST_CASE(TestInputRecord)
   auto ref20 = record.get("z");
   BOOST_CHECK_EXCEPTION(record.get("err"), RuntimeErrorRef, any_exception);
 
+  // The precomputed binding index gives the same positions
+  InputRecord::BindingIndex bindingIndex{schema};
+  InputRecord indexedRecord{schema, span2, &bindingIndex};
+  for (auto binding : {"x", "y", "z", "err"}) {
+    BOOST_CHECK_EQUAL(indexedRecord.getPos(binding), record.getPos(binding));
+  }
+
   // Or we can get it positionally
   BOOST_CHECK_NO_THROW(record.get("x"));
   auto ref01 = record.getByPos(0);
@@ -0,0 +1,83 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework ShmMetricsChannel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "../src/ShmMetricsChannel.h"
+#include "Framework/DeviceMetricsInfo.h"
+#include "Framework/DeviceMetricsHelper.h"
+#include <Monitoring/Metric.h>
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <unistd.h>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestShmMetricsChannel)
+{
+  auto name = "/dpl-test-metrics-" + std::to_string(getpid());
+  auto driver = ShmMetricsChannel::create(name);
+  BOOST_REQUIRE(driver != nullptr);
+  auto device = ShmMetricsChannel::attach(name);
+  BOOST_REQUIRE(device != nullptr);
+  BOOST_CHECK(ShmMetricsChannel::attach(name + "-missing") == nullptr);
+
+  DeviceMetricsInfo info;
+  size_t newMetrics = 0;
+  auto newMetricCallback = [&newMetrics](std::string const&, MetricInfo const&, int, size_t) { ++newMetrics; };
+
+  BOOST_CHECK_EQUAL(driver->process(info, newMetricCallback), 0);
+  BOOST_CHECK(device->send(o2::monitoring::Metric{12, "bkey"}));
+  BOOST_CHECK(device->send(o2::monitoring::Metric{16.5, "akey"}));
+  BOOST_CHECK(device->send(o2::monitoring::Metric{std::string{"some_string"}, "ckey"}));
+  BOOST_CHECK(device->send(o2::monitoring::Metric{(uint64_t)1 << 40, "dkey"}));
+  BOOST_CHECK(device->send(o2::monitoring::Metric{13, "bkey"}));
+  // Too long for the binary representation, needs to go via text.
+  BOOST_CHECK(device->send(o2::monitoring::Metric{std::string(ShmMetricRecord::MAX_STRING_SIZE, 'x'), "ekey"}) == false);
+
+  BOOST_CHECK_EQUAL(driver->process(info, newMetricCallback), 5);
+  BOOST_CHECK_EQUAL(newMetrics, 4);
+  BOOST_REQUIRE_EQUAL(info.metrics.size(), 4);
+
+  auto bkey = DeviceMetricsHelper::metricIdxByName("bkey", info);
+  BOOST_REQUIRE_LT(bkey, info.metrics.size());
+  BOOST_CHECK_EQUAL(info.metrics[bkey].type, MetricType::Int);
+  BOOST_CHECK_EQUAL(info.metrics[bkey].filledMetrics, 2);
+  BOOST_CHECK_EQUAL(info.intMetrics[info.metrics[bkey].storeIdx][0], 12);
+  BOOST_CHECK_EQUAL(info.intMetrics[info.metrics[bkey].storeIdx][1], 13);
+
+  auto akey = DeviceMetricsHelper::metricIdxByName("akey", info);
+  BOOST_REQUIRE_LT(akey, info.metrics.size());
+  BOOST_CHECK_EQUAL(info.metrics[akey].type, MetricType::Float);
+  BOOST_CHECK_EQUAL(info.floatMetrics[info.metrics[akey].storeIdx][0], 16.5f);
+
+  auto ckey = DeviceMetricsHelper::metricIdxByName("ckey", info);
+  BOOST_REQUIRE_LT(ckey, info.metrics.size());
+  BOOST_CHECK_EQUAL(info.metrics[ckey].type, MetricType::String);
+  BOOST_CHECK_EQUAL(std::string(info.stringMetrics[info.metrics[ckey].storeIdx][0].data), "some_string");
+
+  auto dkey = DeviceMetricsHelper::metricIdxByName("dkey", info);
+  BOOST_REQUIRE_LT(dkey, info.metrics.size());
+  BOOST_CHECK_EQUAL(info.metrics[dkey].type, MetricType::Uint64);
+  BOOST_CHECK_EQUAL(info.uint64Metrics[info.metrics[dkey].storeIdx][0], (uint64_t)1 << 40);
+
+  // Fill the ring: the device must report the failure so that the
+  // caller can fall back to the text protocol.
+  size_t sent = 0;
+  while (device->send(o2::monitoring::Metric{1, "bkey"})) {
+    ++sent;
+  }
+  BOOST_CHECK_EQUAL(sent, ShmMetricsSegment::RING_SIZE);
+  BOOST_CHECK_EQUAL(driver->process(info, newMetricCallback), sent);
+  BOOST_CHECK_EQUAL(newMetrics, 4);
+  BOOST_CHECK(device->send(o2::monitoring::Metric{1, "bkey"}));
+}
@@ -20,6 +20,7 @@
 #include "Steer/HitProcessingManager.h" // for DigitizationContext
 #include "DataFormatsITSMFT/Digit.h"
 #include "SimulationDataFormat/ConstMCTruthContainer.h"
+#include "SimulationDataFormat/ChunkedMCTruthContainer.h"
 #include "DetectorsBase/BaseDPLDigitizer.h"
 #include "DetectorsCommonDataFormats/DetID.h"
 #include "DetectorsCommonDataFormats/SimTraits.h"
@@ -137,7 +138,7 @@ class ITSMFTDPLDigitizerTask : BaseDPLDigitizer
 
       std::copy(mROFRecords.begin(), mROFRecords.end(), std::back_inserter(mROFRecordsAccum));
       if (mWithMCTruth) {
-        mLabelsAccum.mergeAtBack(mLabels);
+        mLabelsAccum.mergeAtBack(std::move(mLabels)); // takes over the storage of mLabels
       }
       LOG(INFO) << "Added " << mDigits.size() << " digits ";
       // clean containers from already accumulated stuff
@@ -182,7 +183,7 @@ class ITSMFTDPLDigitizerTask : BaseDPLDigitizer
       mLabelsAccum.flatten_to(sharedlabels);
       // free space of existing label containers
       mLabels.clear_andfreememory();
-      mLabelsAccum.clear_andfreememory();
+      mLabelsAccum.clear();
     }
     LOG(INFO) << mID.getName() << ": Sending ROMode= " << mROMode << " to GRPUpdater";
     pc.outputs().snapshot(Output{mOrigin, "ROMode", 0, Lifetime::Timeframe}, mROMode);
@@ -211,7 +212,7 @@ class ITSMFTDPLDigitizerTask : BaseDPLDigitizer
   std::vector<o2::itsmft::Hit> mHits;
   std::vector<o2::itsmft::Hit>* mHitsP = &mHits;
   o2::dataformats::MCTruthContainer<o2::MCCompLabel> mLabels;
-  o2::dataformats::MCTruthContainer<o2::MCCompLabel> mLabelsAccum;
+  o2::dataformats::ChunkedMCTruthContainer<o2::MCCompLabel> mLabelsAccum;
   std::vector<o2::itsmft::MC2ROFRecord> mMC2ROFRecordsAccum;
   std::vector<TChain*> mSimChains;
 
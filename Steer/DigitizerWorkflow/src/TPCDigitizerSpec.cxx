@@ -118,6 +118,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     mWithMCTruth = o2::conf::DigiParams::Instance().mctruth;
     auto useDistortions = ic.options().get<int>("distortionType");
     auto triggeredMode = ic.options().get<bool>("TPCtriggered");
+    auto nThreads = ic.options().get<int>("nthreads");
 
     if (useDistortions > 0) {
       if (useDistortions == 1) {
@@ -125,6 +126,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       } else {
         LOG(INFO) << "Using constant space-charge distortions.";
       }
+      mDigitizer.setUseSCDistortionLUT(ic.options().get<bool>("useDistortionLUT"));
       auto readSpaceChargeString = ic.options().get<std::string>("readSpaceCharge");
       std::vector<std::string> readSpaceCharge;
       std::stringstream ssSpaceCharge(readSpaceChargeString);
@@ -169,6 +171,8 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       }
     }
     mDigitizer.setContinuousReadout(!triggeredMode);
+    o2::tpc::Digitizer::setNThreads(std::max(1, nThreads));
+    LOG(INFO) << "TPC: Digitizing with " << o2::tpc::Digitizer::getNThreads() << " threads";
 
     // we send the GRP data once if the corresponding output channel is available
     // and set the flag to false after
@@ -484,7 +488,9 @@ o2::framework::DataProcessorSpec getTPCDigitizerSpec(int channel, bool writeGRP,
     Options{{"distortionType", VariantType::Int, 0, {"Distortion type to be used. 0 = no distortions (default), 1 = realistic distortions (not implemented yet), 2 = constant distortions"}},
             {"initialSpaceChargeDensity", VariantType::String, "", {"Path to root file containing TH3 with initial space-charge density and name of the TH3 (comma separated)"}},
             {"readSpaceCharge", VariantType::String, "", {"Path to root file containing pre-calculated space-charge object and name of the object (comma separated)"}},
-            {"TPCtriggered", VariantType::Bool, false, {"Impose triggered RO mode (default: continuous)"}}}};
+            {"useDistortionLUT", VariantType::Bool, false, {"Distort the electrons with a fine-grained lookup table of the space-charge distortions (faster, requires ~300 MB per space-charge object)"}},
+            {"TPCtriggered", VariantType::Bool, false, {"Impose triggered RO mode (default: continuous)"}},
+            {"nthreads", VariantType::Int, 1, {"Number of threads used to digitize each sector, the output is identical to the one with a single thread"}}}};
 }
 
 o2::framework::WorkflowSpec getTPCDigitizerSpec(int nLanes, std::vector<int> const& sectors, bool mctruth, bool internalwriter)
@@ -73,6 +73,7 @@ class Dispatcher : public framework::Task
   std::string mName;
   DataSamplingHeader::DeviceIDType mDeviceID = "invalid";
   std::string mReconfigurationSource;
+  bool mBatchedForwarding = false;
   // policies should be shared between all pipeline threads
   std::vector<std::shared_ptr<DataSamplingPolicy>> mPolicies;
 };
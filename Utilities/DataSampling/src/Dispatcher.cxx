@@ -73,6 +73,10 @@ void Dispatcher::init(InitContext& ctx)
 
   auto spec = ctx.services().get<const DeviceSpec>();
   mDeviceID.runtimeInit(spec.id.substr(0, DataSamplingHeader::deviceIDTypeSize).c_str());
+
+  if (ctx.options().isSet("batched-forwarding")) {
+    mBatchedForwarding = ctx.options().get<bool>("batched-forwarding");
+  }
 }
 
 void Dispatcher::run(ProcessingContext& ctx)
@@ -163,8 +167,9 @@ header::Stack Dispatcher::extractAdditionalHeaders(const char* inputHeaderStack)
 
 void Dispatcher::send(DataAllocator& dataAllocator, const DataRef& inputData, const Output& output) const
 {
-  const auto* inputHeader = header::get<header::DataHeader*>(inputData.header);
-  dataAllocator.snapshot(output, inputData.payload, inputHeader->payloadSize, inputHeader->payloadSerializationMethod);
+  // The sampled payload is shared with the input message whenever the transport allows it,
+  // only the header is new.
+  dataAllocator.forwardPayload(output, inputData, mBatchedForwarding);
 }
 
 void Dispatcher::registerPolicy(std::unique_ptr<DataSamplingPolicy>&& policy)
@@ -225,7 +230,8 @@ Outputs Dispatcher::getOutputSpecs()
 }
 framework::Options Dispatcher::getOptions()
 {
-  return {{"period-timer-stats", framework::VariantType::Int, 10 * 1000000, {"Dispatcher's stats timer period"}}};
+  return {{"period-timer-stats", framework::VariantType::Int, 10 * 1000000, {"Dispatcher's stats timer period"}},
+          {"batched-forwarding", framework::VariantType::Bool, false, {"Send all the parts sampled in one go together, regardless of the dispatch policy"}}};
 }
 
 size_t Dispatcher::numberOfPolicies()